@@ -0,0 +1,71 @@
+/*
+ * PROJECT:         ReactOS Win32 Base API
+ * LICENSE:         GPL - See COPYING in the top level directory
+ * FILE:            dll/win32/kernel32_vista/GetQueuedCompletionStatusEx.c
+ * PURPOSE:         Batched I/O completion port dequeue
+ */
+
+#include "k32_vista.h"
+
+#include <ndk/iofuncs.h>
+
+/* The native API fills OVERLAPPED_ENTRY arrays in place */
+C_ASSERT(sizeof(OVERLAPPED_ENTRY) == sizeof(FILE_IO_COMPLETION_INFORMATION));
+C_ASSERT(FIELD_OFFSET(OVERLAPPED_ENTRY, lpCompletionKey) == FIELD_OFFSET(FILE_IO_COMPLETION_INFORMATION, KeyContext));
+C_ASSERT(FIELD_OFFSET(OVERLAPPED_ENTRY, lpOverlapped) == FIELD_OFFSET(FILE_IO_COMPLETION_INFORMATION, ApcContext));
+C_ASSERT(FIELD_OFFSET(OVERLAPPED_ENTRY, Internal) == FIELD_OFFSET(FILE_IO_COMPLETION_INFORMATION, IoStatusBlock.Status));
+C_ASSERT(FIELD_OFFSET(OVERLAPPED_ENTRY, dwNumberOfBytesTransferred) == FIELD_OFFSET(FILE_IO_COMPLETION_INFORMATION, IoStatusBlock.Information));
+
+/*
+ * @implemented
+ */
+BOOL
+WINAPI
+GetQueuedCompletionStatusEx(IN HANDLE CompletionPort,
+                            OUT LPOVERLAPPED_ENTRY lpCompletionPortEntries,
+                            IN ULONG ulCount,
+                            OUT PULONG ulNumEntriesRemoved,
+                            IN DWORD dwMilliseconds,
+                            IN BOOL fAlertable)
+{
+    NTSTATUS Status;
+    LARGE_INTEGER Time;
+    PLARGE_INTEGER TimePtr = NULL;
+
+    /* Convert the timeout, INFINITE means no timeout at all */
+    if (dwMilliseconds != INFINITE)
+    {
+        Time.QuadPart = -(LONGLONG)dwMilliseconds * 10000;
+        TimePtr = &Time;
+    }
+
+    /* Remove as many packets as we can in a single call */
+    Status = NtRemoveIoCompletionEx(CompletionPort,
+                                    (PFILE_IO_COMPLETION_INFORMATION)lpCompletionPortEntries,
+                                    ulCount,
+                                    ulNumEntriesRemoved,
+                                    TimePtr,
+                                    fAlertable ? TRUE : FALSE);
+    if (!(NT_SUCCESS(Status)) || (Status == STATUS_TIMEOUT))
+    {
+        /* Nothing was removed */
+        *ulNumEntriesRemoved = 0;
+
+        /* Timeout is set directly, anything else gets converted */
+        if (Status == STATUS_TIMEOUT)
+            SetLastError(WAIT_TIMEOUT);
+        else
+            SetLastError(RtlNtStatusToDosError(Status));
+        return FALSE;
+    }
+
+    /* A user APC ran, or the thread was alerted, instead of dequeuing anything */
+    if ((Status == STATUS_USER_APC) || (Status == STATUS_ALERTED))
+    {
+        *ulNumEntriesRemoved = 0;
+        SetLastError(WAIT_IO_COMPLETION);
+        return FALSE;
+    }
+
+    return TRUE;
+}
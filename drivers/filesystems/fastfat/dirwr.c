@@ -650,9 +650,12 @@ FATAddEntry(
     }
     if (!NT_SUCCESS(Status))
     {
+        /* The entry is on disk but can't be indexed */
+        vfatDestroyDirIndex(ParentFcb);
         ExFreePoolWithTag(Buffer, TAG_VFAT);
         return Status;
     }
+    vfatDirIndexAddEntry(ParentFcb, *Fcb);
 
     DPRINT("new : entry=%11.11s\n", (*Fcb)->entry.Fat.Filename);
     DPRINT("new : entry=%11.11s\n", DirContext.DirEntry.Fat.Filename);
@@ -835,6 +838,7 @@ FATDelEntry(
 
     DPRINT("delEntry PathName \'%wZ\'\n", &pFcb->PathNameU);
     DPRINT("delete entry: %u to %u\n", pFcb->startIndex, pFcb->dirIndex);
+    vfatDirIndexRemoveEntry(pFcb->parentFcb, pFcb);
     Offset.u.HighPart = 0;
     for (i = pFcb->startIndex; i <= pFcb->dirIndex; i++)
     {
@@ -302,6 +302,72 @@ FAT12FindAndMarkAvailableCluster(
     return STATUS_DISK_FULL;
 }
 
+static
+NTSTATUS
+FAT32CountAvailableClusters(
+    PDEVICE_EXTENSION DeviceExt);
+
+/*
+ * FUNCTION: Finds the first available cluster in a FAT32 table using the
+ *           in-memory free cluster bitmap
+ */
+static
+NTSTATUS
+FAT32FindAndMarkAvailableClusterFromBitmap(
+    PDEVICE_EXTENSION DeviceExt,
+    PULONG Cluster)
+{
+    ULONG i;
+    PVOID BaseAddress;
+    ULONG ChunkSize;
+    PVOID Context;
+    LARGE_INTEGER Offset;
+    PULONG Block;
+
+    ChunkSize = CACHEPAGESIZE(DeviceExt);
+    *Cluster = 0;
+
+    for (;;)
+    {
+        /* The search starts at the hint and wraps around to the first cluster */
+        i = RtlFindClearBits(&DeviceExt->FreeClusterBitmap, 1, DeviceExt->LastAvailableCluster);
+        if (i == 0xFFFFFFFF)
+            return STATUS_DISK_FULL;
+
+        Offset.QuadPart = ROUND_DOWN(i * 4, ChunkSize);
+        _SEH2_TRY
+        {
+            CcPinRead(DeviceExt->FATFileObject, &Offset, ChunkSize, PIN_WAIT, &Context, &BaseAddress);
+        }
+        _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
+        {
+            DPRINT1("CcPinRead(Offset %x, Length %u) failed\n", (ULONG)Offset.QuadPart, ChunkSize);
+            _SEH2_YIELD(return _SEH2_GetExceptionCode());
+        }
+        _SEH2_END;
+        Block = (PULONG)((ULONG_PTR)BaseAddress + (i * 4) % ChunkSize);
+
+        RtlSetBit(&DeviceExt->FreeClusterBitmap, i);
+        if (DeviceExt->AvailableClustersValid)
+            InterlockedDecrement((PLONG)&DeviceExt->AvailableClusters);
+
+        /* Never trust the bitmap over the FAT itself */
+        if ((*Block & 0x0fffffff) != 0)
+        {
+            DPRINT1("Cluster 0x%x is free in the bitmap but not in the FAT\n", i);
+            CcUnpinData(Context);
+            continue;
+        }
+
+        DPRINT("Found available cluster 0x%x\n", i);
+        DeviceExt->LastAvailableCluster = *Cluster = i;
+        *Block = 0x0fffffff;
+        CcSetDirtyPinnedData(Context, NULL);
+        CcUnpinData(Context);
+        return STATUS_SUCCESS;
+    }
+}
+
 /*
  * FUNCTION: Finds the first available cluster in a FAT32 table
  */
@@ -320,6 +386,13 @@ FAT32FindAndMarkAvailableCluster(
     PULONG Block;
     PULONG BlockEnd;
 
+    /* The first count of the volume also builds the free cluster bitmap */
+    if (!DeviceExt->AvailableClustersValid)
+        FAT32CountAvailableClusters(DeviceExt);
+
+    if (DeviceExt->FreeClusterBitmapValid)
+        return FAT32FindAndMarkAvailableClusterFromBitmap(DeviceExt, Cluster);
+
     ChunkSize = CACHEPAGESIZE(DeviceExt);
     FatLength = (DeviceExt->FatInfo.NumberOfClusters + 2);
     *Cluster = 0;
@@ -480,7 +553,58 @@ FAT16CountAvailableClusters(
 
 
 /*
- * FUNCTION: Counts free clusters in a FAT32 table
+ * FUNCTION: Allocates the free cluster bitmap of a FAT32 volume, with every
+ *           cluster marked as free but the two reserved ones
+ */
+static
+BOOLEAN
+FAT32AllocateFreeClusterBitmap(
+    PDEVICE_EXTENSION DeviceExt)
+{
+    PULONG Buffer;
+    ULONG FatLength;
+    ULONG BitmapSize;
+
+    ASSERT(!DeviceExt->FreeClusterBitmapValid);
+
+    /* One extra set bit at the end, RtlFindClearBits never returns the last bit */
+    FatLength = (DeviceExt->FatInfo.NumberOfClusters + 2);
+    BitmapSize = ROUND_UP(FatLength + 1, 32) / 8;
+
+    Buffer = DeviceExt->FreeClusterBitmap.Buffer;
+    if (Buffer == NULL)
+    {
+        Buffer = ExAllocatePoolWithTag(PagedPool, BitmapSize, TAG_BITMAP);
+        if (Buffer == NULL)
+            return FALSE;
+    }
+
+    RtlInitializeBitMap(&DeviceExt->FreeClusterBitmap, Buffer, FatLength + 1);
+    RtlClearAllBits(&DeviceExt->FreeClusterBitmap);
+    RtlSetBits(&DeviceExt->FreeClusterBitmap, 0, 2);
+    RtlSetBit(&DeviceExt->FreeClusterBitmap, FatLength);
+
+    return TRUE;
+}
+
+/*
+ * FUNCTION: Releases the free cluster bitmap of a volume
+ */
+VOID
+FreeClusterBitmapCleanup(
+    PDEVICE_EXTENSION DeviceExt)
+{
+    DeviceExt->FreeClusterBitmapValid = FALSE;
+    if (DeviceExt->FreeClusterBitmap.Buffer != NULL)
+    {
+        ExFreePoolWithTag(DeviceExt->FreeClusterBitmap.Buffer, TAG_BITMAP);
+        DeviceExt->FreeClusterBitmap.Buffer = NULL;
+    }
+}
+
+/*
+ * FUNCTION: Counts free clusters in a FAT32 table and, memory permitting,
+ *           builds the free cluster bitmap on the way
  */
 static
 NTSTATUS
@@ -496,10 +620,14 @@ FAT32CountAvailableClusters(
     PVOID Context = NULL;
     LARGE_INTEGER Offset;
     ULONG FatLength;
+    BOOLEAN BuildBitmap;
 
     ChunkSize = CACHEPAGESIZE(DeviceExt);
     FatLength = (DeviceExt->FatInfo.NumberOfClusters + 2);
 
+    DeviceExt->FreeClusterBitmapValid = FALSE;
+    BuildBitmap = FAT32AllocateFreeClusterBitmap(DeviceExt);
+
     for (i = 2; i < FatLength; )
     {
         Offset.QuadPart = ROUND_DOWN(i * 4, ChunkSize);
@@ -521,6 +649,8 @@ FAT32CountAvailableClusters(
         {
             if ((*Block & 0x0fffffff) == 0)
                 ulCount++;
+            else if (BuildBitmap)
+                RtlSetBit(&DeviceExt->FreeClusterBitmap, i);
             Block++;
             i++;
         }
@@ -530,6 +660,11 @@ FAT32CountAvailableClusters(
 
     DeviceExt->AvailableClusters = ulCount;
     DeviceExt->AvailableClustersValid = TRUE;
+    if (BuildBitmap)
+    {
+        ASSERT(RtlNumberOfClearBits(&DeviceExt->FreeClusterBitmap) == ulCount);
+        DeviceExt->FreeClusterBitmapValid = TRUE;
+    }
 
     return STATUS_SUCCESS;
 }
@@ -713,6 +848,14 @@ WriteCluster(
         else if (OldValue == 0 && NewValue)
             InterlockedDecrement((PLONG)&DeviceExt->AvailableClusters);
     }
+    if (NT_SUCCESS(Status) && DeviceExt->FreeClusterBitmapValid &&
+        ClusterToWrite >= 2 && ClusterToWrite < DeviceExt->FatInfo.NumberOfClusters + 2)
+    {
+        if (NewValue == 0)
+            RtlClearBit(&DeviceExt->FreeClusterBitmap, ClusterToWrite);
+        else
+            RtlSetBit(&DeviceExt->FreeClusterBitmap, ClusterToWrite);
+    }
     ExReleaseResourceLite(&DeviceExt->FatResource);
     return Status;
 }
@@ -799,6 +942,10 @@ GetNextClusterExtend(
     if ((*NextCluster) == 0xFFFFFFFF)
     {
         /* We are after last existing cluster, we must add one to file */
+        /* Start looking right after it, so that files grow contiguously */
+        if (CurrentCluster + 1 < DeviceExt->FatInfo.NumberOfClusters + 2)
+            DeviceExt->LastAvailableCluster = CurrentCluster + 1;
+
         /* Firstly, find the next available open allocation unit and
            mark it as end of file */
         Status = DeviceExt->FindAndMarkAvailableCluster(DeviceExt, &NewCluster);
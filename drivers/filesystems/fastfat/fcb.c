@@ -24,6 +24,10 @@
 
 #define TAG_FCB 'BCFV'
 
+/* Directories smaller than this are scanned rather than indexed */
+#define VFAT_DIR_INDEX_MIN_SIZE     PAGE_SIZE
+#define VFAT_DIR_INDEX_MIN_BUCKETS  64
+
 #ifdef KDBG
 extern UNICODE_STRING DebugFile;
 #endif
@@ -154,6 +158,7 @@ vfatNewFCB(
     ExInitializeResourceLite(&rcFCB->MainResource);
     FsRtlInitializeFileLock(&rcFCB->FileLock, NULL, NULL);
     ExInitializeFastMutex(&rcFCB->LastMutex);
+    FsRtlInitializeLargeMcb(&rcFCB->ExtentMcb, PagedPool);
     rcFCB->RFCB.PagingIoResource = &rcFCB->PagingIoResource;
     rcFCB->RFCB.Resource = &rcFCB->MainResource;
     rcFCB->RFCB.IsFastIoPossible = FastIoIsNotPossible;
@@ -279,6 +284,8 @@ vfatDestroyFCB(
 #endif
 
     FsRtlUninitializeFileLock(&pFCB->FileLock);
+    FsRtlUninitializeLargeMcb(&pFCB->ExtentMcb);
+    vfatDestroyDirIndex(pFCB);
     if (!vfatFCBIsRoot(pFCB) &&
         !BooleanFlagOn(pFCB->Flags, FCB_IS_FAT) && !BooleanFlagOn(pFCB->Flags, FCB_IS_VOLUME))
     {
@@ -843,6 +850,324 @@ vfatAttachFCBToFileObject(
     return STATUS_SUCCESS;
 }
 
+static
+PVFAT_DIR_INDEX
+vfatAllocateDirIndex(
+    ULONG BucketCount)
+{
+    PVFAT_DIR_INDEX Index;
+    ULONG Size;
+
+    Size = FIELD_OFFSET(VFAT_DIR_INDEX, Buckets[BucketCount]);
+    Index = ExAllocatePoolWithTag(PagedPool, Size, TAG_DIR_INDEX);
+    if (Index != NULL)
+    {
+        RtlZeroMemory(Index, Size);
+        Index->BucketCount = BucketCount;
+    }
+    return Index;
+}
+
+VOID
+vfatDestroyDirIndex(
+    PVFATFCB pDirectoryFCB)
+{
+    PVFAT_DIR_INDEX Index = pDirectoryFCB->NameIndex;
+    PVFAT_DIR_INDEX_ENTRY Entry;
+    ULONG i;
+
+    if (Index == NULL)
+        return;
+
+    for (i = 0; i < Index->BucketCount; i++)
+    {
+        while (Index->Buckets[i] != NULL)
+        {
+            Entry = Index->Buckets[i];
+            Index->Buckets[i] = Entry->Next;
+            ExFreePoolWithTag(Entry, TAG_DIR_INDEX);
+        }
+    }
+
+    ExFreePoolWithTag(Index, TAG_DIR_INDEX);
+    pDirectoryFCB->NameIndex = NULL;
+}
+
+/*
+ * Adds one name hash to the index, doubling the bucket array once the
+ * chains get longer than two entries on average.
+ */
+static
+BOOLEAN
+vfatDirIndexInsert(
+    PVFATFCB pDirectoryFCB,
+    ULONG Hash,
+    ULONG StartIndex)
+{
+    PVFAT_DIR_INDEX Index = pDirectoryFCB->NameIndex;
+    PVFAT_DIR_INDEX NewIndex;
+    PVFAT_DIR_INDEX_ENTRY Entry;
+    ULONG i;
+
+    if (Index->EntryCount >= Index->BucketCount * 2)
+    {
+        NewIndex = vfatAllocateDirIndex(Index->BucketCount * 2);
+        if (NewIndex != NULL)
+        {
+            for (i = 0; i < Index->BucketCount; i++)
+            {
+                while (Index->Buckets[i] != NULL)
+                {
+                    Entry = Index->Buckets[i];
+                    Index->Buckets[i] = Entry->Next;
+                    Entry->Next = NewIndex->Buckets[Entry->Hash & (NewIndex->BucketCount - 1)];
+                    NewIndex->Buckets[Entry->Hash & (NewIndex->BucketCount - 1)] = Entry;
+                }
+            }
+            NewIndex->EntryCount = Index->EntryCount;
+            ExFreePoolWithTag(Index, TAG_DIR_INDEX);
+            pDirectoryFCB->NameIndex = Index = NewIndex;
+        }
+    }
+
+    Entry = ExAllocatePoolWithTag(PagedPool, sizeof(VFAT_DIR_INDEX_ENTRY), TAG_DIR_INDEX);
+    if (Entry == NULL)
+        return FALSE;
+
+    Entry->Hash = Hash;
+    Entry->StartIndex = StartIndex;
+    Entry->Next = Index->Buckets[Hash & (Index->BucketCount - 1)];
+    Index->Buckets[Hash & (Index->BucketCount - 1)] = Entry;
+    Index->EntryCount++;
+    return TRUE;
+}
+
+static
+BOOLEAN
+vfatDirIndexInsertNames(
+    PVFATFCB pDirectoryFCB,
+    PUNICODE_STRING LongNameU,
+    PUNICODE_STRING ShortNameU,
+    ULONG StartIndex)
+{
+    ULONG LongHash, ShortHash;
+
+    LongHash = vfatNameHash(0, LongNameU);
+    if (!vfatDirIndexInsert(pDirectoryFCB, LongHash, StartIndex))
+        return FALSE;
+
+    if (ShortNameU->Length != 0)
+    {
+        ShortHash = vfatNameHash(0, ShortNameU);
+        if (ShortHash != LongHash &&
+            !vfatDirIndexInsert(pDirectoryFCB, ShortHash, StartIndex))
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static
+VOID
+vfatDirIndexRemove(
+    PVFAT_DIR_INDEX Index,
+    ULONG Hash,
+    ULONG StartIndex)
+{
+    PVFAT_DIR_INDEX_ENTRY *Link;
+    PVFAT_DIR_INDEX_ENTRY Entry;
+
+    for (Link = &Index->Buckets[Hash & (Index->BucketCount - 1)]; *Link != NULL; Link = &(*Link)->Next)
+    {
+        Entry = *Link;
+        if (Entry->Hash == Hash && Entry->StartIndex == StartIndex)
+        {
+            *Link = Entry->Next;
+            ExFreePoolWithTag(Entry, TAG_DIR_INDEX);
+            Index->EntryCount--;
+            return;
+        }
+    }
+}
+
+/*
+ * Called by dirwr.c once the entries of pFCB were written to its parent
+ */
+VOID
+vfatDirIndexAddEntry(
+    PVFATFCB pDirectoryFCB,
+    PVFATFCB pFCB)
+{
+    if (pDirectoryFCB->NameIndex == NULL)
+        return;
+
+    /* A partial index would answer wrong negative lookups, drop it instead */
+    if (!vfatDirIndexInsertNames(pDirectoryFCB, &pFCB->LongNameU, &pFCB->ShortNameU, pFCB->startIndex))
+        vfatDestroyDirIndex(pDirectoryFCB);
+}
+
+/*
+ * Called by dirwr.c before the entries of pFCB get deleted from its parent
+ */
+VOID
+vfatDirIndexRemoveEntry(
+    PVFATFCB pDirectoryFCB,
+    PVFATFCB pFCB)
+{
+    PVFAT_DIR_INDEX Index = pDirectoryFCB->NameIndex;
+
+    if (Index == NULL)
+        return;
+
+    vfatDirIndexRemove(Index, vfatNameHash(0, &pFCB->LongNameU), pFCB->startIndex);
+    if (pFCB->ShortNameU.Length != 0)
+        vfatDirIndexRemove(Index, vfatNameHash(0, &pFCB->ShortNameU), pFCB->startIndex);
+}
+
+/*
+ * Scans a large directory once and indexes the names of all its entries.
+ * On failure the directory is just left without an index.
+ */
+static
+VOID
+vfatBuildDirIndex(
+    PDEVICE_EXTENSION pDeviceExt,
+    PVFATFCB pDirectoryFCB)
+{
+    NTSTATUS Status;
+    PVOID Context = NULL;
+    PVOID Page = NULL;
+    BOOLEAN First = TRUE;
+    VFAT_DIRENTRY_CONTEXT DirContext;
+    WCHAR LongNameBuffer[260];
+    WCHAR ShortNameBuffer[13];
+
+    ASSERT(pDirectoryFCB->NameIndex == NULL);
+
+    pDirectoryFCB->NameIndex = vfatAllocateDirIndex(VFAT_DIR_INDEX_MIN_BUCKETS);
+    if (pDirectoryFCB->NameIndex == NULL)
+        return;
+
+    DirContext.DirIndex = 0;
+    DirContext.LongNameU.Buffer = LongNameBuffer;
+    DirContext.LongNameU.Length = 0;
+    DirContext.LongNameU.MaximumLength = sizeof(LongNameBuffer);
+    DirContext.ShortNameU.Buffer = ShortNameBuffer;
+    DirContext.ShortNameU.Length = 0;
+    DirContext.ShortNameU.MaximumLength = sizeof(ShortNameBuffer);
+
+    while (TRUE)
+    {
+        Status = VfatGetNextDirEntry(pDeviceExt,
+                                     &Context,
+                                     &Page,
+                                     pDirectoryFCB,
+                                     &DirContext,
+                                     First);
+        First = FALSE;
+        if (Status == STATUS_NO_MORE_ENTRIES)
+        {
+            break;
+        }
+        if (!NT_SUCCESS(Status))
+        {
+            vfatDestroyDirIndex(pDirectoryFCB);
+            return;
+        }
+
+        if (!ENTRY_VOLUME(FALSE, &DirContext.DirEntry) &&
+            DirContext.LongNameU.Length != 0 &&
+            DirContext.ShortNameU.Length != 0)
+        {
+            if (!vfatDirIndexInsertNames(pDirectoryFCB,
+                                         &DirContext.LongNameU,
+                                         &DirContext.ShortNameU,
+                                         DirContext.StartIndex))
+            {
+                if (Context != NULL)
+                    CcUnpinData(Context);
+                vfatDestroyDirIndex(pDirectoryFCB);
+                return;
+            }
+        }
+        DirContext.DirIndex++;
+    }
+
+    DPRINT("Indexed %u names of %wZ\n", pDirectoryFCB->NameIndex->EntryCount, &pDirectoryFCB->PathNameU);
+}
+
+/*
+ * Looks a name up in the directory index. Returns STATUS_OBJECT_NAME_NOT_FOUND
+ * without touching the directory for names which aren't in it, and
+ * STATUS_RETRY if the index turned out not to match the directory anymore.
+ */
+static
+NTSTATUS
+vfatDirIndexFindFile(
+    PDEVICE_EXTENSION pDeviceExt,
+    PVFATFCB pDirectoryFCB,
+    PUNICODE_STRING FileToFindU,
+    PVFATFCB *pFoundFCB)
+{
+    NTSTATUS Status;
+    PVOID Context;
+    PVOID Page = NULL;
+    VFAT_DIRENTRY_CONTEXT DirContext;
+    WCHAR LongNameBuffer[260];
+    WCHAR ShortNameBuffer[13];
+    PVFAT_DIR_INDEX_ENTRY Entry;
+    ULONG Hash;
+
+    DirContext.LongNameU.Buffer = LongNameBuffer;
+    DirContext.LongNameU.MaximumLength = sizeof(LongNameBuffer);
+    DirContext.ShortNameU.Buffer = ShortNameBuffer;
+    DirContext.ShortNameU.MaximumLength = sizeof(ShortNameBuffer);
+
+    Hash = vfatNameHash(0, FileToFindU);
+    for (Entry = pDirectoryFCB->NameIndex->Buckets[Hash & (pDirectoryFCB->NameIndex->BucketCount - 1)];
+         Entry != NULL;
+         Entry = Entry->Next)
+    {
+        if (Entry->Hash != Hash)
+            continue;
+
+        /* Read the entry back, starting on a fresh page */
+        Context = NULL;
+        DirContext.DirIndex = Entry->StartIndex;
+        DirContext.LongNameU.Length = 0;
+        DirContext.ShortNameU.Length = 0;
+        Status = VfatGetNextDirEntry(pDeviceExt, &Context, &Page, pDirectoryFCB, &DirContext, TRUE);
+        if (!NT_SUCCESS(Status))
+            return STATUS_RETRY;
+
+        if (DirContext.StartIndex != Entry->StartIndex ||
+            (vfatNameHash(0, &DirContext.LongNameU) != Hash &&
+             vfatNameHash(0, &DirContext.ShortNameU) != Hash))
+        {
+            CcUnpinData(Context);
+            return STATUS_RETRY;
+        }
+
+        if (RtlEqualUnicodeString(FileToFindU, &DirContext.LongNameU, TRUE) ||
+            RtlEqualUnicodeString(FileToFindU, &DirContext.ShortNameU, TRUE))
+        {
+            Status = vfatMakeFCBFromDirEntry(pDeviceExt,
+                                             pDirectoryFCB,
+                                             &DirContext,
+                                             pFoundFCB);
+            CcUnpinData(Context);
+            return Status;
+        }
+
+        /* Hash collision */
+        CcUnpinData(Context);
+    }
+
+    return STATUS_OBJECT_NAME_NOT_FOUND;
+}
+
 NTSTATUS
 vfatDirFindFile(
     PDEVICE_EXTENSION pDeviceExt,
@@ -871,6 +1196,25 @@ vfatDirFindFile(
            pDeviceExt, pDirectoryFCB, FileToFindU);
     DPRINT("Dir Path:%wZ\n", &pDirectoryFCB->PathNameU);
 
+    /* Large directories are looked up through their name index */
+    if (!IsFatX && pDirectoryFCB->NameIndex == NULL &&
+        pDirectoryFCB->RFCB.FileSize.u.LowPart >= VFAT_DIR_INDEX_MIN_SIZE)
+    {
+        vfatBuildDirIndex(pDeviceExt, pDirectoryFCB);
+    }
+
+    if (pDirectoryFCB->NameIndex != NULL)
+    {
+        status = vfatDirIndexFindFile(pDeviceExt, pDirectoryFCB, FileToFindU, pFoundFCB);
+        if (status != STATUS_RETRY)
+        {
+            return status;
+        }
+
+        DPRINT1("Name index of %wZ is out of date, dropping it\n", &pDirectoryFCB->PathNameU);
+        vfatDestroyDirIndex(pDirectoryFCB);
+    }
+
     DirContext.DirIndex = 0;
     DirContext.LongNameU.Buffer = LongNameBuffer;
     DirContext.LongNameU.Length = 0;
@@ -1241,6 +1241,7 @@ VfatSetAllocationSizeInformation(
         if (FirstCluster == 0)
         {
             Fcb->LastCluster = Fcb->LastOffset = 0;
+            VfatTruncateExtentCache(DeviceExt, Fcb, 0);
             Status = NextCluster(DeviceExt, FirstCluster, &FirstCluster, TRUE);
             if (!NT_SUCCESS(Status))
             {
@@ -1290,6 +1291,9 @@ VfatSetAllocationSizeInformation(
         }
         else
         {
+            /* Only the chain past the current allocation is about to change */
+            VfatTruncateExtentCache(DeviceExt, Fcb, Fcb->RFCB.AllocationSize.u.LowPart);
+
             if (Fcb->LastCluster > 0)
             {
                 if (Fcb->RFCB.AllocationSize.u.LowPart - ClusterSize == Fcb->LastOffset)
@@ -1356,6 +1360,7 @@ VfatSetAllocationSizeInformation(
         AllocSizeChanged = TRUE;
         /* FIXME: Use the cached cluster/offset better way. */
         Fcb->LastCluster = Fcb->LastOffset = 0;
+        VfatTruncateExtentCache(DeviceExt, Fcb, NewSize);
         UpdateFileSize(FileObject, Fcb, NewSize, ClusterSize, vfatVolumeIsFatX(DeviceExt));
         if (NewSize > 0)
         {
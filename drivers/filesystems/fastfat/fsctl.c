@@ -1214,6 +1214,8 @@ VfatDismountVolume(
     IrpContext->DeviceObject->Vpb->Flags &= ~VPB_MOUNTED;
 #endif
 
+    FreeClusterBitmapCleanup(DeviceExt);
+
     ExReleaseResourceLite(&DeviceExt->FatResource);
 
     /* Release a few resources and quit, we're done */
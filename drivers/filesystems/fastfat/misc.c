@@ -448,6 +448,9 @@ VfatCheckForDismount(
     {
         PVPB DelVpb;
 
+        /* The device extension goes away with the device, free what hangs off it */
+        FreeClusterBitmapCleanup(DeviceExt);
+
         /* If we have a local VPB, we'll have to delete it
          * but we won't dismount us - something went bad before
          */
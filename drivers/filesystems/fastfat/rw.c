@@ -106,6 +106,92 @@ OffsetToCluster(
    }
 }
 
+/*
+ * Same as OffsetToCluster(), but looks the cluster up in the extent cache
+ * of the FCB first. The part of the chain that has to be walked is added to
+ * the cache, so the next lookup anywhere in it is a single tree search.
+ */
+NTSTATUS
+OffsetToClusterCached(
+    PDEVICE_EXTENSION DeviceExt,
+    PVFATFCB Fcb,
+    ULONG FirstCluster,
+    ULONG FileOffset,
+    PULONG Cluster)
+{
+    LONGLONG Vcn, TargetVcn;
+    LONGLONG Lcn;
+    LONGLONG RunVcn, RunLcn, RunLength;
+    ULONG CurrentCluster;
+    NTSTATUS Status = STATUS_SUCCESS;
+
+    if (FirstCluster == 1)
+        return OffsetToCluster(DeviceExt, FirstCluster, FileOffset, Cluster, FALSE);
+
+    TargetVcn = FileOffset / DeviceExt->FatInfo.BytesPerCluster;
+    if (FsRtlLookupLargeMcbEntry(&Fcb->ExtentMcb, TargetVcn, &Lcn, NULL, NULL, NULL, NULL) &&
+        Lcn != -1)
+    {
+        *Cluster = (ULONG)Lcn;
+        return STATUS_SUCCESS;
+    }
+
+    /* Resume the walk from the last cached cluster if it is before the target */
+    if (FsRtlLookupLastLargeMcbEntry(&Fcb->ExtentMcb, &Vcn, &Lcn) && Vcn < TargetVcn)
+    {
+        CurrentCluster = (ULONG)Lcn;
+    }
+    else
+    {
+        Vcn = 0;
+        CurrentCluster = FirstCluster;
+    }
+
+    RunVcn = Vcn;
+    RunLcn = CurrentCluster;
+    RunLength = 1;
+    while (Vcn < TargetVcn)
+    {
+        Status = GetNextCluster(DeviceExt, CurrentCluster, &CurrentCluster);
+        if (!NT_SUCCESS(Status) || CurrentCluster == 0xffffffff)
+            break;
+
+        Vcn++;
+        if (CurrentCluster == RunLcn + RunLength)
+        {
+            RunLength++;
+        }
+        else
+        {
+            FsRtlAddLargeMcbEntry(&Fcb->ExtentMcb, RunVcn, RunLcn, RunLength);
+            RunVcn = Vcn;
+            RunLcn = CurrentCluster;
+            RunLength = 1;
+        }
+    }
+    FsRtlAddLargeMcbEntry(&Fcb->ExtentMcb, RunVcn, RunLcn, RunLength);
+
+    if (!NT_SUCCESS(Status))
+        return Status;
+
+    *Cluster = CurrentCluster;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Drops the cached extents of an FCB from the given file offset onwards
+ */
+VOID
+VfatTruncateExtentCache(
+    PDEVICE_EXTENSION DeviceExt,
+    PVFATFCB Fcb,
+    ULONG FileOffset)
+{
+    FsRtlTruncateLargeMcb(&Fcb->ExtentMcb,
+                          ROUND_UP(FileOffset, DeviceExt->FatInfo.BytesPerCluster) /
+                          DeviceExt->FatInfo.BytesPerCluster);
+}
+
 /*
  * FUNCTION: Reads data from a file
  */
@@ -129,8 +215,6 @@ VfatReadFileData(
     ULONG BytesDone;
     ULONG BytesPerSector;
     ULONG BytesPerCluster;
-    ULONG LastCluster;
-    ULONG LastOffset;
 
     /* PRECONDITION */
     ASSERT(IrpContext);
@@ -208,36 +292,22 @@ VfatReadFileData(
         return Status;
     }
 
-    ExAcquireFastMutex(&Fcb->LastMutex);
-    LastCluster = Fcb->LastCluster;
-    LastOffset = Fcb->LastOffset;
-    ExReleaseFastMutex(&Fcb->LastMutex);
-
     /* Find the cluster to start the read from */
-    if (LastCluster > 0 && ReadOffset.u.LowPart >= LastOffset)
-    {
-        Status = OffsetToCluster(DeviceExt, LastCluster,
-                                 ROUND_DOWN(ReadOffset.u.LowPart, BytesPerCluster) -
-                                 LastOffset,
-                                 &CurrentCluster, FALSE);
+    Status = OffsetToClusterCached(DeviceExt, Fcb, FirstCluster,
+                                   ROUND_DOWN(ReadOffset.u.LowPart, BytesPerCluster),
+                                   &CurrentCluster);
 #ifdef DEBUG_VERIFY_OFFSET_CACHING
-        /* DEBUG VERIFICATION */
-        {
-            ULONG CorrectCluster;
-            OffsetToCluster(DeviceExt, FirstCluster,
-                            ROUND_DOWN(ReadOffset.u.LowPart, BytesPerCluster),
-                            &CorrectCluster, FALSE);
-            if (CorrectCluster != CurrentCluster)
-                KeBugCheck(FAT_FILE_SYSTEM);
-        }
-#endif
-    }
-    else
-    {
-        Status = OffsetToCluster(DeviceExt, FirstCluster,
-                                 ROUND_DOWN(ReadOffset.u.LowPart, BytesPerCluster),
-                                 &CurrentCluster, FALSE);
+    /* DEBUG VERIFICATION */
+    if (NT_SUCCESS(Status))
+    {
+        ULONG CorrectCluster;
+        OffsetToCluster(DeviceExt, FirstCluster,
+                        ROUND_DOWN(ReadOffset.u.LowPart, BytesPerCluster),
+                        &CorrectCluster, FALSE);
+        if (CorrectCluster != CurrentCluster)
+            KeBugCheck(FAT_FILE_SYSTEM);
     }
+#endif
 
     if (!NT_SUCCESS(Status))
     {
@@ -342,8 +412,6 @@ VfatWriteFileData(
     ULONG BytesPerCluster;
     LARGE_INTEGER StartOffset;
     ULONG BufferOffset;
-    ULONG LastCluster;
-    ULONG LastOffset;
 
     /* PRECONDITION */
     ASSERT(IrpContext);
@@ -421,38 +489,24 @@ VfatWriteFileData(
         return Status;
     }
 
-    ExAcquireFastMutex(&Fcb->LastMutex);
-    LastCluster = Fcb->LastCluster;
-    LastOffset = Fcb->LastOffset;
-    ExReleaseFastMutex(&Fcb->LastMutex);
-
     /*
      * Find the cluster to start the write from
      */
-    if (LastCluster > 0 && WriteOffset.u.LowPart >= LastOffset)
-    {
-        Status = OffsetToCluster(DeviceExt, LastCluster,
-                                 ROUND_DOWN(WriteOffset.u.LowPart, BytesPerCluster) -
-                                 LastOffset,
-                                 &CurrentCluster, FALSE);
+    Status = OffsetToClusterCached(DeviceExt, Fcb, FirstCluster,
+                                   ROUND_DOWN(WriteOffset.u.LowPart, BytesPerCluster),
+                                   &CurrentCluster);
 #ifdef DEBUG_VERIFY_OFFSET_CACHING
-        /* DEBUG VERIFICATION */
-        {
-            ULONG CorrectCluster;
-            OffsetToCluster(DeviceExt, FirstCluster,
-                            ROUND_DOWN(WriteOffset.u.LowPart, BytesPerCluster),
-                            &CorrectCluster, FALSE);
-            if (CorrectCluster != CurrentCluster)
-                KeBugCheck(FAT_FILE_SYSTEM);
-        }
-#endif
-    }
-    else
-    {
-        Status = OffsetToCluster(DeviceExt, FirstCluster,
-                                 ROUND_DOWN(WriteOffset.u.LowPart, BytesPerCluster),
-                                 &CurrentCluster, FALSE);
+    /* DEBUG VERIFICATION */
+    if (NT_SUCCESS(Status))
+    {
+        ULONG CorrectCluster;
+        OffsetToCluster(DeviceExt, FirstCluster,
+                        ROUND_DOWN(WriteOffset.u.LowPart, BytesPerCluster),
+                        &CorrectCluster, FALSE);
+        if (CorrectCluster != CurrentCluster)
+            KeBugCheck(FAT_FILE_SYSTEM);
     }
+#endif
 
     if (!NT_SUCCESS(Status))
     {
@@ -274,6 +274,21 @@ typedef struct _HASHENTRY
 }
 HASHENTRY;
 
+/* Name index of a large directory, maps name hashes to directory entries */
+typedef struct _VFAT_DIR_INDEX_ENTRY
+{
+    struct _VFAT_DIR_INDEX_ENTRY *Next;
+    ULONG Hash;
+    ULONG StartIndex;
+} VFAT_DIR_INDEX_ENTRY, *PVFAT_DIR_INDEX_ENTRY;
+
+typedef struct _VFAT_DIR_INDEX
+{
+    ULONG BucketCount;
+    ULONG EntryCount;
+    PVFAT_DIR_INDEX_ENTRY Buckets[ANYSIZE_ARRAY];
+} VFAT_DIR_INDEX, *PVFAT_DIR_INDEX;
+
 typedef struct DEVICE_EXTENSION *PDEVICE_EXTENSION;
 
 typedef NTSTATUS (*PGET_NEXT_CLUSTER)(PDEVICE_EXTENSION,ULONG,PULONG);
@@ -317,6 +332,9 @@ typedef struct DEVICE_EXTENSION
     ULONG LastAvailableCluster;
     ULONG AvailableClusters;
     BOOLEAN AvailableClustersValid;
+    /* In-memory image of the FAT32 allocation state, a set bit is a used cluster */
+    RTL_BITMAP FreeClusterBitmap;
+    BOOLEAN FreeClusterBitmapValid;
     ULONG Flags;
     struct _VFATFCB *VolumeFcb;
     PSTATISTICS Statistics;
@@ -503,6 +521,12 @@ typedef struct _VFATFCB
     FAST_MUTEX LastMutex;
     ULONG LastCluster;
     ULONG LastOffset;
+
+    /* Cluster runs of the file already walked in the FAT, indexed by VCN */
+    LARGE_MCB ExtentMcb;
+
+    /* Long and short names of a directory's entries, protected by DirResource */
+    PVFAT_DIR_INDEX NameIndex;
 } VFATFCB, *PVFATFCB;
 
 #define CCB_DELETE_ON_CLOSE     0x0001
@@ -521,6 +545,8 @@ typedef struct _VFATCCB
 #define TAG_FCB  'BCFV'
 #define TAG_IRP  'PRIV'
 #define TAG_VFAT 'TAFV'
+#define TAG_BITMAP 'PMBV'
+#define TAG_DIR_INDEX 'XIDV'
 
 #define ENTRIES_PER_SECTOR (BLOCKSIZE / sizeof(FATDirEntry))
 
@@ -878,6 +904,10 @@ WriteCluster(
     ULONG ClusterToWrite,
     ULONG NewValue);
 
+VOID
+FreeClusterBitmapCleanup(
+    PDEVICE_EXTENSION DeviceExt);
+
 /* fcb.c */
 
 PVFATFCB
@@ -885,6 +915,20 @@ vfatNewFCB(
     PDEVICE_EXTENSION pVCB,
     PUNICODE_STRING pFileNameU);
 
+VOID
+vfatDirIndexAddEntry(
+    PVFATFCB pDirectoryFCB,
+    PVFATFCB pFCB);
+
+VOID
+vfatDirIndexRemoveEntry(
+    PVFATFCB pDirectoryFCB,
+    PVFATFCB pFCB);
+
+VOID
+vfatDestroyDirIndex(
+    PVFATFCB pDirectoryFCB);
+
 NTSTATUS
 vfatSetFCBNewDirName(
     PDEVICE_EXTENSION pVCB,
@@ -1115,6 +1159,20 @@ NextCluster(
     PULONG CurrentCluster,
     BOOLEAN Extend);
 
+NTSTATUS
+OffsetToClusterCached(
+    PDEVICE_EXTENSION DeviceExt,
+    PVFATFCB Fcb,
+    ULONG FirstCluster,
+    ULONG FileOffset,
+    PULONG Cluster);
+
+VOID
+VfatTruncateExtentCache(
+    PDEVICE_EXTENSION DeviceExt,
+    PVFATFCB Fcb,
+    ULONG FileOffset);
+
 /* shutdown.c */
 
 DRIVER_DISPATCH
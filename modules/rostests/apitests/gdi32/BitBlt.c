@@ -0,0 +1,274 @@
+/*
+ * PROJECT:         ReactOS api tests
+ * LICENSE:         GPL - See COPYING in the top level directory
+ * PURPOSE:         Test for BitBlt color translation
+ */
+
+#include "precomp.h"
+
+#define TEST_COLOR RGB(10, 200, 30)
+#define TEST_BGR 0x0AC81E
+
+static
+HBITMAP
+CreateTestDib(HDC hdc, INT cx, INT cy, WORD BitCount, ULONG RedMask,
+              const RGBQUAD *pColors, ULONG cColors, PVOID *ppvBits)
+{
+    struct
+    {
+        BITMAPINFOHEADER bmiHeader;
+        RGBQUAD bmiColors[256];
+    } bmi;
+
+    ZeroMemory(&bmi, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = cx;
+    bmi.bmiHeader.biHeight = -cy;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = BitCount;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    if (BitCount == 16)
+    {
+        bmi.bmiHeader.biCompression = BI_BITFIELDS;
+        ((PULONG)bmi.bmiColors)[0] = RedMask;
+        ((PULONG)bmi.bmiColors)[1] = (RedMask == 0x7C00) ? 0x3E0 : 0x7E0;
+        ((PULONG)bmi.bmiColors)[2] = 0x1F;
+    }
+    else if (BitCount == 8)
+    {
+        bmi.bmiHeader.biClrUsed = cColors;
+        CopyMemory(bmi.bmiColors, pColors, cColors * sizeof(RGBQUAD));
+    }
+
+    return CreateDIBSection(hdc, (BITMAPINFO*)&bmi, DIB_RGB_COLORS, ppvBits, NULL, 0);
+}
+
+/* A 16bpp source with every color translated by the 3 field lookup tables */
+static
+VOID
+Test_16bppLut(ULONG RedMask)
+{
+    HDC hdcSrc, hdcDst;
+    HBITMAP hbmSrc, hbmDst;
+    PUSHORT pusSrc;
+    PULONG pulDst;
+    ULONG i, Mismatches = 0, Got, Expected;
+    COLORREF Color;
+
+    hdcSrc = CreateCompatibleDC(NULL);
+    hdcDst = CreateCompatibleDC(NULL);
+    hbmSrc = CreateTestDib(hdcSrc, 256, 256, 16, RedMask, NULL, 0, (PVOID*)&pusSrc);
+    hbmDst = CreateTestDib(hdcDst, 256, 256, 32, 0, NULL, 0, (PVOID*)&pulDst);
+    ok(hbmSrc != NULL && hbmDst != NULL, "Failed to create the bitmaps\n");
+    if (!hbmSrc || !hbmDst)
+        goto Cleanup;
+
+    SelectObject(hdcSrc, hbmSrc);
+    SelectObject(hdcDst, hbmDst);
+
+    for (i = 0; i < 0x10000; i++)
+        pusSrc[i] = (USHORT)i;
+
+    ok(BitBlt(hdcDst, 0, 0, 256, 256, hdcSrc, 0, 0, SRCCOPY), "BitBlt failed\n");
+    GdiFlush();
+
+    /* GetPixel translates a single pixel without the tables */
+    for (i = 0; i < 0x10000; i++)
+    {
+        Color = GetPixel(hdcSrc, i & 0xFF, i >> 8);
+        Expected = RGB(GetBValue(Color), GetGValue(Color), GetRValue(Color));
+        Got = pulDst[i] & 0xFFFFFF;
+        if (Got != Expected && Mismatches++ < 4)
+        {
+            ok(0, "Mask 0x%lx, color 0x%lx: got 0x%lx, expected 0x%lx\n",
+               RedMask, i, Got, Expected);
+        }
+    }
+    ok(Mismatches == 0, "Mask 0x%lx: %lu colors differ\n", RedMask, Mismatches);
+
+Cleanup:
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcDst);
+    if (hbmSrc) DeleteObject(hbmSrc);
+    if (hbmDst) DeleteObject(hbmDst);
+}
+
+/* 8bpp sources go through the color table, whole rows at a time */
+static
+VOID
+Test_8bppRow(VOID)
+{
+    HDC hdcSrc, hdcDst;
+    HBITMAP hbmSrc, hbmDst;
+    RGBQUAD aColors[256];
+    PBYTE pjSrc;
+    PULONG pulDst;
+    ULONG i, Mismatches = 0, Expected;
+
+    for (i = 0; i < 256; i++)
+    {
+        aColors[i].rgbBlue = (BYTE)i;
+        aColors[i].rgbGreen = (BYTE)(255 - i);
+        aColors[i].rgbRed = (BYTE)(i * 3);
+        aColors[i].rgbReserved = 0;
+    }
+
+    hdcSrc = CreateCompatibleDC(NULL);
+    hdcDst = CreateCompatibleDC(NULL);
+    hbmSrc = CreateTestDib(hdcSrc, 67, 5, 8, 0, aColors, 256, (PVOID*)&pjSrc);
+    hbmDst = CreateTestDib(hdcDst, 67, 5, 32, 0, NULL, 0, (PVOID*)&pulDst);
+    ok(hbmSrc != NULL && hbmDst != NULL, "Failed to create the bitmaps\n");
+    if (!hbmSrc || !hbmDst)
+        goto Cleanup;
+
+    SelectObject(hdcSrc, hbmSrc);
+    SelectObject(hdcDst, hbmDst);
+
+    /* Rows of 67 pixels are padded to 68 bytes */
+    for (i = 0; i < 68 * 5; i++)
+        pjSrc[i] = (BYTE)(i * 13);
+
+    ok(BitBlt(hdcDst, 0, 0, 67, 5, hdcSrc, 0, 0, SRCCOPY), "BitBlt failed\n");
+    GdiFlush();
+
+    for (i = 0; i < 67 * 5; i++)
+    {
+        Expected = *(PULONG)&aColors[pjSrc[(i / 67) * 68 + i % 67]];
+        if ((pulDst[i] & 0xFFFFFF) != Expected && Mismatches++ < 4)
+        {
+            ok(0, "Pixel %lu: got 0x%lx, expected 0x%lx\n", i, pulDst[i], Expected);
+        }
+    }
+    ok(Mismatches == 0, "%lu pixels differ\n", Mismatches);
+
+Cleanup:
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcDst);
+    if (hbmSrc) DeleteObject(hbmSrc);
+    if (hbmDst) DeleteObject(hbmDst);
+}
+
+static
+BYTE
+BltColorToIndex(HDC hdcSrc, PULONG pulSrc, HDC hdcDst, PBYTE pjDst, ULONG Color)
+{
+    pulSrc[0] = Color;
+    pjDst[0] = 0xCC;
+    ok(BitBlt(hdcDst, 0, 0, 1, 1, hdcSrc, 0, 0, SRCCOPY), "BitBlt failed\n");
+    GdiFlush();
+    return pjDst[0];
+}
+
+/* The nearest index cache must forget results when the colors change */
+static
+VOID
+Test_NearestCache(VOID)
+{
+    HDC hdcSrc, hdcDst;
+    HBITMAP hbmSrc, hbmDst;
+    HPALETTE hpal, hpalOld;
+    RGBQUAD aColors[256];
+    PULONG pulSrc;
+    PBYTE pjDst;
+    ULONG i;
+    struct
+    {
+        WORD palVersion;
+        WORD palNumEntries;
+        PALETTEENTRY palPalEntry[256];
+    } Pal;
+    PALETTEENTRY Entry;
+
+    /* 32 gray colors, white is the last one */
+    for (i = 0; i < 32; i++)
+    {
+        aColors[i].rgbBlue = aColors[i].rgbGreen = aColors[i].rgbRed = (BYTE)(i * 255 / 31);
+        aColors[i].rgbReserved = 0;
+    }
+
+    hdcSrc = CreateCompatibleDC(NULL);
+    hdcDst = CreateCompatibleDC(NULL);
+    hbmSrc = CreateTestDib(hdcSrc, 1, 1, 32, 0, NULL, 0, (PVOID*)&pulSrc);
+    hbmDst = CreateTestDib(hdcDst, 4, 1, 8, 0, aColors, 32, (PVOID*)&pjDst);
+    ok(hbmSrc != NULL && hbmDst != NULL, "Failed to create the bitmaps\n");
+    if (!hbmSrc || !hbmDst)
+        goto Cleanup;
+
+    SelectObject(hdcSrc, hbmSrc);
+    SelectObject(hdcDst, hbmDst);
+
+    /* White must stay within the 32 colors, on every pass */
+    ok_int(BltColorToIndex(hdcSrc, pulSrc, hdcDst, pjDst, 0xFFFFFF), 31);
+    ok_int(BltColorToIndex(hdcSrc, pulSrc, hdcDst, pjDst, 0xFFFFFF), 31);
+    ok_int(BltColorToIndex(hdcSrc, pulSrc, hdcDst, pjDst, 0x000000), 0);
+
+    /* Move white to another index */
+    aColors[31].rgbBlue = aColors[31].rgbGreen = aColors[31].rgbRed = 0;
+    aColors[20].rgbBlue = aColors[20].rgbGreen = aColors[20].rgbRed = 0xFF;
+    ok_int(SetDIBColorTable(hdcDst, 0, 32, aColors), 32);
+    ok_int(BltColorToIndex(hdcSrc, pulSrc, hdcDst, pjDst, 0xFFFFFF), 20);
+
+    /* Now a full palette, realized into the bitmap */
+    DeleteDC(hdcDst);
+    DeleteObject(hbmDst);
+    ZeroMemory(aColors, sizeof(aColors));
+    hdcDst = CreateCompatibleDC(NULL);
+    hbmDst = CreateTestDib(hdcDst, 4, 1, 8, 0, aColors, 256, (PVOID*)&pjDst);
+    ok(hbmDst != NULL, "Failed to create the bitmap\n");
+    if (!hbmDst)
+        goto Cleanup;
+    SelectObject(hdcDst, hbmDst);
+
+    Pal.palVersion = 0x300;
+    Pal.palNumEntries = 256;
+    for (i = 0; i < 256; i++)
+    {
+        Pal.palPalEntry[i].peRed = Pal.palPalEntry[i].peGreen = Pal.palPalEntry[i].peBlue = (BYTE)i;
+        Pal.palPalEntry[i].peFlags = PC_RESERVED;
+    }
+    Pal.palPalEntry[7].peRed = GetRValue(TEST_COLOR);
+    Pal.palPalEntry[7].peGreen = GetGValue(TEST_COLOR);
+    Pal.palPalEntry[7].peBlue = GetBValue(TEST_COLOR);
+
+    hpal = CreatePalette((LOGPALETTE*)&Pal);
+    ok(hpal != NULL, "CreatePalette failed\n");
+    if (!hpal)
+        goto Cleanup;
+    hpalOld = SelectPalette(hdcDst, hpal, FALSE);
+    ok_int(RealizePalette(hdcDst), 256);
+    ok_int(BltColorToIndex(hdcSrc, pulSrc, hdcDst, pjDst, TEST_BGR), 7);
+    ok_int(BltColorToIndex(hdcSrc, pulSrc, hdcDst, pjDst, TEST_BGR), 7);
+
+    /* SetPaletteEntries moves the color from 7 to 200 */
+    Entry = Pal.palPalEntry[7];
+    Pal.palPalEntry[7] = Pal.palPalEntry[0];
+    Pal.palPalEntry[200] = Entry;
+    ok_int(SetPaletteEntries(hpal, 0, 256, Pal.palPalEntry), 256);
+    ok_int(RealizePalette(hdcDst), 256);
+    ok_int(BltColorToIndex(hdcSrc, pulSrc, hdcDst, pjDst, TEST_BGR), 200);
+
+    /* AnimatePalette moves it from 200 to 33 */
+    Pal.palPalEntry[200] = Pal.palPalEntry[0];
+    Pal.palPalEntry[33] = Entry;
+    ok(AnimatePalette(hpal, 0, 256, Pal.palPalEntry), "AnimatePalette failed\n");
+    ok_int(RealizePalette(hdcDst), 256);
+    ok_int(BltColorToIndex(hdcSrc, pulSrc, hdcDst, pjDst, TEST_BGR), 33);
+
+    SelectPalette(hdcDst, hpalOld, FALSE);
+    DeleteObject(hpal);
+
+Cleanup:
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcDst);
+    if (hbmSrc) DeleteObject(hbmSrc);
+    if (hbmDst) DeleteObject(hbmDst);
+}
+
+START_TEST(BitBlt)
+{
+    Test_16bppLut(0xF800);
+    Test_16bppLut(0x7C00);
+    Test_8bppRow();
+    Test_NearestCache();
+}
@@ -0,0 +1,282 @@
+/*
+ * PROJECT:         ReactOS api tests
+ * LICENSE:         GPL - See COPYING in the top level directory
+ * PURPOSE:         Test for GdiAlphaBlend
+ */
+
+#include "precomp.h"
+
+#define SRC_WIDTH 64
+#define SRC_HEIGHT 32
+#define BENCH_SIZE 256
+#define BENCH_LOOPS 50
+
+static ULONG gulSeed = 0x12345678;
+
+static
+ULONG
+NextRandom(VOID)
+{
+    gulSeed = gulSeed * 1103515245 + 12345;
+    return (gulSeed >> 16) | (gulSeed << 16);
+}
+
+static
+HBITMAP
+CreateTestDib(HDC hdc, INT cx, INT cy, WORD BitCount, ULONG RedMask, PVOID *ppvBits)
+{
+    struct
+    {
+        BITMAPINFOHEADER bmiHeader;
+        ULONG bmiColors[3];
+    } bmi;
+
+    ZeroMemory(&bmi, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = cx;
+    bmi.bmiHeader.biHeight = -cy;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = BitCount;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    /* 16bpp needs explicit masks to tell 5-5-5 from 5-6-5 */
+    if (BitCount == 16)
+    {
+        bmi.bmiHeader.biCompression = BI_BITFIELDS;
+        bmi.bmiColors[0] = RedMask;
+        bmi.bmiColors[1] = (RedMask == 0x7C00) ? 0x3E0 : 0x7E0;
+        bmi.bmiColors[2] = 0x1F;
+    }
+
+    return CreateDIBSection(hdc, (BITMAPINFO*)&bmi, DIB_RGB_COLORS, ppvBits, NULL, 0);
+}
+
+static
+VOID
+FillRandom(PVOID pvBits, ULONG cj)
+{
+    PBYTE pj = pvBits;
+
+    while (cj--)
+        *pj++ = (BYTE)NextRandom();
+}
+
+static
+UCHAR
+Clamp(ULONG Value, ULONG Max)
+{
+    return (Value > Max) ? (UCHAR)Max : (UCHAR)Value;
+}
+
+/* Reference blend of one BGRA source pixel into a 32bpp or 24bpp destination */
+static
+ULONG
+RefBlend32(ULONG Dst, ULONG Src, BLENDFUNCTION Blend, BOOL SrcHasAlpha, BOOL DstHasAlpha)
+{
+    UCHAR SrcCol[4], DstCol[4], Alpha;
+    ULONG i, Result = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        SrcCol[i] = (UCHAR)(Src >> (i * 8));
+        DstCol[i] = (UCHAR)(Dst >> (i * 8));
+        SrcCol[i] = (SrcCol[i] * Blend.SourceConstantAlpha) / 255;
+    }
+
+    if (!SrcHasAlpha)
+        SrcCol[3] = Blend.SourceConstantAlpha;
+
+    Alpha = (Blend.AlphaFormat & AC_SRC_ALPHA) ? SrcCol[3] : Blend.SourceConstantAlpha;
+
+    for (i = 0; i < (DstHasAlpha ? 4UL : 3UL); i++)
+    {
+        Result |= (ULONG)Clamp((DstCol[i] * (255 - Alpha)) / 255 + SrcCol[i], 255) << (i * 8);
+    }
+
+    return Result;
+}
+
+/* Reference blend of one BGRA source pixel into a 5-5-5 or 5-6-5 destination */
+static
+USHORT
+RefBlend16(USHORT Dst, ULONG Src, BLENDFUNCTION Blend, BOOL Is555)
+{
+    ULONG Red, Green, Blue, Alpha, Alpha5, Alpha6;
+    ULONG DstRed, DstGreen, DstBlue;
+
+    Red = (((Src >> 16) & 0xFF) * Blend.SourceConstantAlpha) / 255;
+    Green = (((Src >> 8) & 0xFF) * Blend.SourceConstantAlpha) / 255;
+    Blue = ((Src & 0xFF) * Blend.SourceConstantAlpha) / 255;
+    Alpha = (Blend.AlphaFormat & AC_SRC_ALPHA) ?
+            ((Src >> 24) * Blend.SourceConstantAlpha) / 255 : Blend.SourceConstantAlpha;
+    Alpha5 = Alpha >> 3;
+    Alpha6 = Alpha >> 2;
+
+    if (Is555)
+    {
+        DstRed = Clamp((((Dst >> 10) & 0x1F) * (31 - Alpha5)) / 31 + (Red >> 3), 31);
+        DstGreen = Clamp((((Dst >> 5) & 0x1F) * (31 - Alpha5)) / 31 + (Green >> 3), 31);
+        DstBlue = Clamp(((Dst & 0x1F) * (31 - Alpha5)) / 31 + (Blue >> 3), 31);
+        return (USHORT)((Dst & 0x8000) | (DstRed << 10) | (DstGreen << 5) | DstBlue);
+    }
+
+    DstRed = Clamp((((Dst >> 11) & 0x1F) * (31 - Alpha5)) / 31 + (Red >> 3), 31);
+    DstGreen = Clamp((((Dst >> 5) & 0x3F) * (63 - Alpha6)) / 63 + (Green >> 2), 63);
+    DstBlue = Clamp(((Dst & 0x1F) * (31 - Alpha5)) / 31 + (Blue >> 3), 31);
+    return (USHORT)((DstRed << 11) | (DstGreen << 5) | DstBlue);
+}
+
+static
+ULONG
+ReadPixel(PBYTE pjBits, ULONG Bpp, INT cx, INT x, INT y)
+{
+    ULONG cjScan = ((cx * Bpp + 31) & ~31) / 8;
+    PBYTE pj = pjBits + y * cjScan + x * (Bpp / 8);
+
+    switch (Bpp)
+    {
+        case 16: return *(PUSHORT)pj;
+        case 24: return pj[0] | (pj[1] << 8) | (pj[2] << 16);
+        default: return *(PULONG)pj;
+    }
+}
+
+static
+VOID
+Test_Blend(WORD SrcBpp, WORD DstBpp, ULONG DstRedMask, INT DstWidth, INT DstHeight, BLENDFUNCTION Blend)
+{
+    HDC hdcSrc, hdcDst;
+    HBITMAP hbmSrc, hbmDst;
+    PVOID pvSrc, pvDst, pvExpected;
+    ULONG cjDst, Mismatches = 0;
+    INT x, y, sx, sy;
+    ULONG Src, Dst, Expected;
+
+    hdcSrc = CreateCompatibleDC(NULL);
+    hdcDst = CreateCompatibleDC(NULL);
+    hbmSrc = CreateTestDib(hdcSrc, SRC_WIDTH, SRC_HEIGHT, SrcBpp, 0, &pvSrc);
+    hbmDst = CreateTestDib(hdcDst, DstWidth, DstHeight, DstBpp, DstRedMask, &pvDst);
+    ok(hbmSrc != NULL && hbmDst != NULL, "Failed to create the bitmaps\n");
+    if (!hbmSrc || !hbmDst)
+        goto Cleanup;
+
+    SelectObject(hdcSrc, hbmSrc);
+    SelectObject(hdcDst, hbmDst);
+
+    cjDst = DstHeight * (((DstWidth * DstBpp + 31) & ~31) / 8);
+    FillRandom(pvSrc, SRC_HEIGHT * (((SRC_WIDTH * SrcBpp + 31) & ~31) / 8));
+    FillRandom(pvDst, cjDst);
+    pvExpected = HeapAlloc(GetProcessHeap(), 0, cjDst);
+    if (!pvExpected)
+    {
+        skip("Out of memory\n");
+        goto Cleanup;
+    }
+    CopyMemory(pvExpected, pvDst, cjDst);
+
+    ok(GdiAlphaBlend(hdcDst, 0, 0, DstWidth, DstHeight, hdcSrc, 0, 0, SRC_WIDTH, SRC_HEIGHT, Blend),
+       "GdiAlphaBlend failed\n");
+    GdiFlush();
+
+    for (y = 0; y < DstHeight; y++)
+    {
+        sy = (y * SRC_HEIGHT) / DstHeight;
+        for (x = 0; x < DstWidth; x++)
+        {
+            sx = (x * SRC_WIDTH) / DstWidth;
+            Src = ReadPixel(pvSrc, SrcBpp, SRC_WIDTH, sx, sy);
+            Dst = ReadPixel(pvExpected, DstBpp, DstWidth, x, y);
+
+            if (DstBpp == 16)
+                Expected = RefBlend16((USHORT)Dst, Src, Blend, DstRedMask == 0x7C00);
+            else
+                Expected = RefBlend32(Dst, Src, Blend, SrcBpp == 32, DstBpp == 32);
+
+            if (ReadPixel(pvDst, DstBpp, DstWidth, x, y) != Expected)
+            {
+                if (Mismatches++ < 4)
+                {
+                    ok(0, "%u->%u at (%d,%d): got 0x%lx, expected 0x%lx\n",
+                       SrcBpp, DstBpp, x, y, ReadPixel(pvDst, DstBpp, DstWidth, x, y), Expected);
+                }
+            }
+        }
+    }
+
+    ok(Mismatches == 0, "%u->%u, %dx%d, alpha %u, format %u: %lu pixels differ\n",
+       SrcBpp, DstBpp, DstWidth, DstHeight, Blend.SourceConstantAlpha, Blend.AlphaFormat, Mismatches);
+
+    HeapFree(GetProcessHeap(), 0, pvExpected);
+
+Cleanup:
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcDst);
+    if (hbmSrc) DeleteObject(hbmSrc);
+    if (hbmDst) DeleteObject(hbmDst);
+}
+
+static
+VOID
+Test_Benchmark(WORD DstBpp, ULONG DstRedMask)
+{
+    BLENDFUNCTION Blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+    HDC hdcSrc, hdcDst;
+    HBITMAP hbmSrc, hbmDst;
+    PVOID pvSrc, pvDst;
+    LARGE_INTEGER Frequency, Start, End;
+    ULONG i;
+
+    hdcSrc = CreateCompatibleDC(NULL);
+    hdcDst = CreateCompatibleDC(NULL);
+    hbmSrc = CreateTestDib(hdcSrc, BENCH_SIZE, BENCH_SIZE, 32, 0, &pvSrc);
+    hbmDst = CreateTestDib(hdcDst, BENCH_SIZE, BENCH_SIZE, DstBpp, DstRedMask, &pvDst);
+    if (hbmSrc && hbmDst)
+    {
+        SelectObject(hdcSrc, hbmSrc);
+        SelectObject(hdcDst, hbmDst);
+        FillRandom(pvSrc, BENCH_SIZE * BENCH_SIZE * 4);
+
+        QueryPerformanceFrequency(&Frequency);
+        QueryPerformanceCounter(&Start);
+        for (i = 0; i < BENCH_LOOPS; i++)
+        {
+            GdiAlphaBlend(hdcDst, 0, 0, BENCH_SIZE, BENCH_SIZE,
+                          hdcSrc, 0, 0, BENCH_SIZE, BENCH_SIZE, Blend);
+        }
+        GdiFlush();
+        QueryPerformanceCounter(&End);
+
+        trace("%ux%u 32->%u blend: %lu us\n", BENCH_SIZE, BENCH_SIZE, DstBpp,
+              (ULONG)((End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart / BENCH_LOOPS));
+    }
+
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcDst);
+    if (hbmSrc) DeleteObject(hbmSrc);
+    if (hbmDst) DeleteObject(hbmDst);
+}
+
+START_TEST(GdiAlphaBlend)
+{
+    BLENDFUNCTION Constant = { AC_SRC_OVER, 0, 128, 0 };
+    BLENDFUNCTION PerPixel = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+    BLENDFUNCTION Both = { AC_SRC_OVER, 0, 200, AC_SRC_ALPHA };
+
+    /* Same size */
+    Test_Blend(32, 32, 0, SRC_WIDTH, SRC_HEIGHT, Constant);
+    Test_Blend(32, 32, 0, SRC_WIDTH, SRC_HEIGHT, PerPixel);
+    Test_Blend(32, 32, 0, SRC_WIDTH, SRC_HEIGHT, Both);
+    Test_Blend(24, 32, 0, SRC_WIDTH, SRC_HEIGHT, Constant);
+    Test_Blend(32, 16, 0xF800, SRC_WIDTH, SRC_HEIGHT, PerPixel);
+    Test_Blend(32, 16, 0x7C00, SRC_WIDTH, SRC_HEIGHT, Both);
+
+    /* Stretched and shrunk */
+    Test_Blend(32, 32, 0, 100, 45, Both);
+    Test_Blend(32, 32, 0, 40, 20, PerPixel);
+    Test_Blend(24, 32, 0, 77, 13, Constant);
+    Test_Blend(32, 16, 0xF800, 90, 50, Constant);
+    Test_Blend(32, 16, 0x7C00, 33, 17, PerPixel);
+
+    Test_Benchmark(32, 0);
+    Test_Benchmark(16, 0xF800);
+}
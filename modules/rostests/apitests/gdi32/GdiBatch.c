@@ -0,0 +1,235 @@
+/*
+ * PROJECT:         ReactOS api tests
+ * LICENSE:         GPL - See COPYING in the top level directory
+ * PURPOSE:         Test for batching of drawing calls in the TEB
+ */
+
+#include "precomp.h"
+
+#include <ndk/exfuncs.h>
+
+#define FRAME_FILLS 2000
+
+static
+ULONG
+GetSystemCalls(VOID)
+{
+    SYSTEM_PERFORMANCE_INFORMATION PerfInfo;
+    NTSTATUS Status;
+
+    ZeroMemory(&PerfInfo, sizeof(PerfInfo));
+    Status = NtQuerySystemInformation(SystemPerformanceInformation, &PerfInfo, sizeof(PerfInfo), NULL);
+    ok(NT_SUCCESS(Status), "NtQuerySystemInformation failed: 0x%lx\n", Status);
+    return PerfInfo.SystemCalls;
+}
+
+static
+HDC
+CreateTargetDC(HBITMAP *phbmp)
+{
+    HDC hdcScreen, hdc;
+
+    /* Use a device format bitmap, drawing on DIB sections is never batched */
+    hdcScreen = GetDC(NULL);
+    *phbmp = CreateCompatibleBitmap(hdcScreen, 64, 16);
+    ReleaseDC(NULL, hdcScreen);
+    ok(*phbmp != NULL, "CreateCompatibleBitmap failed\n");
+
+    hdc = CreateCompatibleDC(NULL);
+    ok(hdc != NULL, "CreateCompatibleDC failed\n");
+    SelectObject(hdc, *phbmp);
+    return hdc;
+}
+
+static
+void
+Test_PatBlt(HDC hdc)
+{
+    HBRUSH hbrBlue, hbrOld;
+    POLYPATBLT Poly[2];
+
+    /* The DC brush color is taken when the call is queued, not when it is flushed */
+    hbrOld = SelectObject(hdc, GetStockObject(DC_BRUSH));
+    SetDCBrushColor(hdc, RGB(255, 0, 0));
+    ok_long(PatBlt(hdc, 0, 0, 8, 8, PATCOPY), 1);
+    SetDCBrushColor(hdc, RGB(0, 255, 0));
+    ok_long(PatBlt(hdc, 8, 0, 8, 8, PATCOPY), 1);
+
+    /* So is the selected brush */
+    hbrBlue = CreateSolidBrush(RGB(0, 0, 255));
+    SelectObject(hdc, hbrBlue);
+    ok_long(PatBlt(hdc, 16, 0, 8, 8, PATCOPY), 1);
+    SelectObject(hdc, GetStockObject(DC_BRUSH));
+    ok_long(PatBlt(hdc, 24, 0, 8, 8, PATCOPY), 1);
+
+    ok_long(GetPixel(hdc, 4, 4), RGB(255, 0, 0));
+    ok_long(GetPixel(hdc, 12, 4), RGB(0, 255, 0));
+    ok_long(GetPixel(hdc, 20, 4), RGB(0, 0, 255));
+    ok_long(GetPixel(hdc, 28, 4), RGB(0, 255, 0));
+
+    /* Every rectangle comes with its own brush */
+    Poly[0].nXLeft = 32;
+    Poly[0].nYLeft = 0;
+    Poly[0].nWidth = 8;
+    Poly[0].nHeight = 8;
+    Poly[0].hBrush = hbrBlue;
+    Poly[1].nXLeft = 40;
+    Poly[1].nYLeft = 0;
+    Poly[1].nWidth = 8;
+    Poly[1].nHeight = 8;
+    Poly[1].hBrush = GetStockObject(BLACK_BRUSH);
+    ok_long(PolyPatBlt(hdc, PATCOPY, Poly, 2, 0), 1);
+    ok_long(GetPixel(hdc, 36, 4), RGB(0, 0, 255));
+    ok_long(GetPixel(hdc, 44, 4), RGB(0, 0, 0));
+
+    /* Inverting twice leaves the bits alone */
+    ok_long(PatBlt(hdc, 0, 0, 8, 8, DSTINVERT), 1);
+    ok_long(PatBlt(hdc, 0, 0, 8, 8, DSTINVERT), 1);
+    ok_long(GetPixel(hdc, 4, 4), RGB(255, 0, 0));
+
+    SelectObject(hdc, hbrOld);
+    DeleteObject(hbrBlue);
+}
+
+static
+void
+Test_ExtTextOut(HDC hdc)
+{
+    RECT rc;
+
+    /* An opaque rectangle without text is filled with the background color of the call */
+    SetBkColor(hdc, RGB(255, 0, 0));
+    SetRect(&rc, 0, 8, 8, 16);
+    ok_long(ExtTextOutW(hdc, 0, 0, ETO_OPAQUE, &rc, NULL, 0, NULL), 1);
+    SetBkColor(hdc, RGB(0, 255, 0));
+    SetRect(&rc, 8, 8, 16, 16);
+    ok_long(ExtTextOutW(hdc, 0, 0, ETO_OPAQUE, &rc, NULL, 0, NULL), 1);
+
+    /* Same with text, the string is copied into the batch */
+    SetBkColor(hdc, RGB(0, 0, 255));
+    SetTextColor(hdc, RGB(255, 255, 255));
+    SetRect(&rc, 16, 8, 32, 16);
+    ok_long(ExtTextOutW(hdc, 16, 8, ETO_OPAQUE | ETO_CLIPPED, &rc, L"..", 2, NULL), 1);
+    SetBkColor(hdc, RGB(255, 255, 0));
+
+    ok_long(GetPixel(hdc, 0, 15), RGB(255, 0, 0));
+    ok_long(GetPixel(hdc, 8, 15), RGB(0, 255, 0));
+    ok_long(GetPixel(hdc, 31, 15), RGB(0, 0, 255));
+
+    /* The attributes of the DC were not touched by the replay */
+    ok_long(GetBkColor(hdc), RGB(255, 255, 0));
+    ok_long(GetTextColor(hdc), RGB(255, 255, 255));
+}
+
+static
+void
+Test_ExtSelectClipRgn(HDC hdc)
+{
+    HRGN hrgn;
+
+    ok_long(PatBlt(hdc, 0, 0, 64, 16, BLACKNESS), 1);
+
+    /* A rectangular clip region is queued, deleting the region right away is fine */
+    hrgn = CreateRectRgn(0, 0, 8, 8);
+    ok_int(ExtSelectClipRgn(hdc, hrgn, RGN_COPY), SIMPLEREGION);
+    DeleteObject(hrgn);
+    ok_long(PatBlt(hdc, 0, 0, 64, 16, WHITENESS), 1);
+    ok_long(GetPixel(hdc, 4, 4), RGB(255, 255, 255));
+    ok_long(GetPixel(hdc, 12, 4), RGB(0, 0, 0));
+
+    /* An empty one clips everything */
+    hrgn = CreateRectRgn(0, 0, 0, 0);
+    ok_int(ExtSelectClipRgn(hdc, hrgn, RGN_COPY), NULLREGION);
+    DeleteObject(hrgn);
+    ok_long(PatBlt(hdc, 0, 0, 64, 16, BLACKNESS), 1);
+    ok_long(GetPixel(hdc, 4, 4), RGB(255, 255, 255));
+
+    /* And no region removes the clipping */
+    ok_int(ExtSelectClipRgn(hdc, NULL, RGN_COPY), SIMPLEREGION);
+    ok_long(PatBlt(hdc, 0, 0, 64, 16, BLACKNESS), 1);
+    ok_long(GetPixel(hdc, 4, 4), RGB(0, 0, 0));
+    hrgn = CreateRectRgn(0, 0, 0, 0);
+    ok_int(GetClipRgn(hdc, hrgn), 0);
+    DeleteObject(hrgn);
+}
+
+static
+void
+DrawFrame(HDC hdc)
+{
+    ULONG i;
+
+    SelectObject(hdc, GetStockObject(DC_BRUSH));
+    for (i = 0; i < FRAME_FILLS; i++)
+    {
+        SetDCBrushColor(hdc, RGB(i, i >> 8, 0));
+        PatBlt(hdc, i % 64, 0, 1, 16, PATCOPY);
+    }
+
+    /* Make sure everything is drawn before stopping the clock */
+    GdiFlush();
+}
+
+static
+void
+Test_FrameCost(HDC hdc)
+{
+    ULONG Calls, BatchedCalls, UnbatchedCalls;
+    LARGE_INTEGER Frequency, Start, End;
+    ULONG BatchedTime, UnbatchedTime;
+    DWORD DefaultLimit;
+
+    QueryPerformanceFrequency(&Frequency);
+
+    /* Warm up */
+    DrawFrame(hdc);
+
+    /* One call per batch */
+    DefaultLimit = GdiGetBatchLimit();
+    ok_long(GdiSetBatchLimit(1), DefaultLimit);
+    ok_long(GdiGetBatchLimit(), 1);
+    Calls = GetSystemCalls();
+    QueryPerformanceCounter(&Start);
+    DrawFrame(hdc);
+    QueryPerformanceCounter(&End);
+    UnbatchedCalls = GetSystemCalls() - Calls;
+    UnbatchedTime = (ULONG)((End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart);
+
+    /* Back to the default */
+    ok_long(GdiSetBatchLimit(0), 1);
+    ok_long(GdiGetBatchLimit(), DefaultLimit);
+    Calls = GetSystemCalls();
+    QueryPerformanceCounter(&Start);
+    DrawFrame(hdc);
+    QueryPerformanceCounter(&End);
+    BatchedCalls = GetSystemCalls() - Calls;
+    BatchedTime = (ULONG)((End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart);
+
+    /* The counter is system wide, so leave some room for other threads */
+    ok(BatchedCalls < UnbatchedCalls / 2,
+       "Batched frame took %lu system calls, unbatched %lu\n", BatchedCalls, UnbatchedCalls);
+
+    trace("%u fills: %lu system calls / %lu us unbatched, %lu system calls / %lu us batched\n",
+          FRAME_FILLS, UnbatchedCalls, UnbatchedTime, BatchedCalls, BatchedTime);
+}
+
+START_TEST(GdiBatch)
+{
+    HBITMAP hbmp;
+    HDC hdc;
+
+    hdc = CreateTargetDC(&hbmp);
+    if (!hdc || !hbmp)
+    {
+        skip("No target DC\n");
+        return;
+    }
+
+    Test_PatBlt(hdc);
+    Test_ExtTextOut(hdc);
+    Test_ExtSelectClipRgn(hdc);
+    Test_FrameCost(hdc);
+
+    DeleteDC(hdc);
+    DeleteObject(hbmp);
+}
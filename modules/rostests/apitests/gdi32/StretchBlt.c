@@ -0,0 +1,199 @@
+/*
+ * PROJECT:         ReactOS api tests
+ * LICENSE:         GPL - See COPYING in the top level directory
+ * PURPOSE:         Test for StretchBlt
+ */
+
+#include "precomp.h"
+
+#define SRC_WIDTH 48
+#define SRC_HEIGHT 24
+#define BENCH_SIZE 512
+#define BENCH_LOOPS 20
+
+static
+HBITMAP
+CreateTestDib(HDC hdc, INT cx, INT cy, WORD BitCount, PVOID *ppvBits)
+{
+    struct
+    {
+        BITMAPINFOHEADER bmiHeader;
+        ULONG bmiColors[3];
+    } bmi;
+
+    ZeroMemory(&bmi, sizeof(bmi));
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = cx;
+    bmi.bmiHeader.biHeight = -cy;
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = BitCount;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    /* Use 5-6-5 for 16bpp */
+    if (BitCount == 16)
+    {
+        bmi.bmiHeader.biCompression = BI_BITFIELDS;
+        bmi.bmiColors[0] = 0xF800;
+        bmi.bmiColors[1] = 0x7E0;
+        bmi.bmiColors[2] = 0x1F;
+    }
+
+    return CreateDIBSection(hdc, (BITMAPINFO*)&bmi, DIB_RGB_COLORS, ppvBits, NULL, 0);
+}
+
+static
+ULONG
+GetScanBytes(INT cx, ULONG Bpp)
+{
+    return ((cx * Bpp + 31) & ~31) / 8;
+}
+
+static
+ULONG
+ReadPixel(PBYTE pjBits, ULONG Bpp, INT cx, INT x, INT y)
+{
+    PBYTE pj = pjBits + y * GetScanBytes(cx, Bpp) + x * (Bpp / 8);
+
+    switch (Bpp)
+    {
+        case 16: return *(PUSHORT)pj;
+        case 24: return pj[0] | (pj[1] << 8) | (pj[2] << 16);
+        default: return *(PULONG)pj;
+    }
+}
+
+/* Convert a source pixel the way the engine does for these formats */
+static
+ULONG
+ConvertPixel(ULONG Color, ULONG SrcBpp, ULONG DstBpp)
+{
+    if (SrcBpp == DstBpp)
+        return Color;
+
+    if (DstBpp == 16)
+        return ((Color >> 8) & 0xF800) | ((Color >> 5) & 0x7E0) | ((Color >> 3) & 0x1F);
+
+    /* 24bpp and 32bpp are both BGR */
+    return Color & 0xFFFFFF;
+}
+
+static
+VOID
+Test_Stretch(WORD SrcBpp, WORD DstBpp, INT DstWidth, INT DstHeight)
+{
+    HDC hdcSrc, hdcDst;
+    HBITMAP hbmSrc, hbmDst;
+    PVOID pvSrc, pvDst;
+    ULONG i, cjSrc, Mismatches = 0, Got, Expected;
+    INT x, y;
+
+    hdcSrc = CreateCompatibleDC(NULL);
+    hdcDst = CreateCompatibleDC(NULL);
+    hbmSrc = CreateTestDib(hdcSrc, SRC_WIDTH, SRC_HEIGHT, SrcBpp, &pvSrc);
+    hbmDst = CreateTestDib(hdcDst, DstWidth, DstHeight, DstBpp, &pvDst);
+    ok(hbmSrc != NULL && hbmDst != NULL, "Failed to create the bitmaps\n");
+    if (!hbmSrc || !hbmDst)
+        goto Cleanup;
+
+    SelectObject(hdcSrc, hbmSrc);
+    SelectObject(hdcDst, hbmDst);
+
+    /* Every source pixel gets its own color */
+    cjSrc = SRC_HEIGHT * GetScanBytes(SRC_WIDTH, SrcBpp);
+    for (i = 0; i < cjSrc; i++)
+        ((PBYTE)pvSrc)[i] = (BYTE)(i * 7 + (i >> 8));
+
+    SetStretchBltMode(hdcDst, COLORONCOLOR);
+    ok(StretchBlt(hdcDst, 0, 0, DstWidth, DstHeight, hdcSrc, 0, 0, SRC_WIDTH, SRC_HEIGHT, SRCCOPY),
+       "StretchBlt failed\n");
+    GdiFlush();
+
+    for (y = 0; y < DstHeight; y++)
+    {
+        for (x = 0; x < DstWidth; x++)
+        {
+            Expected = ConvertPixel(ReadPixel(pvSrc,
+                                              SrcBpp,
+                                              SRC_WIDTH,
+                                              (x * SRC_WIDTH) / DstWidth,
+                                              (y * SRC_HEIGHT) / DstHeight),
+                                    SrcBpp,
+                                    DstBpp);
+            Got = ReadPixel(pvDst, DstBpp, DstWidth, x, y);
+            if (DstBpp == 32)
+                Got &= 0xFFFFFF;
+            if (SrcBpp == 32 && DstBpp == 32)
+                Expected &= 0xFFFFFF;
+
+            if (Got != Expected && Mismatches++ < 4)
+            {
+                ok(0, "%u->%u at (%d,%d): got 0x%lx, expected 0x%lx\n",
+                   SrcBpp, DstBpp, x, y, Got, Expected);
+            }
+        }
+    }
+
+    ok(Mismatches == 0, "%u->%u, %dx%d: %lu pixels differ\n",
+       SrcBpp, DstBpp, DstWidth, DstHeight, Mismatches);
+
+Cleanup:
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcDst);
+    if (hbmSrc) DeleteObject(hbmSrc);
+    if (hbmDst) DeleteObject(hbmDst);
+}
+
+static
+VOID
+Test_Benchmark(WORD SrcBpp, WORD DstBpp)
+{
+    HDC hdcSrc, hdcDst;
+    HBITMAP hbmSrc, hbmDst;
+    PVOID pvSrc, pvDst;
+    LARGE_INTEGER Frequency, Start, End;
+    ULONG i;
+
+    hdcSrc = CreateCompatibleDC(NULL);
+    hdcDst = CreateCompatibleDC(NULL);
+    hbmSrc = CreateTestDib(hdcSrc, BENCH_SIZE / 2, BENCH_SIZE / 2, SrcBpp, &pvSrc);
+    hbmDst = CreateTestDib(hdcDst, BENCH_SIZE, BENCH_SIZE, DstBpp, &pvDst);
+    if (hbmSrc && hbmDst)
+    {
+        SelectObject(hdcSrc, hbmSrc);
+        SelectObject(hdcDst, hbmDst);
+        SetStretchBltMode(hdcDst, COLORONCOLOR);
+
+        QueryPerformanceFrequency(&Frequency);
+        QueryPerformanceCounter(&Start);
+        for (i = 0; i < BENCH_LOOPS; i++)
+        {
+            StretchBlt(hdcDst, 0, 0, BENCH_SIZE, BENCH_SIZE,
+                       hdcSrc, 0, 0, BENCH_SIZE / 2, BENCH_SIZE / 2, SRCCOPY);
+        }
+        GdiFlush();
+        QueryPerformanceCounter(&End);
+
+        trace("%ux%u %u->%u stretch: %lu us\n", BENCH_SIZE, BENCH_SIZE, SrcBpp, DstBpp,
+              (ULONG)((End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart / BENCH_LOOPS));
+    }
+
+    DeleteDC(hdcSrc);
+    DeleteDC(hdcDst);
+    if (hbmSrc) DeleteObject(hbmSrc);
+    if (hbmDst) DeleteObject(hbmDst);
+}
+
+START_TEST(StretchBlt)
+{
+    Test_Stretch(32, 32, 100, 50);
+    Test_Stretch(32, 32, 30, 17);
+    Test_Stretch(24, 32, 71, 40);
+    Test_Stretch(32, 24, 96, 13);
+    Test_Stretch(24, 24, 20, 60);
+    Test_Stretch(32, 16, 64, 31);
+    Test_Stretch(16, 16, 97, 48);
+
+    Test_Benchmark(32, 32);
+    Test_Benchmark(24, 32);
+    Test_Benchmark(32, 16);
+}
@@ -7,6 +7,7 @@ extern void func_AddFontMemResourceEx(void);
 extern void func_AddFontResource(void);
 extern void func_AddFontResourceEx(void);
 extern void func_BeginPath(void);
+extern void func_BitBlt(void);
 extern void func_CombineRgn(void);
 extern void func_CombineTransform(void);
 extern void func_CreateBitmap(void);
@@ -35,6 +36,8 @@ extern void func_GdiConvertDC(void);
 extern void func_GdiConvertFont(void);
 extern void func_GdiConvertPalette(void);
 extern void func_GdiConvertRegion(void);
+extern void func_GdiAlphaBlend(void);
+extern void func_GdiBatch(void);
 extern void func_GdiDeleteLocalDC(void);
 extern void func_GdiGetCharDimensions(void);
 extern void func_GdiGetLocalBrush(void);
@@ -74,6 +77,7 @@ extern void func_SetPixel(void);
 extern void func_SetSysColors(void);
 extern void func_SetWindowExtEx(void);
 extern void func_SetWorldTransform(void);
+extern void func_StretchBlt(void);
 
 const struct test winetest_testlist[] =
 {
@@ -81,6 +85,7 @@ const struct test winetest_testlist[] =
     { "AddFontResource", func_AddFontResource },
     { "AddFontResourceEx", func_AddFontResourceEx },
     { "BeginPath", func_BeginPath },
+    { "BitBlt", func_BitBlt },
     { "CombineRgn", func_CombineRgn },
     { "CombineTransform", func_CombineTransform },
     { "CreateBitmap", func_CreateBitmap },
@@ -109,6 +114,8 @@ const struct test winetest_testlist[] =
     { "GdiConvertFont", func_GdiConvertFont },
     { "GdiConvertPalette", func_GdiConvertPalette },
     { "GdiConvertRegion", func_GdiConvertRegion },
+    { "GdiAlphaBlend", func_GdiAlphaBlend },
+    { "GdiBatch", func_GdiBatch },
     { "GdiDeleteLocalDC", func_GdiDeleteLocalDC },
     { "GdiGetCharDimensions", func_GdiGetCharDimensions },
     { "GdiGetLocalBrush", func_GdiGetLocalBrush },
@@ -148,6 +155,7 @@ const struct test winetest_testlist[] =
     { "SetSysColors", func_SetSysColors },
     { "SetWindowExtEx", func_SetWindowExtEx },
     { "SetWorldTransform", func_SetWorldTransform },
+    { "StretchBlt", func_StretchBlt },
 
     { 0, 0 }
 };
@@ -0,0 +1,106 @@
+/*
+ * PROJECT:         ReactOS api tests
+ * LICENSE:         LGPLv2.1+ - See COPYING.LIB in the top level directory
+ * PURPOSE:         Test for GetQueuedCompletionStatusEx
+ */
+
+#include "precomp.h"
+
+#if (_WIN32_WINNT < 0x0600)
+typedef struct _OVERLAPPED_ENTRY
+{
+    ULONG_PTR lpCompletionKey;
+    LPOVERLAPPED lpOverlapped;
+    ULONG_PTR Internal;
+    DWORD dwNumberOfBytesTransferred;
+} OVERLAPPED_ENTRY, *LPOVERLAPPED_ENTRY;
+#endif
+
+static BOOL (WINAPI *pGetQueuedCompletionStatusEx)(HANDLE, LPOVERLAPPED_ENTRY, ULONG, PULONG, DWORD, BOOL);
+
+static LONG ApcCount;
+
+static
+VOID
+CALLBACK
+ApcRoutine(ULONG_PTR Parameter)
+{
+    ok(Parameter == 0x1234, "Parameter = %Iu\n", Parameter);
+    InterlockedIncrement(&ApcCount);
+}
+
+static
+VOID
+TestAlertable(HANDLE Port)
+{
+    OVERLAPPED_ENTRY Entries[4];
+    ULONG Removed;
+    BOOL Ret;
+
+    /* A queued user APC ends an alertable wait on an empty port */
+    ApcCount = 0;
+    ok(QueueUserAPC(ApcRoutine, GetCurrentThread(), 0x1234), "QueueUserAPC failed\n");
+    Removed = 0xdeadbeef;
+    SetLastError(0xdeadbeef);
+    Ret = pGetQueuedCompletionStatusEx(Port, Entries, RTL_NUMBER_OF(Entries), &Removed, 1000, TRUE);
+    ok(!Ret, "GetQueuedCompletionStatusEx succeeded\n");
+    ok_err(WAIT_IO_COMPLETION);
+    ok_long(Removed, 0);
+    ok_long(ApcCount, 1);
+
+    /* A non-alertable wait leaves the APC alone and times out */
+    ApcCount = 0;
+    ok(QueueUserAPC(ApcRoutine, GetCurrentThread(), 0x1234), "QueueUserAPC failed\n");
+    SetLastError(0xdeadbeef);
+    Ret = pGetQueuedCompletionStatusEx(Port, Entries, RTL_NUMBER_OF(Entries), &Removed, 0, FALSE);
+    ok(!Ret, "GetQueuedCompletionStatusEx succeeded\n");
+    ok_err(WAIT_TIMEOUT);
+    ok_long(Removed, 0);
+    ok_long(ApcCount, 0);
+    ok_long(SleepEx(0, TRUE), WAIT_IO_COMPLETION);
+    ok_long(ApcCount, 1);
+
+    /* Queued packets are returned before APCs get a chance to run */
+    ApcCount = 0;
+    ok(PostQueuedCompletionStatus(Port, 10, 20, NULL), "PostQueuedCompletionStatus failed\n");
+    ok(QueueUserAPC(ApcRoutine, GetCurrentThread(), 0x1234), "QueueUserAPC failed\n");
+    Removed = 0;
+    Ret = pGetQueuedCompletionStatusEx(Port, Entries, RTL_NUMBER_OF(Entries), &Removed, 1000, TRUE);
+    ok(Ret, "GetQueuedCompletionStatusEx failed with %lu\n", GetLastError());
+    ok_long(Removed, 1);
+    ok(Entries[0].lpCompletionKey == 20, "Key = %Iu\n", Entries[0].lpCompletionKey);
+    ok_long(Entries[0].dwNumberOfBytesTransferred, 10);
+    ok_long(ApcCount, 0);
+    ok_long(SleepEx(0, TRUE), WAIT_IO_COMPLETION);
+    ok_long(ApcCount, 1);
+}
+
+START_TEST(GetQueuedCompletionStatusEx)
+{
+    HMODULE hKernel32;
+    HANDLE Port;
+
+    hKernel32 = GetModuleHandleW(L"kernel32.dll");
+    pGetQueuedCompletionStatusEx = (PVOID)GetProcAddress(hKernel32, "GetQueuedCompletionStatusEx");
+    if (!pGetQueuedCompletionStatusEx)
+    {
+        /* ReactOS has it in the Vista additions */
+        hKernel32 = LoadLibraryW(L"kernel32_vista.dll");
+        if (hKernel32)
+            pGetQueuedCompletionStatusEx = (PVOID)GetProcAddress(hKernel32, "GetQueuedCompletionStatusEx");
+    }
+    if (!pGetQueuedCompletionStatusEx)
+    {
+        skip("GetQueuedCompletionStatusEx not available\n");
+        return;
+    }
+
+    Port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 0);
+    ok(Port != NULL, "CreateIoCompletionPort failed with %lu\n", GetLastError());
+    if (!Port)
+        return;
+
+    TestAlertable(Port);
+
+    CloseHandle(Port);
+}
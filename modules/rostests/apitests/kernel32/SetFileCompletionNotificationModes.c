@@ -0,0 +1,181 @@
+/*
+ * PROJECT:         ReactOS api tests
+ * LICENSE:         LGPLv2.1+ - See COPYING.LIB in the top level directory
+ * PURPOSE:         Test for SetFileCompletionNotificationModes
+ */
+
+#include "precomp.h"
+
+#ifndef FILE_SKIP_COMPLETION_PORT_ON_SUCCESS
+#define FILE_SKIP_COMPLETION_PORT_ON_SUCCESS 0x1
+#define FILE_SKIP_SET_EVENT_ON_HANDLE 0x2
+#endif
+
+#define PIPE_NAME L"\\\\.\\pipe\\rostest_completion_modes"
+#define WRITE_COUNT 64
+
+static BOOL (WINAPI *pSetFileCompletionNotificationModes)(HANDLE, UCHAR);
+
+static
+BOOL
+CreatePipePair(PHANDLE Server, PHANDLE Client)
+{
+    *Server = CreateNamedPipeW(PIPE_NAME,
+                               PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED,
+                               PIPE_TYPE_BYTE | PIPE_WAIT,
+                               1,
+                               0,
+                               64 * 1024,
+                               0,
+                               NULL);
+    ok(*Server != INVALID_HANDLE_VALUE, "CreateNamedPipeW failed: %lu\n", GetLastError());
+    if (*Server == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    *Client = CreateFileW(PIPE_NAME, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+    ok(*Client != INVALID_HANDLE_VALUE, "CreateFileW failed: %lu\n", GetLastError());
+    if (*Client == INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(*Server);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static
+ULONG
+CountPackets(HANDLE Port)
+{
+    DWORD Bytes;
+    ULONG_PTR Key;
+    LPOVERLAPPED Overlapped;
+    ULONG Count = 0;
+
+    while (GetQueuedCompletionStatus(Port, &Bytes, &Key, &Overlapped, 0))
+        Count++;
+
+    ok_err(WAIT_TIMEOUT);
+    return Count;
+}
+
+static
+VOID
+TestSkipCompletionPort(BOOL Skip)
+{
+    HANDLE Server, Client, Port;
+    OVERLAPPED Overlapped[WRITE_COUNT];
+    CHAR Buffer[16] = "completion test";
+    ULONG Inline = 0, Pending = 0, Packets, i;
+    DWORD Written;
+
+    if (!CreatePipePair(&Server, &Client))
+        return;
+
+    Port = CreateIoCompletionPort(Client, NULL, 1, 0);
+    ok(Port != NULL, "CreateIoCompletionPort failed: %lu\n", GetLastError());
+    if (Port == NULL)
+        goto Cleanup;
+
+    if (Skip)
+        ok(pSetFileCompletionNotificationModes(Client, FILE_SKIP_COMPLETION_PORT_ON_SUCCESS),
+           "SetFileCompletionNotificationModes failed: %lu\n", GetLastError());
+
+    /* There's plenty of room in the pipe, so most writes complete inline */
+    ZeroMemory(Overlapped, sizeof(Overlapped));
+    for (i = 0; i < WRITE_COUNT; i++)
+    {
+        if (WriteFile(Client, Buffer, sizeof(Buffer), NULL, &Overlapped[i]))
+        {
+            Inline++;
+        }
+        else
+        {
+            ok_err(ERROR_IO_PENDING);
+            ok(GetOverlappedResult(Client, &Overlapped[i], &Written, TRUE),
+               "GetOverlappedResult failed: %lu\n", GetLastError());
+            Pending++;
+        }
+    }
+
+    /* Only requests that went pending may queue a packet when skipping */
+    Packets = CountPackets(Port);
+    if (Skip)
+    {
+        ok(Inline != 0, "No write completed inline\n");
+        ok(Packets == Pending, "Got %lu packets for %lu pending writes\n", Packets, Pending);
+    }
+    else
+    {
+        ok(Packets == WRITE_COUNT, "Got %lu packets for %u writes\n", Packets, WRITE_COUNT);
+    }
+
+    trace("Skip %d: %lu writes inline, %lu pending, %lu packets queued\n", Skip, Inline, Pending, Packets);
+
+    CloseHandle(Port);
+Cleanup:
+    CloseHandle(Client);
+    CloseHandle(Server);
+}
+
+static
+VOID
+TestSkipSetEvent(BOOL Skip)
+{
+    HANDLE Server, Client;
+    OVERLAPPED Overlapped;
+    CHAR Buffer[16] = "completion test";
+    DWORD Written;
+    BOOL Ret;
+
+    if (!CreatePipePair(&Server, &Client))
+        return;
+
+    if (Skip)
+        ok(pSetFileCompletionNotificationModes(Client, FILE_SKIP_SET_EVENT_ON_HANDLE),
+           "SetFileCompletionNotificationModes failed: %lu\n", GetLastError());
+
+    /* Without an event in the OVERLAPPED, the file handle itself gets signaled */
+    ZeroMemory(&Overlapped, sizeof(Overlapped));
+    Ret = WriteFile(Client, Buffer, sizeof(Buffer), NULL, &Overlapped);
+    if (Ret)
+    {
+        ok_long(WaitForSingleObject(Client, 0), Skip ? WAIT_TIMEOUT : WAIT_OBJECT_0);
+    }
+    else
+    {
+        skip("Write didn't complete inline\n");
+        GetOverlappedResult(Client, &Overlapped, &Written, TRUE);
+    }
+
+    CloseHandle(Client);
+    CloseHandle(Server);
+}
+
+START_TEST(SetFileCompletionNotificationModes)
+{
+    HANDLE Server, Client;
+
+    pSetFileCompletionNotificationModes = (PVOID)GetProcAddress(GetModuleHandleW(L"kernel32.dll"),
+                                                                "SetFileCompletionNotificationModes");
+    if (!pSetFileCompletionNotificationModes)
+    {
+        skip("SetFileCompletionNotificationModes not available\n");
+        return;
+    }
+
+    /* Unknown modes are rejected */
+    if (CreatePipePair(&Server, &Client))
+    {
+        SetLastError(0xdeadbeef);
+        ok(!pSetFileCompletionNotificationModes(Client, 0x80), "SetFileCompletionNotificationModes succeeded\n");
+        ok_err(ERROR_INVALID_PARAMETER);
+        CloseHandle(Client);
+        CloseHandle(Server);
+    }
+
+    TestSkipCompletionPort(FALSE);
+    TestSkipCompletionPort(TRUE);
+    TestSkipSetEvent(FALSE);
+    TestSkipSetEvent(TRUE);
+}
@@ -0,0 +1,132 @@
+/*
+ * PROJECT:         ReactOS api tests
+ * LICENSE:         LGPLv2.1+ - See COPYING.LIB in the top level directory
+ * PURPOSE:         Test for NtRemoveIoCompletionEx
+ */
+
+#include "precomp.h"
+
+#define BENCHMARK_PACKETS 100000
+#define BENCHMARK_BATCH 64
+
+static
+VOID
+PostPackets(HANDLE Port, ULONG Count)
+{
+    NTSTATUS Status;
+    ULONG i;
+
+    for (i = 0; i < Count; i++)
+    {
+        Status = NtSetIoCompletion(Port, (PVOID)(ULONG_PTR)(i + 1), (PVOID)(ULONG_PTR)i, STATUS_SUCCESS, i * 2);
+        if (!NT_SUCCESS(Status))
+        {
+            ok_ntstatus(Status, STATUS_SUCCESS);
+            return;
+        }
+    }
+}
+
+static
+VOID
+TestBasic(HANDLE Port)
+{
+    FILE_IO_COMPLETION_INFORMATION Entries[8];
+    LARGE_INTEGER Timeout;
+    ULONG Removed, i;
+    NTSTATUS Status;
+
+    Timeout.QuadPart = 0;
+
+    /* Empty queue times out */
+    Removed = 0xdeadbeef;
+    Status = NtRemoveIoCompletionEx(Port, Entries, RTL_NUMBER_OF(Entries), &Removed, &Timeout, FALSE);
+    ok_ntstatus(Status, STATUS_TIMEOUT);
+    ok_long(Removed, 0);
+
+    /* A zero sized array is invalid */
+    Status = NtRemoveIoCompletionEx(Port, Entries, 0, &Removed, &Timeout, FALSE);
+    ok_ntstatus(Status, STATUS_INVALID_PARAMETER);
+
+    /* Fewer packets than room returns what's there, in order */
+    PostPackets(Port, 5);
+    Removed = 0;
+    Status = NtRemoveIoCompletionEx(Port, Entries, RTL_NUMBER_OF(Entries), &Removed, &Timeout, FALSE);
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    ok_long(Removed, 5);
+    for (i = 0; i < Removed; i++)
+    {
+        ok(Entries[i].KeyContext == (PVOID)(ULONG_PTR)(i + 1), "Entry %lu: key %p\n", i, Entries[i].KeyContext);
+        ok(Entries[i].ApcContext == (PVOID)(ULONG_PTR)i, "Entry %lu: context %p\n", i, Entries[i].ApcContext);
+        ok_ntstatus(Entries[i].IoStatusBlock.Status, STATUS_SUCCESS);
+        ok(Entries[i].IoStatusBlock.Information == i * 2, "Entry %lu: information %Iu\n", i, Entries[i].IoStatusBlock.Information);
+    }
+
+    /* More packets than room leaves the rest queued */
+    PostPackets(Port, 10);
+    Status = NtRemoveIoCompletionEx(Port, Entries, RTL_NUMBER_OF(Entries), &Removed, &Timeout, FALSE);
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    ok_long(Removed, 8);
+    Status = NtRemoveIoCompletionEx(Port, Entries, RTL_NUMBER_OF(Entries), &Removed, &Timeout, FALSE);
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    ok_long(Removed, 2);
+    ok(Entries[0].KeyContext == (PVOID)9, "Key %p\n", Entries[0].KeyContext);
+}
+
+static
+VOID
+TestThroughput(HANDLE Port)
+{
+    FILE_IO_COMPLETION_INFORMATION Entries[BENCHMARK_BATCH];
+    LARGE_INTEGER Start, End, Frequency, Timeout;
+    IO_STATUS_BLOCK IoStatus;
+    PVOID Key, Context;
+    ULONG Removed, Total;
+    NTSTATUS Status;
+
+    Timeout.QuadPart = 0;
+
+    /* One packet per call */
+    PostPackets(Port, BENCHMARK_PACKETS);
+    NtQueryPerformanceCounter(&Start, &Frequency);
+    for (Total = 0; Total < BENCHMARK_PACKETS; Total++)
+    {
+        Status = NtRemoveIoCompletion(Port, &Key, &Context, &IoStatus, &Timeout);
+        if (Status != STATUS_SUCCESS)
+            break;
+    }
+    NtQueryPerformanceCounter(&End, NULL);
+    ok_long(Total, BENCHMARK_PACKETS);
+    trace("NtRemoveIoCompletion: %lu packets in %I64d us\n", Total,
+          (End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart);
+
+    /* Many packets per call */
+    PostPackets(Port, BENCHMARK_PACKETS);
+    NtQueryPerformanceCounter(&Start, NULL);
+    for (Total = 0; Total < BENCHMARK_PACKETS; Total += Removed)
+    {
+        Status = NtRemoveIoCompletionEx(Port, Entries, RTL_NUMBER_OF(Entries), &Removed, &Timeout, FALSE);
+        if (Status != STATUS_SUCCESS)
+            break;
+    }
+    NtQueryPerformanceCounter(&End, NULL);
+    ok_long(Total, BENCHMARK_PACKETS);
+    trace("NtRemoveIoCompletionEx (%u per call): %lu packets in %I64d us\n", BENCHMARK_BATCH, Total,
+          (End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart);
+}
+
+START_TEST(NtRemoveIoCompletionEx)
+{
+    HANDLE Port;
+    NTSTATUS Status;
+
+    Status = NtCreateIoCompletion(&Port, IO_COMPLETION_ALL_ACCESS, NULL, 0);
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    if (!NT_SUCCESS(Status))
+        return;
+
+    TestBasic(Port);
+    TestThroughput(Port);
+
+    NtClose(Port);
+}
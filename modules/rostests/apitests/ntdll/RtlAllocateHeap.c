@@ -15,6 +15,8 @@ START_TEST(RtlAllocateHeap)
     HANDLE hHeap;
     BOOLEAN Aligned = TRUE;
     RTL_HEAP_PARAMETERS Parameters = {0};
+    NTSTATUS Status;
+    ULONG HeapType;
 
     for (i = 0; i < 0x100; ++i)
     {
@@ -71,4 +73,58 @@ START_TEST(RtlAllocateHeap)
     _SEH2_END;
 
     ok(hHeap == NULL, "Unexpected heap value: %p\n", hHeap);
+
+    /* Low fragmentation front end */
+    hHeap = RtlCreateHeap(HEAP_GROWABLE, NULL, 0, 0, NULL, NULL);
+    ok(hHeap != NULL, "RtlCreateHeap failed\n");
+    if (hHeap == NULL)
+    {
+        return;
+    }
+
+    HeapType = 2;
+    Status = RtlSetHeapInformation(hHeap, HeapCompatibilityInformation, &HeapType, sizeof(HeapType));
+    ok(Status == STATUS_SUCCESS, "RtlSetHeapInformation failed: 0x%lx\n", Status);
+    HeapType = 0;
+    Status = RtlQueryHeapInformation(hHeap, HeapCompatibilityInformation, &HeapType, sizeof(HeapType), NULL);
+    ok(Status == STATUS_SUCCESS, "RtlQueryHeapInformation failed: 0x%lx\n", Status);
+    ok(HeapType == 2, "Unexpected heap type: %lu\n", HeapType);
+
+    for (i = 0; i < 0x100; ++i)
+    {
+        Buffers[i] = RtlAllocateHeap(hHeap, 0, (i % 64) + 1);
+        ok(Buffers[i] != NULL, "Allocation %u failed\n", i);
+        if (Buffers[i] != NULL)
+        {
+            RtlFillMemory(Buffers[i], (i % 64) + 1, (UCHAR)i);
+        }
+    }
+
+    /* Recycle every other block through the front end */
+    for (i = 0; i < 0x100; i += 2)
+    {
+        RtlFreeHeap(hHeap, 0, Buffers[i]);
+        Buffers[i] = RtlAllocateHeap(hHeap, HEAP_ZERO_MEMORY, (i % 64) + 1);
+        ok(Buffers[i] != NULL, "Allocation %u failed\n", i);
+        if (Buffers[i] != NULL)
+        {
+            ok(RtlSizeHeap(hHeap, 0, Buffers[i]) == (i % 64) + 1, "Unexpected size for %u\n", i);
+            ok(*(PUCHAR)Buffers[i] == 0, "Block %u not zeroed\n", i);
+        }
+    }
+
+    /* The untouched blocks must have kept their contents */
+    for (i = 1; i < 0x100; i += 2)
+    {
+        if (Buffers[i] != NULL)
+        {
+            ok(((PUCHAR)Buffers[i])[i % 64] == (UCHAR)i, "Block %u corrupted\n", i);
+        }
+    }
+
+    ok(RtlMultipleFreeHeap(hHeap, 0, 0x100, Buffers) == 0x100, "RtlMultipleFreeHeap failed\n");
+    ok(RtlMultipleAllocateHeap(hHeap, 0, 24, 0x100, Buffers) == 0x100, "RtlMultipleAllocateHeap failed\n");
+    ok(RtlMultipleFreeHeap(hHeap, 0, 0x100, Buffers) == 0x100, "RtlMultipleFreeHeap failed\n");
+
+    RtlDestroyHeap(hHeap);
 }
@@ -314,6 +314,461 @@ Test_KernelDebugger(void)
     ok(Status == STATUS_INVALID_INFO_CLASS, "NtSetSystemInformation returned %lx\n", Status);
 }
 
+static
+void
+Test_WorkQueue(void)
+{
+    NTSTATUS Status;
+    ULONG ReturnLength;
+    ULONG i;
+    PSYSTEM_WORK_QUEUE_INFORMATION WorkQueueInfo;
+
+    /* ReactOS specific class */
+    ReturnLength = 0x55555555;
+    Status = NtQuerySystemInformation(SystemWorkQueueInformation, NULL, 0, &ReturnLength);
+    if (Status == STATUS_INVALID_INFO_CLASS)
+    {
+        skip("SystemWorkQueueInformation not supported\n");
+        return;
+    }
+    ok(Status == STATUS_INFO_LENGTH_MISMATCH, "NtQuerySystemInformation returned %lx\n", Status);
+    /* There is at least one queue of each type */
+    ok(ReturnLength >= FIELD_OFFSET(SYSTEM_WORK_QUEUE_INFORMATION, Queues[3]), "ReturnLength = %lu\n", ReturnLength);
+
+    WorkQueueInfo = HeapAlloc(GetProcessHeap(), 0, ReturnLength);
+    if (!WorkQueueInfo)
+    {
+        skip("Out of memory\n");
+        return;
+    }
+
+    Status = NtQuerySystemInformation(SystemWorkQueueInformation, WorkQueueInfo, ReturnLength, &ReturnLength);
+    ok(Status == STATUS_SUCCESS, "NtQuerySystemInformation returned %lx\n", Status);
+    if (NT_SUCCESS(Status))
+    {
+        ok(ReturnLength == FIELD_OFFSET(SYSTEM_WORK_QUEUE_INFORMATION, Queues[WorkQueueInfo->NumberOfQueues]), "ReturnLength = %lu\n", ReturnLength);
+        for (i = 0; i < WorkQueueInfo->NumberOfQueues; i++)
+        {
+            PSYSTEM_WORK_QUEUE_ENTRY Entry = &WorkQueueInfo->Queues[i];
+
+            ok(Entry->QueueType <= 2, "Queue %lu: QueueType = %lu\n", i, Entry->QueueType);
+            ok(Entry->WorkerCount != 0, "Queue %lu: no workers\n", i);
+            trace("Queue %lu: type %lu, cpu %ld, %lu workers (%lu dynamic), depth %lu, "
+                  "%lu queued, %lu processed, %lu stolen, max wait %lu\n",
+                  i, Entry->QueueType, (LONG)Entry->Processor, Entry->WorkerCount,
+                  Entry->DynamicThreadCount, Entry->QueueDepth, Entry->WorkItemsQueued,
+                  Entry->WorkItemsProcessed, Entry->WorkItemsStolen, Entry->MaximumWaitTime);
+        }
+    }
+
+    /* Set - not supported */
+    Status = NtSetSystemInformation(SystemWorkQueueInformation, WorkQueueInfo, ReturnLength);
+    ok(Status == STATUS_INVALID_INFO_CLASS, "NtSetSystemInformation returned %lx\n", Status);
+
+    HeapFree(GetProcessHeap(), 0, WorkQueueInfo);
+}
+
+static
+void
+Test_LockStatistics(void)
+{
+    NTSTATUS Status;
+    ULONG ReturnLength;
+    ULONG i;
+    struct
+    {
+        SYSTEM_LOCK_STATISTICS_INFORMATION Info;
+        SYSTEM_LOCK_STATISTICS_ENTRY MoreLocks[15];
+    } LockInfo;
+
+    /* ReactOS specific class, only there when the statistics are compiled in */
+    ReturnLength = 0x55555555;
+    Status = NtQuerySystemInformation(SystemLockStatisticsInformation, &LockInfo, sizeof(LockInfo), &ReturnLength);
+    if ((Status == STATUS_INVALID_INFO_CLASS) || (Status == STATUS_NOT_IMPLEMENTED))
+    {
+        skip("SystemLockStatisticsInformation not supported\n");
+        return;
+    }
+    ok(Status == STATUS_SUCCESS, "NtQuerySystemInformation returned %lx\n", Status);
+    if (!NT_SUCCESS(Status))
+        return;
+
+    ok(LockInfo.Info.NumberOfLocks <= 16, "NumberOfLocks = %lu\n", LockInfo.Info.NumberOfLocks);
+    ok(LockInfo.Info.NumberOfLocks <= LockInfo.Info.TotalLocks, "NumberOfLocks = %lu, TotalLocks = %lu\n",
+       LockInfo.Info.NumberOfLocks, LockInfo.Info.TotalLocks);
+    ok(ReturnLength == FIELD_OFFSET(SYSTEM_LOCK_STATISTICS_INFORMATION, Locks[LockInfo.Info.NumberOfLocks]),
+       "ReturnLength = %lu\n", ReturnLength);
+    for (i = 0; i < LockInfo.Info.NumberOfLocks; i++)
+    {
+        PSYSTEM_LOCK_STATISTICS_ENTRY Entry = &LockInfo.Info.Locks[i];
+
+        ok(Entry->Lock != NULL, "Lock %lu: no address\n", i);
+        ok(Entry->Contentions <= Entry->Acquires, "Lock %lu: %lu contentions for %lu acquires\n",
+           i, Entry->Contentions, Entry->Acquires);
+        /* Sorted by time lost */
+        if (i > 0)
+            ok(Entry->SpinCycles <= LockInfo.Info.Locks[i - 1].SpinCycles, "Lock %lu is out of order\n", i);
+        trace("Lock %p (%s) at %p: %lu acquires, %lu contended, %I64u cycles spinning, %I64u max hold\n",
+              Entry->Lock, Entry->Type == LOCK_STATISTICS_GUARDED_MUTEX ? "guarded mutex" : "spinlock",
+              Entry->CallSite, Entry->Acquires, Entry->Contentions, Entry->SpinCycles, Entry->MaximumHoldCycles);
+    }
+
+    /* Too small for the header */
+    Status = NtQuerySystemInformation(SystemLockStatisticsInformation, &LockInfo, sizeof(ULONG), &ReturnLength);
+    ok(Status == STATUS_INFO_LENGTH_MISMATCH, "NtQuerySystemInformation returned %lx\n", Status);
+}
+
+static
+void
+Test_ZeroPage(void)
+{
+    NTSTATUS Status;
+    ULONG ReturnLength;
+    SYSTEM_ZERO_PAGE_INFORMATION ZeroPageInfo;
+    SYSTEM_PERFORMANCE_INFORMATION PerfInfo;
+
+    /* ReactOS specific class */
+    ReturnLength = 0x55555555;
+    Status = NtQuerySystemInformation(SystemZeroPageInformation, &ZeroPageInfo, sizeof(ZeroPageInfo), &ReturnLength);
+    if (Status == STATUS_INVALID_INFO_CLASS)
+    {
+        skip("SystemZeroPageInformation not supported\n");
+        return;
+    }
+    ok(Status == STATUS_SUCCESS, "NtQuerySystemInformation returned %lx\n", Status);
+    ok(ReturnLength == sizeof(ZeroPageInfo), "ReturnLength = %lu\n", ReturnLength);
+    if (!NT_SUCCESS(Status))
+        return;
+
+    ok(ZeroPageInfo.ZeroingThreads != 0, "No zeroing threads\n");
+    ok(ZeroPageInfo.ActiveZeroingThreads <= ZeroPageInfo.ZeroingThreads, "%lu of %lu threads active\n",
+       ZeroPageInfo.ActiveZeroingThreads, ZeroPageInfo.ZeroingThreads);
+    trace("Zeroed %lu, free %lu, %lu threads (%lu active), %lu pages zeroed by threads, %lu synchronously\n",
+          ZeroPageInfo.ZeroedPageCount, ZeroPageInfo.FreePageCount, ZeroPageInfo.ZeroingThreads,
+          ZeroPageInfo.ActiveZeroingThreads, ZeroPageInfo.PagesZeroedByThreads, ZeroPageInfo.SynchronousZeroPages);
+
+    /* The fallback count is also in the performance information */
+    Status = NtQuerySystemInformation(SystemPerformanceInformation, &PerfInfo, sizeof(PerfInfo), NULL);
+    ok(Status == STATUS_SUCCESS, "NtQuerySystemInformation returned %lx\n", Status);
+    if (NT_SUCCESS(Status))
+    {
+        ok(PerfInfo.Spare3Count >= ZeroPageInfo.SynchronousZeroPages, "Spare3Count = %lu, expected at least %lu\n",
+           PerfInfo.Spare3Count, ZeroPageInfo.SynchronousZeroPages);
+    }
+
+    /* Too small */
+    Status = NtQuerySystemInformation(SystemZeroPageInformation, &ZeroPageInfo, sizeof(ULONG), &ReturnLength);
+    ok(Status == STATUS_INFO_LENGTH_MISMATCH, "NtQuerySystemInformation returned %lx\n", Status);
+}
+
+static
+BOOLEAN
+QuerySectionFaults(PULONG ClusterSize, PSYSTEM_SECTION_FAULT_ENTRY Own)
+{
+    NTSTATUS Status;
+    ULONG ReturnLength;
+    ULONG i;
+    PSYSTEM_SECTION_FAULT_INFORMATION Info;
+    ULONG Size = FIELD_OFFSET(SYSTEM_SECTION_FAULT_INFORMATION, Processes[512]);
+
+    Info = RtlAllocateHeap(RtlGetProcessHeap(), 0, Size);
+    if (!Info)
+    {
+        skip("Out of memory\n");
+        return FALSE;
+    }
+
+    Status = NtQuerySystemInformation(SystemSectionFaultInformation, Info, Size, &ReturnLength);
+    ok(Status == STATUS_SUCCESS, "NtQuerySystemInformation returned %lx\n", Status);
+    if (!NT_SUCCESS(Status))
+    {
+        RtlFreeHeap(RtlGetProcessHeap(), 0, Info);
+        return FALSE;
+    }
+    ok(ReturnLength == FIELD_OFFSET(SYSTEM_SECTION_FAULT_INFORMATION, Processes[Info->NumberOfProcesses]),
+       "ReturnLength = %lu\n", ReturnLength);
+
+    *ClusterSize = Info->ClusterSize;
+    RtlZeroMemory(Own, sizeof(*Own));
+    for (i = 0; i < Info->NumberOfProcesses; i++)
+    {
+        if (Info->Processes[i].UniqueProcessId == NtCurrentTeb()->ClientId.UniqueProcess)
+        {
+            *Own = Info->Processes[i];
+            break;
+        }
+    }
+    ok(i < Info->NumberOfProcesses, "Current process not found in %lu processes\n", Info->NumberOfProcesses);
+
+    RtlFreeHeap(RtlGetProcessHeap(), 0, Info);
+    return i < Info->NumberOfProcesses;
+}
+
+#define SECTION_FAULT_PAGES 64
+
+/* Map a fresh file and read every page of it once */
+static
+BOOLEAN
+TouchFreshFile(PSYSTEM_SECTION_FAULT_ENTRY Delta)
+{
+    NTSTATUS Status;
+    WCHAR TempPath[MAX_PATH];
+    WCHAR FileName[MAX_PATH];
+    HANDLE Handle, SectionHandle;
+    PUCHAR Data, BaseAddress = NULL;
+    SIZE_T ViewSize = 0;
+    SYSTEM_SECTION_FAULT_ENTRY Before, After;
+    ULONG ClusterSize, Written, i;
+    BOOLEAN Result = FALSE;
+
+    GetTempPathW(MAX_PATH, TempPath);
+    GetTempFileNameW(TempPath, L"sfc", 0, FileName);
+    Handle = CreateFileW(FileName, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    if (Handle == INVALID_HANDLE_VALUE)
+    {
+        skip("Failed to create temp file %ls, error %lu\n", FileName, GetLastError());
+        return FALSE;
+    }
+
+    Data = RtlAllocateHeap(RtlGetProcessHeap(), HEAP_ZERO_MEMORY, SECTION_FAULT_PAGES * PAGE_SIZE);
+    if (Data)
+    {
+        ok(WriteFile(Handle, Data, SECTION_FAULT_PAGES * PAGE_SIZE, &Written, NULL), "WriteFile failed with %lu\n", GetLastError());
+        RtlFreeHeap(RtlGetProcessHeap(), 0, Data);
+    }
+
+    Status = NtCreateSection(&SectionHandle, SECTION_MAP_READ, NULL, NULL, PAGE_READONLY, SEC_COMMIT, Handle);
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    if (NT_SUCCESS(Status))
+    {
+        Status = NtMapViewOfSection(SectionHandle, NtCurrentProcess(), (PVOID*)&BaseAddress, 0, 0, NULL,
+                                    &ViewSize, ViewUnmap, 0, PAGE_READONLY);
+        ok_ntstatus(Status, STATUS_SUCCESS);
+        if (NT_SUCCESS(Status))
+        {
+            if (QuerySectionFaults(&ClusterSize, &Before))
+            {
+                for (i = 0; i < SECTION_FAULT_PAGES; i++)
+                    (void)((volatile UCHAR *)BaseAddress)[i * PAGE_SIZE];
+
+                if (QuerySectionFaults(&ClusterSize, &After))
+                {
+                    Delta->SinglePageFaults = After.SinglePageFaults - Before.SinglePageFaults;
+                    Delta->ClusteredFaults = After.ClusteredFaults - Before.ClusteredFaults;
+                    Delta->ClusteredPages = After.ClusteredPages - Before.ClusteredPages;
+                    Result = TRUE;
+                }
+            }
+            NtUnmapViewOfSection(NtCurrentProcess(), BaseAddress);
+        }
+        NtClose(SectionHandle);
+    }
+
+    CloseHandle(Handle);
+    DeleteFileW(FileName);
+    return Result;
+}
+
+static
+void
+Test_SectionFault(void)
+{
+    NTSTATUS Status;
+    ULONG ReturnLength;
+    ULONG ClusterSize, NewClusterSize;
+    SYSTEM_SECTION_FAULT_INFORMATION Info;
+    SYSTEM_SECTION_FAULT_ENTRY Own, Single, Clustered;
+    BOOLEAN WasEnabled;
+
+    /* ReactOS specific class */
+    ReturnLength = 0x55555555;
+    Status = NtQuerySystemInformation(SystemSectionFaultInformation, &Info, sizeof(ULONG), &ReturnLength);
+    if (Status == STATUS_INVALID_INFO_CLASS)
+    {
+        skip("SystemSectionFaultInformation not supported\n");
+        return;
+    }
+    ok(Status == STATUS_INFO_LENGTH_MISMATCH, "NtQuerySystemInformation returned %lx\n", Status);
+
+    if (!QuerySectionFaults(&ClusterSize, &Own))
+        return;
+    trace("Cluster size %lu: %lu single page faults, %lu clustered faults bringing in %lu more pages\n",
+          ClusterSize, Own.SinglePageFaults, Own.ClusteredFaults, Own.ClusteredPages);
+
+    /* Changing the cluster size needs the debug privilege */
+    Status = RtlAdjustPrivilege(SE_DEBUG_PRIVILEGE, TRUE, FALSE, &WasEnabled);
+    if (!NT_SUCCESS(Status))
+    {
+        skip("RtlAdjustPrivilege(SE_DEBUG_PRIVILEGE) failed (Status 0x%08lx)\n", Status);
+        return;
+    }
+
+    /* Compare reading a file page by page with reading it in clusters */
+    NewClusterSize = 1;
+    Status = NtSetSystemInformation(SystemSectionFaultInformation, &NewClusterSize, sizeof(NewClusterSize));
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    if (NT_SUCCESS(Status) && TouchFreshFile(&Single))
+    {
+        ok(Single.SinglePageFaults >= SECTION_FAULT_PAGES, "%lu single page faults for %u pages\n",
+           Single.SinglePageFaults, SECTION_FAULT_PAGES);
+        ok(Single.ClusteredFaults == 0, "%lu clustered faults without clustering\n", Single.ClusteredFaults);
+    }
+
+    NewClusterSize = 16;
+    Status = NtSetSystemInformation(SystemSectionFaultInformation, &NewClusterSize, sizeof(NewClusterSize));
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    if (NT_SUCCESS(Status) && TouchFreshFile(&Clustered))
+    {
+        ok(Clustered.ClusteredFaults != 0, "No clustered faults\n");
+        ok(Clustered.SinglePageFaults + Clustered.ClusteredFaults <= SECTION_FAULT_PAGES / 4,
+           "%lu faults for %u pages\n", Clustered.SinglePageFaults + Clustered.ClusteredFaults, SECTION_FAULT_PAGES);
+        trace("Clustered: %lu faults, %lu pages read ahead\n",
+              Clustered.SinglePageFaults + Clustered.ClusteredFaults, Clustered.ClusteredPages);
+    }
+
+    /* Out of range cluster sizes are refused */
+    NewClusterSize = 0;
+    Status = NtSetSystemInformation(SystemSectionFaultInformation, &NewClusterSize, sizeof(NewClusterSize));
+    ok_ntstatus(Status, STATUS_INVALID_PARAMETER);
+    NewClusterSize = 33;
+    Status = NtSetSystemInformation(SystemSectionFaultInformation, &NewClusterSize, sizeof(NewClusterSize));
+    ok_ntstatus(Status, STATUS_INVALID_PARAMETER);
+
+    Status = NtSetSystemInformation(SystemSectionFaultInformation, &ClusterSize, sizeof(ClusterSize));
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    RtlAdjustPrivilege(SE_DEBUG_PRIVILEGE, WasEnabled, FALSE, &WasEnabled);
+
+    /* Wrong size */
+    Status = NtSetSystemInformation(SystemSectionFaultInformation, &NewClusterSize, sizeof(USHORT));
+    ok(Status == STATUS_INFO_LENGTH_MISMATCH, "NtSetSystemInformation returned %lx\n", Status);
+}
+
+/* Don't stress machines where filling up memory takes ages */
+#define PAGE_FILE_STRESS_MAX_PAGES (256 * 1024 * 1024 / PAGE_SIZE)
+#define PAGE_FILE_STRESS_EXTRA_PAGES (32 * 1024 * 1024 / PAGE_SIZE)
+
+static
+void
+Test_PageFileWrite(void)
+{
+    NTSTATUS Status;
+    ULONG ReturnLength;
+    SYSTEM_PAGE_FILE_WRITE_INFORMATION Before, After;
+    SYSTEM_PERFORMANCE_INFORMATION PerfInfo;
+    SYSTEM_BASIC_INFORMATION BasicInfo;
+    LARGE_INTEGER MaximumSize, Frequency, Start, End;
+    HANDLE SectionHandle;
+    PULONG BaseAddress = NULL;
+    SIZE_T ViewSize = 0;
+    ULONG Pages, Wrong, i;
+    LONGLONG Latency, MaxLatency = 0;
+
+    /* ReactOS specific class */
+    ReturnLength = 0x55555555;
+    Status = NtQuerySystemInformation(SystemPageFileWriteInformation, &Before, sizeof(Before), &ReturnLength);
+    if (Status == STATUS_INVALID_INFO_CLASS)
+    {
+        skip("SystemPageFileWriteInformation not supported\n");
+        return;
+    }
+    ok(Status == STATUS_SUCCESS, "NtQuerySystemInformation returned %lx\n", Status);
+    ok(ReturnLength == sizeof(Before), "ReturnLength = %lu\n", ReturnLength);
+    if (!NT_SUCCESS(Status))
+        return;
+
+    ok(Before.WriteIoCount <= Before.PagesWritten, "%lu writes for %lu pages\n", Before.WriteIoCount, Before.PagesWritten);
+
+    /* The same counters are in the performance information */
+    RtlZeroMemory(&PerfInfo, sizeof(PerfInfo));
+    Status = NtQuerySystemInformation(SystemPerformanceInformation, &PerfInfo, sizeof(PerfInfo), NULL);
+    ok(Status == STATUS_SUCCESS, "NtQuerySystemInformation returned %lx\n", Status);
+    if (NT_SUCCESS(Status))
+    {
+        ok(PerfInfo.DirtyPagesWriteCount >= Before.PagesWritten, "DirtyPagesWriteCount = %lu, expected at least %lu\n",
+           PerfInfo.DirtyPagesWriteCount, Before.PagesWritten);
+        ok(PerfInfo.DirtyWriteIoCount >= Before.WriteIoCount, "DirtyWriteIoCount = %lu, expected at least %lu\n",
+           PerfInfo.DirtyWriteIoCount, Before.WriteIoCount);
+    }
+
+    /* Too small */
+    Status = NtQuerySystemInformation(SystemPageFileWriteInformation, &Before, sizeof(ULONG), &ReturnLength);
+    ok(Status == STATUS_INFO_LENGTH_MISMATCH, "NtQuerySystemInformation returned %lx\n", Status);
+
+    /* Now push some memory out to the page file */
+    Status = NtQuerySystemInformation(SystemBasicInformation, &BasicInfo, sizeof(BasicInfo), NULL);
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    if (!NT_SUCCESS(Status))
+        return;
+
+    if (BasicInfo.NumberOfPhysicalPages > PAGE_FILE_STRESS_MAX_PAGES)
+    {
+        skip("Too much memory to stress the page file (%lu pages)\n", BasicInfo.NumberOfPhysicalPages);
+        return;
+    }
+
+    if (PerfInfo.CommitLimit <= BasicInfo.NumberOfPhysicalPages + PAGE_FILE_STRESS_EXTRA_PAGES)
+    {
+        skip("No room in the page file\n");
+        return;
+    }
+
+    Pages = BasicInfo.NumberOfPhysicalPages + PAGE_FILE_STRESS_EXTRA_PAGES;
+    MaximumSize.QuadPart = (LONGLONG)Pages * PAGE_SIZE;
+    Status = NtCreateSection(&SectionHandle, SECTION_ALL_ACCESS, NULL, &MaximumSize, PAGE_READWRITE, SEC_COMMIT, NULL);
+    if (!NT_SUCCESS(Status))
+    {
+        skip("NtCreateSection failed with %lx\n", Status);
+        return;
+    }
+
+    Status = NtMapViewOfSection(SectionHandle, NtCurrentProcess(), (PVOID*)&BaseAddress, 0, 0, NULL,
+                                &ViewSize, ViewUnmap, 0, PAGE_READWRITE);
+    ok_ntstatus(Status, STATUS_SUCCESS);
+    if (NT_SUCCESS(Status))
+    {
+        QueryPerformanceFrequency(&Frequency);
+
+        /* Dirty every page, the older ones have to go to the page file */
+        for (i = 0; i < Pages; i++)
+        {
+            QueryPerformanceCounter(&Start);
+            BaseAddress[i * (PAGE_SIZE / sizeof(ULONG))] = i;
+            QueryPerformanceCounter(&End);
+            Latency = End.QuadPart - Start.QuadPart;
+            if (Latency > MaxLatency)
+                MaxLatency = Latency;
+        }
+
+        /* And read them all back */
+        Wrong = 0;
+        for (i = 0; i < Pages; i++)
+        {
+            if (BaseAddress[i * (PAGE_SIZE / sizeof(ULONG))] != i)
+                Wrong++;
+        }
+        ok(Wrong == 0, "%lu of %lu pages have the wrong contents\n", Wrong, Pages);
+
+        Status = NtQuerySystemInformation(SystemPageFileWriteInformation, &After, sizeof(After), NULL);
+        ok_ntstatus(Status, STATUS_SUCCESS);
+        if (NT_SUCCESS(Status))
+        {
+            ok(After.PagesWritten > Before.PagesWritten, "No pages written to the page file\n");
+            ok(After.WriteIoCount - Before.WriteIoCount <= After.PagesWritten - Before.PagesWritten,
+               "%lu writes for %lu pages\n", After.WriteIoCount - Before.WriteIoCount,
+               After.PagesWritten - Before.PagesWritten);
+            trace("%lu pages written in %lu writes (%lu by the modified page writer), %I64u ms writing, longest write %lu ms\n",
+                  After.PagesWritten - Before.PagesWritten, After.WriteIoCount - Before.WriteIoCount,
+                  After.ModifiedPagesWritten - Before.ModifiedPagesWritten,
+                  (After.TotalWriteTime.QuadPart - Before.TotalWriteTime.QuadPart) / 10000,
+                  After.MaximumWriteTime / 10000);
+        }
+        trace("Touched %lu pages, worst page fault took %I64d us\n", Pages, MaxLatency * 1000000 / Frequency.QuadPart);
+
+        NtUnmapViewOfSection(NtCurrentProcess(), BaseAddress);
+    }
+    NtClose(SectionHandle);
+}
+
 START_TEST(NtSystemInformation)
 {
     NTSTATUS Status;
@@ -355,4 +810,9 @@ START_TEST(NtSystemInformation)
     Test_Flags();
     Test_TimeAdjustment();
     Test_KernelDebugger();
+    Test_WorkQueue();
+    Test_LockStatistics();
+    Test_ZeroPage();
+    Test_SectionFault();
+    Test_PageFileWrite();
 }
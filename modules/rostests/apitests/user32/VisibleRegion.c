@@ -0,0 +1,170 @@
+/*
+ * PROJECT:         ReactOS api tests
+ * LICENSE:         GPL - See COPYING in the top level directory
+ * PURPOSE:         Test for the visible region of windows with many children
+ */
+
+#include "precomp.h"
+
+#define CHILD_COUNT 500
+#define CHILD_COLUMNS 25
+#define CHILD_STEP 20
+#define CHILD_SIZE 24
+#define BENCH_LOOPS 20
+
+static HWND ahwndChild[CHILD_COUNT];
+
+static
+BOOL
+IsPointVisible(HWND hwnd, INT x, INT y)
+{
+    POINT pt = { x, y };
+    HRGN hrgn;
+    HDC hdc;
+    BOOL bVisible;
+
+    hrgn = CreateRectRgn(0, 0, 0, 0);
+    hdc = GetDC(hwnd);
+    ok(GetRandomRgn(hdc, hrgn, SYSRGN) == 1, "GetRandomRgn failed\n");
+    ReleaseDC(hwnd, hdc);
+
+    /* The system region is in screen coordinates */
+    ClientToScreen(hwnd, &pt);
+    bVisible = PtInRegion(hrgn, pt.x, pt.y);
+    DeleteObject(hrgn);
+    return bVisible;
+}
+
+static
+VOID
+Test_Invalidation(HWND hwndParent)
+{
+    HWND hwndTarget = ahwndChild[0], hwndCover;
+    RECT rc;
+
+    /* Another child, hidden for now */
+    GetWindowRect(hwndTarget, &rc);
+    MapWindowPoints(NULL, hwndParent, (LPPOINT)&rc, 2);
+    hwndCover = CreateWindowExW(0, L"VisRgnChild", NULL, WS_CHILD | WS_CLIPSIBLINGS,
+                                rc.left + 4, rc.top + 4, 8, 8,
+                                hwndParent, NULL, NULL, NULL);
+    ok(hwndCover != NULL, "CreateWindowExW failed\n");
+    if (!hwndCover)
+        return;
+
+    /* Ask twice, so the second answer may come from a cache */
+    ok(IsPointVisible(hwndTarget, 6, 6), "Point should be visible\n");
+    ok(IsPointVisible(hwndTarget, 6, 6), "Point should be visible\n");
+
+    /* Showing a sibling above the window takes the area away */
+    SetWindowPos(hwndCover, HWND_TOP, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_SHOWWINDOW);
+    ok(!IsPointVisible(hwndTarget, 6, 6), "Point should be covered\n");
+
+    /* Moving it away gives it back */
+    SetWindowPos(hwndCover, NULL, rc.left + 14, rc.top + 14, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
+    ok(IsPointVisible(hwndTarget, 6, 6), "Point should be visible\n");
+    ok(!IsPointVisible(hwndTarget, 16, 16), "Point should be covered\n");
+
+    /* And so do z-order changes */
+    SetWindowPos(hwndCover, HWND_BOTTOM, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
+    SetWindowPos(hwndTarget, HWND_TOP, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
+    ok(IsPointVisible(hwndTarget, 16, 16), "Point should be visible\n");
+
+    SetWindowPos(hwndCover, HWND_TOP, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE);
+    ok(!IsPointVisible(hwndTarget, 16, 16), "Point should be covered\n");
+
+    /* And hiding or destroying it */
+    ShowWindow(hwndCover, SW_HIDE);
+    ok(IsPointVisible(hwndTarget, 16, 16), "Point should be visible\n");
+    ShowWindow(hwndCover, SW_SHOWNA);
+    ok(!IsPointVisible(hwndTarget, 16, 16), "Point should be covered\n");
+    DestroyWindow(hwndCover);
+    ok(IsPointVisible(hwndTarget, 16, 16), "Point should be visible\n");
+}
+
+static
+VOID
+Test_Benchmark(HWND hwndParent)
+{
+    LARGE_INTEGER Frequency, Start, End;
+    ULONG i, j;
+    HDC hdc;
+
+    QueryPerformanceFrequency(&Frequency);
+
+    QueryPerformanceCounter(&Start);
+    for (i = 0; i < BENCH_LOOPS; i++)
+    {
+        for (j = 0; j < CHILD_COUNT; j++)
+        {
+            hdc = GetDC(ahwndChild[j]);
+            ReleaseDC(ahwndChild[j], hdc);
+        }
+    }
+    QueryPerformanceCounter(&End);
+
+    trace("%u children: GetDC/ReleaseDC %lu ns\n", CHILD_COUNT,
+          (ULONG)((End.QuadPart - Start.QuadPart) * 1000000000 / Frequency.QuadPart / (BENCH_LOOPS * CHILD_COUNT)));
+
+    QueryPerformanceCounter(&Start);
+    for (i = 0; i < BENCH_LOOPS; i++)
+    {
+        RedrawWindow(hwndParent, NULL, NULL, RDW_INVALIDATE | RDW_ERASE | RDW_ALLCHILDREN | RDW_UPDATENOW);
+    }
+    QueryPerformanceCounter(&End);
+
+    trace("%u children: full repaint %lu us\n", CHILD_COUNT,
+          (ULONG)((End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart / BENCH_LOOPS));
+}
+
+START_TEST(VisibleRegion)
+{
+    WNDCLASSW wc = { 0 };
+    HWND hwndParent;
+    ULONG i;
+
+    wc.lpfnWndProc = DefWindowProcW;
+    wc.hInstance = GetModuleHandleW(NULL);
+    wc.hCursor = LoadCursorW(NULL, (LPCWSTR)IDC_ARROW);
+    wc.hbrBackground = GetStockObject(GRAY_BRUSH);
+    wc.lpszClassName = L"VisRgnChild";
+    RegisterClassW(&wc);
+
+    hwndParent = CreateWindowExW(0, L"VisRgnChild", L"VisibleRegion",
+                                 WS_POPUP | WS_VISIBLE | WS_CLIPCHILDREN,
+                                 0, 0,
+                                 CHILD_COLUMNS * CHILD_STEP + CHILD_SIZE,
+                                 (CHILD_COUNT / CHILD_COLUMNS) * CHILD_STEP + CHILD_SIZE,
+                                 NULL, NULL, NULL, NULL);
+    ok(hwndParent != NULL, "CreateWindowExW failed\n");
+    if (!hwndParent)
+    {
+        skip("No parent window\n");
+        return;
+    }
+
+    /* Overlapping children, so every one of them is clipped by its neighbours */
+    for (i = 0; i < CHILD_COUNT; i++)
+    {
+        ahwndChild[i] = CreateWindowExW(0, L"VisRgnChild", NULL,
+                                        WS_CHILD | WS_VISIBLE | WS_CLIPSIBLINGS,
+                                        (i % CHILD_COLUMNS) * CHILD_STEP,
+                                        (i / CHILD_COLUMNS) * CHILD_STEP,
+                                        CHILD_SIZE, CHILD_SIZE,
+                                        hwndParent, NULL, NULL, NULL);
+        ok(ahwndChild[i] != NULL, "CreateWindowExW failed for child %lu\n", i);
+        if (!ahwndChild[i])
+        {
+            DestroyWindow(hwndParent);
+            return;
+        }
+    }
+
+    UpdateWindow(hwndParent);
+
+    Test_Invalidation(hwndParent);
+    Test_Benchmark(hwndParent);
+
+    DestroyWindow(hwndParent);
+    UnregisterClassW(L"VisRgnChild", GetModuleHandleW(NULL));
+}
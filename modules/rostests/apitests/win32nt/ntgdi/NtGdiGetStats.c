@@ -0,0 +1,60 @@
+/*
+ * PROJECT:         ReactOS api tests
+ * LICENSE:         GPL - See COPYING in the top level directory
+ * PURPOSE:         Test for NtGdiGetStats
+ * PROGRAMMERS:
+ */
+
+#include <win32nt.h>
+#include <ntstatus.h>
+
+START_TEST(NtGdiGetStats)
+{
+    FONT_CACHE_INFO Info1, Info2;
+    NTSTATUS Status;
+    HDC hdc;
+    HFONT hFont, hOldFont;
+    RECT rc = {0, 0, 100, 20};
+
+    /* Unknown index */
+    Status = NtGdiGetStats(GetCurrentProcess(), 0x7FFF, 0, &Info1, sizeof(Info1));
+    ok_hex(Status, STATUS_NOT_IMPLEMENTED);
+
+    /* Buffer checks */
+    Status = NtGdiGetStats(GetCurrentProcess(), GS_GLYPH_CACHE_INFO, 0, &Info1, sizeof(Info1) - 1);
+    ok_hex(Status, STATUS_BUFFER_TOO_SMALL);
+    Status = NtGdiGetStats(GetCurrentProcess(), GS_GLYPH_CACHE_INFO, 0, NULL, sizeof(Info1));
+    ok_hex(Status, STATUS_ACCESS_VIOLATION);
+
+    Status = NtGdiGetStats(GetCurrentProcess(), GS_GLYPH_CACHE_INFO, 0, &Info1, sizeof(Info1));
+    ok_hex(Status, STATUS_SUCCESS);
+    ok(Info1.MaxEntries != 0, "MaxEntries is 0\n");
+    ok(Info1.NumEntries <= Info1.MaxEntries, "NumEntries %lu > MaxEntries %lu\n",
+       Info1.NumEntries, Info1.MaxEntries);
+    ok(Info1.CacheBytes <= Info1.MaxCacheBytes, "CacheBytes %lu > MaxCacheBytes %lu\n",
+       Info1.CacheBytes, Info1.MaxCacheBytes);
+
+    /* Draw the same text twice, the second pass must be served from the cache */
+    hdc = CreateCompatibleDC(NULL);
+    ok(hdc != NULL, "CreateCompatibleDC failed\n");
+    hFont = CreateFontW(-13, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, ANSI_CHARSET,
+                        OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY,
+                        DEFAULT_PITCH, L"Tahoma");
+    ok(hFont != NULL, "CreateFontW failed\n");
+    hOldFont = SelectObject(hdc, hFont);
+
+    ExtTextOutW(hdc, 0, 0, ETO_OPAQUE, &rc, L"Glyph cache", 11, NULL);
+    Status = NtGdiGetStats(GetCurrentProcess(), GS_GLYPH_CACHE_INFO, 0, &Info1, sizeof(Info1));
+    ok_hex(Status, STATUS_SUCCESS);
+
+    ExtTextOutW(hdc, 0, 0, ETO_OPAQUE, &rc, L"Glyph cache", 11, NULL);
+    Status = NtGdiGetStats(GetCurrentProcess(), GS_GLYPH_CACHE_INFO, 0, &Info2, sizeof(Info2));
+    ok_hex(Status, STATUS_SUCCESS);
+
+    ok(Info2.Hits > Info1.Hits, "Hits did not increase (%lu -> %lu)\n", Info1.Hits, Info2.Hits);
+    ok(Info2.Misses >= Info1.Misses, "Misses went back (%lu -> %lu)\n", Info1.Misses, Info2.Misses);
+
+    SelectObject(hdc, hOldFont);
+    DeleteObject(hFont);
+    DeleteDC(hdc);
+}
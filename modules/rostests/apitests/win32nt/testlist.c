@@ -26,6 +26,7 @@ extern void func_NtGdiGetBitmapBits(void);
 extern void func_NtGdiGetDIBitsInternal(void);
 extern void func_NtGdiGetFontResourceInfoInternalW(void);
 extern void func_NtGdiGetRandomRgn(void);
+extern void func_NtGdiGetStats(void);
 extern void func_NtGdiGetStockObject(void);
 extern void func_NtGdiPolyPolyDraw(void);
 extern void func_NtGdiRestoreDC(void);
@@ -86,6 +87,7 @@ const struct test winetest_testlist[] =
     { "NtGdiGetDIBitsInternal", func_NtGdiGetDIBitsInternal },
     { "NtGdiGetFontResourceInfoInternalW", func_NtGdiGetFontResourceInfoInternalW },
     { "NtGdiGetRandomRgn", func_NtGdiGetRandomRgn },
+    { "NtGdiGetStats", func_NtGdiGetStats },
     { "NtGdiGetStockObject", func_NtGdiGetStockObject },
     { "NtGdiPolyPolyDraw", func_NtGdiPolyPolyDraw },
     { "NtGdiRestoreDC", func_NtGdiRestoreDC },
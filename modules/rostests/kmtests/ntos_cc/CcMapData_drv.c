@@ -105,6 +105,17 @@ static CC_FILE_SIZES FileSizes = {
     RTL_CONSTANT_LARGE_INTEGER((LONGLONG)0x4000)  // .ValidDataLength
 };
 
+/* Sparse multi-GB file, used to exercise the view lookup */
+#define SPARSE_TEST_ID 3
+#define SPARSE_VIEWS 64
+#define SPARSE_STRIDE 0x4000000LL
+
+static CC_FILE_SIZES SparseFileSizes = {
+    RTL_CONSTANT_LARGE_INTEGER((LONGLONG)0x100000000), // .AllocationSize
+    RTL_CONSTANT_LARGE_INTEGER((LONGLONG)0x100000000), // .FileSize
+    RTL_CONSTANT_LARGE_INTEGER((LONGLONG)0x100000000)  // .ValidDataLength
+};
+
 static
 PVOID
 MapAndLockUserBuffer(
@@ -137,6 +148,43 @@ MapAndLockUserBuffer(
     return MmGetSystemAddressForMdlSafe(Irp->MdlAddress, NormalPagePriority);
 }
 
+static
+VOID
+PerformSparseTest(VOID)
+{
+    PVOID Bcb;
+    BOOLEAN Ret;
+    PULONG Buffer;
+    ULONG i, Pass;
+    LARGE_INTEGER Offset;
+    LARGE_INTEGER Start, Stop, Frequency;
+
+    for (Pass = 0; Pass < 2; ++Pass)
+    {
+        Start = KeQueryPerformanceCounter(&Frequency);
+        for (i = 0; i < SPARSE_VIEWS; ++i)
+        {
+            Ret = FALSE;
+            Offset.QuadPart = i * SPARSE_STRIDE + 0x1000;
+            KmtStartSeh();
+            Ret = CcMapData(TestFileObject, &Offset, sizeof(ULONG), MAP_WAIT, &Bcb, (PVOID *)&Buffer);
+            KmtEndSeh(STATUS_SUCCESS);
+
+            if (!skip(Ret == TRUE, "CcMapData failed\n"))
+            {
+                ok_eq_ulong(Buffer[0], (ULONG)(Offset.QuadPart >> PAGE_SHIFT));
+                CcUnpinData(Bcb);
+            }
+        }
+        Stop = KeQueryPerformanceCounter(NULL);
+
+        /* First pass creates the views, the second one only looks them up */
+        trace("Pass %lu: %I64u us for %lu views\n", Pass,
+              (Stop.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart,
+              SPARSE_VIEWS);
+    }
+}
+
 static
 VOID
 PerformTest(
@@ -169,10 +217,19 @@ PerformTest(
             TestFileObject->SectionObjectPointer = &Fcb->SectionObjectPointers;
 
             KmtStartSeh();
-            CcInitializeCacheMap(TestFileObject, &FileSizes, FALSE, &Callbacks, NULL);
+            CcInitializeCacheMap(TestFileObject,
+                                 (TestId == SPARSE_TEST_ID) ? &SparseFileSizes : &FileSizes,
+                                 FALSE, &Callbacks, NULL);
             KmtEndSeh(STATUS_SUCCESS);
 
-            if (!skip(CcIsFileCached(TestFileObject) == TRUE, "CcInitializeCacheMap failed\n"))
+            if (TestId == SPARSE_TEST_ID)
+            {
+                if (!skip(CcIsFileCached(TestFileObject) == TRUE, "CcInitializeCacheMap failed\n"))
+                {
+                    PerformSparseTest();
+                }
+            }
+            else if (!skip(CcIsFileCached(TestFileObject) == TRUE, "CcInitializeCacheMap failed\n"))
             {
                 Ret = FALSE;
                 Offset.QuadPart = TestId * 0x1000;
@@ -302,7 +359,17 @@ TestIrpHandler(
         RtlFillMemory(Buffer, Length, 0xBA);
 
         Status = STATUS_SUCCESS;
-        if (Offset.QuadPart <= 0x3000 && Offset.QuadPart + Length > 0x3000)
+        if (TestTestId == SPARSE_TEST_ID)
+        {
+            ULONG i;
+
+            /* Tag each page with its page number in the file */
+            for (i = 0; i < Length / PAGE_SIZE; ++i)
+            {
+                *(PULONG)((ULONG_PTR)Buffer + i * PAGE_SIZE) = (ULONG)(Offset.QuadPart >> PAGE_SHIFT) + i;
+            }
+        }
+        else if (Offset.QuadPart <= 0x3000 && Offset.QuadPart + Length > 0x3000)
         {
             *(PULONG)((ULONG_PTR)Buffer + (ULONG_PTR)(0x3000 - Offset.QuadPart)) = 0xDEADBABE;
         }
@@ -712,6 +712,40 @@ static VOID FsRtlLargeMcbTestsFastFat()
     ok_eq_longlong(Lbn, -1);
     ok_eq_ulong(Index, (ULONG) -1);
 
+    /* Fragmented cluster chain, as cached by the FAT driver: 64 runs of 4 clusters */
+    for (Vbn = 0; Vbn < 256; Vbn += 4)
+    {
+        Result = FsRtlAddLargeMcbEntry(&FirstMcb, Vbn, 1000 + Vbn * 2, 4);
+        ok_bool_true(Result, "FsRtlAddLargeMcbEntry returned");
+    }
+    ok_eq_ulong(FsRtlNumberOfRunsInLargeMcb(&FirstMcb), 64);
+
+    for (Vbn = 0; Vbn < 256; Vbn++)
+    {
+        LONGLONG IndexedLbn, IndexedSectorCount;
+
+        Result = FsRtlLookupLargeMcbEntry(&FirstMcb, Vbn, &Lbn, &SectorCount, NULL, NULL, NULL);
+        ok_bool_true(Result, "FsRtlLookupLargeMcbEntry returned");
+        ok_eq_longlong(Lbn, 1000 + (Vbn & ~3) * 2 + (Vbn & 3));
+        ok_eq_longlong(SectorCount, 4 - (Vbn & 3));
+
+        Result = FsRtlLookupLargeMcbEntry(&FirstMcb, Vbn, &IndexedLbn, &IndexedSectorCount, NULL, NULL, &Index);
+        ok_bool_true(Result, "FsRtlLookupLargeMcbEntry returned");
+        ok_eq_longlong(IndexedLbn, Lbn);
+        ok_eq_longlong(IndexedSectorCount, SectorCount);
+        ok_eq_ulong(Index, (ULONG)(Vbn / 4));
+    }
+
+    Lbn = 0;
+    Result = FsRtlLookupLargeMcbEntry(&FirstMcb, 256, &Lbn, NULL, NULL, NULL, NULL);
+    ok_bool_false(Result, "FsRtlLookupLargeMcbEntry returned");
+    ok_eq_longlong(Lbn, -1);
+
+    FsRtlTruncateLargeMcb(&FirstMcb, 128);
+    ok_eq_ulong(FsRtlNumberOfRunsInLargeMcb(&FirstMcb), 32);
+    Result = FsRtlLookupLargeMcbEntry(&FirstMcb, 128, &Lbn, NULL, NULL, NULL, NULL);
+    ok_bool_false(Result, "FsRtlLookupLargeMcbEntry returned");
+
     FsRtlUninitializeLargeMcb(&FirstMcb);
 }
 
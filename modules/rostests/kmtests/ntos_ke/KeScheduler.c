@@ -0,0 +1,187 @@
+/*
+ * PROJECT:         ReactOS kernel-mode tests
+ * LICENSE:         LGPLv2+ - See COPYING.LIB in the top level directory
+ * PURPOSE:         Kernel-Mode Test Suite thread placement test
+ */
+
+/* This test spins for a few seconds on every processor, hence it's manual */
+
+#include <kmt_test.h>
+
+#define NDEBUG
+#include <debug.h>
+
+#define SPIN_THREADS_PER_PROCESSOR 2
+#define SPIN_TIME (3 * 1000 * 1000 * 10LL)
+#define PICKUP_TIMEOUT (2 * 1000 * 1000 * 10LL)
+#define MAX_TEST_PROCESSORS 32
+
+typedef struct _SPIN_CONTEXT
+{
+    KEVENT StartEvent;
+    LONG Samples[MAX_TEST_PROCESSORS];
+    LONG Finished;
+} SPIN_CONTEXT, *PSPIN_CONTEXT;
+
+typedef struct _PICKUP_CONTEXT
+{
+    KEVENT StartedEvent;
+    KEVENT ReadyEvent;
+    volatile LONG Processor;
+} PICKUP_CONTEXT, *PPICKUP_CONTEXT;
+
+static
+VOID
+NTAPI
+PickupThread(
+    IN PVOID Context)
+{
+    PPICKUP_CONTEXT PickupContext = Context;
+
+    KeSetEvent(&PickupContext->StartedEvent, IO_NO_INCREMENT, FALSE);
+    KeWaitForSingleObject(&PickupContext->ReadyEvent, Executive, KernelMode, FALSE, NULL);
+
+    /* Tell the readying thread where we got to run */
+    InterlockedExchange(&PickupContext->Processor, (LONG)KeGetCurrentProcessorNumber());
+}
+
+static
+VOID
+TestIdlePickup(VOID)
+{
+    PICKUP_CONTEXT Context;
+    PKTHREAD Thread;
+    KPRIORITY OldPriority;
+    ULONGLONG EndTime;
+    LARGE_INTEGER Timeout;
+    LONG Processor;
+
+    if (skip(KeNumberProcessors > 1, "Needs more than one processor\n"))
+        return;
+
+    KeInitializeEvent(&Context.StartedEvent, NotificationEvent, FALSE);
+    KeInitializeEvent(&Context.ReadyEvent, NotificationEvent, FALSE);
+    Context.Processor = -1;
+
+    Thread = KmtStartThread(PickupThread, &Context);
+    if (skip(Thread != NULL, "Failed to create thread\n"))
+        return;
+
+    /* Let it block, preferring the processor we are about to occupy */
+    KeSetIdealProcessorThread(Thread, 0);
+    KeWaitForSingleObject(&Context.StartedEvent, Executive, KernelMode, FALSE, NULL);
+    Timeout.QuadPart = -10 * 1000 * 10;
+    KeDelayExecutionThread(KernelMode, FALSE, &Timeout);
+
+    /* Keep processor 0 busy with something it can't preempt */
+    KeSetSystemAffinityThread(1);
+    OldPriority = KeSetPriorityThread(KeGetCurrentThread(), LOW_REALTIME_PRIORITY);
+
+    /* Ready it from here, then never give the processor up while we wait */
+    KeSetEvent(&Context.ReadyEvent, IO_NO_INCREMENT, FALSE);
+    EndTime = KeQueryInterruptTime() + PICKUP_TIMEOUT;
+    while ((Context.Processor == -1) && (KeQueryInterruptTime() < EndTime))
+        KeStallExecutionProcessor(100);
+    Processor = Context.Processor;
+
+    KeSetPriorityThread(KeGetCurrentThread(), OldPriority);
+    KeRevertToUserAffinityThread();
+    KmtFinishThread(Thread, NULL);
+
+    /* Another, idle processor must have picked it up while processor 0 was busy */
+    ok(Processor != -1, "Thread readied on a busy processor never ran elsewhere\n");
+    ok(Processor != 0, "Thread ran on the busy processor\n");
+}
+
+static
+VOID
+NTAPI
+SpinThread(
+    IN PVOID Context)
+{
+    PSPIN_CONTEXT SpinContext = Context;
+    ULONGLONG EndTime;
+    ULONG Processor;
+
+    KeWaitForSingleObject(&SpinContext->StartEvent, Executive, KernelMode, FALSE, NULL);
+
+    /* Burn CPU and record where we ran, without ever blocking */
+    EndTime = KeQueryInterruptTime() + SPIN_TIME;
+    while (KeQueryInterruptTime() < EndTime)
+    {
+        Processor = KeGetCurrentProcessorNumber();
+        if (Processor < MAX_TEST_PROCESSORS)
+            InterlockedIncrement(&SpinContext->Samples[Processor]);
+        KeStallExecutionProcessor(100);
+    }
+
+    InterlockedIncrement(&SpinContext->Finished);
+}
+
+static
+VOID
+TestDistribution(VOID)
+{
+    PSPIN_CONTEXT Context;
+    PKTHREAD Threads[MAX_TEST_PROCESSORS * SPIN_THREADS_PER_PROCESSOR];
+    ULONG ThreadCount, Processors, i;
+    LONG Total = 0;
+
+    Processors = min((ULONG)KeNumberProcessors, MAX_TEST_PROCESSORS);
+    ThreadCount = Processors * SPIN_THREADS_PER_PROCESSOR;
+
+    Context = ExAllocatePoolWithTag(NonPagedPool, sizeof(*Context), 'hcSK');
+    if (skip(Context != NULL, "Out of memory\n"))
+        return;
+    RtlZeroMemory(Context, sizeof(*Context));
+    KeInitializeEvent(&Context->StartEvent, NotificationEvent, FALSE);
+
+    for (i = 0; i < ThreadCount; i++)
+        Threads[i] = KmtStartThread(SpinThread, Context);
+
+    /* Release all of them at once so placement happens under load */
+    KeSetEvent(&Context->StartEvent, IO_NO_INCREMENT, FALSE);
+
+    for (i = 0; i < ThreadCount; i++)
+        KmtFinishThread(Threads[i], NULL);
+
+    ok_eq_long(Context->Finished, (LONG)ThreadCount);
+
+    for (i = 0; i < Processors; i++)
+        Total += Context->Samples[i];
+
+    /* Report the distribution, and make sure no processor was left idle */
+    for (i = 0; i < Processors; i++)
+    {
+        trace("Processor %lu: %ld samples (%ld%%)\n", i, Context->Samples[i],
+              Total ? Context->Samples[i] * 100 / Total : 0);
+        ok(Context->Samples[i] != 0, "Processor %lu never ran a spinning thread\n", i);
+    }
+
+    ExFreePoolWithTag(Context, 'hcSK');
+}
+
+static
+VOID
+TestAffinity(VOID)
+{
+    ULONG Processor;
+    KIRQL Irql;
+
+    /* Every processor must honor a thread that is restricted to it */
+    for (Processor = 0; Processor < min((ULONG)KeNumberProcessors, MAX_TEST_PROCESSORS); Processor++)
+    {
+        KeSetSystemAffinityThread((KAFFINITY)1 << Processor);
+        KeRaiseIrql(DISPATCH_LEVEL, &Irql);
+        ok_eq_ulong(KeGetCurrentProcessorNumber(), Processor);
+        KeLowerIrql(Irql);
+        KeRevertToUserAffinityThread();
+    }
+}
+
+START_TEST(KeScheduler)
+{
+    TestAffinity();
+    TestIdlePickup();
+    TestDistribution();
+}
@@ -0,0 +1,180 @@
+/*
+ * PROJECT:         ReactOS kernel-mode tests
+ * LICENSE:         LGPLv2+ - See COPYING.LIB in the top level directory
+ * PURPOSE:         Kernel-Mode Test Suite timer table scalability test
+ */
+
+/* This test arms up to 100000 timers and reports timings, hence it's manual */
+
+#include <kmt_test.h>
+
+#define NDEBUG
+#include <debug.h>
+
+#define MS_TO_RELATIVE(Ms) (-10000LL * (Ms))
+
+typedef BOOLEAN (NTAPI *PKE_SET_COALESCABLE_TIMER)(PKTIMER, LARGE_INTEGER, ULONG, ULONG, PKDPC);
+static PKE_SET_COALESCABLE_TIMER pKeSetCoalescableTimer;
+
+typedef struct _TIMER_TEST_CONTEXT
+{
+    KEVENT DoneEvent;
+    LONG Remaining;
+    LONG Early;
+    ULONGLONG ArmTime;
+} TIMER_TEST_CONTEXT, *PTIMER_TEST_CONTEXT;
+
+typedef struct _TEST_TIMER
+{
+    KTIMER Timer;
+    KDPC Dpc;
+    ULONGLONG DueTime;
+} TEST_TIMER, *PTEST_TIMER;
+
+static PTIMER_TEST_CONTEXT TestContext;
+
+static
+VOID
+NTAPI
+TimerDpc(
+    IN PKDPC Dpc,
+    IN PVOID DeferredContext,
+    IN PVOID SystemArgument1,
+    IN PVOID SystemArgument2)
+{
+    PTEST_TIMER TestTimer = DeferredContext;
+
+    if (KeQueryInterruptTime() < TestTimer->DueTime)
+        InterlockedIncrement(&TestContext->Early);
+
+    if (InterlockedDecrement(&TestContext->Remaining) == 0)
+        KeSetEvent(&TestContext->DoneEvent, IO_NO_INCREMENT, FALSE);
+}
+
+static
+ULONGLONG
+ElapsedMicroseconds(
+    IN LARGE_INTEGER Start,
+    IN LARGE_INTEGER Frequency)
+{
+    LARGE_INTEGER End = KeQueryPerformanceCounter(NULL);
+    return (End.QuadPart - Start.QuadPart) * 1000000 / Frequency.QuadPart;
+}
+
+static
+VOID
+TestTimerScale(
+    IN ULONG Count,
+    IN ULONG TolerableDelay)
+{
+    PTEST_TIMER Timers;
+    LARGE_INTEGER Start, Frequency, DueTime, Timeout;
+    ULONGLONG InsertUs, CancelUs, ExpireUs;
+    ULONG i, Cancelled = 0;
+    NTSTATUS Status;
+
+    Timers = ExAllocatePoolWithTag(NonPagedPool, Count * sizeof(*Timers), 'rmTK');
+    if (skip(Timers != NULL, "Out of memory for %lu timers\n", Count))
+        return;
+
+    for (i = 0; i < Count; i++)
+    {
+        KeInitializeTimer(&Timers[i].Timer);
+        KeInitializeDpc(&Timers[i].Dpc, TimerDpc, &Timers[i]);
+    }
+
+    /* Insertion and cancellation, with a mix of short and very long timers */
+    Start = KeQueryPerformanceCounter(&Frequency);
+    for (i = 0; i < Count; i++)
+    {
+        DueTime.QuadPart = (i & 1) ? MS_TO_RELATIVE(60 * 60 * 1000 + i) :
+                                     MS_TO_RELATIVE(30 * 1000 + i % 1000);
+        KeSetTimer(&Timers[i].Timer, DueTime, NULL);
+    }
+    InsertUs = ElapsedMicroseconds(Start, Frequency);
+
+    Start = KeQueryPerformanceCounter(NULL);
+    for (i = 0; i < Count; i++)
+    {
+        if (KeCancelTimer(&Timers[i].Timer))
+            Cancelled++;
+    }
+    CancelUs = ElapsedMicroseconds(Start, Frequency);
+    ok_eq_ulong(Cancelled, Count);
+
+    /* Expiration of short timers spread over one second */
+    TestContext->Remaining = Count;
+    TestContext->Early = 0;
+    KeClearEvent(&TestContext->DoneEvent);
+    TestContext->ArmTime = KeQueryInterruptTime();
+    for (i = 0; i < Count; i++)
+    {
+        DueTime.QuadPart = MS_TO_RELATIVE(100 + i % 1000);
+        Timers[i].DueTime = KeQueryInterruptTime() - DueTime.QuadPart;
+        if (pKeSetCoalescableTimer && TolerableDelay)
+            pKeSetCoalescableTimer(&Timers[i].Timer, DueTime, 0, TolerableDelay, &Timers[i].Dpc);
+        else
+            KeSetTimer(&Timers[i].Timer, DueTime, &Timers[i].Dpc);
+    }
+
+    Start = KeQueryPerformanceCounter(NULL);
+    Timeout.QuadPart = MS_TO_RELATIVE(30 * 1000);
+    Status = KeWaitForSingleObject(&TestContext->DoneEvent, Executive, KernelMode, FALSE, &Timeout);
+    ExpireUs = ElapsedMicroseconds(Start, Frequency);
+    ok_eq_hex(Status, STATUS_SUCCESS);
+    ok_eq_long(TestContext->Early, 0L);
+
+    trace("%lu timers, tolerable delay %lu ms: insert %I64u us, cancel %I64u us, "
+          "expire all %I64u us after arming (%I64u ms)\n",
+          Count, TolerableDelay, InsertUs, CancelUs, ExpireUs,
+          (KeQueryInterruptTime() - TestContext->ArmTime) / 10000);
+
+    /* Make sure nothing is left in the timer table before freeing */
+    for (i = 0; i < Count; i++)
+        KeCancelTimer(&Timers[i].Timer);
+    KeFlushQueuedDpcs();
+
+    ExFreePoolWithTag(Timers, 'rmTK');
+}
+
+static
+VOID
+TestOverflowTimer(VOID)
+{
+    KTIMER Timer;
+    LARGE_INTEGER DueTime, Timeout;
+    NTSTATUS Status;
+
+    /* A far away timer must be cancellable and must not fire early */
+    KeInitializeTimer(&Timer);
+    DueTime.QuadPart = MS_TO_RELATIVE(2 * 60 * 60 * 1000);
+    ok_bool_false(KeSetTimer(&Timer, DueTime, NULL), "KeSetTimer returned");
+    Timeout.QuadPart = MS_TO_RELATIVE(100);
+    Status = KeWaitForSingleObject(&Timer, Executive, KernelMode, FALSE, &Timeout);
+    ok_eq_hex(Status, STATUS_TIMEOUT);
+    ok_bool_true(KeSetTimer(&Timer, DueTime, NULL), "KeSetTimer returned");
+    ok_bool_true(KeCancelTimer(&Timer), "KeCancelTimer returned");
+    ok_bool_false(KeCancelTimer(&Timer), "KeCancelTimer returned");
+}
+
+START_TEST(KeTimerTable)
+{
+    pKeSetCoalescableTimer = KmtGetSystemRoutineAddress(L"KeSetCoalescableTimer");
+
+    TestContext = ExAllocatePoolWithTag(NonPagedPool, sizeof(*TestContext), 'rmTK');
+    if (skip(TestContext != NULL, "Out of memory\n"))
+        return;
+    KeInitializeEvent(&TestContext->DoneEvent, NotificationEvent, FALSE);
+
+    TestOverflowTimer();
+
+    TestTimerScale(10000, 0);
+    TestTimerScale(100000, 0);
+    if (!skip(pKeSetCoalescableTimer != NULL, "KeSetCoalescableTimer unavailable\n"))
+    {
+        TestTimerScale(10000, 100);
+        TestTimerScale(100000, 100);
+    }
+
+    ExFreePoolWithTag(TestContext, 'rmTK');
+}
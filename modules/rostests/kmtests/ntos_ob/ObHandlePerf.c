@@ -0,0 +1,127 @@
+/*
+ * PROJECT:         ReactOS kernel-mode tests
+ * LICENSE:         LGPLv2.1+ - See COPYING.LIB in the top level directory
+ * PURPOSE:         Kernel-Mode Test Suite Object Handle throughput test
+ */
+
+#include <kmt_test.h>
+#define NDEBUG
+#include <debug.h>
+
+#define ITERATIONS_PER_THREAD 20000
+#define MAX_THREADS 16
+
+typedef struct _HANDLE_PERF_CONTEXT
+{
+    KEVENT StartEvent;
+    volatile LONG Failures;
+} HANDLE_PERF_CONTEXT, *PHANDLE_PERF_CONTEXT;
+
+static
+VOID
+NTAPI
+HandlePerfThread(
+    _In_ PVOID Context)
+{
+    PHANDLE_PERF_CONTEXT PerfContext = Context;
+    NTSTATUS Status;
+    HANDLE Handle;
+    PVOID Object;
+    ULONG i;
+
+    KeWaitForSingleObject(&PerfContext->StartEvent,
+                          Executive,
+                          KernelMode,
+                          FALSE,
+                          NULL);
+
+    for (i = 0; i < ITERATIONS_PER_THREAD; i++)
+    {
+        /* Create, look up and close a kernel handle */
+        Status = ObOpenObjectByPointer(PsInitialSystemProcess,
+                                       OBJ_KERNEL_HANDLE,
+                                       NULL,
+                                       PROCESS_QUERY_INFORMATION,
+                                       *PsProcessType,
+                                       KernelMode,
+                                       &Handle);
+        if (!NT_SUCCESS(Status))
+        {
+            InterlockedIncrement(&PerfContext->Failures);
+            continue;
+        }
+
+        Status = ObReferenceObjectByHandle(Handle,
+                                           PROCESS_QUERY_INFORMATION,
+                                           *PsProcessType,
+                                           KernelMode,
+                                           &Object,
+                                           NULL);
+        if (NT_SUCCESS(Status))
+        {
+            if (Object != PsInitialSystemProcess)
+                InterlockedIncrement(&PerfContext->Failures);
+            ObDereferenceObject(Object);
+        }
+        else
+        {
+            InterlockedIncrement(&PerfContext->Failures);
+        }
+
+        Status = ObCloseHandle(Handle, KernelMode);
+        if (!NT_SUCCESS(Status))
+            InterlockedIncrement(&PerfContext->Failures);
+    }
+}
+
+static
+VOID
+TestHandleThroughput(
+    _In_ ULONG ThreadCount)
+{
+    HANDLE_PERF_CONTEXT Context;
+    PKTHREAD Threads[MAX_THREADS];
+    ULONGLONG StartTime, EndTime;
+    ULONG Milliseconds;
+    ULONG i;
+
+    KeInitializeEvent(&Context.StartEvent, NotificationEvent, FALSE);
+    Context.Failures = 0;
+
+    for (i = 0; i < ThreadCount; i++)
+    {
+        Threads[i] = KmtStartThread(HandlePerfThread, &Context);
+    }
+
+    /* Let all of them go at once */
+    StartTime = KeQueryInterruptTime();
+    KeSetEvent(&Context.StartEvent, IO_NO_INCREMENT, FALSE);
+
+    for (i = 0; i < ThreadCount; i++)
+    {
+        KmtFinishThread(Threads[i], NULL);
+    }
+    EndTime = KeQueryInterruptTime();
+
+    ok_eq_long(Context.Failures, 0L);
+
+    Milliseconds = (ULONG)((EndTime - StartTime) / 10000);
+    trace("%lu thread(s): %lu handle create/close pairs in %lu ms (%lu per second)\n",
+          ThreadCount,
+          ThreadCount * ITERATIONS_PER_THREAD,
+          Milliseconds,
+          Milliseconds ? (ULONG)(((ULONGLONG)ThreadCount * ITERATIONS_PER_THREAD * 1000) / Milliseconds) : 0);
+}
+
+START_TEST(ObHandlePerf)
+{
+    ULONG ThreadCount, MaxThreads;
+
+    /* Go up to twice the processor count to also cover preemption */
+    MaxThreads = min(2 * (ULONG)KeNumberProcessors, MAX_THREADS);
+
+    for (ThreadCount = 1; ThreadCount <= MaxThreads; ThreadCount *= 2)
+    {
+        TestHandleThroughput(ThreadCount);
+    }
+}
@@ -18,6 +18,10 @@ BOOLEAN CcPfEnablePrefetcher;
 PFSN_PREFETCHER_GLOBALS CcPfGlobals;
 MM_SYSTEMSIZE CcCapturedSystemSize;
 
+/* Number of views read ahead of a sequential reader,
+ * doubled for files opened with FO_SEQUENTIAL_ONLY */
+ULONG CcReadAheadViews = 2;
+
 static ULONG BugCheckFileId = 0x4 << 16;
 
 /* FUNCTIONS *****************************************************************/
@@ -151,7 +155,7 @@ CcRemapBcb (
 }
 
 /*
- * @unimplemented
+ * @implemented
  */
 VOID
 NTAPI
@@ -163,6 +167,10 @@ CcScheduleReadAhead (
 {
     KIRQL OldIrql;
     LARGE_INTEGER NewOffset;
+    LONGLONG ReadAheadStart, ReadAheadEnd;
+    LONGLONG Stride;
+    ULONG Window;
+    PWORK_QUEUE_ENTRY WorkItem;
     PROS_SHARED_CACHE_MAP SharedCacheMap;
     PPRIVATE_CACHE_MAP PrivateCacheMap;
 
@@ -183,75 +191,103 @@ CcScheduleReadAhead (
 
     /* Lock read ahead spin lock */
     KeAcquireSpinLock(&PrivateCacheMap->ReadAheadSpinLock, &OldIrql);
-    /* Easy case: the file is sequentially read */
-    if (BooleanFlagOn(FileObject->Flags, FO_SEQUENTIAL_ONLY))
+
+    /* A read ahead is already in flight, it will do for now */
+    if (PrivateCacheMap->Flags.ReadAheadActive)
+    {
+        KeReleaseSpinLock(&PrivateCacheMap->ReadAheadSpinLock, OldIrql);
+        return;
+    }
+
+    ReadAheadEnd = PrivateCacheMap->ReadAheadOffset[1].QuadPart + PrivateCacheMap->ReadAheadLength[1];
+    Stride = PrivateCacheMap->FileOffset2.QuadPart - PrivateCacheMap->FileOffset1.QuadPart;
+
+    /* Sequential access: either the caller told us so, or this read
+     * starts where (or within a read ahead unit of where) the previous one ended.
+     * Keep a window of views prefetched in front of the reader.
+     */
+    if (BooleanFlagOn(FileObject->Flags, FO_SEQUENTIAL_ONLY) ||
+        (FileOffset->QuadPart >= PrivateCacheMap->FileOffset2.QuadPart &&
+         FileOffset->QuadPart <= PrivateCacheMap->BeyondLastByte2.QuadPart + PrivateCacheMap->ReadAheadMask + 1))
     {
-        /* If we went backward, this is no go! */
-        if (NewOffset.QuadPart < PrivateCacheMap->ReadAheadOffset[1].QuadPart)
+        Window = CcReadAheadViews * VACB_MAPPING_GRANULARITY;
+        if (BooleanFlagOn(FileObject->Flags, FO_SEQUENTIAL_ONLY))
         {
+            Window *= 2;
+        }
+
+        if (ReadAheadEnd < NewOffset.QuadPart ||
+            ReadAheadEnd > NewOffset.QuadPart + Window)
+        {
+            /* The reader isn't in the window anymore, start a new one */
+            ReadAheadStart = NewOffset.QuadPart;
+        }
+        else if (ReadAheadEnd - NewOffset.QuadPart >= Window / 2)
+        {
+            /* Still far enough ahead of the reader */
             KeReleaseSpinLock(&PrivateCacheMap->ReadAheadSpinLock, OldIrql);
             return;
         }
+        else
+        {
+            /* Extend the current window */
+            ReadAheadStart = ReadAheadEnd;
+        }
 
-        /* FIXME: hackish, but will do the job for now */
-        PrivateCacheMap->ReadAheadOffset[1].QuadPart = NewOffset.QuadPart;
-        PrivateCacheMap->ReadAheadLength[1] = Length;
+        PrivateCacheMap->ReadAheadOffset[1].QuadPart = ReadAheadStart;
+        PrivateCacheMap->ReadAheadLength[1] = (ULONG)(NewOffset.QuadPart + Window - ReadAheadStart);
     }
-    /* Other cases: try to find some logic in that mess... */
-    else
+    /* Strided access: the last three reads are evenly spaced,
+     * prefetch where the next one should land
+     */
+    else if (Stride != 0 &&
+             FileOffset->QuadPart - PrivateCacheMap->FileOffset2.QuadPart == Stride &&
+             FileOffset->QuadPart + Stride >= 0)
     {
-        /* Let's check if we always read the same way (like going down in the file)
-         * and pretend it's enough for now
-         */
-        if (PrivateCacheMap->FileOffset2.QuadPart >= PrivateCacheMap->FileOffset1.QuadPart &&
-            FileOffset->QuadPart >= PrivateCacheMap->FileOffset2.QuadPart)
+        ReadAheadStart = FileOffset->QuadPart + Stride;
+        if (PrivateCacheMap->ReadAheadOffset[1].QuadPart == ReadAheadStart)
         {
-            /* FIXME: hackish, but will do the job for now */
-            PrivateCacheMap->ReadAheadOffset[1].QuadPart = NewOffset.QuadPart;
-            PrivateCacheMap->ReadAheadLength[1] = Length;
-        }
-        else
-        {
-            /* FIXME: handle the other cases */
             KeReleaseSpinLock(&PrivateCacheMap->ReadAheadSpinLock, OldIrql);
-            UNIMPLEMENTED_ONCE;
             return;
         }
-    }
 
-    /* If read ahead isn't active yet */
-    if (!PrivateCacheMap->Flags.ReadAheadActive)
+        PrivateCacheMap->ReadAheadOffset[1].QuadPart = ReadAheadStart;
+        PrivateCacheMap->ReadAheadLength[1] = Length;
+    }
+    /* No pattern we know of */
+    else
     {
-        PWORK_QUEUE_ENTRY WorkItem;
-
-        /* It's active now!
-         * Be careful with the mask, you don't want to mess with node code
-         */
-        InterlockedOr((volatile long *)&PrivateCacheMap->UlongFlags, PRIVATE_CACHE_MAP_READ_AHEAD_ACTIVE);
         KeReleaseSpinLock(&PrivateCacheMap->ReadAheadSpinLock, OldIrql);
+        return;
+    }
 
-        /* Get a work item */
-        WorkItem = ExAllocateFromNPagedLookasideList(&CcTwilightLookasideList);
-        if (WorkItem != NULL)
-        {
-            /* Reference our FO so that it doesn't go in between */
-            ObReferenceObject(FileObject);
+    /* It's active now!
+     * Be careful with the mask, you don't want to mess with node code
+     */
+    InterlockedOr((volatile long *)&PrivateCacheMap->UlongFlags, PRIVATE_CACHE_MAP_READ_AHEAD_ACTIVE);
+    KeReleaseSpinLock(&PrivateCacheMap->ReadAheadSpinLock, OldIrql);
 
-            /* We want to do read ahead! */
-            WorkItem->Function = ReadAhead;
-            WorkItem->Parameters.Read.FileObject = FileObject;
+    /* Get a work item */
+    WorkItem = ExAllocateFromNPagedLookasideList(&CcTwilightLookasideList);
+    if (WorkItem != NULL)
+    {
+        /* Reference our FO so that it doesn't go in between */
+        ObReferenceObject(FileObject);
 
-            /* Queue in the read ahead dedicated queue */
-            CcPostWorkQueue(WorkItem, &CcExpressWorkQueue);
+        /* We want to do read ahead! */
+        WorkItem->Function = ReadAhead;
+        WorkItem->Parameters.Read.FileObject = FileObject;
 
-            return;
-        }
+        /* Queue in the read ahead dedicated queue */
+        CcPostWorkQueue(WorkItem, &CcExpressWorkQueue);
 
-        /* Fail path: lock again, and revert read ahead active */
-        KeAcquireSpinLock(&PrivateCacheMap->ReadAheadSpinLock, &OldIrql);
-        InterlockedAnd((volatile long *)&PrivateCacheMap->UlongFlags, ~PRIVATE_CACHE_MAP_READ_AHEAD_ACTIVE);
+        return;
     }
 
+    /* Fail path: lock again, and revert read ahead active */
+    KeAcquireSpinLock(&PrivateCacheMap->ReadAheadSpinLock, &OldIrql);
+    InterlockedAnd((volatile long *)&PrivateCacheMap->UlongFlags, ~PRIVATE_CACHE_MAP_READ_AHEAD_ACTIVE);
+
     /* Done (fail) */
     KeReleaseSpinLock(&PrivateCacheMap->ReadAheadSpinLock, OldIrql);
 }
@@ -50,6 +50,15 @@ ULONG CcFastReadResourceMiss;
 ULONG CcDataPages = 0;
 ULONG CcDataFlushes = 0;
 
+/* Read ahead counters:
+ * - Number of views read by read ahead
+ * - Pages brought in by read ahead and then accessed
+ * - Pages brought in by read ahead and released without being accessed
+ */
+ULONG CcReadAheadIos = 0;
+ULONG CcReadAheadHitPages = 0;
+ULONG CcReadAheadWastedPages = 0;
+
 /* FUNCTIONS *****************************************************************/
 
 VOID
@@ -245,6 +254,19 @@ ReadWriteOrZero(
     return Status;
 }
 
+static
+VOID
+CcReadAheadHit(
+    PROS_VACB Vacb)
+{
+    /* First access to a view read ahead of time */
+    if (Vacb->ReadAhead)
+    {
+        Vacb->ReadAhead = FALSE;
+        InterlockedExchangeAdd((PLONG)&CcReadAheadHitPages, VACB_MAPPING_GRANULARITY / PAGE_SIZE);
+    }
+}
+
 BOOLEAN
 CcCopyData (
     _In_ PFILE_OBJECT FileObject,
@@ -260,7 +282,7 @@ CcCopyData (
     ULONG BytesCopied;
     KIRQL OldIrql;
     PROS_SHARED_CACHE_MAP SharedCacheMap;
-    PLIST_ENTRY ListEntry;
+    LONGLONG ViewOffset;
     PROS_VACB Vacb;
     ULONG PartialLength;
     PVOID BaseAddress;
@@ -277,25 +299,18 @@ CcCopyData (
         /* test if the requested data is available */
         KeAcquireSpinLock(&SharedCacheMap->CacheMapLock, &OldIrql);
         /* FIXME: this loop doesn't take into account areas that don't have
-         * a VACB in the list yet */
-        ListEntry = SharedCacheMap->CacheMapVacbListHead.Flink;
-        while (ListEntry != &SharedCacheMap->CacheMapVacbListHead)
+         * a VACB in the index yet */
+        for (ViewOffset = ROUND_DOWN(CurrentOffset, VACB_MAPPING_GRANULARITY);
+             ViewOffset < CurrentOffset + Length;
+             ViewOffset += VACB_MAPPING_GRANULARITY)
         {
-            Vacb = CONTAINING_RECORD(ListEntry,
-                                     ROS_VACB,
-                                     CacheMapVacbListEntry);
-            ListEntry = ListEntry->Flink;
-            if (!Vacb->Valid &&
-                DoRangesIntersect(Vacb->FileOffset.QuadPart,
-                                  VACB_MAPPING_GRANULARITY,
-                                  CurrentOffset, Length))
+            Vacb = CcRosVacbIndexGet(SharedCacheMap, ViewOffset);
+            if (Vacb != NULL && !Vacb->Valid)
             {
                 KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, OldIrql);
                 /* data not available */
                 return FALSE;
             }
-            if (Vacb->FileOffset.QuadPart >= CurrentOffset + Length)
-                break;
         }
         KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, OldIrql);
     }
@@ -321,6 +336,10 @@ CcCopyData (
                 ExRaiseStatus(Status);
             }
         }
+        else
+        {
+            CcReadAheadHit(Vacb);
+        }
         Status = ReadWriteOrZero((PUCHAR)BaseAddress + CurrentOffset % VACB_MAPPING_GRANULARITY,
                                  Buffer,
                                  PartialLength,
@@ -361,6 +380,10 @@ CcCopyData (
                 ExRaiseStatus(Status);
             }
         }
+        else if (Valid)
+        {
+            CcReadAheadHit(Vacb);
+        }
         Status = ReadWriteOrZero(BaseAddress, Buffer, PartialLength, Operation);
 
         CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, Operation != CcOperationRead, FALSE);
@@ -379,11 +402,10 @@ CcCopyData (
     /* If that was a successful sync read operation, let's handle read ahead */
     if (Operation == CcOperationRead && Length == 0 && Wait)
     {
-        /* If file isn't random access and next read may get us cross VACB boundary,
-         * schedule next read
+        /* Unless the file is accessed randomly, let read ahead look
+         * at the access pattern and prefetch what comes next
          */
-        if (!BooleanFlagOn(FileObject->Flags, FO_RANDOM_ACCESS) &&
-            (CurrentOffset - 1) / VACB_MAPPING_GRANULARITY != (CurrentOffset + BytesCopied - 1) / VACB_MAPPING_GRANULARITY)
+        if (!BooleanFlagOn(FileObject->Flags, FO_RANDOM_ACCESS))
         {
             CcScheduleReadAhead(FileObject, (PLARGE_INTEGER)&FileOffset, BytesCopied);
         }
@@ -568,6 +590,9 @@ CcPerformReadAhead(
                 DPRINT1("Failed to read data: %lx!\n", Status);
                 goto Clear;
             }
+
+            Vacb->ReadAhead = TRUE;
+            InterlockedIncrement((PLONG)&CcReadAheadIos);
         }
 
         CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, FALSE, FALSE);
@@ -600,6 +625,9 @@ CcPerformReadAhead(
                 DPRINT1("Failed to read data: %lx!\n", Status);
                 goto Clear;
             }
+
+            Vacb->ReadAhead = TRUE;
+            InterlockedIncrement((PLONG)&CcReadAheadIos);
         }
 
         CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, FALSE, FALSE);
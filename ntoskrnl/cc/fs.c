@@ -221,7 +221,8 @@ CcPurgeCacheSection (
                       SharedCacheMap->SectionSize.QuadPart);
         if (ViewEnd >= EndOffset)
         {
-            break;
+            /* The list isn't sorted, there may be VACBs in range further on */
+            continue;
         }
 
         /* Still in use, it cannot be purged, fail
@@ -243,6 +244,7 @@ CcPurgeCacheSection (
         {
             CcRosUnmarkDirtyVacb(Vacb, FALSE);
         }
+        CcRosVacbIndexRemove(Vacb);
         RemoveEntryList(&Vacb->CacheMapVacbListEntry);
         InsertHeadList(&FreeList, &Vacb->CacheMapVacbListEntry);
     }
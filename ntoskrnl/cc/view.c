@@ -365,6 +365,7 @@ retry:
             ASSERT(!current->MappedCount);
             ASSERT(Refs == 1);
 
+            CcRosVacbIndexRemove(current);
             RemoveEntryList(&current->CacheMapVacbListEntry);
             RemoveEntryList(&current->VacbLruListEntry);
             InitializeListHead(&current->VacbLruListEntry);
@@ -454,6 +455,179 @@ CcRosReleaseVacb (
     return STATUS_SUCCESS;
 }
 
+/*
+ * The VACB index maps a view number (file offset / VACB_MAPPING_GRANULARITY)
+ * to its VACB. It is a two level sparse array: a directory of leaves, each
+ * leaf covering VACB_INDEX_LEAF_SIZE consecutive views, so that huge sparse
+ * files only pay for the ranges actually cached. Both levels are protected
+ * by the shared cache map lock and are only ever grown while the cache map
+ * is alive.
+ */
+PROS_VACB
+NTAPI
+CcRosVacbIndexGet(
+    PROS_SHARED_CACHE_MAP SharedCacheMap,
+    LONGLONG FileOffset)
+{
+    ULONGLONG View;
+    ULONGLONG Slot;
+    PROS_VACB_INDEX_LEAF Leaf;
+
+    View = (ULONGLONG)FileOffset / VACB_MAPPING_GRANULARITY;
+    Slot = View / VACB_INDEX_LEAF_SIZE;
+
+    if (Slot >= SharedCacheMap->VacbIndexSize)
+        return NULL;
+
+    Leaf = SharedCacheMap->VacbIndex[Slot];
+    if (Leaf == NULL)
+        return NULL;
+
+    return Leaf->Vacbs[View % VACB_INDEX_LEAF_SIZE];
+}
+
+static
+VOID
+CcRosVacbIndexSet(
+    PROS_SHARED_CACHE_MAP SharedCacheMap,
+    LONGLONG FileOffset,
+    PROS_VACB Vacb)
+{
+    ULONGLONG View;
+    ULONGLONG Slot;
+
+    View = (ULONGLONG)FileOffset / VACB_MAPPING_GRANULARITY;
+    Slot = View / VACB_INDEX_LEAF_SIZE;
+
+    /* Room must have been made with CcRosVacbIndexReserve */
+    ASSERT(Slot < SharedCacheMap->VacbIndexSize);
+    ASSERT(SharedCacheMap->VacbIndex[Slot] != NULL);
+
+    SharedCacheMap->VacbIndex[Slot]->Vacbs[View % VACB_INDEX_LEAF_SIZE] = Vacb;
+}
+
+VOID
+NTAPI
+CcRosVacbIndexRemove(
+    PROS_VACB Vacb)
+{
+    ASSERT(CcRosVacbIndexGet(Vacb->SharedCacheMap, Vacb->FileOffset.QuadPart) == Vacb);
+
+    CcRosVacbIndexSet(Vacb->SharedCacheMap, Vacb->FileOffset.QuadPart, NULL);
+}
+
+/*
+ * Makes sure the index has a leaf for the view at FileOffset.
+ * Must be called at PASSIVE_LEVEL without the cache map lock held.
+ */
+static
+NTSTATUS
+CcRosVacbIndexReserve(
+    PROS_SHARED_CACHE_MAP SharedCacheMap,
+    LONGLONG FileOffset)
+{
+    ULONGLONG Slot;
+    ULONG NewSize;
+    KIRQL oldIrql;
+    PROS_VACB_INDEX_LEAF NewLeaf;
+    PROS_VACB_INDEX_LEAF *NewIndex, *OldIndex;
+
+    Slot = ((ULONGLONG)FileOffset / VACB_MAPPING_GRANULARITY) / VACB_INDEX_LEAF_SIZE;
+    if (Slot >= MAXULONG)
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    KeAcquireSpinLock(&SharedCacheMap->CacheMapLock, &oldIrql);
+    if (Slot < SharedCacheMap->VacbIndexSize &&
+        SharedCacheMap->VacbIndex[Slot] != NULL)
+    {
+        KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
+        return STATUS_SUCCESS;
+    }
+    NewSize = SharedCacheMap->VacbIndexSize;
+    KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
+
+    NewLeaf = ExAllocatePoolWithTag(NonPagedPool, sizeof(ROS_VACB_INDEX_LEAF), TAG_VACB_INDEX);
+    if (NewLeaf == NULL)
+    {
+        return STATUS_INSUFFICIENT_RESOURCES;
+    }
+    RtlZeroMemory(NewLeaf, sizeof(ROS_VACB_INDEX_LEAF));
+
+    /* Size the directory after the section, so that it rarely has to grow */
+    NewIndex = NULL;
+    if (Slot >= NewSize)
+    {
+        NewSize = (ULONG)(((ULONGLONG)SharedCacheMap->SectionSize.QuadPart / VACB_MAPPING_GRANULARITY) / VACB_INDEX_LEAF_SIZE) + 1;
+        NewSize = max(NewSize, (ULONG)Slot + 1);
+        NewIndex = ExAllocatePoolWithTag(NonPagedPool, NewSize * sizeof(PROS_VACB_INDEX_LEAF), TAG_VACB_INDEX);
+        if (NewIndex == NULL)
+        {
+            ExFreePoolWithTag(NewLeaf, TAG_VACB_INDEX);
+            return STATUS_INSUFFICIENT_RESOURCES;
+        }
+        RtlZeroMemory(NewIndex, NewSize * sizeof(PROS_VACB_INDEX_LEAF));
+    }
+
+    OldIndex = NULL;
+    KeAcquireSpinLock(&SharedCacheMap->CacheMapLock, &oldIrql);
+    /* Someone may have grown the directory in the meantime */
+    if (Slot >= SharedCacheMap->VacbIndexSize)
+    {
+        ASSERT(NewIndex != NULL);
+        ASSERT(NewSize > SharedCacheMap->VacbIndexSize);
+        if (SharedCacheMap->VacbIndexSize != 0)
+        {
+            RtlCopyMemory(NewIndex, SharedCacheMap->VacbIndex,
+                          SharedCacheMap->VacbIndexSize * sizeof(PROS_VACB_INDEX_LEAF));
+        }
+        OldIndex = SharedCacheMap->VacbIndex;
+        SharedCacheMap->VacbIndex = NewIndex;
+        SharedCacheMap->VacbIndexSize = NewSize;
+        NewIndex = NULL;
+    }
+    if (SharedCacheMap->VacbIndex[Slot] == NULL)
+    {
+        SharedCacheMap->VacbIndex[Slot] = NewLeaf;
+        NewLeaf = NULL;
+    }
+    KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
+
+    if (OldIndex != NULL)
+        ExFreePoolWithTag(OldIndex, TAG_VACB_INDEX);
+    if (NewIndex != NULL)
+        ExFreePoolWithTag(NewIndex, TAG_VACB_INDEX);
+    if (NewLeaf != NULL)
+        ExFreePoolWithTag(NewLeaf, TAG_VACB_INDEX);
+
+    return STATUS_SUCCESS;
+}
+
+static
+VOID
+CcRosVacbIndexFree(
+    PROS_SHARED_CACHE_MAP SharedCacheMap)
+{
+    ULONG i;
+
+    for (i = 0; i < SharedCacheMap->VacbIndexSize; i++)
+    {
+        if (SharedCacheMap->VacbIndex[i] != NULL)
+        {
+            ExFreePoolWithTag(SharedCacheMap->VacbIndex[i], TAG_VACB_INDEX);
+        }
+    }
+
+    if (SharedCacheMap->VacbIndex != NULL)
+    {
+        ExFreePoolWithTag(SharedCacheMap->VacbIndex, TAG_VACB_INDEX);
+    }
+
+    SharedCacheMap->VacbIndex = NULL;
+    SharedCacheMap->VacbIndexSize = 0;
+}
+
 /* Returns with VACB Lock Held! */
 PROS_VACB
 NTAPI
@@ -461,7 +635,6 @@ CcRosLookupVacb (
     PROS_SHARED_CACHE_MAP SharedCacheMap,
     LONGLONG FileOffset)
 {
-    PLIST_ENTRY current_entry;
     PROS_VACB current;
     KIRQL oldIrql;
 
@@ -470,33 +643,22 @@ CcRosLookupVacb (
     DPRINT("CcRosLookupVacb(SharedCacheMap 0x%p, FileOffset %I64u)\n",
            SharedCacheMap, FileOffset);
 
-    KeAcquireGuardedMutex(&ViewLock);
+    /* The index is protected by the cache map lock, the global
+     * ViewLock isn't needed here */
     KeAcquireSpinLock(&SharedCacheMap->CacheMapLock, &oldIrql);
 
-    current_entry = SharedCacheMap->CacheMapVacbListHead.Flink;
-    while (current_entry != &SharedCacheMap->CacheMapVacbListHead)
+    current = CcRosVacbIndexGet(SharedCacheMap, FileOffset);
+    if (current != NULL)
     {
-        current = CONTAINING_RECORD(current_entry,
-                                    ROS_VACB,
-                                    CacheMapVacbListEntry);
-        if (IsPointInRange(current->FileOffset.QuadPart,
-                           VACB_MAPPING_GRANULARITY,
-                           FileOffset))
-        {
-            CcRosVacbIncRefCount(current);
-            KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
-            KeReleaseGuardedMutex(&ViewLock);
-            return current;
-        }
-        if (current->FileOffset.QuadPart > FileOffset)
-            break;
-        current_entry = current_entry->Flink;
+        ASSERT(IsPointInRange(current->FileOffset.QuadPart,
+                              VACB_MAPPING_GRANULARITY,
+                              FileOffset));
+        CcRosVacbIncRefCount(current);
     }
 
     KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
-    KeReleaseGuardedMutex(&ViewLock);
 
-    return NULL;
+    return current;
 }
 
 VOID
@@ -705,8 +867,6 @@ CcRosCreateVacb (
     PROS_VACB *Vacb)
 {
     PROS_VACB current;
-    PROS_VACB previous;
-    PLIST_ENTRY current_entry;
     NTSTATUS Status;
     KIRQL oldIrql;
     ULONG Refs;
@@ -726,6 +886,7 @@ CcRosCreateVacb (
     current->Valid = FALSE;
     current->Dirty = FALSE;
     current->PageOut = FALSE;
+    current->ReadAhead = FALSE;
     current->FileOffset.QuadPart = ROUND_DOWN(FileOffset, VACB_MAPPING_GRANULARITY);
     current->SharedCacheMap = SharedCacheMap;
 #if DBG
@@ -751,6 +912,14 @@ CcRosCreateVacb (
         return Status;
     }
 
+    Status = CcRosVacbIndexReserve(SharedCacheMap, FileOffset);
+    if (!NT_SUCCESS(Status))
+    {
+        Refs = CcRosVacbDecRefCount(current);
+        ASSERT(Refs == 0);
+        return Status;
+    }
+
     KeAcquireGuardedMutex(&ViewLock);
 
     *Vacb = current;
@@ -760,56 +929,33 @@ CcRosCreateVacb (
      * our newly created VACB and return the existing one.
      */
     KeAcquireSpinLock(&SharedCacheMap->CacheMapLock, &oldIrql);
-    current_entry = SharedCacheMap->CacheMapVacbListHead.Flink;
-    previous = NULL;
-    while (current_entry != &SharedCacheMap->CacheMapVacbListHead)
+    current = CcRosVacbIndexGet(SharedCacheMap, FileOffset);
+    if (current != NULL)
     {
-        current = CONTAINING_RECORD(current_entry,
-                                    ROS_VACB,
-                                    CacheMapVacbListEntry);
-        if (IsPointInRange(current->FileOffset.QuadPart,
-                           VACB_MAPPING_GRANULARITY,
-                           FileOffset))
-        {
-            CcRosVacbIncRefCount(current);
-            KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
+        CcRosVacbIncRefCount(current);
+        KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
 #if DBG
-            if (SharedCacheMap->Trace)
-            {
-                DPRINT1("CacheMap 0x%p: deleting newly created VACB 0x%p ( found existing one 0x%p )\n",
-                        SharedCacheMap,
-                        (*Vacb),
-                        current);
-            }
+        if (SharedCacheMap->Trace)
+        {
+            DPRINT1("CacheMap 0x%p: deleting newly created VACB 0x%p ( found existing one 0x%p )\n",
+                    SharedCacheMap,
+                    (*Vacb),
+                    current);
+        }
 #endif
-            KeReleaseGuardedMutex(&ViewLock);
+        KeReleaseGuardedMutex(&ViewLock);
 
-            Refs = CcRosVacbDecRefCount(*Vacb);
-            ASSERT(Refs == 0);
+        Refs = CcRosVacbDecRefCount(*Vacb);
+        ASSERT(Refs == 0);
 
-            *Vacb = current;
-            return STATUS_SUCCESS;
-        }
-        if (current->FileOffset.QuadPart < FileOffset)
-        {
-            ASSERT(previous == NULL ||
-                   previous->FileOffset.QuadPart < current->FileOffset.QuadPart);
-            previous = current;
-        }
-        if (current->FileOffset.QuadPart > FileOffset)
-            break;
-        current_entry = current_entry->Flink;
+        *Vacb = current;
+        return STATUS_SUCCESS;
     }
-    /* There was no existing VACB. */
+    /* There was no existing VACB. Lookups go through the index,
+     * so the per cache map list doesn't need to be kept sorted. */
     current = *Vacb;
-    if (previous)
-    {
-        InsertHeadList(&previous->CacheMapVacbListEntry, &current->CacheMapVacbListEntry);
-    }
-    else
-    {
-        InsertHeadList(&SharedCacheMap->CacheMapVacbListHead, &current->CacheMapVacbListEntry);
-    }
+    CcRosVacbIndexSet(SharedCacheMap, current->FileOffset.QuadPart, current);
+    InsertTailList(&SharedCacheMap->CacheMapVacbListHead, &current->CacheMapVacbListEntry);
     KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
     InsertTailList(&VacbLruListHead, &current->VacbLruListEntry);
     KeReleaseGuardedMutex(&ViewLock);
@@ -954,6 +1100,12 @@ CcRosInternalFreeVacb (
  */
 {
     DPRINT("Freeing VACB 0x%p\n", Vacb);
+
+    /* Read ahead brought it in for nothing */
+    if (Vacb->ReadAhead)
+    {
+        InterlockedExchangeAdd((PLONG)&CcReadAheadWastedPages, VACB_MAPPING_GRANULARITY / PAGE_SIZE);
+    }
 #if DBG
     if (Vacb->SharedCacheMap->Trace)
     {
@@ -1098,9 +1250,10 @@ CcRosDeleteFileCache (
         while (!IsListEmpty(&SharedCacheMap->CacheMapVacbListHead))
         {
             current_entry = RemoveTailList(&SharedCacheMap->CacheMapVacbListHead);
+            current = CONTAINING_RECORD(current_entry, ROS_VACB, CacheMapVacbListEntry);
+            CcRosVacbIndexRemove(current);
             KeReleaseSpinLock(&SharedCacheMap->CacheMapLock, oldIrql);
 
-            current = CONTAINING_RECORD(current_entry, ROS_VACB, CacheMapVacbListEntry);
             RemoveEntryList(&current->VacbLruListEntry);
             InitializeListHead(&current->VacbLruListEntry);
             if (current->Dirty)
@@ -1168,6 +1321,7 @@ CcRosDeleteFileCache (
         RemoveEntryList(&SharedCacheMap->SharedCacheMapLinks);
         KeReleaseQueuedSpinLock(LockQueueMasterLock, OldIrql);
 
+        CcRosVacbIndexFree(SharedCacheMap);
         ExFreeToNPagedLookasideList(&SharedCacheMapLookasideList, SharedCacheMap);
         KeAcquireGuardedMutex(&ViewLock);
     }
@@ -1519,6 +1673,11 @@ ExpKdbgExtFileCache(ULONG Argc, PCHAR Argv[])
         KdbpPrint("%p\t%d\t%d\t%wZ%S\n", SharedCacheMap, Valid, Dirty, FileName, Extra);
     }
 
+    KdbpPrint("Read ahead: %lu views read, %lu Kb used, %lu Kb wasted\n",
+              CcReadAheadIos,
+              (CcReadAheadHitPages * PAGE_SIZE) / 1024,
+              (CcReadAheadWastedPages * PAGE_SIZE) / 1024);
+
     return TRUE;
 }
 
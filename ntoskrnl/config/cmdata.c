@@ -402,6 +402,14 @@ INIT_FUNCTION CM_SYSTEM_CONTROL_VECTOR CmControlVector[] =
         NULL
     },
 
+    {
+        L"Session Manager\\Memory Management",
+        L"SectionFaultClusterSize",
+        &MmSectionFaultClusterSize,
+        NULL,
+        NULL
+    },
+
     {
         L"Session Manager\\Memory Management",
         L"PoolTagSmallTableSize",
@@ -618,6 +626,22 @@ INIT_FUNCTION CM_SYSTEM_CONTROL_VECTOR CmControlVector[] =
         NULL
     },
 
+    {
+        L"Session Manager",
+        L"ResourceSpinCount",
+        &ExpResourceSpinCount,
+        NULL,
+        NULL
+    },
+
+    {
+        L"Session Manager",
+        L"PushLockSpinCount",
+        &ExpPushLockSpinLimit,
+        NULL,
+        NULL
+    },
+
     {
         L"Session Manager",
         L"CriticalSectionTimeout",
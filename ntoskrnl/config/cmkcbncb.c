@@ -492,6 +492,13 @@ CmpCleanUpKcbCacheWithLock(IN PCM_KEY_CONTROL_BLOCK Kcb,
     /* Check if we have an index hint block and free it */
     if (Kcb->ExtFlags & CM_KCB_SUBKEY_HINT) CmpFree(Kcb->IndexHint, 0);
 
+    /* Free the subkey lookup cache too */
+    if (Kcb->SubKeyCache)
+    {
+        CmpFree(Kcb->SubKeyCache, TAG_KCB_SUBKEY_CACHE);
+        Kcb->SubKeyCache = NULL;
+    }
+
     /* Check if we were already deleted */
     Parent = Kcb->ParentKcb;
     if (!Kcb->Delete) CmpRemoveKeyControlBlock(Kcb);
@@ -512,6 +519,134 @@ CmpCleanUpKcbCacheWithLock(IN PCM_KEY_CONTROL_BLOCK Kcb,
     }
 }
 
+static
+ULONG
+CmpComputeSubKeyConvKey(IN PCUNICODE_STRING Name)
+{
+    ULONG ConvKey = 0, i;
+
+    for (i = 0; i < Name->Length / sizeof(WCHAR); i++)
+    {
+        ConvKey = 37 * ConvKey + RtlUpcaseUnicodeChar(Name->Buffer[i]);
+    }
+
+    return ConvKey;
+}
+
+HCELL_INDEX
+NTAPI
+CmpFindSubKeyByNameWithCache(IN PCM_KEY_CONTROL_BLOCK Kcb,
+                             IN PHHIVE Hive,
+                             IN PCM_KEY_NODE Node,
+                             IN PCUNICODE_STRING SearchName)
+{
+    PCM_SUBKEY_CACHE Cache;
+    PCM_SUBKEY_CACHE_ENTRY Entry;
+    HCELL_INDEX Cell;
+    ULONG ConvKey, Generation, i;
+    USHORT Length;
+    PAGED_CODE();
+
+    /* Names too long to be cached go straight to the hive */
+    Length = SearchName->Length;
+    if (Length > sizeof(Entry->Name))
+    {
+        return CmpFindSubKeyByName(Hive, Node, SearchName);
+    }
+
+    /* Allocate the cache on the first lookup */
+    Cache = Kcb->SubKeyCache;
+    if (!Cache)
+    {
+        Cache = CmpAllocate(sizeof(CM_SUBKEY_CACHE), TRUE, TAG_KCB_SUBKEY_CACHE);
+        if (!Cache) return CmpFindSubKeyByName(Hive, Node, SearchName);
+
+        RtlZeroMemory(Cache, sizeof(CM_SUBKEY_CACHE));
+        ExInitializePushLock(&Cache->Lock);
+
+        /* Somebody else may have been faster */
+        if (InterlockedCompareExchangePointer((PVOID*)&Kcb->SubKeyCache,
+                                              Cache,
+                                              NULL))
+        {
+            CmpFree(Cache, TAG_KCB_SUBKEY_CACHE);
+            Cache = Kcb->SubKeyCache;
+        }
+    }
+
+    ConvKey = CmpComputeSubKeyConvKey(SearchName);
+    Entry = &Cache->Entries[ConvKey % CM_SUBKEY_CACHE_ENTRIES];
+
+    /* Look it up */
+    KeEnterCriticalRegion();
+    ExAcquirePushLockShared(&Cache->Lock);
+    if ((Entry->NameLength == Length) && (Entry->ConvKey == ConvKey))
+    {
+        for (i = 0; i < Length / sizeof(WCHAR); i++)
+        {
+            if (Entry->Name[i] != RtlUpcaseUnicodeChar(SearchName->Buffer[i])) break;
+        }
+
+        if (i == Length / sizeof(WCHAR))
+        {
+            /* Hit, which may well be a remembered miss */
+            Cell = Entry->Cell;
+            ExReleasePushLockShared(&Cache->Lock);
+            KeLeaveCriticalRegion();
+            return Cell;
+        }
+    }
+
+    /* Remember the generation so a racing invalidation wins */
+    Generation = Cache->Generation;
+    ExReleasePushLockShared(&Cache->Lock);
+    KeLeaveCriticalRegion();
+
+    /* Do the real lookup */
+    Cell = CmpFindSubKeyByName(Hive, Node, SearchName);
+
+    /* And cache the result, found or not */
+    KeEnterCriticalRegion();
+    ExAcquirePushLockExclusive(&Cache->Lock);
+    if (Generation == Cache->Generation)
+    {
+        Entry->ConvKey = ConvKey;
+        Entry->Cell = Cell;
+        Entry->NameLength = Length;
+        for (i = 0; i < Length / sizeof(WCHAR); i++)
+        {
+            Entry->Name[i] = RtlUpcaseUnicodeChar(SearchName->Buffer[i]);
+        }
+    }
+    ExReleasePushLockExclusive(&Cache->Lock);
+    KeLeaveCriticalRegion();
+
+    return Cell;
+}
+
+VOID
+NTAPI
+CmpInvalidateSubKeyCache(IN PCM_KEY_CONTROL_BLOCK Kcb)
+{
+    PCM_SUBKEY_CACHE Cache = Kcb->SubKeyCache;
+    ULONG i;
+    PAGED_CODE();
+
+    /* Nothing to do if nothing was ever looked up */
+    if (!Cache) return;
+
+    /* Drop all entries and make in-flight lookups discard their result */
+    KeEnterCriticalRegion();
+    ExAcquirePushLockExclusive(&Cache->Lock);
+    Cache->Generation++;
+    for (i = 0; i < CM_SUBKEY_CACHE_ENTRIES; i++)
+    {
+        Cache->Entries[i].NameLength = 0;
+    }
+    ExReleasePushLockExclusive(&Cache->Lock);
+    KeLeaveCriticalRegion();
+}
+
 VOID
 NTAPI
 CmpCleanUpSubKeyInfo(IN PCM_KEY_CONTROL_BLOCK Kcb)
@@ -521,6 +656,9 @@ CmpCleanUpSubKeyInfo(IN PCM_KEY_CONTROL_BLOCK Kcb)
     /* Make sure we have the exclusive lock */
     CMP_ASSERT_KCB_LOCK(Kcb);
 
+    /* Forget the subkey lookups we cached */
+    CmpInvalidateSubKeyCache(Kcb);
+
     /* Check if there's any cached subkey */
     if (Kcb->ExtFlags & (CM_KCB_NO_SUBKEY | CM_KCB_SUBKEY_ONE | CM_KCB_SUBKEY_HINT))
     {
@@ -724,6 +862,7 @@ CmpCreateKeyControlBlock(IN PHHIVE Hive,
     Kcb->ConvKey = ConvKey;
     Kcb->DelayedCloseIndex = CmpDelayedCloseSize;
     Kcb->InDelayClose = 0;
+    Kcb->SubKeyCache = NULL;
     ASSERT_KCB_VALID(Kcb);
 
     /* Check if we have two hash entires */
@@ -490,6 +490,9 @@ CmpDoCreate(IN PHHIVE Hive,
             ASSERT(FALSE);
         }
 
+        /* Cached misses for this name are now wrong */
+        CmpInvalidateSubKeyCache(ParentKcb);
+
         /* Get the key node */
         KeyNode = (PCM_KEY_NODE)HvGetCell(Hive, Cell);
         if (!KeyNode)
@@ -905,6 +908,9 @@ CmpCreateLinkNode(IN PHHIVE Hive,
             ASSERT(FALSE);
         }
 
+        /* Cached misses for this name are now wrong */
+        CmpInvalidateSubKeyCache(ParentKcb);
+
         /* Get the key body */
         KeyBody = (PCM_KEY_BODY)*Object;
 
@@ -1169,8 +1175,8 @@ CmpParseKey(IN PVOID ParseObject,
             /* See if this is a sym link */
             if (!(Kcb->Flags & KEY_SYM_LINK))
             {
-                /* Find the subkey */
-                NextCell = CmpFindSubKeyByName(Hive, Node, &NextName);
+                /* Find the subkey, going through the parent's lookup cache */
+                NextCell = CmpFindSubKeyByNameWithCache(ParentKcb, Hive, Node, &NextName);
                 if (NextCell != HCELL_NIL)
                 {
                     /* Get the new node */
@@ -20,6 +20,36 @@ EX_PUSH_LOCK HandleTableListLock;
 #define SizeOfHandle(x) (sizeof(HANDLE) * (x))
 #define INDEX_TO_HANDLE_VALUE(x) ((x) << HANDLE_TAG_BITS)
 
+/* How long to spin on a locked entry before blocking, on MP only */
+#define EXP_HANDLE_LOCK_SPIN_COUNT 256
+
+/* Free handle cache, one slot per processor (modulo the slot count). Each
+   slot lives on its own cache line so processors don't fight over them */
+#define EXP_HANDLE_CACHE_SLOTS 4
+
+typedef struct _EXP_HANDLE_CACHE_SLOT
+{
+    ULONG FreeHandle;
+    UCHAR Padding[64 - sizeof(ULONG)];
+} EXP_HANDLE_CACHE_SLOT, *PEXP_HANDLE_CACHE_SLOT;
+
+/* The cache is kept out of the documented HANDLE_TABLE layout by
+   allocating it right behind the table */
+typedef struct _EXP_HANDLE_TABLE
+{
+    HANDLE_TABLE Table;
+    EXP_HANDLE_CACHE_SLOT Cache[EXP_HANDLE_CACHE_SLOTS];
+} EXP_HANDLE_TABLE, *PEXP_HANDLE_TABLE;
+
+FORCEINLINE
+PULONG
+ExpGetHandleCacheSlot(IN PHANDLE_TABLE HandleTable)
+{
+    PEXP_HANDLE_TABLE Table = CONTAINING_RECORD(HandleTable, EXP_HANDLE_TABLE, Table);
+
+    return &Table->Cache[KeGetCurrentProcessorNumber() % EXP_HANDLE_CACHE_SLOTS].FreeHandle;
+}
+
 /* PRIVATE FUNCTIONS *********************************************************/
 
 VOID
@@ -275,6 +305,15 @@ ExpFreeHandleTableEntry(IN PHANDLE_TABLE HandleTable,
     /* Check if we're FIFO */
     if (!HandleTable->StrictFIFO)
     {
+        /* Park it in this processor's cache slot if that one is empty */
+        if (!InterlockedCompareExchange((PLONG)ExpGetHandleCacheSlot(HandleTable),
+                                        Handle.AsULONG,
+                                        0))
+        {
+            /* The next allocation on this processor will pick it up */
+            return;
+        }
+
         /* Select a lock index */
         LockIndex = Handle.Index % 4;
 
@@ -314,9 +353,9 @@ ExpAllocateHandleTable(IN PEPROCESS Process OPTIONAL,
     ULONG i;
     PAGED_CODE();
 
-    /* Allocate the table */
+    /* Allocate the table along with its free handle cache */
     HandleTable = ExAllocatePoolWithTag(PagedPool,
-                                        sizeof(HANDLE_TABLE),
+                                        sizeof(EXP_HANDLE_TABLE),
                                         TAG_OBJECT_TABLE);
     if (!HandleTable) return NULL;
 
@@ -326,8 +365,8 @@ ExpAllocateHandleTable(IN PEPROCESS Process OPTIONAL,
         /* FIXME: Charge quota */
     }
 
-    /* Clear the table */
-    RtlZeroMemory(HandleTable, sizeof(HANDLE_TABLE));
+    /* Clear the table and the cache */
+    RtlZeroMemory(HandleTable, sizeof(EXP_HANDLE_TABLE));
 
     /* Now allocate the first level structures */
     HandleTableTable = ExpAllocateTablePagedPoolNoZero(Process, PAGE_SIZE);
@@ -611,7 +650,9 @@ ULONG
 NTAPI
 ExpMoveFreeHandles(IN PHANDLE_TABLE HandleTable)
 {
-    ULONG LastFree, i;
+    ULONG LastFree, OldValue, Index, i;
+    EXHANDLE Handle;
+    PHANDLE_TABLE_ENTRY Entry;
 
     /* Clear the last free index */
     LastFree = InterlockedExchange((PLONG) &HandleTable->LastFree, 0);
@@ -637,9 +678,60 @@ ExpMoveFreeHandles(IN PHANDLE_TABLE HandleTable)
         }
     }
 
-    /* We are strict FIFO, we need to reverse the entries */
-    ASSERT(FALSE);
-    return LastFree;
+    /* We are strict FIFO, or handles got freed to the first free list in the
+       meantime. Either way, reverse the batch so the oldest free comes first */
+    Index = 0;
+    while (LastFree)
+    {
+        Handle.Value = LastFree & FREE_HANDLE_MASK;
+        Entry = ExpLookupHandleTableEntry(HandleTable, Handle);
+
+        LastFree = Entry->NextFreeTableEntry;
+        Entry->NextFreeTableEntry = Index;
+        Index = Handle.AsULONG;
+    }
+
+    /* Hold every lock so no allocation can take the tail entry away while we
+       link to it. Frees can still push in front, which doesn't matter here */
+    for (i = 1; i < 4; i++)
+    {
+        ExAcquirePushLockExclusive(&HandleTable->HandleTableLock[i]);
+    }
+
+    /* Append the batch behind whatever is on the first free list */
+    for (;;)
+    {
+        OldValue = HandleTable->FirstFree;
+        if (!OldValue)
+        {
+            /* Nothing there, the batch becomes the list */
+            if (!InterlockedCompareExchange((PLONG) &HandleTable->FirstFree, Index, 0))
+            {
+                OldValue = Index;
+                break;
+            }
+            continue;
+        }
+
+        /* Walk to the tail and link the batch */
+        Handle.Value = OldValue & FREE_HANDLE_MASK;
+        Entry = ExpLookupHandleTableEntry(HandleTable, Handle);
+        while (Entry->NextFreeTableEntry)
+        {
+            Handle.Value = Entry->NextFreeTableEntry & FREE_HANDLE_MASK;
+            Entry = ExpLookupHandleTableEntry(HandleTable, Handle);
+        }
+        Entry->NextFreeTableEntry = Index;
+        break;
+    }
+
+    /* Release the locks */
+    for (i = 3; i > 0; i--)
+    {
+        ExReleasePushLockExclusive(&HandleTable->HandleTableLock[i]);
+    }
+
+    return OldValue;
 }
 
 PHANDLE_TABLE_ENTRY
@@ -652,6 +744,28 @@ ExpAllocateHandleTableEntry(IN PHANDLE_TABLE HandleTable,
     EXHANDLE Handle, OldHandle;
     BOOLEAN Result;
     ULONG i;
+    PULONG CacheSlot;
+
+    /* Try the free handle cached for this processor first */
+    if (!HandleTable->StrictFIFO)
+    {
+        CacheSlot = ExpGetHandleCacheSlot(HandleTable);
+        if (*CacheSlot)
+        {
+            OldValue = InterlockedExchange((PLONG)CacheSlot, 0);
+            if (OldValue)
+            {
+                /* Got one without touching the free lists */
+                Handle.Value = OldValue;
+                Entry = ExpLookupHandleTableEntry(HandleTable, Handle);
+                ASSERT(Entry->Object == NULL);
+
+                InterlockedIncrement(&HandleTable->HandleCount);
+                *NewHandle = Handle;
+                return Entry;
+            }
+        }
+    }
 
     /* Start allocation loop */
     for (;;)
@@ -849,6 +963,7 @@ ExpLockHandleTableEntry(IN PHANDLE_TABLE HandleTable,
                         IN PHANDLE_TABLE_ENTRY HandleTableEntry)
 {
     LONG_PTR NewValue, OldValue;
+    ULONG SpinCount = (KeNumberProcessors > 1) ? EXP_HANDLE_LOCK_SPIN_COUNT : 0;
 
     /* Sanity check */
     ASSERT((KeGetCurrentThread()->CombinedApcDisable != 0) ||
@@ -877,6 +992,14 @@ ExpLockHandleTableEntry(IN PHANDLE_TABLE HandleTable,
             if (!OldValue) return FALSE;
         }
 
+        /* Entries are held very briefly, so spin a bit before blocking */
+        if (SpinCount)
+        {
+            SpinCount--;
+            YieldProcessor();
+            continue;
+        }
+
         /* It's locked, wait for it to be unlocked */
         ExpBlockOnLockedHandleEntry(HandleTable, HandleTableEntry);
     }
@@ -24,8 +24,16 @@ LIST_ENTRY ExpPagedLookasideListHead;
 KSPIN_LOCK ExpPagedLookasideListLock;
 LIST_ENTRY ExSystemLookasideListHead;
 LIST_ENTRY ExPoolLookasideListHead;
-GENERAL_LOOKASIDE ExpSmallNPagedPoolLookasideLists[MAXIMUM_PROCESSORS];
-GENERAL_LOOKASIDE ExpSmallPagedPoolLookasideLists[MAXIMUM_PROCESSORS];
+GENERAL_LOOKASIDE ExpSmallNPagedPoolLookasideLists[NUMBER_POOL_LOOKASIDE_LISTS];
+GENERAL_LOOKASIDE ExpSmallPagedPoolLookasideLists[NUMBER_POOL_LOOKASIDE_LISTS];
+
+/* Per-processor pool lookaside lists of the boot processor */
+GENERAL_LOOKASIDE ExpBootNPagedPoolLookasideLists[NUMBER_POOL_LOOKASIDE_LISTS];
+GENERAL_LOOKASIDE ExpBootPagedPoolLookasideLists[NUMBER_POOL_LOOKASIDE_LISTS];
+
+/* Depth tuning */
+#define EXP_LOOKASIDE_MINIMUM_DEPTH      4
+#define EXP_LOOKASIDE_MINIMUM_ALLOCATES  75
 
 /* PRIVATE FUNCTIONS *********************************************************/
 
@@ -57,34 +65,220 @@ ExInitializeSystemLookasideList(IN PGENERAL_LOOKASIDE List,
     List->LastAllocateHits = 0;
 }
 
+static
+VOID
+ExpInitializePoolLookaside(IN PGENERAL_LOOKASIDE List,
+                           IN POOL_TYPE Type,
+                           IN ULONG Size)
+{
+    /* Per-processor lists aren't linked anywhere, the balancer walks the PRCBs */
+    List->Tag = TAG_POOL_LOOKASIDE;
+    List->Type = Type;
+    List->Size = Size;
+    InitializeListHead(&List->ListEntry);
+    List->MaximumDepth = 256;
+    List->Depth = 2;
+    List->Allocate = ExAllocatePoolWithTag;
+    List->Free = ExFreePool;
+    InitializeSListHead(&List->ListHead);
+    List->TotalAllocates = 0;
+    List->AllocateHits = 0;
+    List->TotalFrees = 0;
+    List->FreeHits = 0;
+    List->LastTotalAllocates = 0;
+    List->LastAllocateHits = 0;
+}
+
+static
+VOID
+ExpBindPoolLookasides(IN PKPRCB Prcb,
+                      IN PGENERAL_LOOKASIDE NPagedLists OPTIONAL,
+                      IN PGENERAL_LOOKASIDE PagedLists OPTIONAL)
+{
+    ULONG i;
+
+    /* Loop for all pool lists */
+    for (i = 0; i < NUMBER_POOL_LOOKASIDE_LISTS; i++)
+    {
+        /* Bind the shared lists to the PRCB */
+        Prcb->PPNPagedLookasideList[i].L = &ExpSmallNPagedPoolLookasideLists[i];
+        Prcb->PPPagedLookasideList[i].L = &ExpSmallPagedPoolLookasideLists[i];
+
+        /* Without per-processor lists, use the shared ones for both */
+        if (!NPagedLists)
+        {
+            Prcb->PPNPagedLookasideList[i].P = &ExpSmallNPagedPoolLookasideLists[i];
+            Prcb->PPPagedLookasideList[i].P = &ExpSmallPagedPoolLookasideLists[i];
+            continue;
+        }
+
+        /* Initialize the per-processor lists and bind them too */
+        ExpInitializePoolLookaside(&NPagedLists[i], NonPagedPool, (i + 1) * 8);
+        ExpInitializePoolLookaside(&PagedLists[i], PagedPool, (i + 1) * 8);
+        Prcb->PPNPagedLookasideList[i].P = &NPagedLists[i];
+        Prcb->PPPagedLookasideList[i].P = &PagedLists[i];
+    }
+}
+
 VOID
 NTAPI
-INIT_FUNCTION
 ExInitPoolLookasidePointers(VOID)
 {
-    ULONG i;
     PKPRCB Prcb = KeGetCurrentPrcb();
-    PGENERAL_LOOKASIDE Entry;
 
-    /* Loop for all pool lists */
-    for (i = 0; i < MAXIMUM_PROCESSORS; i++)
+    /* The boot processor has static per-processor lists. Application
+       processors start at high IRQL where pool can't be used, so they
+       share the global lists until the balancer gives them their own */
+    if (Prcb->Number == 0)
     {
-        /* Initialize the non-paged list */
-        Entry = &ExpSmallNPagedPoolLookasideLists[i];
-        InitializeSListHead(&Entry->ListHead);
+        ExpBindPoolLookasides(Prcb,
+                              ExpBootNPagedPoolLookasideLists,
+                              ExpBootPagedPoolLookasideLists);
+    }
+    else
+    {
+        ExpBindPoolLookasides(Prcb, NULL, NULL);
+    }
+}
 
-        /* Bind to PRCB */
-        Prcb->PPNPagedLookasideList[i].P = Entry;
-        Prcb->PPNPagedLookasideList[i].L = Entry;
+static
+VOID
+ExpAllocateProcessorPoolLookasides(IN PKPRCB Prcb)
+{
+    PGENERAL_LOOKASIDE Lists;
 
-        /* Initialize the paged list */
-        Entry = &ExpSmallPagedPoolLookasideLists[i];
-        InitializeSListHead(&Entry->ListHead);
+    Lists = ExAllocatePoolWithTag(NonPagedPool,
+                                  2 * NUMBER_POOL_LOOKASIDE_LISTS * sizeof(GENERAL_LOOKASIDE),
+                                  TAG_POOL_LOOKASIDE);
+    if (!Lists) return;
+
+    /* The owner keeps using whichever list it read, both remain valid */
+    ExpBindPoolLookasides(Prcb, Lists, &Lists[NUMBER_POOL_LOOKASIDE_LISTS]);
+}
+
+static
+VOID
+ExpComputeLookasideDepth(IN PGENERAL_LOOKASIDE Lookaside,
+                         IN ULONG Misses)
+{
+    ULONG Allocates, MissRatio;
+    LONG Depth, MaximumDepth;
+
+    /* Get the allocations done since the last scan */
+    Allocates = Lookaside->TotalAllocates - Lookaside->LastTotalAllocates;
+    Lookaside->LastTotalAllocates = Lookaside->TotalAllocates;
+
+    Depth = Lookaside->Depth;
+    MaximumDepth = Lookaside->MaximumDepth;
+
+    if (Allocates < EXP_LOOKASIDE_MINIMUM_ALLOCATES)
+    {
+        /* Barely used, give the memory back */
+        Depth -= 10;
+    }
+    else
+    {
+        /* Get the miss rate in tenths of percent */
+        MissRatio = (ULONG)(((ULONGLONG)min(Misses, Allocates) * 1000) / Allocates);
+        if (MissRatio < 5)
+        {
+            /* Nearly always hit, slowly shrink */
+            Depth--;
+        }
+        else
+        {
+            /* Grow proportionally to the miss rate and to the room left */
+            Depth += ((MissRatio * (MaximumDepth - Depth)) / 2000) + 5;
+        }
+    }
+
+    /* Keep it within bounds */
+    if (Depth > MaximumDepth) Depth = MaximumDepth;
+    if (Depth < EXP_LOOKASIDE_MINIMUM_DEPTH) Depth = EXP_LOOKASIDE_MINIMUM_DEPTH;
+    Lookaside->Depth = (USHORT)Depth;
+}
+
+static
+VOID
+ExpScanPoolLookaside(IN PGENERAL_LOOKASIDE Lookaside)
+{
+    ULONG Allocates, Hits;
+
+    /* Pool lookasides count hits rather than misses */
+    Allocates = Lookaside->TotalAllocates - Lookaside->LastTotalAllocates;
+    Hits = Lookaside->AllocateHits - Lookaside->LastAllocateHits;
+    Lookaside->LastAllocateHits = Lookaside->AllocateHits;
+
+    ExpComputeLookasideDepth(Lookaside, Allocates - min(Hits, Allocates));
+}
 
-        /* Bind to PRCB */
-        Prcb->PPPagedLookasideList[i].P = Entry;
-        Prcb->PPPagedLookasideList[i].L = Entry;
+static
+VOID
+ExpScanGeneralLookasideList(IN PLIST_ENTRY ListHead,
+                            IN PKSPIN_LOCK Lock OPTIONAL)
+{
+    PLIST_ENTRY ListEntry;
+    PGENERAL_LOOKASIDE Lookaside;
+    ULONG Misses;
+    KIRQL OldIrql = PASSIVE_LEVEL;
+
+    if (Lock) KeAcquireSpinLock(Lock, &OldIrql);
+
+    for (ListEntry = ListHead->Flink;
+         ListEntry != ListHead;
+         ListEntry = ListEntry->Flink)
+    {
+        Lookaside = CONTAINING_RECORD(ListEntry, GENERAL_LOOKASIDE, ListEntry);
+
+        Misses = Lookaside->AllocateMisses - Lookaside->LastAllocateMisses;
+        Lookaside->LastAllocateMisses = Lookaside->AllocateMisses;
+
+        ExpComputeLookasideDepth(Lookaside, Misses);
+    }
+
+    if (Lock) KeReleaseSpinLock(Lock, OldIrql);
+}
+
+VOID
+NTAPI
+ExAdjustLookasideDepth(VOID)
+{
+    ULONG i, j;
+    PKPRCB Prcb;
+    PLIST_ENTRY ListEntry;
+
+    /* Tune the per-processor pool lookasides */
+    for (i = 0; i < (ULONG)KeNumberProcessors; i++)
+    {
+        Prcb = KiProcessorBlock[i];
+        if (!Prcb) continue;
+
+        /* Give processors still sharing the global lists their own */
+        if (Prcb->PPNPagedLookasideList[0].P == Prcb->PPNPagedLookasideList[0].L)
+        {
+            ExpAllocateProcessorPoolLookasides(Prcb);
+            continue;
+        }
+
+        for (j = 0; j < NUMBER_POOL_LOOKASIDE_LISTS; j++)
+        {
+            ExpScanPoolLookaside(Prcb->PPNPagedLookasideList[j].P);
+            ExpScanPoolLookaside(Prcb->PPPagedLookasideList[j].P);
+        }
     }
+
+    /* Then the shared pool lookasides */
+    for (ListEntry = ExPoolLookasideListHead.Flink;
+         ListEntry != &ExPoolLookasideListHead;
+         ListEntry = ListEntry->Flink)
+    {
+        ExpScanPoolLookaside(CONTAINING_RECORD(ListEntry, GENERAL_LOOKASIDE, ListEntry));
+    }
+
+    /* And finally the system and driver lookasides */
+    ExpScanGeneralLookasideList(&ExSystemLookasideListHead, NULL);
+    ExpScanGeneralLookasideList(&ExpNonPagedLookasideListHead, &ExpNonPagedLookasideListLock);
+    ExpScanGeneralLookasideList(&ExpPagedLookasideListHead, &ExpPagedLookasideListLock);
 }
 
 VOID
@@ -102,14 +296,14 @@ ExpInitLookasideLists(VOID)
     KeInitializeSpinLock(&ExpNonPagedLookasideListLock);
     KeInitializeSpinLock(&ExpPagedLookasideListLock);
 
-    /* Initialize the system lookaside lists */
-    for (i = 0; i < MAXIMUM_PROCESSORS; i++)
+    /* Initialize the shared pool lookaside lists */
+    for (i = 0; i < NUMBER_POOL_LOOKASIDE_LISTS; i++)
     {
         /* Initialize the non-paged list */
         ExInitializeSystemLookasideList(&ExpSmallNPagedPoolLookasideLists[i],
                                         NonPagedPool,
                                         (i + 1) * 8,
-                                        'looP',
+                                        TAG_POOL_LOOKASIDE,
                                         256,
                                         &ExPoolLookasideListHead);
 
@@ -117,7 +311,7 @@ ExpInitLookasideLists(VOID)
         ExInitializeSystemLookasideList(&ExpSmallPagedPoolLookasideLists[i],
                                         PagedPool,
                                         (i + 1) * 8,
-                                        'looP',
+                                        TAG_POOL_LOOKASIDE,
                                         256,
                                         &ExPoolLookasideListHead);
     }
@@ -16,6 +16,14 @@
 
 ULONG ExPushLockSpinCount = 0;
 
+/* Spin count used on MP systems, can be changed from the registry */
+ULONG ExpPushLockSpinLimit = 1024;
+
+#if DBG
+/* Global contention statistics, pushlocks have no room for their own */
+EXP_LOCK_STATISTICS ExpPushLockStatistics;
+#endif
+
 #undef EX_PUSH_LOCK
 #undef PEX_PUSH_LOCK
 
@@ -45,9 +53,112 @@ INIT_FUNCTION
 ExpInitializePushLocks(VOID)
 {
 #ifdef CONFIG_SMP
-    /* Initialize an internal 1024-iteration spin for MP CPUs */
+    /* Initialize an internal spin for MP CPUs, 1024 iterations by default */
     if (KeNumberProcessors > 1)
-        ExPushLockSpinCount = 1024;
+        ExPushLockSpinCount = ExpPushLockSpinLimit;
+#endif
+}
+
+#ifdef CONFIG_SMP
+/*++
+ * @name ExpSpinOnPushLock
+ *
+ *     The ExpSpinOnPushLock routine spins on a locked pushlock until it is
+ *     released, before the caller queues a wait block.
+ *
+ * @param PushLock
+ *        Pointer to the contended pushlock.
+ *
+ * @return TRUE if the pushlock was released while spinning, FALSE otherwise.
+ *
+ * @remarks Pushlocks don't know their owner, so the spin is bounded by
+ *          ExPushLockSpinCount instead. It stops as soon as someone else
+ *          queues up, since waiters are woken before spinners get a chance.
+ *
+ *--*/
+BOOLEAN
+FASTCALL
+ExpSpinOnPushLock(PEX_PUSH_LOCK PushLock)
+{
+    ULONG_PTR Value;
+    ULONG i = ExPushLockSpinCount;
+
+    do
+    {
+        /* Check if it got released, or if someone queued up */
+        Value = *(volatile ULONG_PTR *)&PushLock->Value;
+        if (!(Value & EX_PUSH_LOCK_LOCK)) return TRUE;
+        if (Value & EX_PUSH_LOCK_WAITING) break;
+
+        YieldProcessor();
+    } while (--i);
+
+    return FALSE;
+}
+#endif
+
+/*++
+ * @name ExpWaitForPushLock
+ *
+ *     The ExpWaitForPushLock routine waits for a queued pushlock wait block
+ *     to be signaled, spinning first on SMP machines.
+ *
+ * @param WaitBlock
+ *        Pointer to the wait block queued on the pushlock.
+ *
+ * @return None.
+ *
+ * @remarks This is an internal routine; on debug builds it also updates the
+ *          global pushlock contention statistics.
+ *
+ *--*/
+VOID
+FASTCALL
+ExpWaitForPushLock(PEX_PUSH_LOCK_WAIT_BLOCK WaitBlock)
+{
+#if DBG
+    ULONGLONG StartTime;
+#endif
+
+#ifdef CONFIG_SMP
+    /* Now spin on the push lock if necessary */
+    if (ExPushLockSpinCount)
+    {
+        ULONG i = ExPushLockSpinCount;
+
+        do
+        {
+            if (!(*(volatile LONG *)&WaitBlock->Flags & EX_PUSH_LOCK_WAITING))
+                break;
+
+            YieldProcessor();
+        } while (--i);
+    }
+#endif
+
+    /* Now try to remove the wait bit */
+    if (InterlockedBitTestAndReset(&WaitBlock->Flags, 1))
+    {
+        /* Nobody removed it already, let's do a full wait */
+#if DBG
+        StartTime = KeQueryInterruptTime();
+#endif
+        KeWaitForGate(&WaitBlock->WakeGate, WrPushLock, KernelMode);
+        ASSERT(WaitBlock->Signaled);
+
+#if DBG
+        /* Account for the time we were blocked */
+        InterlockedIncrement((PLONG)&ExpPushLockStatistics.Waits);
+        ExInterlockedAddLargeStatistic(&ExpPushLockStatistics.WaitTime,
+                                       (ULONG)(KeQueryInterruptTime() - StartTime));
+#endif
+    }
+#if DBG
+    else
+    {
+        /* We got woken up while spinning */
+        InterlockedIncrement((PLONG)&ExpPushLockStatistics.SpinAcquires);
+    }
 #endif
 }
 
@@ -471,7 +582,7 @@ FASTCALL
 ExfAcquirePushLockExclusive(PEX_PUSH_LOCK PushLock)
 {
     EX_PUSH_LOCK OldValue = *PushLock, NewValue, TempValue;
-    BOOLEAN NeedWake;
+    BOOLEAN NeedWake, Contended = FALSE;
     EX_PUSH_LOCK_WAIT_BLOCK Block;
     PEX_PUSH_LOCK_WAIT_BLOCK WaitBlock = &Block;
 
@@ -500,6 +611,30 @@ ExfAcquirePushLockExclusive(PEX_PUSH_LOCK PushLock)
         }
         else
         {
+            /* Account for the contention once */
+            if (!Contended)
+            {
+                Contended = TRUE;
+#if DBG
+                InterlockedIncrement((PLONG)&ExpPushLockStatistics.Contentions);
+#endif
+
+#ifdef CONFIG_SMP
+                /* Spin before queuing up, unless others are queued already */
+                if ((ExPushLockSpinCount) &&
+                    !(OldValue.Waiting) &&
+                    (ExpSpinOnPushLock(PushLock)))
+                {
+                    /* It got released, try to take it */
+#if DBG
+                    InterlockedIncrement((PLONG)&ExpPushLockStatistics.SpinAcquires);
+#endif
+                    OldValue = *PushLock;
+                    continue;
+                }
+#endif
+            }
+
             /* We'll have to create a Waitblock */
             WaitBlock->Flags = EX_PUSH_LOCK_FLAGS_EXCLUSIVE |
                                EX_PUSH_LOCK_FLAGS_WAIT;
@@ -589,32 +724,9 @@ ExfAcquirePushLockExclusive(PEX_PUSH_LOCK PushLock)
                 ExpOptimizePushLockList(PushLock, TempValue);
             }
 
-            /* Set up the Wait Gate */
+            /* Set up the Wait Gate and wait on it */
             KeInitializeGate(&WaitBlock->WakeGate);
-
-#ifdef CONFIG_SMP
-            /* Now spin on the push lock if necessary */
-            if (ExPushLockSpinCount)
-            {
-                ULONG i = ExPushLockSpinCount;
-
-                do
-                {
-                    if (!(*(volatile LONG *)&WaitBlock->Flags & EX_PUSH_LOCK_WAITING))
-                        break;
-
-                    YieldProcessor();
-                } while (--i);
-            }
-#endif
-
-            /* Now try to remove the wait bit */
-            if (InterlockedBitTestAndReset(&WaitBlock->Flags, 1))
-            {
-                /* Nobody removed it already, let's do a full wait */
-                KeWaitForGate(&WaitBlock->WakeGate, WrPushLock, KernelMode);
-                ASSERT(WaitBlock->Signaled);
-            }
+            ExpWaitForPushLock(WaitBlock);
 
             /* We shouldn't be shared anymore */
             ASSERT((WaitBlock->ShareCount == 0));
@@ -645,7 +757,7 @@ FASTCALL
 ExfAcquirePushLockShared(PEX_PUSH_LOCK PushLock)
 {
     EX_PUSH_LOCK OldValue = *PushLock, NewValue;
-    BOOLEAN NeedWake;
+    BOOLEAN NeedWake, Contended = FALSE;
     EX_PUSH_LOCK_WAIT_BLOCK Block;
     PEX_PUSH_LOCK_WAIT_BLOCK WaitBlock = &Block;
 
@@ -687,6 +799,30 @@ ExfAcquirePushLockShared(PEX_PUSH_LOCK PushLock)
         }
         else
         {
+            /* Account for the contention once */
+            if (!Contended)
+            {
+                Contended = TRUE;
+#if DBG
+                InterlockedIncrement((PLONG)&ExpPushLockStatistics.Contentions);
+#endif
+
+#ifdef CONFIG_SMP
+                /* Spin before queuing up, unless others are queued already */
+                if ((ExPushLockSpinCount) &&
+                    !(OldValue.Waiting) &&
+                    (ExpSpinOnPushLock(PushLock)))
+                {
+                    /* It got released, try to take it */
+#if DBG
+                    InterlockedIncrement((PLONG)&ExpPushLockStatistics.SpinAcquires);
+#endif
+                    OldValue = *PushLock;
+                    continue;
+                }
+#endif
+            }
+
             /* We'll have to create a Waitblock */
             WaitBlock->Flags = EX_PUSH_LOCK_FLAGS_WAIT;
             WaitBlock->ShareCount = 0;
@@ -756,32 +892,9 @@ ExfAcquirePushLockShared(PEX_PUSH_LOCK PushLock)
                 ExpOptimizePushLockList(PushLock, OldValue);
             }
 
-            /* Set up the Wait Gate */
+            /* Set up the Wait Gate and wait on it */
             KeInitializeGate(&WaitBlock->WakeGate);
-
-#ifdef CONFIG_SMP
-            /* Now spin on the push lock if necessary */
-            if (ExPushLockSpinCount)
-            {
-                ULONG i = ExPushLockSpinCount;
-
-                do
-                {
-                    if (!(*(volatile LONG *)&WaitBlock->Flags & EX_PUSH_LOCK_WAITING))
-                        break;
-
-                    YieldProcessor();
-                } while (--i);
-            }
-#endif
-
-            /* Now try to remove the wait bit */
-            if (InterlockedBitTestAndReset(&WaitBlock->Flags, 1))
-            {
-                /* Fast-path did not work, we need to do a full wait */
-                KeWaitForGate(&WaitBlock->WakeGate, WrPushLock, KernelMode);
-                ASSERT(WaitBlock->Signaled);
-            }
+            ExpWaitForPushLock(WaitBlock);
 
             /* We shouldn't be shared anymore */
             ASSERT((WaitBlock->ShareCount == 0));
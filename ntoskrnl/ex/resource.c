@@ -18,6 +18,28 @@
 #define IsOwnedExclusive(r)     (r->Flag & ResourceOwnedExclusive)
 #define IsBoostAllowed(r)       (!(r->Flag & ResourceHasDisabledPriorityBoost))
 
+#if DBG
+/* Contention statistics are kept in the otherwise unused address field */
+#define ExpResourceStatistics(r) ((PEXP_LOCK_STATISTICS)(r)->Address)
+
+/*
+ * The statistics of a resource, also hashed by the resource address, so
+ * they can still be found if the resource is initialized again without
+ * having been deleted.
+ */
+typedef struct _EXP_RESOURCE_STATISTICS
+{
+    EXP_LOCK_STATISTICS Statistics;
+    LIST_ENTRY HashLinks;
+    PERESOURCE Resource;
+} EXP_RESOURCE_STATISTICS, *PEXP_RESOURCE_STATISTICS;
+
+#define EXP_RESOURCE_STATISTICS_BUCKETS 64
+#define ExpResourceStatisticsBucket(r) \
+    (&ExpResourceStatisticsTable[((ULONG_PTR)(r) / sizeof(ERESOURCE)) % \
+                                 EXP_RESOURCE_STATISTICS_BUCKETS])
+#endif
+
 #if (!(defined(CONFIG_SMP)) && !(DBG))
 
 FORCEINLINE
@@ -76,6 +98,15 @@ KSPIN_LOCK ExpResourceSpinLock;
 LIST_ENTRY ExpSystemResourcesList;
 BOOLEAN ExResourceStrict = TRUE;
 
+/* Number of iterations to spin on a contended resource on MP systems */
+ULONG ExpResourceSpinCount = 4096;
+
+#if DBG
+/* Statistics of every contended resource, by resource address */
+LIST_ENTRY ExpResourceStatisticsTable[EXP_RESOURCE_STATISTICS_BUCKETS];
+KSPIN_LOCK ExpResourceStatisticsLock;
+#endif
+
 /* PRIVATE FUNCTIONS *********************************************************/
 
 #if DBG
@@ -168,10 +199,194 @@ NTAPI
 INIT_FUNCTION
 ExpResourceInitialization(VOID)
 {
+#if DBG
+    ULONG i;
+#endif
+
     /* Setup the timeout */
     ExpTimeout.QuadPart = Int32x32To64(4, -10000000);
     InitializeListHead(&ExpSystemResourcesList);
     KeInitializeSpinLock(&ExpResourceSpinLock);
+
+#if DBG
+    /* Setup the statistics table */
+    for (i = 0; i < EXP_RESOURCE_STATISTICS_BUCKETS; i++)
+    {
+        InitializeListHead(&ExpResourceStatisticsTable[i]);
+    }
+    KeInitializeSpinLock(&ExpResourceStatisticsLock);
+#endif
+}
+
+#if DBG
+/*++
+ * @name ExpGetResourceStatistics
+ *
+ *     The ExpGetResourceStatistics routine returns the contention statistics
+ *     of a resource, allocating them on first use.
+ *
+ * @param Resource
+ *        Pointer to the resource.
+ *
+ * @return Pointer to the statistics, or NULL if they couldn't be allocated.
+ *
+ * @remarks The resource lock must be held. Most resources are never
+ *          contended, so they never pay for the statistics.
+ *
+ *--*/
+PEXP_LOCK_STATISTICS
+NTAPI
+ExpGetResourceStatistics(IN PERESOURCE Resource)
+{
+    PEXP_RESOURCE_STATISTICS Statistics;
+    KLOCK_QUEUE_HANDLE LockHandle;
+
+    /* Check if we have them already */
+    if (ExpResourceStatistics(Resource)) return ExpResourceStatistics(Resource);
+
+    /* Allocate them */
+    Statistics = ExAllocatePoolWithTag(NonPagedPool,
+                                       sizeof(EXP_RESOURCE_STATISTICS),
+                                       TAG_RESOURCE_STATISTICS);
+    if (!Statistics) return NULL;
+
+    /* Initialize them and make them findable by the resource address */
+    RtlZeroMemory(Statistics, sizeof(EXP_RESOURCE_STATISTICS));
+    Statistics->Resource = Resource;
+    KeAcquireInStackQueuedSpinLock(&ExpResourceStatisticsLock, &LockHandle);
+    InsertHeadList(ExpResourceStatisticsBucket(Resource), &Statistics->HashLinks);
+    KeReleaseInStackQueuedSpinLock(&LockHandle);
+
+    /* Save them */
+    Resource->Address = Statistics;
+    return &Statistics->Statistics;
+}
+
+/*++
+ * @name ExpFreeResourceStatistics
+ *
+ *     The ExpFreeResourceStatistics routine frees the contention statistics
+ *     of a resource, if it has any.
+ *
+ * @param Resource
+ *        Pointer to the resource.
+ *
+ * @return None.
+ *
+ * @remarks The statistics are looked up by the resource address, so this is
+ *          safe to call on a resource that has not been initialized yet.
+ *
+ *--*/
+VOID
+NTAPI
+ExpFreeResourceStatistics(IN PERESOURCE Resource)
+{
+    PEXP_RESOURCE_STATISTICS Statistics = NULL;
+    KLOCK_QUEUE_HANDLE LockHandle;
+    PLIST_ENTRY Bucket, ListEntry;
+
+    /* Look for statistics belonging to this address and unlink them */
+    Bucket = ExpResourceStatisticsBucket(Resource);
+    KeAcquireInStackQueuedSpinLock(&ExpResourceStatisticsLock, &LockHandle);
+    for (ListEntry = Bucket->Flink; ListEntry != Bucket; ListEntry = ListEntry->Flink)
+    {
+        Statistics = CONTAINING_RECORD(ListEntry, EXP_RESOURCE_STATISTICS, HashLinks);
+        if (Statistics->Resource == Resource)
+        {
+            RemoveEntryList(ListEntry);
+            break;
+        }
+        Statistics = NULL;
+    }
+    KeReleaseInStackQueuedSpinLock(&LockHandle);
+
+    /* Free them if there were any */
+    if (Statistics) ExFreePoolWithTag(Statistics, TAG_RESOURCE_STATISTICS);
+}
+#endif
+
+/*++
+ * @name ExpSpinForResource
+ *
+ *     The ExpSpinForResource routine spins on a contended resource while its
+ *     owner is running on another processor, instead of blocking right away.
+ *
+ * @param Resource
+ *        Pointer to the contended resource.
+ *
+ * @param LockHandle
+ *        Pointer to in-stack queued spinlock. It is held on entry and on
+ *        exit, but released while spinning.
+ *
+ * @return TRUE if the lock was released and the acquire must be retried,
+ *         FALSE if the caller should wait on the resource.
+ *
+ * @remarks Critical sections protected by resources are often a few hundred
+ *          cycles long, much less than a context switch. Spinning is only
+ *          worth it if the owner can release the resource meanwhile, so it
+ *          is only done when the owner is running and nobody waits yet.
+ *
+ *          Callers must only call this routine once per acquire.
+ *
+ *--*/
+BOOLEAN
+NTAPI
+ExpSpinForResource(IN PERESOURCE Resource,
+                   IN PKLOCK_QUEUE_HANDLE LockHandle)
+{
+#if DBG
+    PEXP_LOCK_STATISTICS Statistics;
+#endif
+    ERESOURCE_THREAD OwnerThread;
+    ULONG SpinCount;
+
+#if DBG
+    /* Account for the contention */
+    Statistics = ExpGetResourceStatistics(Resource);
+    if (Statistics) Statistics->Contentions++;
+#endif
+
+    /* Nobody could release the resource while we spin on a UP machine */
+    SpinCount = ExpResourceSpinCount;
+    if (!(SpinCount) || (KeNumberProcessors == 1)) return FALSE;
+
+    /* Waiters get the resource handed over on release, don't spin behind them */
+    if ((IsExclusiveWaiting(Resource)) || (IsSharedWaiting(Resource))) return FALSE;
+
+    /*
+     * Check if the owner is running. It can't go away while it owns the
+     * resource, and owner pointers set by ExSetResourceOwnerPointer are
+     * not threads.
+     */
+    OwnerThread = Resource->OwnerEntry.OwnerThread;
+    if (!(OwnerThread) ||
+        ((OwnerThread & 3) == 3) ||
+        (((PKTHREAD)OwnerThread)->State != Running))
+    {
+        return FALSE;
+    }
+
+    /* Release the lock and spin until the resource is free */
+    ExReleaseResourceLock(Resource, LockHandle);
+    do
+    {
+        /* Stop if it's free, or if someone else started waiting */
+        if (!(*(volatile ULONG *)&Resource->ActiveEntries) ||
+            (*(volatile ULONG *)&Resource->NumberOfExclusiveWaiters) ||
+            (*(volatile ULONG *)&Resource->NumberOfSharedWaiters))
+        {
+            break;
+        }
+
+        YieldProcessor();
+    } while (--SpinCount);
+
+    /* Get the lock back and check if spinning paid off */
+    ExAcquireResourceLock(Resource, LockHandle);
+#if DBG
+    if ((Statistics) && !(Resource->ActiveEntries)) Statistics->SpinAcquires++;
+#endif
+    return TRUE;
 }
 
 /*++
@@ -627,6 +842,8 @@ ExpWaitForResource(IN PERESOURCE Resource,
     PKTHREAD Thread, OwnerThread;
 #if DBG
     KLOCK_QUEUE_HANDLE LockHandle;
+    PEXP_LOCK_STATISTICS Statistics;
+    ULONGLONG StartTime = KeQueryInterruptTime();
 #endif
 
     /* Increase contention count and use a 5 second timeout */
@@ -727,6 +944,17 @@ ExpWaitForResource(IN PERESOURCE Resource,
             }
         }
     }
+
+#if DBG
+    /* Account for the time we were blocked */
+    Statistics = ExpResourceStatistics(Resource);
+    if (Statistics)
+    {
+        InterlockedIncrement((PLONG)&Statistics->Waits);
+        ExInterlockedAddLargeStatistic(&Statistics->WaitTime,
+                                       (ULONG)(KeQueryInterruptTime() - StartTime));
+    }
+#endif
 }
 
 /* FUNCTIONS *****************************************************************/
@@ -772,7 +1000,10 @@ ExAcquireResourceExclusiveLite(IN PERESOURCE Resource,
 {
     KLOCK_QUEUE_HANDLE LockHandle;
     ERESOURCE_THREAD Thread;
-    BOOLEAN Success;
+    BOOLEAN Success, Spun = FALSE;
+#if DBG
+    PEXP_LOCK_STATISTICS Statistics;
+#endif
 
     /* Sanity check */
     ASSERT((Resource->Flag & ResourceNeverExclusive) == 0);
@@ -788,6 +1019,12 @@ ExAcquireResourceExclusiveLite(IN PERESOURCE Resource,
     ExAcquireResourceLock(Resource, &LockHandle);
     ExpCheckForApcsDisabled(LockHandle.OldIrql, Resource, (PKTHREAD)Thread);
 
+#if DBG
+    /* Account for the acquire if the resource has been contended before */
+    Statistics = ExpResourceStatistics(Resource);
+    if (Statistics) Statistics->Acquires++;
+#endif
+
     /* Check if there is a shared owner or exclusive owner */
 TryAcquire:
     if (Resource->ActiveEntries)
@@ -813,6 +1050,13 @@ TryAcquire:
             }
             else
             {
+                /* Try spinning first if the owner is about to release it */
+                if (!Spun)
+                {
+                    Spun = TRUE;
+                    if (ExpSpinForResource(Resource, &LockHandle)) goto TryAcquire;
+                }
+
                 /* Check if it has exclusive waiters */
                 if (!Resource->ExclusiveWaiters)
                 {
@@ -888,7 +1132,10 @@ ExAcquireResourceSharedLite(IN PERESOURCE Resource,
     KLOCK_QUEUE_HANDLE LockHandle;
     ERESOURCE_THREAD Thread;
     POWNER_ENTRY Owner = NULL;
-    BOOLEAN FirstEntryBusy;
+    BOOLEAN FirstEntryBusy, Spun = FALSE;
+#if DBG
+    PEXP_LOCK_STATISTICS Statistics;
+#endif
 
     /* Get the thread */
     Thread = ExGetCurrentResourceThread();
@@ -901,6 +1148,12 @@ ExAcquireResourceSharedLite(IN PERESOURCE Resource,
     ExAcquireResourceLock(Resource, &LockHandle);
     ExpCheckForApcsDisabled(LockHandle.OldIrql, Resource, (PKTHREAD)Thread);
 
+#if DBG
+    /* Account for the acquire if the resource has been contended before */
+    Statistics = ExpResourceStatistics(Resource);
+    if (Statistics) Statistics->Acquires++;
+#endif
+
     /* Check how many active entries we've got */
     while (Resource->ActiveEntries != 0)
     {
@@ -979,6 +1232,13 @@ ExAcquireResourceSharedLite(IN PERESOURCE Resource,
             ExReleaseResourceLock(Resource, &LockHandle);
             return FALSE;
         }
+
+        /* Try spinning first if the owner is about to release it */
+        if (!Spun)
+        {
+            Spun = TRUE;
+            if (ExpSpinForResource(Resource, &LockHandle)) continue;
+        }
         
         /* Check if we have a shared waiters semaphore */
         if (!Resource->SharedWaiters)
@@ -1476,6 +1736,9 @@ ExDeleteResourceLite(IN PERESOURCE Resource)
     if (Resource->OwnerTable) ExFreePoolWithTag(Resource->OwnerTable, TAG_RESOURCE_TABLE);
     if (Resource->SharedWaiters) ExFreePoolWithTag(Resource->SharedWaiters, TAG_RESOURCE_SEMAPHORE);
     if (Resource->ExclusiveWaiters) ExFreePoolWithTag(Resource->ExclusiveWaiters, TAG_RESOURCE_EVENT);
+#if DBG
+    ExpFreeResourceStatistics(Resource);
+#endif
 
     /* Return success */
     return STATUS_SUCCESS;
@@ -1583,6 +1846,11 @@ ExInitializeResourceLite(IN PERESOURCE Resource)
 {
     KLOCK_QUEUE_HANDLE LockHandle;
 
+#if DBG
+    /* Don't leak the statistics if this is initialized again without a delete */
+    ExpFreeResourceStatistics(Resource);
+#endif
+
     /* Clear the structure */
     RtlZeroMemory(Resource, sizeof(ERESOURCE));
 
@@ -1757,6 +2025,9 @@ ExReinitializeResourceLite(IN PERESOURCE Resource)
 {
     PKEVENT Event;
     PKSEMAPHORE Semaphore;
+#if DBG
+    PEXP_LOCK_STATISTICS Statistics;
+#endif
     ULONG i, Size;
     POWNER_ENTRY Owner;
 
@@ -1787,6 +2058,12 @@ ExReinitializeResourceLite(IN PERESOURCE Resource)
     Event = Resource->ExclusiveWaiters;
     if (Event) KeInitializeEvent(Event, SynchronizationEvent, FALSE);
 
+#if DBG
+    /* Reset the statistics, but keep using the same block */
+    Statistics = ExpResourceStatistics(Resource);
+    if (Statistics) RtlZeroMemory(Statistics, sizeof(EXP_LOCK_STATISTICS));
+#endif
+
     /* Clear the resource data */
     Resource->OwnerEntry.OwnerThread = 0;
     Resource->OwnerEntry.OwnerCount = 0;
@@ -2283,3 +2560,77 @@ ExReleaseResourceAndLeaveCriticalRegion(IN PERESOURCE Resource)
     /* Leave critical region */
     KeLeaveCriticalRegion();
 }
+
+#if DBG && defined(KDBG)
+
+BOOLEAN
+ExpKdbgExtLocks(ULONG Argc, PCHAR Argv[])
+{
+    PLIST_ENTRY ListEntry;
+    PERESOURCE Resource;
+    PEXP_LOCK_STATISTICS Statistics;
+    BOOLEAN Verbose = FALSE;
+    ULONG Count = 0, Contended = 0;
+
+    if (Argc > 1)
+    {
+        if (strcmp(Argv[1], "-v"))
+        {
+            KdbpPrint("Invalid parameter: %s\n", Argv[1]);
+            return TRUE;
+        }
+
+        Verbose = TRUE;
+    }
+
+    KdbpPrint("Resource\tOwner\t\tActive\tAcquires\tContended\tSpun\tWaits\tWait time (ms)\n");
+
+    /* Loop every resource in the system */
+    for (ListEntry = ExpSystemResourcesList.Flink;
+         ListEntry != &ExpSystemResourcesList;
+         ListEntry = ListEntry->Flink)
+    {
+        Resource = CONTAINING_RECORD(ListEntry, ERESOURCE, SystemResourcesList);
+        Statistics = ExpResourceStatistics(Resource);
+        Count++;
+
+        /* Only show contended ones unless asked to */
+        if (Statistics) Contended++;
+        if (!(Statistics) && !(Verbose)) continue;
+
+        if (Statistics)
+        {
+            KdbpPrint("%p\t%p\t%lu\t%lu\t\t%lu\t\t%lu\t%lu\t%I64u\n",
+                      Resource,
+                      (PVOID)Resource->OwnerEntry.OwnerThread,
+                      Resource->ActiveEntries,
+                      Statistics->Acquires,
+                      Statistics->Contentions,
+                      Statistics->SpinAcquires,
+                      Statistics->Waits,
+                      Statistics->WaitTime.QuadPart / 10000);
+        }
+        else
+        {
+            KdbpPrint("%p\t%p\t%lu\n",
+                      Resource,
+                      (PVOID)Resource->OwnerEntry.OwnerThread,
+                      Resource->ActiveEntries);
+        }
+    }
+
+    KdbpPrint("%lu resources, %lu contended, spin count %lu\n",
+              Count, Contended, ExpResourceSpinCount);
+
+    /* Push locks only have global statistics */
+    KdbpPrint("Push locks: %lu contended, %lu spun, %lu waits, %I64u ms waiting, spin count %lu\n",
+              ExpPushLockStatistics.Contentions,
+              ExpPushLockStatistics.SpinAcquires,
+              ExpPushLockStatistics.Waits,
+              ExpPushLockStatistics.WaitTime.QuadPart / 10000,
+              ExpPushLockSpinLimit);
+
+    return TRUE;
+}
+
+#endif // DBG && KDBG
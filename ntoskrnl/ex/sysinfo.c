@@ -645,8 +645,8 @@ QSI_DEF(SystemPerformanceInformation)
     Spi->PageReadIoCount = 0; /* FIXME */
     Spi->CacheReadCount = 0; /* FIXME */
     Spi->CacheIoCount = 0; /* FIXME */
-    Spi->DirtyPagesWriteCount = 0; /* FIXME */
-    Spi->DirtyWriteIoCount = 0; /* FIXME */
+    Spi->DirtyPagesWriteCount = MmSwapPagesWritten;
+    Spi->DirtyWriteIoCount = MmSwapWriteIoCount;
     Spi->MappedPagesWriteCount = 0; /* FIXME */
     Spi->MappedWriteIoCount = 0; /* FIXME */
 
@@ -671,7 +671,7 @@ QSI_DEF(SystemPerformanceInformation)
     Spi->ResidentSystemCodePage = 0; /* FIXME */
 
     Spi->TotalSystemDriverPages = 0; /* FIXME */
-    Spi->Spare3Count = 0; /* FIXME */
+    Spi->Spare3Count = MmSynchronousZeroPages;
 
     Spi->ResidentSystemCachePage = MiMemoryConsumers[MC_CACHE].PagesUsed;
     Spi->ResidentPagedPoolPage = 0; /* FIXME */
@@ -706,7 +706,7 @@ QSI_DEF(SystemPerformanceInformation)
     Spi->CcMdlReadWait = 0; /* FIXME */
     Spi->CcMdlReadNoWaitMiss = 0; /* FIXME */
     Spi->CcMdlReadWaitMiss = 0; /* FIXME */
-    Spi->CcReadAheadIos = 0; /* FIXME */
+    Spi->CcReadAheadIos = CcReadAheadIos;
     Spi->CcLazyWriteIos = CcLazyWriteIos;
     Spi->CcLazyWritePages = CcLazyWritePages;
     Spi->CcDataFlushes = CcDataFlushes;
@@ -2503,6 +2503,189 @@ QSI_DEF(SystemExtendedHandleInformation)
     return Status;
 }
 
+/* Class 0x1000 - ReactOS specific */
+QSI_DEF(SystemWorkQueueInformation)
+{
+    PSYSTEM_WORK_QUEUE_INFORMATION Info = (PSYSTEM_WORK_QUEUE_INFORMATION)Buffer;
+    PSYSTEM_WORK_QUEUE_ENTRY Entry;
+    PEXP_WORK_QUEUE Queue;
+    ULONG Count = 0, i, j;
+
+    /* Count the queues */
+    for (i = 0; i < MaximumWorkQueue; i++)
+    {
+        Count += ExpWorkQueueCount[i];
+    }
+
+    /* Check user's buffer size */
+    *ReqSize = FIELD_OFFSET(SYSTEM_WORK_QUEUE_INFORMATION, Queues[Count]);
+    if (Size < *ReqSize)
+    {
+        return STATUS_INFO_LENGTH_MISMATCH;
+    }
+
+    /* Copy the statistics of each queue */
+    Info->NumberOfQueues = Count;
+    Entry = Info->Queues;
+    for (i = 0; i < MaximumWorkQueue; i++)
+    {
+        for (j = 0; j < ExpWorkQueueCount[i]; j++)
+        {
+            Queue = &ExpWorkQueues[i][j];
+
+            Entry->QueueType = Queue->QueueType;
+            Entry->Processor = (ExpWorkQueueCount[i] > 1) ? Queue->Index : MAXULONG;
+            Entry->WorkerCount = Queue->Queue.Info.WorkerCount;
+            Entry->DynamicThreadCount = Queue->Queue.DynamicThreadCount;
+            Entry->QueueDepth = max(KeReadStateQueue(&Queue->Queue.WorkerQueue), 0);
+            Entry->WorkItemsQueued = Queue->WorkItemsQueued;
+            Entry->WorkItemsProcessed = Queue->Queue.WorkItemsProcessed;
+            Entry->WorkItemsStolen = Queue->WorkItemsStolen;
+            Entry->MaximumWaitTime = Queue->MaximumWaitTime;
+            Entry->TotalWaitTime = Queue->TotalWaitTime;
+            Entry++;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/* Class 0x1001 - ReactOS specific */
+QSI_DEF(SystemLockStatisticsInformation)
+{
+    return KeQueryLockStatistics((PSYSTEM_LOCK_STATISTICS_INFORMATION)Buffer, Size, ReqSize);
+}
+
+SSI_DEF(SystemLockStatisticsInformation)
+{
+    /* Any write clears the statistics */
+    if (!SeSinglePrivilegeCheck(SeDebugPrivilege, ExGetPreviousMode()))
+    {
+        return STATUS_ACCESS_DENIED;
+    }
+
+    return KeResetLockStatistics();
+}
+
+/* Class 0x1002 - ReactOS specific */
+QSI_DEF(SystemZeroPageInformation)
+{
+    PSYSTEM_ZERO_PAGE_INFORMATION Info = (PSYSTEM_ZERO_PAGE_INFORMATION)Buffer;
+
+    /* Check user's buffer size */
+    *ReqSize = sizeof(SYSTEM_ZERO_PAGE_INFORMATION);
+    if (Size < *ReqSize)
+    {
+        return STATUS_INFO_LENGTH_MISMATCH;
+    }
+
+    Info->ZeroedPageCount = (ULONG)MmZeroedPageListHead.Total;
+    Info->FreePageCount = (ULONG)MmFreePageListHead.Total;
+    Info->ZeroingThreads = MmZeroingPageThreads;
+    Info->ActiveZeroingThreads = MmActiveZeroingPageThreads;
+    Info->PagesZeroedByThreads = MmPagesZeroedByThreads;
+    Info->SynchronousZeroPages = MmSynchronousZeroPages;
+
+    return STATUS_SUCCESS;
+}
+
+/* Class 0x1003 - ReactOS specific */
+QSI_DEF(SystemSectionFaultInformation)
+{
+    PSYSTEM_SECTION_FAULT_INFORMATION Info = (PSYSTEM_SECTION_FAULT_INFORMATION)Buffer;
+    PSYSTEM_SECTION_FAULT_ENTRY Entry;
+    PEPROCESS Process = NULL;
+    NTSTATUS Status = STATUS_SUCCESS;
+    ULONG Count = 0;
+
+    /* Check user's buffer size for the fixed part */
+    *ReqSize = FIELD_OFFSET(SYSTEM_SECTION_FAULT_INFORMATION, Processes);
+    if (Size < *ReqSize)
+    {
+        return STATUS_INFO_LENGTH_MISMATCH;
+    }
+
+    _SEH2_TRY
+    {
+        Info->ClusterSize = MmSectionFaultClusterSize;
+
+        /* Copy the counters of every process that fits */
+        Entry = Info->Processes;
+        while ((Process = PsGetNextProcess(Process)))
+        {
+            Count++;
+            *ReqSize = FIELD_OFFSET(SYSTEM_SECTION_FAULT_INFORMATION, Processes[Count]);
+            if (Size < *ReqSize) continue;
+
+            Entry->UniqueProcessId = Process->UniqueProcessId;
+            Entry->SinglePageFaults = MmGetSectionFaultCounters(Process)->SinglePageFaults;
+            Entry->ClusteredFaults = MmGetSectionFaultCounters(Process)->ClusteredFaults;
+            Entry->ClusteredPages = MmGetSectionFaultCounters(Process)->ClusteredPages;
+            Entry++;
+        }
+
+        Info->NumberOfProcesses = Count;
+        if (Size < *ReqSize) Status = STATUS_INFO_LENGTH_MISMATCH;
+    }
+    _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
+    {
+        if (Process) ObDereferenceObject(Process);
+        Status = _SEH2_GetExceptionCode();
+    }
+    _SEH2_END;
+
+    return Status;
+}
+
+SSI_DEF(SystemSectionFaultInformation)
+{
+    ULONG ClusterSize;
+
+    /* Only the cluster size can be changed */
+    if (Size != sizeof(ULONG))
+    {
+        return STATUS_INFO_LENGTH_MISMATCH;
+    }
+
+    if (!SeSinglePrivilegeCheck(SeDebugPrivilege, ExGetPreviousMode()))
+    {
+        return STATUS_ACCESS_DENIED;
+    }
+
+    /* Read the caller's buffer only once, it might change under us */
+    ClusterSize = *(volatile ULONG *)Buffer;
+
+    /* One page disables clustering, zero is not a size */
+    if ((ClusterSize == 0) || (ClusterSize > MM_MAX_SECTION_FAULT_CLUSTER))
+    {
+        return STATUS_INVALID_PARAMETER;
+    }
+
+    MmSectionFaultClusterSize = ClusterSize;
+    return STATUS_SUCCESS;
+}
+
+/* Class 0x1004 - ReactOS specific */
+QSI_DEF(SystemPageFileWriteInformation)
+{
+    PSYSTEM_PAGE_FILE_WRITE_INFORMATION Info = (PSYSTEM_PAGE_FILE_WRITE_INFORMATION)Buffer;
+
+    /* Check user's buffer size */
+    *ReqSize = sizeof(SYSTEM_PAGE_FILE_WRITE_INFORMATION);
+    if (Size < *ReqSize)
+    {
+        return STATUS_INFO_LENGTH_MISMATCH;
+    }
+
+    Info->WriteIoCount = MmSwapWriteIoCount;
+    Info->PagesWritten = MmSwapPagesWritten;
+    Info->ModifiedPagesWritten = MmModifiedPagesWritten;
+    Info->MaximumWriteTime = MmMaximumSwapWriteTime;
+    Info->TotalWriteTime = MmSwapWriteTime;
+
+    return STATUS_SUCCESS;
+}
+
 /* Query/Set Calls Table */
 typedef
 struct _QSSI_CALLS
@@ -2596,6 +2779,40 @@ C_ASSERT(SystemBasicInformation == 0);
 #define MIN_SYSTEM_INFO_CLASS (SystemBasicInformation)
 #define MAX_SYSTEM_INFO_CLASS (sizeof(CallQS) / sizeof(CallQS[0]))
 
+/* ReactOS specific classes, starting at SystemReactOSInformationBase */
+static
+QSSI_CALLS
+CallQSReactOS [] =
+{
+    SI_QX(SystemWorkQueueInformation),
+    SI_QS(SystemLockStatisticsInformation),
+    SI_QX(SystemZeroPageInformation),
+    SI_QS(SystemSectionFaultInformation),
+    SI_QX(SystemPageFileWriteInformation),
+};
+
+#define MAX_REACTOS_INFO_CLASS \
+    (SystemReactOSInformationBase + sizeof(CallQSReactOS) / sizeof(CallQSReactOS[0]))
+
+static
+QSSI_CALLS*
+ExpGetSystemInfoCalls(IN SYSTEM_INFORMATION_CLASS SystemInformationClass)
+{
+    /* Check the NT classes first */
+    if ((ULONG)SystemInformationClass < MAX_SYSTEM_INFO_CLASS)
+        return &CallQS[SystemInformationClass];
+
+    /* Then our own ones */
+    if (((ULONG)SystemInformationClass >= SystemReactOSInformationBase) &&
+        ((ULONG)SystemInformationClass < MAX_REACTOS_INFO_CLASS))
+    {
+        return &CallQSReactOS[SystemInformationClass - SystemReactOSInformationBase];
+    }
+
+    /* Invalid class */
+    return NULL;
+}
+
 /*
  * @implemented
  */
@@ -2612,6 +2829,7 @@ NtQuerySystemInformation(
     ULONG ResultLength = 0;
     ULONG Alignment = TYPE_ALIGNMENT(ULONG);
     NTSTATUS FStatus = STATUS_NOT_IMPLEMENTED;
+    QSSI_CALLS *Calls;
 
     PAGED_CODE();
 
@@ -2623,7 +2841,8 @@ NtQuerySystemInformation(
         /*
          * Check if the request is valid.
          */
-        if (SystemInformationClass >= MAX_SYSTEM_INFO_CLASS)
+        Calls = ExpGetSystemInfoCalls(SystemInformationClass);
+        if (Calls == NULL)
         {
             _SEH2_YIELD(return STATUS_INVALID_INFO_CLASS);
         }
@@ -2647,20 +2866,21 @@ NtQuerySystemInformation(
         /*
          * Check if the request is valid.
          */
-        if (SystemInformationClass >= MAX_SYSTEM_INFO_CLASS)
+        Calls = ExpGetSystemInfoCalls(SystemInformationClass);
+        if (Calls == NULL)
         {
             _SEH2_YIELD(return STATUS_INVALID_INFO_CLASS);
         }
 #endif
 
-        if (NULL != CallQS [SystemInformationClass].Query)
+        if (NULL != Calls->Query)
         {
             /*
              * Hand the request to a subhandler.
              */
-            FStatus = CallQS [SystemInformationClass].Query(SystemInformation,
-                                                            Length,
-                                                            &ResultLength);
+            FStatus = Calls->Query(SystemInformation,
+                                   Length,
+                                   &ResultLength);
 
             /* Save the result length to the caller */
             if (UnsafeResultLength)
@@ -2685,6 +2905,7 @@ NtSetSystemInformation (IN SYSTEM_INFORMATION_CLASS SystemInformationClass,
 {
     NTSTATUS Status = STATUS_INVALID_INFO_CLASS;
     KPROCESSOR_MODE PreviousMode;
+    QSSI_CALLS *Calls;
 
     PAGED_CODE();
 
@@ -2704,17 +2925,14 @@ NtSetSystemInformation (IN SYSTEM_INFORMATION_CLASS SystemInformationClass,
         /*
          * Check the request is valid.
          */
-        if ((SystemInformationClass >= MIN_SYSTEM_INFO_CLASS) &&
-            (SystemInformationClass < MAX_SYSTEM_INFO_CLASS))
+        Calls = ExpGetSystemInfoCalls(SystemInformationClass);
+        if ((Calls != NULL) && (NULL != Calls->Set))
         {
-            if (NULL != CallQS [SystemInformationClass].Set)
-            {
-                /*
-                 * Hand the request to a subhandler.
-                 */
-                Status = CallQS [SystemInformationClass].Set(SystemInformation,
-                                                             SystemInformationLength);
-            }
+            /*
+             * Hand the request to a subhandler.
+             */
+            Status = Calls->Set(SystemInformation,
+                                SystemInformationLength);
         }
     }
     _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
@@ -26,13 +26,33 @@
 /* Magic flag for dynamic worker threads */
 #define EX_DYNAMIC_WORK_THREAD                      0x80000000
 
+/* Worker thread context: queue type in the low byte, queue index above it */
+#define EX_WORK_THREAD_CONTEXT(Type, Index)         (((Index) << 8) | (Type))
+#define EX_WORK_THREAD_QUEUE_TYPE(Context)          ((Context) & 0xFF)
+#define EX_WORK_THREAD_QUEUE_INDEX(Context)         \
+    (((Context) & ~EX_DYNAMIC_WORK_THREAD) >> 8)
+
+/* Maximum number of dynamic worker threads on a single queue */
+#define EX_MAXIMUM_DYNAMIC_WORK_THREADS             16
+
+/* Work waiting longer than this (50ms) on a stuck queue gets a new thread */
+#define EX_WORK_QUEUE_LATENCY_THRESHOLD             (50 * 10000)
+
 /* Worker thread priority increments (added to base priority) */
 #define EX_HYPERCRITICAL_QUEUE_PRIORITY_INCREMENT   7
 #define EX_CRITICAL_QUEUE_PRIORITY_INCREMENT        5
 #define EX_DELAYED_QUEUE_PRIORITY_INCREMENT         4
 
-/* The actual worker queue array */
-EX_WORK_QUEUE ExWorkerQueue[MaximumWorkQueue];
+/* The boot worker queues, one for each type */
+EXP_WORK_QUEUE ExWorkerQueue[MaximumWorkQueue];
+
+/*
+ * The actual worker queues for each type, one per processor if possible.
+ * There are no NUMA nodes to group processors by, so every processor gets
+ * its own queue instead of every node.
+ */
+PEXP_WORK_QUEUE ExpWorkQueues[MaximumWorkQueue];
+ULONG ExpWorkQueueCount[MaximumWorkQueue];
 
 /* Accounting of the total threads and registry hacked threads */
 ULONG ExCriticalWorkerThreads;
@@ -55,6 +75,199 @@ PETHREAD ExpLastWorkerThread;
 
 /* PRIVATE FUNCTIONS *********************************************************/
 
+/*++
+ * @name ExpWorkItemDequeued
+ *
+ *     The ExpWorkItemDequeued routine accounts for a work item that a worker
+ *     thread removed from the specified queue.
+ *
+ * @param WorkQueue
+ *        Queue the work item was removed from.
+ *
+ * @return None.
+ *
+ * @remarks The wait time is only known if the item's enqueue stamp was not
+ *          overwritten yet, which is the case unless the queue is very deep.
+ *
+ *--*/
+VOID
+NTAPI
+ExpWorkItemDequeued(IN PEXP_WORK_QUEUE WorkQueue)
+{
+    LONG Index;
+    ULONG WaitTime, MaximumWaitTime;
+
+    /* Increment Processed Work Items */
+    InterlockedIncrement((PLONG)&WorkQueue->Queue.WorkItemsProcessed);
+
+    /* Check if the item's enqueue stamp is still there */
+    Index = InterlockedIncrement(&WorkQueue->WorkItemsDequeued);
+    if (((ULONG)WorkQueue->WorkItemsQueued - (ULONG)Index) >=
+        EXP_WORK_QUEUE_TIME_SLOTS)
+    {
+        return;
+    }
+
+    /* Account for the time it spent on the queue */
+    WaitTime = (ULONG)KeQueryInterruptTime() -
+               WorkQueue->EnqueueTime[(ULONG)Index % EXP_WORK_QUEUE_TIME_SLOTS];
+    ExInterlockedAddLargeStatistic(&WorkQueue->TotalWaitTime, WaitTime);
+
+    /* Update the maximum, racing with other workers */
+    do
+    {
+        MaximumWaitTime = WorkQueue->MaximumWaitTime;
+        if (WaitTime <= MaximumWaitTime) break;
+    }
+    while (InterlockedCompareExchange((PLONG)&WorkQueue->MaximumWaitTime,
+                                      WaitTime,
+                                      MaximumWaitTime) != MaximumWaitTime);
+}
+
+/*++
+ * @name ExpGetWorkQueueLatency
+ *
+ *     The ExpGetWorkQueueLatency routine returns how long the oldest work
+ *     item of the specified queue has been waiting.
+ *
+ * @param WorkQueue
+ *        Queue to check.
+ *
+ * @return Waiting time of the oldest item in 100ns units, 0 if the queue is
+ *         empty, or MAXULONG if the queue is too deep to know.
+ *
+ * @remarks This is a lockless estimate, good enough for balancing decisions.
+ *
+ *--*/
+ULONG
+NTAPI
+ExpGetWorkQueueLatency(IN PEXP_WORK_QUEUE WorkQueue)
+{
+    LONG Oldest;
+
+    /* Nothing is waiting on an empty queue */
+    if (KeReadStateQueue(&WorkQueue->Queue.WorkerQueue) <= 0) return 0;
+
+    /* Check if the stamp of the oldest item was overwritten already */
+    Oldest = WorkQueue->WorkItemsDequeued + 1;
+    if (((ULONG)WorkQueue->WorkItemsQueued - (ULONG)Oldest) >=
+        EXP_WORK_QUEUE_TIME_SLOTS)
+    {
+        return MAXULONG;
+    }
+
+    /* Return how long it has been waiting */
+    return (ULONG)KeQueryInterruptTime() -
+           WorkQueue->EnqueueTime[(ULONG)Oldest % EXP_WORK_QUEUE_TIME_SLOTS];
+}
+
+/*++
+ * @name ExpSelectWorkQueue
+ *
+ *     The ExpSelectWorkQueue routine picks the queue a new work item of the
+ *     specified type goes to.
+ *
+ * @param QueueType
+ *        Type of the queue to use for this item.
+ *
+ * @return Queue to insert the item into.
+ *
+ * @remarks The queue of the current processor is preferred, so the item
+ *          runs close to the data it was queued for. If all of its workers
+ *          are busy, the item goes to another queue with an idle worker.
+ *
+ *--*/
+PEXP_WORK_QUEUE
+NTAPI
+ExpSelectWorkQueue(IN WORK_QUEUE_TYPE QueueType)
+{
+    PEXP_WORK_QUEUE WorkQueue, OtherQueue;
+    ULONG Count, Index, i;
+
+    /* Start with the queue of the current processor */
+    Count = ExpWorkQueueCount[QueueType];
+    Index = KeGetCurrentProcessorNumber() % Count;
+    WorkQueue = &ExpWorkQueues[QueueType][Index];
+
+    /* Use it if one of its workers is waiting for work */
+    if (!IsListEmpty(&WorkQueue->Queue.WorkerQueue.Header.WaitListHead))
+        return WorkQueue;
+
+    /* Otherwise, look for a queue with an idle worker */
+    for (i = 1; i < Count; i++)
+    {
+        OtherQueue = &ExpWorkQueues[QueueType][(Index + i) % Count];
+        if (!IsListEmpty(&OtherQueue->Queue.WorkerQueue.Header.WaitListHead))
+            return OtherQueue;
+    }
+
+    /* Everyone is busy, keep it local */
+    return WorkQueue;
+}
+
+/*++
+ * @name ExpStealWorkItem
+ *
+ *     The ExpStealWorkItem routine lets an idle worker thread take a work
+ *     item from another queue of the same type.
+ *
+ * @param WorkQueue
+ *        Queue of the worker thread that is about to go idle.
+ *
+ * @param SourceQueue
+ *        Receives the queue the work item was taken from.
+ *
+ * @return Queue entry of the work item, or NULL if there was nothing to take.
+ *
+ * @remarks Only queues with items that none of their own workers could pick
+ *          up are looked at, and none of them is ever waited on.
+ *
+ *--*/
+PLIST_ENTRY
+NTAPI
+ExpStealWorkItem(IN PEXP_WORK_QUEUE WorkQueue,
+                 OUT PEXP_WORK_QUEUE *SourceQueue)
+{
+    PEXP_WORK_QUEUE OtherQueue;
+    PLIST_ENTRY QueueEntry;
+    ULONG Count, i;
+
+    /* Our own queue comes first */
+    Count = ExpWorkQueueCount[WorkQueue->QueueType];
+    if ((Count == 1) || (KeReadStateQueue(&WorkQueue->Queue.WorkerQueue) > 0))
+        return NULL;
+
+    /* Start with the next queue, so thieves spread out */
+    for (i = 1; i < Count; i++)
+    {
+        OtherQueue = &ExpWorkQueues[WorkQueue->QueueType]
+                                   [(WorkQueue->Index + i) % Count];
+
+        /* Items are only left queued if no worker of that queue was idle */
+        if (KeReadStateQueue(&OtherQueue->Queue.WorkerQueue) <= 0) continue;
+
+        /*
+         * Try to take one without waiting. This must not go through
+         * KeRemoveQueue, which would make the other queue ours and break the
+         * concurrency accounting of both.
+         */
+        QueueEntry = KeTryToRemoveQueueEntry(&OtherQueue->Queue.WorkerQueue);
+        if (!QueueEntry)
+        {
+            /* Someone was faster */
+            continue;
+        }
+
+        /* Got one */
+        InterlockedIncrement(&OtherQueue->WorkItemsStolen);
+        *SourceQueue = OtherQueue;
+        return QueueEntry;
+    }
+
+    /* Nothing to do anywhere */
+    return NULL;
+}
+
 /*++
  * @name ExpWorkerThreadEntryPoint
  *
@@ -62,14 +275,17 @@ PETHREAD ExpLastWorkerThread;
  *     worker thread created by teh system.
  *
  * @param Context
- *        Contains the work queue type masked with a flag specifing whether the
- *        thread is dynamic or not.
+ *        Contains the work queue type and index masked with a flag specifing
+ *        whether the thread is dynamic or not.
  *
  * @return None.
  *
  * @remarks A dynamic thread can timeout after 10 minutes of waiting on a queue
  *          while a static thread will never timeout.
  *
+ *          Before waiting on its own queue, a worker takes work left over on
+ *          the other queues of its type.
+ *
  *          Worker threads must return at IRQL == PASSIVE_LEVEL, must not have
  *          active impersonation info, and must not have disabled APCs.
  *
@@ -83,8 +299,7 @@ ExpWorkerThreadEntryPoint(IN PVOID Context)
 {
     PWORK_QUEUE_ITEM WorkItem;
     PLIST_ENTRY QueueEntry;
-    WORK_QUEUE_TYPE WorkQueueType;
-    PEX_WORK_QUEUE WorkQueue;
+    PEXP_WORK_QUEUE WorkQueue, SourceQueue;
     LARGE_INTEGER Timeout;
     PLARGE_INTEGER TimeoutPointer = NULL;
     PETHREAD Thread = PsGetCurrentThread();
@@ -99,13 +314,12 @@ ExpWorkerThreadEntryPoint(IN PVOID Context)
         TimeoutPointer = &Timeout;
     }
 
-    /* Get Queue Type and Worker Queue */
-    WorkQueueType = (WORK_QUEUE_TYPE)((ULONG_PTR)Context &
-                                      ~EX_DYNAMIC_WORK_THREAD);
-    WorkQueue = &ExWorkerQueue[WorkQueueType];
+    /* Get the Worker Queue */
+    WorkQueue = &ExpWorkQueues[EX_WORK_THREAD_QUEUE_TYPE((ULONG_PTR)Context)]
+                              [EX_WORK_THREAD_QUEUE_INDEX((ULONG_PTR)Context)];
 
     /* Select the wait mode */
-    WaitMode = (UCHAR)WorkQueue->Info.WaitMode;
+    WaitMode = (UCHAR)WorkQueue->Queue.Info.WaitMode;
 
     /* Nobody should have initialized this yet, do it now */
     ASSERT(Thread->ExWorkerCanWaitUser == 0);
@@ -118,7 +332,7 @@ ExpWorkerThreadEntryPoint(IN PVOID Context)
     do
     {
         /* Check if the queue is being disabled */
-        if (WorkQueue->Info.QueueDisabled)
+        if (WorkQueue->Queue.Info.QueueDisabled)
         {
             /* Re-enable stack swapping and kill us */
             KeSetKernelStackSwapEnable(TRUE);
@@ -126,11 +340,11 @@ ExpWorkerThreadEntryPoint(IN PVOID Context)
         }
 
         /* Increase the worker count */
-        OldValue = WorkQueue->Info;
+        OldValue = WorkQueue->Queue.Info;
         NewValue = OldValue;
         NewValue.WorkerCount++;
     }
-    while (InterlockedCompareExchange((PLONG)&WorkQueue->Info,
+    while (InterlockedCompareExchange((PLONG)&WorkQueue->Queue.Info,
                                       *(PLONG)&NewValue,
                                       *(PLONG)&OldValue) != *(PLONG)&OldValue);
 
@@ -141,16 +355,22 @@ ExpWorkerThreadEntryPoint(IN PVOID Context)
 ProcessLoop:
     for (;;)
     {
-        /* Wait for something to happen on the queue */
-        QueueEntry = KeRemoveQueue(&WorkQueue->WorkerQueue,
-                                   WaitMode,
-                                   TimeoutPointer);
-
-        /* Check if we timed out and quit this loop in that case */
-        if ((NTSTATUS)(ULONG_PTR)QueueEntry == STATUS_TIMEOUT) break;
+        /* Help out the other queues if ours is empty */
+        QueueEntry = ExpStealWorkItem(WorkQueue, &SourceQueue);
+        if (!QueueEntry)
+        {
+            /* Wait for something to happen on the queue */
+            SourceQueue = WorkQueue;
+            QueueEntry = KeRemoveQueue(&WorkQueue->Queue.WorkerQueue,
+                                       WaitMode,
+                                       TimeoutPointer);
+
+            /* Check if we timed out and quit this loop in that case */
+            if ((NTSTATUS)(ULONG_PTR)QueueEntry == STATUS_TIMEOUT) break;
+        }
 
-        /* Increment Processed Work Items */
-        InterlockedIncrement((PLONG)&WorkQueue->WorkItemsProcessed);
+        /* Account for the Work Item */
+        ExpWorkItemDequeued(SourceQueue);
 
         /* Get the Work Item */
         WorkItem = CONTAINING_RECORD(QueueEntry, WORK_QUEUE_ITEM, List);
@@ -201,22 +421,22 @@ ProcessLoop:
     if (!IsListEmpty(&Thread->IrpList)) goto ProcessLoop;
 
     /* Don't terminate it if the queue is disabled either */
-    if (WorkQueue->Info.QueueDisabled) goto ProcessLoop;
+    if (WorkQueue->Queue.Info.QueueDisabled) goto ProcessLoop;
 
     /* Set the worker flags */
     do
     {
         /* Decrease the worker count */
-        OldValue = WorkQueue->Info;
+        OldValue = WorkQueue->Queue.Info;
         NewValue = OldValue;
         NewValue.WorkerCount--;
     }
-    while (InterlockedCompareExchange((PLONG)&WorkQueue->Info,
+    while (InterlockedCompareExchange((PLONG)&WorkQueue->Queue.Info,
                                       *(PLONG)&NewValue,
                                       *(PLONG)&OldValue) != *(PLONG)&OldValue);
 
     /* Decrement dynamic thread count */
-    InterlockedDecrement(&WorkQueue->DynamicThreadCount);
+    InterlockedDecrement(&WorkQueue->Queue.DynamicThreadCount);
 
     /* We're not a worker thread anymore */
     Thread->ActiveExWorker = FALSE;
@@ -232,8 +452,8 @@ ProcessLoop:
  *     The ExpCreateWorkerThread routine creates a new worker thread for the
  *     specified queue.
  *
- * @param QueueType
- *        Type of the queue to use for this thread. Valid values are:
+ * @param WorkQueue
+ *        Queue to use for this thread. Its type is one of:
  *          - DelayedWorkQueue
  *          - CriticalWorkQueue
  *          - HyperCriticalWorkQueue
@@ -248,19 +468,22 @@ ProcessLoop:
  *
  *          This, worker threads cannot pre-empty a normal user-mode thread.
  *
+ *          Threads of a per-processor queue prefer running on that processor.
+ *
  *--*/
 VOID
 NTAPI
-ExpCreateWorkerThread(WORK_QUEUE_TYPE WorkQueueType,
+ExpCreateWorkerThread(IN PEXP_WORK_QUEUE WorkQueue,
                       IN BOOLEAN Dynamic)
 {
     PETHREAD Thread;
     HANDLE hThread;
     ULONG Context;
     KPRIORITY Priority;
+    WORK_QUEUE_TYPE WorkQueueType = WorkQueue->QueueType;
 
-    /* Check if this is going to be a dynamic thread */
-    Context = WorkQueueType;
+    /* Let the thread know which queue it belongs to */
+    Context = EX_WORK_THREAD_CONTEXT(WorkQueueType, WorkQueue->Index);
 
     /* Add the dynamic mask */
     if (Dynamic) Context |= EX_DYNAMIC_WORK_THREAD;
@@ -278,7 +501,7 @@ ExpCreateWorkerThread(WORK_QUEUE_TYPE WorkQueueType,
     if (Dynamic)
     {
         /* Increase the count */
-        InterlockedIncrement(&ExWorkerQueue[WorkQueueType].DynamicThreadCount);
+        InterlockedIncrement(&WorkQueue->Queue.DynamicThreadCount);
     }
 
     /* Set the priority */
@@ -309,55 +532,82 @@ ExpCreateWorkerThread(WORK_QUEUE_TYPE WorkQueueType,
     /* Set the Priority */
     KeSetBasePriorityThread(&Thread->Tcb, Priority);
 
+    /* Keep the workers of a per-processor queue on their processor */
+    if (ExpWorkQueueCount[WorkQueueType] > 1)
+    {
+        KeSetIdealProcessorThread(&Thread->Tcb, (UCHAR)WorkQueue->Index);
+    }
+
     /* Dereference and close handle */
     ObDereferenceObject(Thread);
     ObCloseHandle(hThread, KernelMode);
 }
 
 /*++
- * @name ExpDetectWorkerThreadDeadlock
+ * @name ExpCheckWorkQueueLatency
  *
- *     The ExpDetectWorkerThreadDeadlock routine checks every queue and creates
- *     a dynamic thread if the queue seems to be deadlocked.
+ *     The ExpCheckWorkQueueLatency routine checks every queue and creates
+ *     a dynamic thread if work on it waits for too long.
  *
  * @param None
  *
- * @return None.
+ * @return TRUE if work is still waiting on any queue, FALSE otherwise.
  *
- * @remarks The algorithm for deciding if a new thread must be created is based
- *          on whether the queue has processed no new items in the last second,
- *          and new items are still enqueued.
+ * @remarks A new thread is created when the oldest item of a queue has been
+ *          waiting longer than the latency threshold while processors could
+ *          still run another worker, which means that the workers of the
+ *          queue are blocked. A queue that processed nothing since the last
+ *          pass while items are waiting is still treated as deadlocked.
  *
  *--*/
-VOID
+BOOLEAN
 NTAPI
-ExpDetectWorkerThreadDeadlock(VOID)
+ExpCheckWorkQueueLatency(VOID)
 {
-    ULONG i;
-    PEX_WORK_QUEUE Queue;
+    ULONG i, j;
+    PEXP_WORK_QUEUE Queue;
+    ULONG Latency;
+    BOOLEAN Deadlocked, Waiting = FALSE;
 
-    /* Loop the 3 queues */
+    /* Loop the 3 queue types */
     for (i = 0; i < MaximumWorkQueue; i++)
     {
-        /* Get the queue */
-        Queue = &ExWorkerQueue[i];
-        ASSERT(Queue->DynamicThreadCount <= 16);
-
-        /* Check if stuff is on the queue that still is unprocessed */
-        if ((Queue->QueueDepthLastPass) &&
-            (Queue->WorkItemsProcessed == Queue->WorkItemsProcessedLastPass) &&
-            (Queue->DynamicThreadCount < 16))
+        /* Loop every queue of that type */
+        for (j = 0; j < ExpWorkQueueCount[i]; j++)
         {
-            /* Stuff is still on the queue and nobody did anything about it */
-            DPRINT1("EX: Work Queue Deadlock detected: %lu\n", i);
-            ExpCreateWorkerThread(i, TRUE);
-            DPRINT1("Dynamic threads queued %d\n", Queue->DynamicThreadCount);
-        }
+            /* Get the queue */
+            Queue = &ExpWorkQueues[i][j];
+            ASSERT(Queue->Queue.DynamicThreadCount <= EX_MAXIMUM_DYNAMIC_WORK_THREADS);
+
+            /* Check for how long work has been waiting on it */
+            Latency = ExpGetWorkQueueLatency(Queue);
+            if (Latency) Waiting = TRUE;
+
+            /* Check if stuff is on the queue that nobody did anything about */
+            Deadlocked = (Queue->Queue.QueueDepthLastPass) &&
+                         (Queue->Queue.WorkItemsProcessed ==
+                          Queue->Queue.WorkItemsProcessedLastPass);
+
+            /* Check if a new thread would help */
+            if (((Deadlocked) ||
+                 ((Latency >= EX_WORK_QUEUE_LATENCY_THRESHOLD) &&
+                  (Queue->Queue.WorkerQueue.CurrentCount <
+                   Queue->Queue.WorkerQueue.MaximumCount))) &&
+                (Queue->Queue.DynamicThreadCount < EX_MAXIMUM_DYNAMIC_WORK_THREADS))
+            {
+                /* Work is stuck on the queue */
+                if (Deadlocked) DPRINT1("EX: Work Queue Deadlock detected: %lu/%lu\n", i, j);
+                ExpCreateWorkerThread(Queue, TRUE);
+                DPRINT("Dynamic threads queued %d\n", Queue->Queue.DynamicThreadCount);
+            }
 
-        /* Update our data */
-        Queue->WorkItemsProcessedLastPass = Queue->WorkItemsProcessed;
-        Queue->QueueDepthLastPass = KeReadStateQueue(&Queue->WorkerQueue);
+            /* Update our data */
+            Queue->Queue.WorkItemsProcessedLastPass = Queue->Queue.WorkItemsProcessed;
+            Queue->Queue.QueueDepthLastPass = KeReadStateQueue(&Queue->Queue.WorkerQueue);
+        }
     }
+
+    return Waiting;
 }
 
 /*++
@@ -378,25 +628,29 @@ VOID
 NTAPI
 ExpCheckDynamicThreadCount(VOID)
 {
-    ULONG i;
-    PEX_WORK_QUEUE Queue;
+    ULONG i, j;
+    PEXP_WORK_QUEUE Queue;
 
-    /* Loop the 3 queues */
+    /* Loop the 3 queue types */
     for (i = 0; i < MaximumWorkQueue; i++)
     {
-        /* Get the queue */
-        Queue = &ExWorkerQueue[i];
-
-        /* Check if still need a new thread. See ExQueueWorkItem */
-        if ((Queue->Info.MakeThreadsAsNecessary) &&
-            (!IsListEmpty(&Queue->WorkerQueue.EntryListHead)) &&
-            (Queue->WorkerQueue.CurrentCount <
-             Queue->WorkerQueue.MaximumCount) &&
-            (Queue->DynamicThreadCount < 16))
+        /* Loop every queue of that type */
+        for (j = 0; j < ExpWorkQueueCount[i]; j++)
         {
-            /* Create a new thread */
-            DPRINT1("EX: Creating new dynamic thread as requested\n");
-            ExpCreateWorkerThread(i, TRUE);
+            /* Get the queue */
+            Queue = &ExpWorkQueues[i][j];
+
+            /* Check if still need a new thread. See ExQueueWorkItem */
+            if ((Queue->Queue.Info.MakeThreadsAsNecessary) &&
+                (!IsListEmpty(&Queue->Queue.WorkerQueue.EntryListHead)) &&
+                (Queue->Queue.WorkerQueue.CurrentCount <
+                 Queue->Queue.WorkerQueue.MaximumCount) &&
+                (Queue->Queue.DynamicThreadCount < EX_MAXIMUM_DYNAMIC_WORK_THREADS))
+            {
+                /* Create a new thread */
+                DPRINT1("EX: Creating new dynamic thread as requested\n");
+                ExpCreateWorkerThread(Queue, TRUE);
+            }
         }
     }
 }
@@ -416,6 +670,9 @@ ExpCheckDynamicThreadCount(VOID)
  *          also be woken up by an event when a new thread is needed, or by the
  *          special shutdown event. This thread runs at priority 7.
  *
+ *          While work is waiting on any queue, it checks the latency of the
+ *          queues more often, so blocked workers get help quickly.
+ *
  *          This routine must run at IRQL == PASSIVE_LEVEL.
  *
  *--*/
@@ -424,9 +681,10 @@ NTAPI
 ExpWorkerThreadBalanceManager(IN PVOID Context)
 {
     KTIMER Timer;
-    LARGE_INTEGER Timeout;
+    LARGE_INTEGER Timeout, ShortTimeout;
     NTSTATUS Status;
     PVOID WaitEvents[3];
+    BOOLEAN Waiting = FALSE;
     PAGED_CODE();
     UNREFERENCED_PARAMETER(Context);
 
@@ -437,6 +695,7 @@ ExpWorkerThreadBalanceManager(IN PVOID Context)
     /* Setup the timer */
     KeInitializeTimer(&Timer);
     Timeout.QuadPart = Int32x32To64(-1, 10000000);
+    ShortTimeout.QuadPart = -EX_WORK_QUEUE_LATENCY_THRESHOLD;
 
     /* We'll wait on the periodic timer and also the emergency event */
     WaitEvents[0] = &Timer;
@@ -447,7 +706,7 @@ ExpWorkerThreadBalanceManager(IN PVOID Context)
     for (;;)
     {
         /* Wait for the timer */
-        KeSetTimer(&Timer, Timeout, NULL);
+        KeSetTimer(&Timer, Waiting ? ShortTimeout : Timeout, NULL);
         Status = KeWaitForMultipleObjects(3,
                                           WaitEvents,
                                           WaitAny,
@@ -458,13 +717,16 @@ ExpWorkerThreadBalanceManager(IN PVOID Context)
                                           NULL);
         if (Status == 0)
         {
-            /* Our timer expired. Check for deadlocks */
-            ExpDetectWorkerThreadDeadlock();
+            /* Our timer expired. Check for deadlocks and slow queues */
+            Waiting = ExpCheckWorkQueueLatency();
         }
         else if (Status == 1)
         {
             /* Someone notified us, verify if we should create a new thread */
             ExpCheckDynamicThreadCount();
+
+            /* Keep an eye on the queues for a while */
+            Waiting = TRUE;
         }
         else if (Status == 2)
         {
@@ -514,6 +776,10 @@ ExpWorkerThreadBalanceManager(IN PVOID Context)
  *
  * @remarks This routine is only called once during system initialization.
  *
+ *          On multiprocessor systems, the critical and delayed queues are
+ *          split in one queue per processor, and their built-in threads are
+ *          spread over them.
+ *
  *--*/
 VOID
 INIT_FUNCTION
@@ -521,10 +787,11 @@ NTAPI
 ExpInitializeWorkerThreads(VOID)
 {
     ULONG WorkQueueType;
-    ULONG CriticalThreads, DelayedThreads;
+    ULONG CriticalThreads, DelayedThreads, Threads;
     HANDLE ThreadHandle;
     PETHREAD Thread;
-    ULONG i;
+    PEXP_WORK_QUEUE WorkQueues;
+    ULONG i, j;
 
     /* Setup the stack swap support */
     ExInitializeFastMutex(&ExpWorkerSwapinMutex);
@@ -549,12 +816,52 @@ ExpInitializeWorkerThreads(VOID)
     for (WorkQueueType = 0; WorkQueueType < MaximumWorkQueue; WorkQueueType++)
     {
         /* Clear the structure and initialize the queue */
-        RtlZeroMemory(&ExWorkerQueue[WorkQueueType], sizeof(EX_WORK_QUEUE));
-        KeInitializeQueue(&ExWorkerQueue[WorkQueueType].WorkerQueue, 0);
+        RtlZeroMemory(&ExWorkerQueue[WorkQueueType], sizeof(EXP_WORK_QUEUE));
+        KeInitializeQueue(&ExWorkerQueue[WorkQueueType].Queue.WorkerQueue, 0);
+        ExWorkerQueue[WorkQueueType].QueueType = WorkQueueType;
+
+        /* Start with a single queue of this type */
+        ExpWorkQueues[WorkQueueType] = &ExWorkerQueue[WorkQueueType];
+        ExpWorkQueueCount[WorkQueueType] = 1;
+
+        /* The hypercritical queue has a single thread, don't split it */
+        if ((WorkQueueType == HyperCriticalWorkQueue) ||
+            (KeNumberProcessors == 1))
+        {
+            continue;
+        }
+
+        /* Allocate a queue for each processor */
+        WorkQueues = ExAllocatePoolWithTag(NonPagedPool,
+                                           KeNumberProcessors *
+                                           sizeof(EXP_WORK_QUEUE),
+                                           TAG_WORKER_QUEUE);
+        if (!WorkQueues)
+        {
+            /* Not fatal, everything just goes through the boot queue */
+            DPRINT1("EX: Failed to allocate per-processor work queues\n");
+            continue;
+        }
+
+        /* Initialize them */
+        RtlZeroMemory(WorkQueues, KeNumberProcessors * sizeof(EXP_WORK_QUEUE));
+        for (i = 0; i < (ULONG)KeNumberProcessors; i++)
+        {
+            KeInitializeQueue(&WorkQueues[i].Queue.WorkerQueue, 0);
+            WorkQueues[i].QueueType = WorkQueueType;
+            WorkQueues[i].Index = i;
+        }
+
+        /* Use them from now on */
+        ExpWorkQueues[WorkQueueType] = WorkQueues;
+        ExpWorkQueueCount[WorkQueueType] = KeNumberProcessors;
     }
 
-    /* Dynamic threads are only used for the critical queue */
-    ExWorkerQueue[CriticalWorkQueue].Info.MakeThreadsAsNecessary = TRUE;
+    /* Dynamic threads are only used for the critical queues */
+    for (i = 0; i < ExpWorkQueueCount[CriticalWorkQueue]; i++)
+    {
+        ExpWorkQueues[CriticalWorkQueue][i].Queue.Info.MakeThreadsAsNecessary = TRUE;
+    }
 
     /* Initialize the balance set manager events */
     KeInitializeEvent(&ExpThreadSetManagerEvent, SynchronizationEvent, FALSE);
@@ -562,24 +869,34 @@ ExpInitializeWorkerThreads(VOID)
                       NotificationEvent,
                       FALSE);
 
-    /* Create the built-in worker threads for the critical queue */
-    for (i = 0; i < CriticalThreads; i++)
+    /* Create the built-in worker threads for the critical queues */
+    Threads = (CriticalThreads + ExpWorkQueueCount[CriticalWorkQueue] - 1) /
+              ExpWorkQueueCount[CriticalWorkQueue];
+    for (i = 0; i < ExpWorkQueueCount[CriticalWorkQueue]; i++)
     {
-        /* Create the thread */
-        ExpCreateWorkerThread(CriticalWorkQueue, FALSE);
-        ExCriticalWorkerThreads++;
+        for (j = 0; j < Threads; j++)
+        {
+            /* Create the thread */
+            ExpCreateWorkerThread(&ExpWorkQueues[CriticalWorkQueue][i], FALSE);
+            ExCriticalWorkerThreads++;
+        }
     }
 
-    /* Create the built-in worker threads for the delayed queue */
-    for (i = 0; i < DelayedThreads; i++)
+    /* Create the built-in worker threads for the delayed queues */
+    Threads = (DelayedThreads + ExpWorkQueueCount[DelayedWorkQueue] - 1) /
+              ExpWorkQueueCount[DelayedWorkQueue];
+    for (i = 0; i < ExpWorkQueueCount[DelayedWorkQueue]; i++)
     {
-        /* Create the thread */
-        ExpCreateWorkerThread(DelayedWorkQueue, FALSE);
-        ExDelayedWorkerThreads++;
+        for (j = 0; j < Threads; j++)
+        {
+            /* Create the thread */
+            ExpCreateWorkerThread(&ExpWorkQueues[DelayedWorkQueue][i], FALSE);
+            ExDelayedWorkerThreads++;
+        }
     }
 
     /* Create the built-in worker thread for the hypercritical queue */
-    ExpCreateWorkerThread(HyperCriticalWorkQueue, FALSE);
+    ExpCreateWorkerThread(&ExWorkerQueue[HyperCriticalWorkQueue], FALSE);
 
     /* Create the balance set manager thread */
     PsCreateSystemThread(&ThreadHandle,
@@ -717,7 +1034,7 @@ NTAPI
 ExQueueWorkItem(IN PWORK_QUEUE_ITEM WorkItem,
                 IN WORK_QUEUE_TYPE QueueType)
 {
-    PEX_WORK_QUEUE WorkQueue = &ExWorkerQueue[QueueType];
+    PEXP_WORK_QUEUE WorkQueue;
     ASSERT(QueueType < MaximumWorkQueue);
     ASSERT(WorkItem->List.Flink == NULL);
 
@@ -732,9 +1049,11 @@ ExQueueWorkItem(IN PWORK_QUEUE_ITEM WorkItem,
                      0);
     }
 
-    /* Insert the Queue */
-    KeInsertQueue(&WorkQueue->WorkerQueue, &WorkItem->List);
-    ASSERT(!WorkQueue->Info.QueueDisabled);
+    /* Pick a queue and insert the item */
+    WorkQueue = ExpSelectWorkQueue(QueueType);
+    ExpWorkItemQueued(WorkQueue);
+    KeInsertQueue(&WorkQueue->Queue.WorkerQueue, &WorkItem->List);
+    ASSERT(!WorkQueue->Queue.Info.QueueDisabled);
 
     /*
      * Check if we need a new thread. Our decision is as follows:
@@ -743,16 +1062,16 @@ ExQueueWorkItem(IN PWORK_QUEUE_ITEM WorkItem,
      *  - We have CPUs which could be handling another thread
      *  - We haven't abused our usage of dynamic threads.
      */
-    if ((WorkQueue->Info.MakeThreadsAsNecessary) &&
-        (!IsListEmpty(&WorkQueue->WorkerQueue.EntryListHead)) &&
-        (WorkQueue->WorkerQueue.CurrentCount <
-         WorkQueue->WorkerQueue.MaximumCount) &&
-        (WorkQueue->DynamicThreadCount < 16))
+    if ((WorkQueue->Queue.Info.MakeThreadsAsNecessary) &&
+        (!IsListEmpty(&WorkQueue->Queue.WorkerQueue.EntryListHead)) &&
+        (WorkQueue->Queue.WorkerQueue.CurrentCount <
+         WorkQueue->Queue.WorkerQueue.MaximumCount) &&
+        (WorkQueue->Queue.DynamicThreadCount < EX_MAXIMUM_DYNAMIC_WORK_THREADS))
     {
         /* Let the balance manager know about it */
         DPRINT1("Requesting a new thread. CurrentCount: %lu. MaxCount: %lu\n",
-                WorkQueue->WorkerQueue.CurrentCount,
-                WorkQueue->WorkerQueue.MaximumCount);
+                WorkQueue->Queue.WorkerQueue.CurrentCount,
+                WorkQueue->Queue.WorkerQueue.MaximumCount);
         KeSetEvent(&ExpThreadSetManagerEvent, 0, FALSE);
     }
 }
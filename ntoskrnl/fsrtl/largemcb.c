@@ -515,6 +515,38 @@ FsRtlLookupBaseMcbEntry(IN PBASE_MCB OpaqueMcb,
 
     DPRINT("FsRtlLookupBaseMcbEntry(%p, %I64d, %p, %p, %p, %p, %p)\n", OpaqueMcb, Vbn, Lbn, SectorCountFromLbn, StartingLbn, SectorCountFromStartingLbn, Index);
 
+    /* Unless the run index is wanted, a mapped Vbn only needs a tree lookup */
+    if (!Index)
+    {
+        PBASE_MCB_INTERNAL Mcb = (PBASE_MCB_INTERNAL)OpaqueMcb;
+        LARGE_MCB_MAPPING_ENTRY NeedleRun;
+        PLARGE_MCB_MAPPING_ENTRY Run;
+
+        NeedleRun.RunStartVbn.QuadPart = Vbn;
+        NeedleRun.RunEndVbn.QuadPart = Vbn + 1;
+        NeedleRun.StartingLbn.QuadPart = ~0ULL;
+        Mcb->Mapping->Table.CompareRoutine = McbMappingIntersectCompare;
+        Run = RtlLookupElementGenericTable(&Mcb->Mapping->Table, &NeedleRun);
+        Mcb->Mapping->Table.CompareRoutine = McbMappingCompare;
+
+        if (Run)
+        {
+            if (Lbn)
+                *Lbn = Run->StartingLbn.QuadPart + (Vbn - Run->RunStartVbn.QuadPart);
+            if (SectorCountFromLbn)
+                *SectorCountFromLbn = Run->RunEndVbn.QuadPart - Vbn;
+            if (StartingLbn)
+                *StartingLbn = Run->StartingLbn.QuadPart;
+            if (SectorCountFromStartingLbn)
+                *SectorCountFromStartingLbn = Run->RunEndVbn.QuadPart - Run->RunStartVbn.QuadPart;
+
+            Result = TRUE;
+            goto quit;
+        }
+
+        /* Holes and Vbns past the last run are handled by the walk below */
+    }
+
     for (i = 0; FsRtlGetNextBaseMcbEntry(OpaqueMcb, i, &LastVbn, &LastLbn, &Count); i++)
     {
         // have we reached the target mapping?
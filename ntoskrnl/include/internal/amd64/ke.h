@@ -193,6 +193,14 @@ KeRestoreInterrupts(BOOLEAN WereEnabled)
     if (WereEnabled) _enable();
 }
 
+/* Cycle timestamp for the lock statistics, never zero */
+FORCEINLINE
+ULONG64
+KiLockStatTimestamp(VOID)
+{
+    return __rdtsc() | 1;
+}
+
 //
 // Invalidates the TLB entry for a specified address
 //
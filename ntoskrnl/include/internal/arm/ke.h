@@ -98,6 +98,15 @@ KeRestoreInterrupts(BOOLEAN WereEnabled)
     if (WereEnabled) _enable();
 }
 
+/* Cycle timestamp for the lock statistics, never zero */
+FORCEINLINE
+ULONG64
+KiLockStatTimestamp(VOID)
+{
+    /* No cheap cycle counter, only the counts will be meaningful */
+    return 1;
+}
+
 //
 // Invalidates the TLB entry for a specified address
 //
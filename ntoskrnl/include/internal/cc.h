@@ -52,6 +52,7 @@ extern LIST_ENTRY CcRegularWorkQueue;
 extern LIST_ENTRY CcPostTickWorkQueue;
 extern NPAGED_LOOKASIDE_LIST CcTwilightLookasideList;
 extern LARGE_INTEGER CcIdleDelay;
+extern ULONG CcReadAheadViews;
 
 //
 // Counters
@@ -64,6 +65,9 @@ extern ULONG CcPinReadWait;
 extern ULONG CcPinReadNoWait;
 extern ULONG CcDataPages;
 extern ULONG CcDataFlushes;
+extern ULONG CcReadAheadIos;
+extern ULONG CcReadAheadHitPages;
+extern ULONG CcReadAheadWastedPages;
 
 typedef struct _PF_SCENARIO_ID
 {
@@ -166,6 +170,14 @@ typedef struct _PFSN_PREFETCHER_GLOBALS
     LONG ActivePrefetches;
 } PFSN_PREFETCHER_GLOBALS, *PPFSN_PREFETCHER_GLOBALS;
 
+/* One page worth of VACB pointers, indexed by view number */
+#define VACB_INDEX_LEAF_SIZE (PAGE_SIZE / sizeof(PVOID))
+
+typedef struct _ROS_VACB_INDEX_LEAF
+{
+    struct _ROS_VACB *Vacbs[VACB_INDEX_LEAF_SIZE];
+} ROS_VACB_INDEX_LEAF, *PROS_VACB_INDEX_LEAF;
+
 typedef struct _ROS_SHARED_CACHE_MAP
 {
     CSHORT NodeTypeCode;
@@ -185,6 +197,9 @@ typedef struct _ROS_SHARED_CACHE_MAP
 
     /* ROS specific */
     LIST_ENTRY CacheMapVacbListHead;
+    /* Sparse index of the VACBs by view number, protected by CacheMapLock */
+    PROS_VACB_INDEX_LEAF *VacbIndex;
+    ULONG VacbIndexSize;
     ULONG TimeStamp;
     BOOLEAN PinAccess;
     KSPIN_LOCK CacheMapLock;
@@ -208,6 +223,8 @@ typedef struct _ROS_VACB
     BOOLEAN Dirty;
     /* Page out in progress */
     BOOLEAN PageOut;
+    /* Brought in by read ahead and not accessed since. */
+    BOOLEAN ReadAhead;
     ULONG MappedCount;
     /* Entry in the list of VACBs for this shared cache map. */
     LIST_ENTRY CacheMapVacbListEntry;
@@ -357,6 +374,19 @@ CcRosLookupVacb(
     LONGLONG FileOffset
 );
 
+PROS_VACB
+NTAPI
+CcRosVacbIndexGet(
+    PROS_SHARED_CACHE_MAP SharedCacheMap,
+    LONGLONG FileOffset
+);
+
+VOID
+NTAPI
+CcRosVacbIndexRemove(
+    PROS_VACB Vacb
+);
+
 VOID
 NTAPI
 CcInitCacheZeroPage(VOID);
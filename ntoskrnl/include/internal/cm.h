@@ -252,6 +252,27 @@ typedef struct _CM_NAME_CONTROL_BLOCK
     };
 } CM_NAME_CONTROL_BLOCK, *PCM_NAME_CONTROL_BLOCK;
 
+//
+// Subkey Lookup Cache, remembers both hits and misses of a KCB's subkeys
+//
+#define CM_SUBKEY_CACHE_ENTRIES                         8
+#define CM_SUBKEY_CACHE_NAME_LENGTH                     24
+
+typedef struct _CM_SUBKEY_CACHE_ENTRY
+{
+    ULONG ConvKey;
+    HCELL_INDEX Cell;
+    USHORT NameLength;
+    WCHAR Name[CM_SUBKEY_CACHE_NAME_LENGTH];
+} CM_SUBKEY_CACHE_ENTRY, *PCM_SUBKEY_CACHE_ENTRY;
+
+typedef struct _CM_SUBKEY_CACHE
+{
+    EX_PUSH_LOCK Lock;
+    ULONG Generation;
+    CM_SUBKEY_CACHE_ENTRY Entries[CM_SUBKEY_CACHE_ENTRIES];
+} CM_SUBKEY_CACHE, *PCM_SUBKEY_CACHE;
+
 //
 // Key Control Block (KCB)
 //
@@ -307,6 +328,7 @@ typedef struct _CM_KEY_CONTROL_BLOCK
          ULONG Flags : 16;
     };
     ULONG InDelayClose;
+    PCM_SUBKEY_CACHE SubKeyCache;
 } CM_KEY_CONTROL_BLOCK, *PCM_KEY_CONTROL_BLOCK;
 
 //
@@ -1014,6 +1036,21 @@ CmpCleanUpKcbCacheWithLock(
     IN BOOLEAN LockHeldExclusively
 );
 
+HCELL_INDEX
+NTAPI
+CmpFindSubKeyByNameWithCache(
+    IN PCM_KEY_CONTROL_BLOCK Kcb,
+    IN PHHIVE Hive,
+    IN PCM_KEY_NODE Node,
+    IN PCUNICODE_STRING SearchName
+);
+
+VOID
+NTAPI
+CmpInvalidateSubKeyCache(
+    IN PCM_KEY_CONTROL_BLOCK Kcb
+);
+
 VOID
 NTAPI
 CmpCleanUpSubKeyInfo(
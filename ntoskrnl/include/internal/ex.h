@@ -67,6 +67,49 @@ extern ULONG_PTR ExpDebuggerPageIn;
 VOID NTAPI ExpDebuggerWorker(IN PVOID Context);
 // #endif /* _WINKD_ */
 
+/*
+ * Executive worker queues. Critical and delayed work get one queue per
+ * processor, hypercritical work uses a single one.
+ */
+#define EXP_WORK_QUEUE_TIME_SLOTS 64
+
+typedef struct _EXP_WORK_QUEUE
+{
+    EX_WORK_QUEUE Queue;
+    WORK_QUEUE_TYPE QueueType;
+    ULONG Index;
+    LONG WorkItemsQueued;
+    LONG WorkItemsStolen;
+    LONG WorkItemsDequeued;
+    ULONG MaximumWaitTime;
+    LARGE_INTEGER TotalWaitTime;
+    ULONG EnqueueTime[EXP_WORK_QUEUE_TIME_SLOTS];
+} EXP_WORK_QUEUE, *PEXP_WORK_QUEUE;
+
+extern EXP_WORK_QUEUE ExWorkerQueue[MaximumWorkQueue];
+extern PEXP_WORK_QUEUE ExpWorkQueues[MaximumWorkQueue];
+extern ULONG ExpWorkQueueCount[MaximumWorkQueue];
+
+/*
+ * Contention statistics of executive locks, only kept on debug builds.
+ * Resources get their own once they are contended, push locks share a
+ * global one.
+ */
+typedef struct _EXP_LOCK_STATISTICS
+{
+    ULONG Acquires;
+    ULONG Contentions;
+    ULONG SpinAcquires;
+    ULONG Waits;
+    LARGE_INTEGER WaitTime;
+} EXP_LOCK_STATISTICS, *PEXP_LOCK_STATISTICS;
+
+extern ULONG ExpResourceSpinCount;
+extern ULONG ExpPushLockSpinLimit;
+#if DBG
+extern EXP_LOCK_STATISTICS ExpPushLockStatistics;
+#endif
+
 #ifdef _WIN64
 #define HANDLE_LOW_BITS (PAGE_SHIFT - 4)
 #define HANDLE_HIGH_BITS (PAGE_SHIFT - 3)
@@ -271,6 +314,10 @@ VOID
 NTAPI
 ExInitPoolLookasidePointers(VOID);
 
+VOID
+NTAPI
+ExAdjustLookasideDepth(VOID);
+
 /* Callback Functions ********************************************************/
 
 VOID
@@ -500,6 +547,23 @@ LONG
 NTAPI
 ExSystemExceptionFilter(VOID);
 
+/* WORKER QUEUES *************************************************************/
+
+FORCEINLINE
+VOID
+ExpWorkItemQueued(IN PEXP_WORK_QUEUE WorkQueue)
+{
+    LONG Index;
+
+    /*
+     * Stamp the slot of this item. Queues are FIFO, so the worker that
+     * dequeues the same sequence number knows how long the item waited.
+     */
+    Index = InterlockedIncrement(&WorkQueue->WorkItemsQueued);
+    WorkQueue->EnqueueTime[(ULONG)Index % EXP_WORK_QUEUE_TIME_SLOTS] =
+        (ULONG)KeQueryInterruptTime();
+}
+
 /* CALLBACKS *****************************************************************/
 
 FORCEINLINE
@@ -200,6 +200,14 @@ KeRestoreInterrupts(BOOLEAN WereEnabled)
     if (WereEnabled) _enable();
 }
 
+/* Cycle timestamp for the lock statistics, never zero */
+FORCEINLINE
+ULONG64
+KiLockStatTimestamp(VOID)
+{
+    return __rdtsc() | 1;
+}
+
 //
 // Registers an interrupt handler with an IDT vector
 //
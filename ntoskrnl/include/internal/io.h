@@ -86,6 +86,22 @@
 //
 #define IOP_MAX_REPARSE_TRAVERSAL 0x20
 
+//
+// Information class for the completion notification modes of a file object.
+// It's only declared for Vista targets, but the I/O Manager handles it itself
+//
+#if (NTDDI_VERSION < NTDDI_VISTA)
+#define FileIoCompletionNotificationInformation \
+    ((FILE_INFORMATION_CLASS)(FileShortNameInformation + 1))
+#endif
+
+//
+// Completion notification modes a file object supports
+//
+#define IOP_VALID_COMPLETION_NOTIFICATION_FLAGS         \
+    (FILE_SKIP_COMPLETION_PORT_ON_SUCCESS |             \
+     FILE_SKIP_SET_EVENT_ON_HANDLE)
+
 //
 // Private flags for IoCreateFile / IoParseDevice
 //
@@ -129,6 +129,22 @@ IopUpdateTransferCount(IN IOP_TRANSFER_TYPE Type, IN ULONG TransferCount)
     }
 }
 
+static
+__inline
+BOOLEAN
+IopSkipCompletionPort(IN PFILE_OBJECT FileObject,
+                      IN NTSTATUS Status,
+                      IN BOOLEAN PendingReturned)
+{
+    /*
+     * If the caller asked for it, requests that succeeded without ever
+     * going pending don't queue a packet, the caller already knows.
+     */
+    return ((FileObject->Flags & FO_SKIP_COMPLETION_PORT) &&
+            !(PendingReturned) &&
+            (NT_SUCCESS(Status)));
+}
+
 static
 __inline
 BOOLEAN
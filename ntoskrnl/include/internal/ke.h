@@ -117,6 +117,9 @@ extern LIST_ENTRY KeBugcheckCallbackListHead, KeBugcheckReasonCallbackListHead;
 extern KSPIN_LOCK BugCheckCallbackLock;
 extern KDPC KiTimerExpireDpc;
 extern KTIMER_TABLE_ENTRY KiTimerTableListHead[TIMER_TABLE_SIZE];
+extern LIST_ENTRY KiTimerOverflowListHead[TIMER_TABLE_SIZE];
+extern KSPIN_LOCK KiTimerOverflowLock;
+extern ULONGLONG KiTimerCascadeTime;
 extern FAST_MUTEX KiGenericCallDpcMutex;
 extern LIST_ENTRY KiProfileListHead, KiProfileSourceListHead;
 extern KSPIN_LOCK KiProfileLock;
@@ -293,6 +296,53 @@ KiCompleteTimer(
     IN PKSPIN_LOCK_QUEUE LockQueue
 );
 
+ULONG
+NTAPI
+KeRemoveQueueEx(
+    IN PKQUEUE Queue,
+    IN KPROCESSOR_MODE WaitMode,
+    IN BOOLEAN Alertable,
+    IN PLARGE_INTEGER Timeout OPTIONAL,
+    OUT PLIST_ENTRY *EntryArray,
+    IN ULONG Count
+);
+
+PLIST_ENTRY
+NTAPI
+KeTryToRemoveQueueEntry(
+    IN PKQUEUE Queue
+);
+
+BOOLEAN
+FASTCALL
+KiSignalTimer(
+    IN PKTIMER Timer
+);
+
+BOOLEAN
+FASTCALL
+KiRemoveOverflowTimer(
+    IN PKTIMER Timer
+);
+
+VOID
+FASTCALL
+KiCascadeOverflowTimers(
+    IN ULONGLONG InterruptTime
+);
+
+VOID
+FASTCALL
+KiRemoveAbsoluteOverflowTimers(
+    IN PLIST_ENTRY ListHead
+);
+
+VOID
+FASTCALL
+KiCoalesceDueTime(
+    IN PKTIMER Timer
+);
+
 /* gmutex.c ********************************************************************/
 
 VOID
@@ -307,6 +357,30 @@ KiAcquireFastMutex(
     IN PFAST_MUTEX FastMutex
 );
 
+/* lockstat.c ******************************************************************/
+
+#ifdef CONFIG_LOCK_STATISTICS
+VOID
+NTAPI
+KiLockStatGuardedMutexAcquired(
+    IN PKGUARDED_MUTEX GuardedMutex,
+    IN PVOID CallSite,
+    IN ULONG64 WaitStart
+);
+#endif
+
+NTSTATUS
+NTAPI
+KeQueryLockStatistics(
+    OUT PSYSTEM_LOCK_STATISTICS_INFORMATION SystemInformation,
+    IN ULONG SystemInformationLength,
+    OUT PULONG ReturnLength
+);
+
+NTSTATUS
+NTAPI
+KeResetLockStatistics(VOID);
+
 /* gate.c **********************************************************************/
 
 VOID
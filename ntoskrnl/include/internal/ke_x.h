@@ -226,6 +226,17 @@ KiReleasePrcbLock(IN PKPRCB Prcb)
     UNREFERENCED_PARAMETER(Prcb);
 }
 
+//
+// This routine protects against multiple CPU acquires, it's meaningless on UP.
+//
+FORCEINLINE
+BOOLEAN
+KiTryToAcquirePrcbLock(IN PKPRCB Prcb)
+{
+    UNREFERENCED_PARAMETER(Prcb);
+    return TRUE;
+}
+
 //
 // This routine protects against multiple CPU acquires, it's meaningless on UP.
 //
@@ -450,6 +461,28 @@ KiAcquirePrcbLock(IN PKPRCB Prcb)
     }
 }
 
+//
+// This routine attempts to acquire the PRCB lock without spinning. It is
+// used when looking at another processor's PRCB, where waiting on a busy
+// lock is not worth it.
+//
+// Since this is a simple optimized spin-lock, it must only be acquired
+// at dispatcher level or higher!
+//
+FORCEINLINE
+BOOLEAN
+KiTryToAcquirePrcbLock(IN PKPRCB Prcb)
+{
+    /* Make sure we're at a safe level to touch the PRCB lock */
+    ASSERT(KeGetCurrentIrql() >= DISPATCH_LEVEL);
+
+    /* Don't bother with the interlocked operation if it's obviously held */
+    if (Prcb->PrcbLock) return FALSE;
+
+    /* Try to acquire it once */
+    return (InterlockedExchange((PLONG)&Prcb->PrcbLock, 1) == 0);
+}
+
 //
 // This routine releases the PRCB lock so that other callers can touch
 // volatile PRCB data.
@@ -875,6 +908,17 @@ KiComputeTimerTableIndex(IN ULONGLONG DueTime)
     return (DueTime / KeMaximumIncrement) & (TIMER_TABLE_SIZE - 1);
 }
 
+//
+// The cascade time is updated under the overflow lock on one CPU and read
+// by the clock interrupt of every CPU, so both halves must be read at once
+//
+FORCEINLINE
+ULONGLONG
+KiReadTimerCascadeTime(VOID)
+{
+    return (ULONGLONG)InterlockedCompareExchange64((PLONGLONG)&KiTimerCascadeTime, 0, 0);
+}
+
 //
 // Called from KiCompleteTimer, KiInsertTreeTimer, KeSetSystemTime
 // to remove timer entries
@@ -978,6 +1022,9 @@ KiComputeDueTime(IN PKTIMER Timer,
     /* Recalculate due time */
     Timer->DueTime.QuadPart = InterruptTime.QuadPart - DueTime.QuadPart;
 
+    /* Let coalescable timers expire together on a shared boundary */
+    if (Timer->Header.Coalescable) KiCoalesceDueTime(Timer);
+
     /* Get the handle */
     *Hand = KiComputeTimerTableIndex(Timer->DueTime.QuadPart);
     Timer->Header.Hand = (UCHAR)*Hand;
@@ -1004,8 +1051,9 @@ KxRemoveTreeTimer(IN PKTIMER Timer)
     /* Set the timer as non-inserted */
     Timer->Header.Inserted = FALSE;
 
-    /* Remove it from the timer list */
-    if (RemoveEntryList(&Timer->TimerListEntry))
+    /* Remove it from the overflow wheel, or from the timer list */
+    if (!(KiRemoveOverflowTimer(Timer)) &&
+        (RemoveEntryList(&Timer->TimerListEntry)))
     {
         /* Get the entry and check if it's empty */
         TimerEntry = &KiTimerTableListHead[Hand];
@@ -1508,6 +1556,9 @@ VOID
 _KeAcquireGuardedMutexUnsafe(IN OUT PKGUARDED_MUTEX GuardedMutex)
 {
     PKTHREAD Thread = KeGetCurrentThread();
+#ifdef CONFIG_LOCK_STATISTICS
+    ULONG64 WaitStart = 0;
+#endif
 
     /* Sanity checks */
     ASSERT((KeGetCurrentIrql() == APC_LEVEL) ||
@@ -1519,12 +1570,18 @@ _KeAcquireGuardedMutexUnsafe(IN OUT PKGUARDED_MUTEX GuardedMutex)
     /* Remove the lock */
     if (!InterlockedBitTestAndReset(&GuardedMutex->Count, GM_LOCK_BIT_V))
     {
+#ifdef CONFIG_LOCK_STATISTICS
+        WaitStart = KiLockStatTimestamp();
+#endif
         /* The Guarded Mutex was already locked, enter contented case */
         KiAcquireGuardedMutex(GuardedMutex);
     }
 
     /* Set the Owner */
     GuardedMutex->Owner = Thread;
+#ifdef CONFIG_LOCK_STATISTICS
+    KiLockStatGuardedMutexAcquired(GuardedMutex, _ReturnAddress(), WaitStart);
+#endif
 }
 
 FORCEINLINE
@@ -1573,6 +1630,9 @@ VOID
 _KeAcquireGuardedMutex(IN PKGUARDED_MUTEX GuardedMutex)
 {
     PKTHREAD Thread = KeGetCurrentThread();
+#ifdef CONFIG_LOCK_STATISTICS
+    ULONG64 WaitStart = 0;
+#endif
 
     /* Sanity checks */
     ASSERT(KeGetCurrentIrql() <= APC_LEVEL);
@@ -1584,6 +1644,9 @@ _KeAcquireGuardedMutex(IN PKGUARDED_MUTEX GuardedMutex)
     /* Remove the lock */
     if (!InterlockedBitTestAndReset(&GuardedMutex->Count, GM_LOCK_BIT_V))
     {
+#ifdef CONFIG_LOCK_STATISTICS
+        WaitStart = KiLockStatTimestamp();
+#endif
         /* The Guarded Mutex was already locked, enter contented case */
         KiAcquireGuardedMutex(GuardedMutex);
     }
@@ -1591,6 +1654,9 @@ _KeAcquireGuardedMutex(IN PKGUARDED_MUTEX GuardedMutex)
     /* Set the Owner and Special APC Disable state */
     GuardedMutex->Owner = Thread;
     GuardedMutex->SpecialApcDisable = Thread->SpecialApcDisable;
+#ifdef CONFIG_LOCK_STATISTICS
+    KiLockStatGuardedMutexAcquired(GuardedMutex, _ReturnAddress(), WaitStart);
+#endif
 }
 
 FORCEINLINE
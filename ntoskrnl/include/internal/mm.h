@@ -15,6 +15,16 @@ extern PFN_NUMBER MmLowestPhysicalPage;
 extern PFN_NUMBER MmHighestPhysicalPage;
 extern PFN_NUMBER MmAvailablePages;
 extern PFN_NUMBER MmResidentAvailablePages;
+extern ULONG MmZeroingPageThreads;
+extern ULONG MmActiveZeroingPageThreads;
+extern ULONG MmPagesZeroedByThreads;
+extern ULONG MmSynchronousZeroPages;
+extern ULONG MmSectionFaultClusterSize;
+extern ULONG MmSwapWriteIoCount;
+extern ULONG MmSwapPagesWritten;
+extern LARGE_INTEGER MmSwapWriteTime;
+extern ULONG MmMaximumSwapWriteTime;
+extern ULONG MmModifiedPagesWritten;
 extern ULONG MmThrottleTop;
 extern ULONG MmThrottleBottom;
 
@@ -231,6 +241,45 @@ typedef struct _MEMORY_AREA
     } Data;
 } MEMORY_AREA, *PMEMORY_AREA;
 
+//
+// Largest number of pages read in around a section fault
+//
+#define MM_MAX_SECTION_FAULT_CLUSTER    32
+
+//
+// Per process section fault counters, see SystemSectionFaultInformation.
+// The public EPROCESS layout has no room for them, so they live in its
+// spare pointers.
+//
+typedef struct _MM_SECTION_FAULT_COUNTERS
+{
+    ULONG SinglePageFaults;
+    ULONG ClusteredFaults;
+    ULONG ClusteredPages;
+} MM_SECTION_FAULT_COUNTERS, *PMM_SECTION_FAULT_COUNTERS;
+
+C_ASSERT(sizeof(MM_SECTION_FAULT_COUNTERS) <= RTL_FIELD_SIZE(EPROCESS, Spare0));
+
+#define MmGetSectionFaultCounters(Process) \
+    ((PMM_SECTION_FAULT_COUNTERS)(Process)->Spare0)
+
+//
+// Maximum number of pages written to the page file in one go
+//
+#define MM_SWAP_WRITE_CLUSTER    16
+
+//
+// A page being written ahead of trimming by the modified page writer
+//
+typedef struct _MM_SWAP_WRITE_ENTRY
+{
+    PFN_NUMBER Page;
+    PEPROCESS Process;
+    PMM_SECTION_SEGMENT Segment;
+    LARGE_INTEGER Offset;
+    ULONG_PTR SectionEntry;
+} MM_SWAP_WRITE_ENTRY, *PMM_SWAP_WRITE_ENTRY;
+
 typedef struct _MM_RMAP_ENTRY
 {
    struct _MM_RMAP_ENTRY* Next;
@@ -602,6 +651,13 @@ SWAPENTRY
 NTAPI
 MmAllocSwapPage(VOID);
 
+ULONG
+NTAPI
+MmAllocSwapPages(
+    ULONG Count,
+    PSWAPENTRY SwapEntries
+);
+
 VOID
 NTAPI
 MmFreeSwapPage(SWAPENTRY Entry);
@@ -628,6 +684,14 @@ MmWriteToSwapPage(
     PFN_NUMBER Page
 );
 
+NTSTATUS
+NTAPI
+MmWriteToSwapPages(
+    PSWAPENTRY SwapEntries,
+    PPFN_NUMBER Pages,
+    ULONG Count
+);
+
 VOID
 NTAPI
 MmShowOutOfSpaceMessagePagingFile(VOID);
@@ -868,6 +932,17 @@ NTSTATUS
 NTAPI
 MmPageOutPhysicalAddress(PFN_NUMBER Page);
 
+NTSTATUS
+NTAPI
+MmPrepareSwapWritePhysicalAddress(PMM_SWAP_WRITE_ENTRY SwapWrite);
+
+VOID
+NTAPI
+MmCompleteSwapWritePhysicalAddress(
+    PMM_SWAP_WRITE_ENTRY SwapWrite,
+    SWAPENTRY SwapEntry
+);
+
 /* freelist.c **********************************************************/
 
 FORCEINLINE
@@ -1308,6 +1383,22 @@ MmPageOutSectionView(
     ULONG_PTR Entry
 );
 
+NTSTATUS
+NTAPI
+MmPrepareSwapWriteSectionView(
+    PMMSUPPORT AddressSpace,
+    PMEMORY_AREA MemoryArea,
+    PVOID Address,
+    PMM_SWAP_WRITE_ENTRY SwapWrite
+);
+
+VOID
+NTAPI
+MmCompleteSwapWriteSectionView(
+    PMM_SWAP_WRITE_ENTRY SwapWrite,
+    SWAPENTRY SwapEntry
+);
+
 NTSTATUS
 NTAPI
 MmCreatePhysicalMemorySection(VOID);
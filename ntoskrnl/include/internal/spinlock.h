@@ -10,6 +10,14 @@ VOID
 NTAPI
 Kii386SpinOnSpinLock(PKSPIN_LOCK SpinLock, ULONG Flags);
 
+VOID
+NTAPI
+KiLockStatSpinLockAcquired(PKSPIN_LOCK SpinLock, PVOID CallSite, ULONG64 SpinStart);
+
+VOID
+NTAPI
+KiLockStatSpinLockReleased(PKSPIN_LOCK SpinLock);
+
 #ifndef CONFIG_SMP
 
 //
@@ -51,6 +59,9 @@ FORCEINLINE
 VOID
 KxAcquireSpinLock(IN PKSPIN_LOCK SpinLock)
 {
+#ifdef CONFIG_LOCK_STATISTICS
+    ULONG64 SpinStart = 0;
+#endif
 #if DBG
     /* Make sure that we don't own the lock already */
     if (((KSPIN_LOCK)KeGetCurrentThread() | 1) == *SpinLock)
@@ -63,6 +74,10 @@ KxAcquireSpinLock(IN PKSPIN_LOCK SpinLock)
     /* Try to acquire the lock */
     while (InterlockedBitTestAndSet((PLONG)SpinLock, 0))
     {
+#ifdef CONFIG_LOCK_STATISTICS
+        /* Remember when we started spinning */
+        if (!SpinStart) SpinStart = KiLockStatTimestamp();
+#endif
 #if defined(_M_IX86) && DBG
         /* On x86 debug builds, we use a much slower but useful routine */
         Kii386SpinOnSpinLock(SpinLock, 5);
@@ -79,6 +94,10 @@ KxAcquireSpinLock(IN PKSPIN_LOCK SpinLock)
     /* On debug builds, we OR in the KTHREAD */
     *SpinLock = (KSPIN_LOCK)KeGetCurrentThread() | 1;
 #endif
+#ifdef CONFIG_LOCK_STATISTICS
+    /* Account the acquisition to whoever called the function we're inlined in */
+    KiLockStatSpinLockAcquired(SpinLock, _ReturnAddress(), SpinStart);
+#endif
 }
 
 //
@@ -95,6 +114,10 @@ KxReleaseSpinLock(IN PKSPIN_LOCK SpinLock)
         /* They don't, bugcheck */
         KeBugCheckEx(SPIN_LOCK_NOT_OWNED, (ULONG_PTR)SpinLock, 0, 0, 0);
     }
+#endif
+#ifdef CONFIG_LOCK_STATISTICS
+    /* Record the hold time while we still own the lock */
+    KiLockStatSpinLockReleased(SpinLock);
 #endif
     /* Clear the lock */
     InterlockedAnd((PLONG)SpinLock, 0);
@@ -6,6 +6,7 @@
 #define TAG_SHARED_CACHE_MAP    'cScC'
 #define TAG_PRIVATE_CACHE_MAP   'cPcC'
 #define TAG_BCB                 'cBcC'
+#define TAG_VACB_INDEX          'iVcC'
 
 /* Executive Callbacks */
 #define TAG_CALLBACK_ROUTINE_BLOCK 'brbC'
@@ -18,10 +19,17 @@
 #define TAG_RESOURCE_TABLE      'aTeR'
 #define TAG_RESOURCE_EVENT      'aTeR'
 #define TAG_RESOURCE_SEMAPHORE  'aTeR'
+#define TAG_RESOURCE_STATISTICS 'sTeR'
 
 /* formerly located in ex/handle.c */
 #define TAG_OBJECT_TABLE 'btbO'
 
+/* formerly located in ex/lookas.c */
+#define TAG_POOL_LOOKASIDE 'looP'
+
+/* Executive Worker Queues */
+#define TAG_WORKER_QUEUE 'QkrW'
+
 /* formerly located in ex/init.c */
 #define TAG_INIT 'tinI'
 #define TAG_RTLI 'iltR'
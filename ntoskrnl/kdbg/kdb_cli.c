@@ -95,6 +95,8 @@ BOOLEAN ExpKdbgExtPool(ULONG Argc, PCHAR Argv[]);
 BOOLEAN ExpKdbgExtPoolUsed(ULONG Argc, PCHAR Argv[]);
 BOOLEAN ExpKdbgExtFileCache(ULONG Argc, PCHAR Argv[]);
 BOOLEAN ExpKdbgExtDefWrites(ULONG Argc, PCHAR Argv[]);
+BOOLEAN ExpKdbgExtLocks(ULONG Argc, PCHAR Argv[]);
+BOOLEAN KiKdbgExtLockStat(ULONG Argc, PCHAR Argv[]);
 
 #ifdef __ROS_DWARF__
 static BOOLEAN KdbpCmdPrintStruct(ULONG Argc, PCHAR Argv[]);
@@ -187,9 +189,11 @@ static const struct
     { "kmsg", "kmsg", "Kernel dmesg. Alias for dmesg.", KdbpCmdDmesg },
     { "help", "help", "Display help screen.", KdbpCmdHelp },
     { "!pool", "!pool [Address [Flags]]", "Display information about pool allocations.", ExpKdbgExtPool },
-    { "!poolused", "!poolused [Flags [Tag]]", "Display pool usage.", ExpKdbgExtPoolUsed },
+    { "!poolused", "!poolused [Flags [Tag]]", "Display pool usage. Flag 2 adds lookaside hit rates.", ExpKdbgExtPoolUsed },
     { "!filecache", "!filecache", "Display cache usage.", ExpKdbgExtFileCache },
     { "!defwrites", "!defwrites", "Display cache write values.", ExpKdbgExtDefWrites },
+    { "!locks", "!locks [-v]", "Display contention statistics of resources and push locks. -v shows all resources.", ExpKdbgExtLocks },
+    { "!lockstat", "!lockstat [Count | -r]", "Display the most contended spinlocks and guarded mutexes with their call sites. -r clears the statistics.", KiKdbgExtLockStat },
 };
 
 /* FUNCTIONS *****************************************************************/
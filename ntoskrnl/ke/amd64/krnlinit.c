@@ -182,7 +182,11 @@ KiInitializeKernel(IN PKPROCESS InitProcess,
         InitializeListHead(&KiTimerTableListHead[i].Entry);
         KiTimerTableListHead[i].Time.HighPart = 0xFFFFFFFF;
         KiTimerTableListHead[i].Time.LowPart = 0;
+
+        /* Initialize the overflow wheel for far away timers */
+        InitializeListHead(&KiTimerOverflowListHead[i]);
     }
+    KeInitializeSpinLock(&KiTimerOverflowLock);
 
     /* Initialize the Swap event and all swap lists */
     KeInitializeEvent(&KiSwapEvent, SynchronizationEvent, FALSE);
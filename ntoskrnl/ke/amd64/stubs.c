@@ -162,6 +162,13 @@ KiIdleLoop(VOID)
             /* Go back to DISPATCH_LEVEL */
             KeLowerIrql(DISPATCH_LEVEL);
         }
+#ifdef CONFIG_SMP
+        else if ((Prcb->IdleSchedule) && (KiIdleSchedule(Prcb)))
+        {
+            /* We picked up a thread from another processor, go run it */
+            continue;
+        }
+#endif
         else
         {
             /* Continue staying idle. Note the HAL returns with interrupts on */
@@ -354,6 +361,13 @@ KiSystemCallHandler(
     /* Get descriptor table */
     DescriptorTable = (PVOID)((ULONG_PTR)Thread->ServiceTable + Offset);
 
+    /* Check if this is a GUI call */
+    if (Offset & SERVICE_TABLE_TEST)
+    {
+        /* Get the batch count and flush if necessary */
+        if (NtCurrentTeb()->GdiBatchCount) KeGdiFlushUserBatch();
+    }
+
     /* Get stack bytes and calculate argument count */
     Count = DescriptorTable->Number[ServiceNumber] / 8;
 
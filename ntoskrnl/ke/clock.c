@@ -106,6 +106,9 @@ KeSetSystemTime(IN PLARGE_INTEGER NewTime,
         KiReleaseTimerLock(LockQueue);
     }
 
+    /* Absolute timers waiting on the overflow wheel need a new due time too */
+    KiRemoveAbsoluteOverflowTimers(&TempList);
+
     /* Setup a temporary list of expired timers */
     InitializeListHead(&TempList2);
 
@@ -125,6 +125,12 @@ KiTimerExpiration(IN PKDPC Dpc,
     /* Lock the Database and Raise IRQL */
     OldIrql = KiAcquireDispatcherLock();
 
+    /* Move timers that are now close enough from the overflow wheel */
+    if (KiReadTimerCascadeTime() <= InterruptTime.QuadPart)
+    {
+        KiCascadeOverflowTimers(InterruptTime.QuadPart);
+    }
+
     /* Start expiration loop */
     do
     {
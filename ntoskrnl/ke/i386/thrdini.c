@@ -314,6 +314,13 @@ KiIdleLoop(VOID)
             /* Switch away from the idle thread */
             KiSwapContext(APC_LEVEL, OldThread);
         }
+#ifdef CONFIG_SMP
+        else if ((Prcb->IdleSchedule) && (KiIdleSchedule(Prcb)))
+        {
+            /* We picked up a thread from another processor, go run it */
+            continue;
+        }
+#endif
         else
         {
             /* Continue staying idle. Note the HAL returns with interrupts on */
@@ -0,0 +1,449 @@
+/*
+ * PROJECT:         ReactOS Kernel
+ * LICENSE:         GPL - See COPYING in the top level directory
+ * FILE:            ntoskrnl/ke/lockstat.c
+ * PURPOSE:         Lock Contention Statistics for Spinlocks and Guarded Mutexes
+ */
+
+/* INCLUDES ******************************************************************/
+
+#include <ntoskrnl.h>
+#define NDEBUG
+#include <debug.h>
+
+#ifdef CONFIG_LOCK_STATISTICS
+
+/* GLOBALS *******************************************************************/
+
+/* Per-processor table of lock and call site pairs, must be a power of two */
+#define KI_LOCK_STAT_HASH_BITS      8
+#define KI_LOCK_STAT_ENTRIES        (1 << KI_LOCK_STAT_HASH_BITS)
+#define KI_LOCK_STAT_PROBES         8
+
+/* Spinlocks held at once on a processor whose hold time we can track */
+#define KI_LOCK_STAT_HELD_LOCKS     16
+
+/* Most entries the debugger extension shows */
+#define KI_LOCK_STAT_MAX_TOP        64
+
+#define KI_LOCK_STAT_HASH(Lock, CallSite)                                   \
+    (((((ULONG)(ULONG_PTR)(Lock)) ^ (((ULONG)(ULONG_PTR)(CallSite)) << 4)) * \
+      0x9E3779B1) >> (32 - KI_LOCK_STAT_HASH_BITS))
+
+typedef struct _KI_LOCK_STAT_HELD
+{
+    PVOID Lock;
+    PSYSTEM_LOCK_STATISTICS_ENTRY Entry;
+    ULONG64 AcquireTime;
+} KI_LOCK_STAT_HELD, *PKI_LOCK_STAT_HELD;
+
+typedef struct _KI_LOCK_STAT_PROCESSOR
+{
+    SYSTEM_LOCK_STATISTICS_ENTRY Entries[KI_LOCK_STAT_ENTRIES];
+    KI_LOCK_STAT_HELD Held[KI_LOCK_STAT_HELD_LOCKS];
+    ULONG HeldCount;
+    ULONG Dropped;
+} KI_LOCK_STAT_PROCESSOR, *PKI_LOCK_STAT_PROCESSOR;
+
+/*
+ * Each processor only ever writes to its own table, with interrupts disabled,
+ * so recording never needs a lock of its own. Readers add the tables up.
+ */
+static KI_LOCK_STAT_PROCESSOR KiLockStatProcessors[MAXIMUM_PROCESSORS];
+
+/* PRIVATE FUNCTIONS *********************************************************/
+
+static
+PSYSTEM_LOCK_STATISTICS_ENTRY
+KiLockStatFindEntry(IN PKI_LOCK_STAT_PROCESSOR Processor,
+                    IN PVOID Lock,
+                    IN PVOID CallSite)
+{
+    PSYSTEM_LOCK_STATISTICS_ENTRY Entry;
+    ULONG Hash, i;
+
+    /* Probe a few slots after the hashed one */
+    Hash = KI_LOCK_STAT_HASH(Lock, CallSite);
+    for (i = 0; i < KI_LOCK_STAT_PROBES; i++)
+    {
+        Entry = &Processor->Entries[(Hash + i) & (KI_LOCK_STAT_ENTRIES - 1)];
+        if (!Entry->Lock) break;
+        if ((Entry->Lock == Lock) && (Entry->CallSite == CallSite)) return Entry;
+    }
+
+    return NULL;
+}
+
+static
+PSYSTEM_LOCK_STATISTICS_ENTRY
+KiLockStatGetEntry(IN PKI_LOCK_STAT_PROCESSOR Processor,
+                   IN PVOID Lock,
+                   IN PVOID CallSite,
+                   IN ULONG Type)
+{
+    PSYSTEM_LOCK_STATISTICS_ENTRY Entry;
+    ULONG Hash, i;
+
+    Hash = KI_LOCK_STAT_HASH(Lock, CallSite);
+    for (i = 0; i < KI_LOCK_STAT_PROBES; i++)
+    {
+        Entry = &Processor->Entries[(Hash + i) & (KI_LOCK_STAT_ENTRIES - 1)];
+
+        /* Claim the first free slot */
+        if (!Entry->Lock)
+        {
+            Entry->CallSite = CallSite;
+            Entry->Type = Type;
+            Entry->Lock = Lock;
+            return Entry;
+        }
+
+        if ((Entry->Lock == Lock) && (Entry->CallSite == CallSite)) return Entry;
+    }
+
+    /* The neighbourhood is full, this pair won't be tracked */
+    Processor->Dropped++;
+    return NULL;
+}
+
+static
+VOID
+KiLockStatRecord(IN PSYSTEM_LOCK_STATISTICS_ENTRY Entry,
+                 IN ULONG64 Start,
+                 IN ULONG64 Now)
+{
+    Entry->Acquires++;
+
+    /* A start time means we had to spin or wait for the lock */
+    if (Start)
+    {
+        Entry->Contentions++;
+        Entry->SpinCycles += Now - Start;
+    }
+}
+
+static
+BOOLEAN
+KiLockStatIsMoreContended(IN PSYSTEM_LOCK_STATISTICS_ENTRY Entry,
+                          IN PSYSTEM_LOCK_STATISTICS_ENTRY Other)
+{
+    /* Time lost to the lock counts first, then how often it happened */
+    if (Entry->SpinCycles != Other->SpinCycles)
+        return Entry->SpinCycles > Other->SpinCycles;
+
+    return Entry->Contentions > Other->Contentions;
+}
+
+static
+ULONG
+KiLockStatCollect(OUT PSYSTEM_LOCK_STATISTICS_ENTRY Top,
+                  IN ULONG MaximumCount,
+                  OUT PULONG TotalLocks,
+                  OUT PULONG DroppedLocks)
+{
+    PSYSTEM_LOCK_STATISTICS_ENTRY Entry, Other;
+    SYSTEM_LOCK_STATISTICS_ENTRY Total;
+    ULONG Processors = (ULONG)KeNumberProcessors;
+    ULONG Count = 0, Processor, Position, i, j;
+
+    *TotalLocks = 0;
+    *DroppedLocks = 0;
+
+    for (Processor = 0; Processor < Processors; Processor++)
+    {
+        *DroppedLocks += KiLockStatProcessors[Processor].Dropped;
+
+        for (i = 0; i < KI_LOCK_STAT_ENTRIES; i++)
+        {
+            Entry = &KiLockStatProcessors[Processor].Entries[i];
+            if (!Entry->Lock) continue;
+
+            /* Each pair is reported by the first processor that has seen it */
+            for (j = 0; j < Processor; j++)
+            {
+                if (KiLockStatFindEntry(&KiLockStatProcessors[j],
+                                        Entry->Lock,
+                                        Entry->CallSite)) break;
+            }
+            if (j < Processor) continue;
+
+            /* Add up what the other processors have seen */
+            Total = *Entry;
+            for (j = Processor + 1; j < Processors; j++)
+            {
+                Other = KiLockStatFindEntry(&KiLockStatProcessors[j],
+                                            Entry->Lock,
+                                            Entry->CallSite);
+                if (!Other) continue;
+
+                Total.Acquires += Other->Acquires;
+                Total.Contentions += Other->Contentions;
+                Total.SpinCycles += Other->SpinCycles;
+                Total.MaximumHoldCycles = max(Total.MaximumHoldCycles,
+                                              Other->MaximumHoldCycles);
+            }
+            (*TotalLocks)++;
+
+            /* Keep the most contended ones, sorted */
+            for (Position = 0; Position < Count; Position++)
+            {
+                if (KiLockStatIsMoreContended(&Total, &Top[Position])) break;
+            }
+            if (Position >= MaximumCount) continue;
+
+            if (Count < MaximumCount) Count++;
+            RtlMoveMemory(&Top[Position + 1],
+                          &Top[Position],
+                          (Count - Position - 1) * sizeof(SYSTEM_LOCK_STATISTICS_ENTRY));
+            Top[Position] = Total;
+        }
+    }
+
+    return Count;
+}
+
+static
+VOID
+KiLockStatResetProcessor(IN PKI_LOCK_STAT_PROCESSOR Processor)
+{
+    /* Held locks would point at cleared entries, forget about them too */
+    RtlZeroMemory(Processor, sizeof(KI_LOCK_STAT_PROCESSOR));
+}
+
+static
+ULONG_PTR
+NTAPI
+KiLockStatResetTarget(IN ULONG_PTR Context)
+{
+    UNREFERENCED_PARAMETER(Context);
+
+    /* Each processor clears its own table */
+    KiLockStatResetProcessor(&KiLockStatProcessors[KeGetCurrentProcessorNumber()]);
+    return 0;
+}
+
+#endif // CONFIG_LOCK_STATISTICS
+
+/* PUBLIC FUNCTIONS **********************************************************/
+
+/*
+ * Exported for the HAL spinlock routines, which inline KxAcquireSpinLock
+ * and KxReleaseSpinLock as well.
+ */
+VOID
+NTAPI
+KiLockStatSpinLockAcquired(IN PKSPIN_LOCK SpinLock,
+                           IN PVOID CallSite,
+                           IN ULONG64 SpinStart)
+{
+#ifdef CONFIG_LOCK_STATISTICS
+    PKI_LOCK_STAT_PROCESSOR Processor;
+    PSYSTEM_LOCK_STATISTICS_ENTRY Entry;
+    PKI_LOCK_STAT_HELD Held;
+    ULONG64 Now;
+    BOOLEAN Enabled;
+
+    /* Interrupt spinlocks may be taken while we're updating the table */
+    Enabled = KeDisableInterrupts();
+    Now = KiLockStatTimestamp();
+    Processor = &KiLockStatProcessors[KeGetCurrentProcessorNumber()];
+
+    Entry = KiLockStatGetEntry(Processor, SpinLock, CallSite, LOCK_STATISTICS_SPIN_LOCK);
+    if (Entry) KiLockStatRecord(Entry, SpinStart, Now);
+
+    /* Remember when we got it, the release computes the hold time */
+    if (Processor->HeldCount < KI_LOCK_STAT_HELD_LOCKS)
+    {
+        Held = &Processor->Held[Processor->HeldCount++];
+        Held->Lock = SpinLock;
+        Held->Entry = Entry;
+        Held->AcquireTime = Now;
+    }
+
+    KeRestoreInterrupts(Enabled);
+#else
+    UNREFERENCED_PARAMETER(SpinLock);
+    UNREFERENCED_PARAMETER(CallSite);
+    UNREFERENCED_PARAMETER(SpinStart);
+#endif
+}
+
+VOID
+NTAPI
+KiLockStatSpinLockReleased(IN PKSPIN_LOCK SpinLock)
+{
+#ifdef CONFIG_LOCK_STATISTICS
+    PKI_LOCK_STAT_PROCESSOR Processor;
+    PKI_LOCK_STAT_HELD Held;
+    ULONG64 HoldCycles;
+    ULONG i;
+    BOOLEAN Enabled;
+
+    Enabled = KeDisableInterrupts();
+    Processor = &KiLockStatProcessors[KeGetCurrentProcessorNumber()];
+
+    /* Spinlocks are usually released in reverse order, start at the top */
+    for (i = Processor->HeldCount; i > 0; i--)
+    {
+        Held = &Processor->Held[i - 1];
+        if (Held->Lock != SpinLock) continue;
+
+        HoldCycles = KiLockStatTimestamp() - Held->AcquireTime;
+        if ((Held->Entry) && (HoldCycles > Held->Entry->MaximumHoldCycles))
+        {
+            Held->Entry->MaximumHoldCycles = HoldCycles;
+        }
+
+        /* Close the gap */
+        for (; i < Processor->HeldCount; i++)
+        {
+            Processor->Held[i - 1] = Processor->Held[i];
+        }
+        Processor->HeldCount--;
+        break;
+    }
+
+    KeRestoreInterrupts(Enabled);
+#else
+    UNREFERENCED_PARAMETER(SpinLock);
+#endif
+}
+
+#ifdef CONFIG_LOCK_STATISTICS
+/*
+ * Guarded mutex owners can be preempted and moved to another processor,
+ * so only the acquisitions and the time spent waiting are recorded.
+ */
+VOID
+NTAPI
+KiLockStatGuardedMutexAcquired(IN PKGUARDED_MUTEX GuardedMutex,
+                               IN PVOID CallSite,
+                               IN ULONG64 WaitStart)
+{
+    PKI_LOCK_STAT_PROCESSOR Processor;
+    PSYSTEM_LOCK_STATISTICS_ENTRY Entry;
+    BOOLEAN Enabled;
+
+    Enabled = KeDisableInterrupts();
+    Processor = &KiLockStatProcessors[KeGetCurrentProcessorNumber()];
+
+    Entry = KiLockStatGetEntry(Processor, GuardedMutex, CallSite, LOCK_STATISTICS_GUARDED_MUTEX);
+    if (Entry) KiLockStatRecord(Entry, WaitStart, KiLockStatTimestamp());
+
+    KeRestoreInterrupts(Enabled);
+}
+#endif
+
+NTSTATUS
+NTAPI
+KeQueryLockStatistics(OUT PSYSTEM_LOCK_STATISTICS_INFORMATION SystemInformation,
+                      IN ULONG SystemInformationLength,
+                      OUT PULONG ReturnLength)
+{
+#ifdef CONFIG_LOCK_STATISTICS
+    ULONG MaximumCount;
+
+    /* Check user's buffer size */
+    *ReturnLength = FIELD_OFFSET(SYSTEM_LOCK_STATISTICS_INFORMATION, Locks);
+    if (SystemInformationLength < *ReturnLength)
+    {
+        return STATUS_INFO_LENGTH_MISMATCH;
+    }
+
+    /* The caller picks how many of the most contended locks it wants */
+    MaximumCount = (SystemInformationLength - *ReturnLength) / sizeof(SYSTEM_LOCK_STATISTICS_ENTRY);
+    SystemInformation->NumberOfLocks = KiLockStatCollect(SystemInformation->Locks,
+                                                         MaximumCount,
+                                                         &SystemInformation->TotalLocks,
+                                                         &SystemInformation->DroppedLocks);
+
+    *ReturnLength += SystemInformation->NumberOfLocks * sizeof(SYSTEM_LOCK_STATISTICS_ENTRY);
+    return STATUS_SUCCESS;
+#else
+    UNREFERENCED_PARAMETER(SystemInformation);
+    UNREFERENCED_PARAMETER(SystemInformationLength);
+    *ReturnLength = 0;
+
+    /* Not compiled in */
+    return STATUS_NOT_IMPLEMENTED;
+#endif
+}
+
+NTSTATUS
+NTAPI
+KeResetLockStatistics(VOID)
+{
+#ifdef CONFIG_LOCK_STATISTICS
+    /* Have every processor clear its own table at the same time */
+    KeIpiGenericCall(KiLockStatResetTarget, 0);
+    return STATUS_SUCCESS;
+#else
+    return STATUS_NOT_IMPLEMENTED;
+#endif
+}
+
+#if DBG && defined(KDBG)
+
+BOOLEAN
+KiKdbgExtLockStat(ULONG Argc, PCHAR Argv[])
+{
+#ifdef CONFIG_LOCK_STATISTICS
+    static SYSTEM_LOCK_STATISTICS_ENTRY Top[KI_LOCK_STAT_MAX_TOP];
+    PSYSTEM_LOCK_STATISTICS_ENTRY Entry;
+    ULONG Wanted = 20, Count, Total, Dropped, i;
+
+    if (Argc > 1)
+    {
+        /* The other processors are frozen, we can clear their tables */
+        if (!strcmp(Argv[1], "-r"))
+        {
+            for (i = 0; i < (ULONG)KeNumberProcessors; i++)
+            {
+                KiLockStatResetProcessor(&KiLockStatProcessors[i]);
+            }
+
+            KdbpPrint("Lock statistics cleared\n");
+            return TRUE;
+        }
+
+        Wanted = strtoul(Argv[1], NULL, 0);
+        if ((Wanted == 0) || (Wanted > KI_LOCK_STAT_MAX_TOP))
+        {
+            KdbpPrint("Invalid parameter: %s (1-%u)\n", Argv[1], KI_LOCK_STAT_MAX_TOP);
+            return TRUE;
+        }
+    }
+
+    Count = KiLockStatCollect(Top, Wanted, &Total, &Dropped);
+
+    KdbpPrint("Lock\t\tType\tAcquires\tContended\tSpin cycles\tMax hold\tCall site\n");
+    for (i = 0; i < Count; i++)
+    {
+        Entry = &Top[i];
+        KdbpPrint("%p\t%s\t%lu\t\t%lu\t\t%I64u\t\t%I64u\t\t",
+                  Entry->Lock,
+                  (Entry->Type == LOCK_STATISTICS_GUARDED_MUTEX) ? "GMutex" : "Spin",
+                  Entry->Acquires,
+                  Entry->Contentions,
+                  Entry->SpinCycles,
+                  Entry->MaximumHoldCycles);
+
+        if (!KdbSymPrintAddress(Entry->CallSite, NULL))
+            KdbpPrint("<%p>\n", Entry->CallSite);
+        else
+            KdbpPrint("\n");
+    }
+
+    KdbpPrint("%lu of %lu locks shown, %lu not tracked\n", Count, Total, Dropped);
+#else
+    UNREFERENCED_PARAMETER(Argc);
+    UNREFERENCED_PARAMETER(Argv);
+
+    KdbpPrint("Lock statistics aren't compiled in, build with LOCK_STATISTICS enabled\n");
+#endif
+    return TRUE;
+}
+
+#endif // DBG && KDBG
+
+/* EOF */
@@ -230,13 +230,11 @@ KeReadStateQueue(IN PKQUEUE Queue)
     return Queue->Header.SignalState;
 }
 
-/*
- * @implemented
- */
+static
 PLIST_ENTRY
-NTAPI
-KeRemoveQueue(IN PKQUEUE Queue,
+KiRemoveQueue(IN PKQUEUE Queue,
               IN KPROCESSOR_MODE WaitMode,
+              IN BOOLEAN Alertable,
               IN PLARGE_INTEGER Timeout OPTIONAL)
 {
     PLIST_ENTRY QueueEntry;
@@ -259,12 +257,14 @@ KeRemoveQueue(IN PKQUEUE Queue,
         /* It is, so next time don't do expect this */
         Thread->WaitNext = FALSE;
         KxQueueThreadWait();
+        Thread->Alertable = Alertable;
     }
     else
     {
         /* Raise IRQL to synch, prepare the wait, then lock the database */
         Thread->WaitIrql = KeRaiseIrqlToSynchLevel();
         KxQueueThreadWait();
+        Thread->Alertable = Alertable;
         KiAcquireDispatcherLockAtDpcLevel();
     }
 
@@ -344,12 +344,12 @@ KeRemoveQueue(IN PKQUEUE Queue,
             }
             else
             {
-                /* Fail if there's a User APC Pending */
-                if ((WaitMode != KernelMode) &&
-                    (Thread->ApcState.UserApcPending))
+                /* Fail if the thread was alerted or has a User APC pending */
+                Status = KiCheckAlertability(Thread, Alertable, WaitMode);
+                if (Status != STATUS_WAIT_0)
                 {
                     /* Return the status and increase the pending threads */
-                    QueueEntry = (PLIST_ENTRY)STATUS_USER_APC;
+                    QueueEntry = (PLIST_ENTRY)Status;
                     Queue->CurrentCount++;
                     break;
                 }
@@ -419,6 +419,7 @@ KeRemoveQueue(IN PKQUEUE Queue,
             /* Start another wait */
             Thread->WaitIrql = KeRaiseIrqlToSynchLevel();
             KxQueueThreadWait();
+            Thread->Alertable = Alertable;
             KiAcquireDispatcherLockAtDpcLevel();
             Queue->CurrentCount--;
         }
@@ -430,6 +431,139 @@ KeRemoveQueue(IN PKQUEUE Queue,
     return QueueEntry;
 }
 
+/*
+ * @implemented
+ */
+PLIST_ENTRY
+NTAPI
+KeRemoveQueue(IN PKQUEUE Queue,
+              IN KPROCESSOR_MODE WaitMode,
+              IN PLARGE_INTEGER Timeout OPTIONAL)
+{
+    /* Remove a single entry with a non-alertable wait */
+    return KiRemoveQueue(Queue, WaitMode, FALSE, Timeout);
+}
+
+/*
+ * @implemented
+ */
+ULONG
+NTAPI
+KeRemoveQueueEx(IN PKQUEUE Queue,
+                IN KPROCESSOR_MODE WaitMode,
+                IN BOOLEAN Alertable,
+                IN PLARGE_INTEGER Timeout OPTIONAL,
+                OUT PLIST_ENTRY *EntryArray,
+                IN ULONG Count)
+{
+    PLIST_ENTRY QueueEntry;
+    ULONG Removed = 1;
+    KIRQL OldIrql;
+    ASSERT_QUEUE(Queue);
+    ASSERT(Count != 0);
+
+    /* Wait for the first entry exactly like a single removal would */
+    QueueEntry = KiRemoveQueue(Queue, WaitMode, Alertable, Timeout);
+    EntryArray[0] = QueueEntry;
+
+    /* If the wait failed, the caller gets the status as the only entry */
+    if (((NTSTATUS)(ULONG_PTR)QueueEntry == STATUS_TIMEOUT) ||
+        ((NTSTATUS)(ULONG_PTR)QueueEntry == STATUS_USER_APC) ||
+        ((NTSTATUS)(ULONG_PTR)QueueEntry == STATUS_ALERTED) ||
+        ((NTSTATUS)(ULONG_PTR)QueueEntry == STATUS_ABANDONED))
+    {
+        return Removed;
+    }
+
+    /* Check if there's room for more and anything else is queued */
+    if ((Count > 1) && !(IsListEmpty(&Queue->EntryListHead)))
+    {
+        /* Lock the database */
+        OldIrql = KiAcquireDispatcherLock();
+
+        /*
+         * Take what's already there without waiting again. The calling thread
+         * was accounted for with the first entry, so the concurrency count is
+         * left alone; the whole batch is processed by this one thread.
+         */
+        while ((Removed < Count) && !(IsListEmpty(&Queue->EntryListHead)))
+        {
+            /* Decrease the number of entries */
+            QueueEntry = Queue->EntryListHead.Flink;
+            Queue->Header.SignalState--;
+
+            /* Check if the entry is valid. If not, bugcheck */
+            if (!(QueueEntry->Flink) || !(QueueEntry->Blink))
+            {
+                /* Invalid item */
+                KeBugCheckEx(INVALID_WORK_QUEUE_ITEM,
+                             (ULONG_PTR)QueueEntry,
+                             (ULONG_PTR)Queue,
+                             (ULONG_PTR)NULL,
+                             (ULONG_PTR)((PWORK_QUEUE_ITEM)QueueEntry)->
+                                         WorkerRoutine);
+            }
+
+            /* Remove the Entry */
+            RemoveEntryList(QueueEntry);
+            QueueEntry->Flink = NULL;
+            EntryArray[Removed++] = QueueEntry;
+        }
+
+        /* Unlock the database */
+        KiReleaseDispatcherLock(OldIrql);
+    }
+
+    /* Return how many entries we removed */
+    return Removed;
+}
+
+/*
+ * Takes the first entry of a queue without waiting, and without associating
+ * the calling thread with the queue, so the concurrency count of the queue
+ * and the thread's own queue are left alone. Returns NULL if it is empty.
+ */
+PLIST_ENTRY
+NTAPI
+KeTryToRemoveQueueEntry(IN PKQUEUE Queue)
+{
+    PLIST_ENTRY QueueEntry = NULL;
+    KIRQL OldIrql;
+    ASSERT_QUEUE(Queue);
+    ASSERT_IRQL_LESS_OR_EQUAL(DISPATCH_LEVEL);
+
+    /* Lock the database */
+    OldIrql = KiAcquireDispatcherLock();
+
+    /* Check if there's anything queued */
+    if (!IsListEmpty(&Queue->EntryListHead))
+    {
+        /* Decrease the number of entries */
+        QueueEntry = Queue->EntryListHead.Flink;
+        Queue->Header.SignalState--;
+
+        /* Check if the entry is valid. If not, bugcheck */
+        if (!(QueueEntry->Flink) || !(QueueEntry->Blink))
+        {
+            /* Invalid item */
+            KeBugCheckEx(INVALID_WORK_QUEUE_ITEM,
+                         (ULONG_PTR)QueueEntry,
+                         (ULONG_PTR)Queue,
+                         (ULONG_PTR)NULL,
+                         (ULONG_PTR)((PWORK_QUEUE_ITEM)QueueEntry)->
+                                     WorkerRoutine);
+        }
+
+        /* Remove the Entry */
+        RemoveEntryList(QueueEntry);
+        QueueEntry->Flink = NULL;
+    }
+
+    /* Unlock the database and return the entry */
+    KiReleaseDispatcherLock(OldIrql);
+    return QueueEntry;
+}
+
 /*
  * @implemented
  */
@@ -12,7 +12,6 @@
 #define NDEBUG
 #include <debug.h>
 
-extern EX_WORK_QUEUE ExWorkerQueue[MaximumWorkQueue];
 extern LIST_ENTRY PspReaperListHead;
 
 ULONG KiMask32Array[MAXIMUM_PRIORITY] =
@@ -1421,7 +1420,8 @@ KeTerminateThread(IN KPRIORITY Increment)
     if (!Entry)
     {
         /* Activate it as a work item, directly through its Queue */
-        KiInsertQueue(&ExWorkerQueue[HyperCriticalWorkQueue].WorkerQueue,
+        ExpWorkItemQueued(&ExWorkerQueue[HyperCriticalWorkQueue]);
+        KiInsertQueue(&ExWorkerQueue[HyperCriticalWorkQueue].Queue.WorkerQueue,
                       &PspReaperWorkItem.List,
                       FALSE);
     }
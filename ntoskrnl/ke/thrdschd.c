@@ -15,9 +15,13 @@
 #ifdef _WIN64
 # define InterlockedOrSetMember(Destination, SetMember) \
     InterlockedOr64((PLONG64)Destination, SetMember);
+# define InterlockedAndNotSetMember(Destination, SetMember) \
+    InterlockedAnd64((PLONG64)Destination, ~(LONG64)(SetMember));
 #else
 # define InterlockedOrSetMember(Destination, SetMember) \
     InterlockedOr((PLONG)Destination, SetMember);
+# define InterlockedAndNotSetMember(Destination, SetMember) \
+    InterlockedAnd((PLONG)Destination, ~(LONG)(SetMember));
 #endif
 
 /* GLOBALS *******************************************************************/
@@ -27,13 +31,209 @@ ULONG_PTR KiIdleSMTSummary;
 
 /* FUNCTIONS *****************************************************************/
 
+#ifdef CONFIG_SMP
+static
+ULONG
+KiFindFirstSetAffinity(IN KAFFINITY Set)
+{
+    ULONG Processor;
+
+    ASSERT(Set != 0);
+#ifdef _WIN64
+    BitScanForward64(&Processor, Set);
+#else
+    BitScanForward(&Processor, Set);
+#endif
+    return Processor;
+}
+
+static
+ULONG
+KiSelectIdealProcessor(IN PKTHREAD Thread,
+                       IN KAFFINITY Affinity)
+{
+    /* Use the ideal processor if the affinity still allows it */
+    if (Affinity & AFFINITY_MASK(Thread->IdealProcessor))
+    {
+        return Thread->IdealProcessor;
+    }
+
+    /* Otherwise stay where the thread last ran to keep its cache warm */
+    if (Affinity & AFFINITY_MASK(Thread->NextProcessor))
+    {
+        return Thread->NextProcessor;
+    }
+
+    /* Fall back to the first processor in the affinity set */
+    return KiFindFirstSetAffinity(Affinity);
+}
+
+static
+ULONG
+KiSelectIdleProcessor(IN KAFFINITY IdleSet,
+                      IN ULONG IdealProcessor)
+{
+    ULONG Processor;
+
+    /* Prefer the ideal processor, then the current one */
+    if (IdleSet & AFFINITY_MASK(IdealProcessor)) return IdealProcessor;
+    Processor = KeGetCurrentProcessorNumber();
+    if (IdleSet & AFFINITY_MASK(Processor)) return Processor;
+
+    /* Otherwise take the lowest numbered idle processor */
+    return KiFindFirstSetAffinity(IdleSet);
+}
+
+static
+ULONG
+KiSelectLowestPriorityProcessor(IN KAFFINITY Affinity,
+                                IN ULONG IdealProcessor,
+                                IN KPRIORITY Priority)
+{
+    ULONG Processor, Target = IdealProcessor;
+    KPRIORITY LowestPriority = Priority;
+    PKTHREAD NextThread;
+    PKPRCB Prcb;
+
+    /* Loop every processor this thread may run on */
+    while (Affinity)
+    {
+        Processor = KiFindFirstSetAffinity(Affinity);
+        Affinity &= ~(KAFFINITY)AFFINITY_MASK(Processor);
+
+        /*
+         * Get the priority of what this processor will run next. This is
+         * done without the PRCB lock, it's only a hint and the caller will
+         * re-check everything under the lock of the processor we pick.
+         */
+        Prcb = KiProcessorBlock[Processor];
+        NextThread = Prcb->NextThread;
+        if (!NextThread) NextThread = Prcb->CurrentThread;
+
+        /* Keep the processor running the least important thread */
+        if (NextThread->Priority < LowestPriority)
+        {
+            LowestPriority = NextThread->Priority;
+            Target = Processor;
+        }
+    }
+
+    /* If nothing could be preempted, this is the ideal processor */
+    return Target;
+}
+
+static
+PKTHREAD
+KiStealReadyThread(IN PKPRCB Prcb,
+                   OUT PBOOLEAN Contended OPTIONAL)
+{
+    ULONG Processor, PrioritySet;
+    LONG HighPriority;
+    PLIST_ENTRY ListHead, ListEntry;
+    PKTHREAD Thread;
+    PKPRCB OtherPrcb;
+
+    /* Assume every ready list we care about gets looked at */
+    if (Contended) *Contended = FALSE;
+
+    /* Loop every other processor */
+    for (Processor = 0; Processor < (ULONG)KeNumberProcessors; Processor++)
+    {
+        /* Skip ourselves, and processors with nothing ready */
+        OtherPrcb = KiProcessorBlock[Processor];
+        if ((OtherPrcb == Prcb) || !(OtherPrcb->ReadySummary)) continue;
+
+        /* Don't wait on a busy processor, just move on to the next one */
+        if (!KiTryToAcquirePrcbLock(OtherPrcb))
+        {
+            /* But let the caller know there might have been something */
+            if (Contended) *Contended = TRUE;
+            continue;
+        }
+
+        /* Scan its ready lists from the highest priority downwards */
+        PrioritySet = OtherPrcb->ReadySummary;
+        while (PrioritySet)
+        {
+            BitScanReverse((PULONG)&HighPriority, PrioritySet);
+            PrioritySet ^= PRIORITY_MASK(HighPriority);
+
+            /* Look for a thread that is allowed to run on this processor */
+            ListHead = &OtherPrcb->DispatcherReadyListHead[HighPriority];
+            for (ListEntry = ListHead->Flink;
+                 ListEntry != ListHead;
+                 ListEntry = ListEntry->Flink)
+            {
+                Thread = CONTAINING_RECORD(ListEntry, KTHREAD, WaitListEntry);
+                ASSERT(HighPriority == Thread->Priority);
+                if (!(Thread->Affinity & Prcb->SetMember)) continue;
+
+                /* Found one, take it off the other processor */
+                if (RemoveEntryList(&Thread->WaitListEntry))
+                {
+                    /* The list is empty now, reset the ready summary */
+                    OtherPrcb->ReadySummary ^= PRIORITY_MASK(HighPriority);
+                }
+
+                /* It will run here now */
+                Thread->NextProcessor = Prcb->Number;
+                KiReleasePrcbLock(OtherPrcb);
+                return Thread;
+            }
+        }
+
+        /* Nothing we can run, release the lock */
+        KiReleasePrcbLock(OtherPrcb);
+    }
+
+    /* Nothing to steal */
+    return NULL;
+}
+#endif
+
 PKTHREAD
 FASTCALL
 KiIdleSchedule(IN PKPRCB Prcb)
 {
-    /* FIXME: TODO */
-    ASSERTMSG("SMP: Not yet implemented\n", FALSE);
+#ifdef CONFIG_SMP
+    PKTHREAD Thread;
+    BOOLEAN Contended;
+
+    /*
+     * Acquire our PRCB and make sure nobody scheduled something for us.
+     * The flag is cleared before looking at the other ready lists, so work
+     * queued while we scan sets it again and we come back for it.
+     */
+    KiAcquirePrcbLock(Prcb);
+    Prcb->IdleSchedule = FALSE;
+    KeMemoryBarrier();
+    Thread = Prcb->NextThread;
+    if (!Thread)
+    {
+        /* Try to pick up a ready thread from another processor */
+        Thread = KiStealReadyThread(Prcb, &Contended);
+        if (Thread)
+        {
+            /* We are not idle anymore, and this is our next thread */
+            InterlockedAndNotSetMember(&KiIdleSummary, Prcb->SetMember);
+            Thread->State = Standby;
+            Prcb->NextThread = Thread;
+        }
+        else if (Contended)
+        {
+            /* Some ready list was busy, try again on the next idle pass */
+            Prcb->IdleSchedule = TRUE;
+        }
+    }
+
+    /* Release the PRCB and return what we will run */
+    KiReleasePrcbLock(Prcb);
+    return Thread;
+#else
+    /* There is no other processor to take work from */
+    UNREFERENCED_PARAMETER(Prcb);
     return NULL;
+#endif
 }
 
 VOID
@@ -83,6 +283,10 @@ KiDeferredReadyThread(IN PKTHREAD Thread)
     ULONG Processor = 0;
     KPRIORITY OldPriority;
     PKTHREAD NextThread;
+#ifdef CONFIG_SMP
+    KAFFINITY Affinity, IdleSet;
+    ULONG IdealProcessor;
+#endif
 
     /* Sanity checks */
     ASSERT(Thread->State == DeferredReady);
@@ -228,9 +432,59 @@ KiDeferredReadyThread(IN PKTHREAD Thread)
     OldPriority = Thread->Priority;
     Thread->Preempted = FALSE;
 
-    /* Queue the thread on CPU 0 and get the PRCB and lock it */
-    Thread->NextProcessor = 0;
-    Prcb = KiProcessorBlock[0];
+#ifdef CONFIG_SMP
+    /* Get the processors this thread can run on and its preferred one */
+    Affinity = Thread->Affinity & KeActiveProcessors;
+    ASSERT(Affinity != 0);
+    IdealProcessor = KiSelectIdealProcessor(Thread, Affinity);
+
+    /* Check if any of these processors are idle */
+    IdleSet = KiIdleSummary & Affinity;
+    if (IdleSet)
+    {
+        /* Pick one of them, preferring the ideal processor */
+        Processor = KiSelectIdleProcessor(IdleSet, IdealProcessor);
+        Prcb = KiProcessorBlock[Processor];
+        KiAcquirePrcbLock(Prcb);
+
+        /* Make sure it's still idle now that we own its PRCB */
+        NextThread = Prcb->NextThread;
+        if ((NextThread == Prcb->IdleThread) ||
+            (!(NextThread) && (Prcb->CurrentThread == Prcb->IdleThread)))
+        {
+            /* It isn't idle anymore, clear its bit in the summary */
+            InterlockedAndNotSetMember(&KiIdleSummary, Prcb->SetMember);
+
+            /* Set this thread as the next one */
+            Thread->NextProcessor = (UCHAR)Processor;
+            Thread->State = Standby;
+            Prcb->NextThread = Thread;
+
+            /* Unlock the PRCB */
+            KiReleasePrcbLock(Prcb);
+
+            /* Wake up the processor if it's not this one */
+            if (KeGetCurrentProcessorNumber() != Processor)
+            {
+                KiIpiSend(AFFINITY_MASK(Processor), IPI_DPC);
+            }
+            return;
+        }
+
+        /* Somebody beat us to it, handle it like any busy processor */
+    }
+    else
+    {
+        /* Nothing is idle, look for the least important running thread */
+        Processor = KiSelectLowestPriorityProcessor(Affinity,
+                                                    IdealProcessor,
+                                                    OldPriority);
+        Prcb = KiProcessorBlock[Processor];
+        KiAcquirePrcbLock(Prcb);
+    }
+#else
+    /* Get the PRCB and lock it */
+    Prcb = KiProcessorBlock[Processor];
     KiAcquirePrcbLock(Prcb);
 
     /* Check if we have an idle summary */
@@ -238,6 +492,7 @@ KiDeferredReadyThread(IN PKTHREAD Thread)
     {
         /* Clear it and set this thread as the next one */
         KiIdleSummary = 0;
+        Thread->NextProcessor = (UCHAR)Processor;
         Thread->State = Standby;
         Prcb->NextThread = Thread;
 
@@ -245,13 +500,32 @@ KiDeferredReadyThread(IN PKTHREAD Thread)
         KiReleasePrcbLock(Prcb);
         return;
     }
+#endif
 
     /* Set the CPU number */
     Thread->NextProcessor = (UCHAR)Processor;
 
     /* Get the next scheduled thread */
     NextThread = Prcb->NextThread;
-    if (NextThread)
+    if ((NextThread) && (NextThread == Prcb->IdleThread))
+    {
+        /* The processor is about to go idle, run this thread instead */
+        InterlockedAndNotSetMember(&KiIdleSummary, Prcb->SetMember);
+        Thread->State = Standby;
+        Prcb->NextThread = Thread;
+
+        /* Release the lock */
+        KiReleasePrcbLock(Prcb);
+
+        /* Check if we're running on another CPU */
+        if (KeGetCurrentProcessorNumber() != Thread->NextProcessor)
+        {
+            /* We are, send an IPI */
+            KiIpiSend(AFFINITY_MASK(Thread->NextProcessor), IPI_DPC);
+        }
+        return;
+    }
+    else if (NextThread)
     {
         /* Sanity check */
         ASSERT(NextThread->State == Standby);
@@ -321,6 +595,17 @@ KiDeferredReadyThread(IN PKTHREAD Thread)
 
     /* Release the lock */
     KiReleasePrcbLock(Prcb);
+
+#ifdef CONFIG_SMP
+    /* Idle processors that could run this thread should come and take it */
+    IdleSet = KiIdleSummary & Affinity & ~Prcb->SetMember;
+    while (IdleSet)
+    {
+        Processor = KiFindFirstSetAffinity(IdleSet);
+        IdleSet &= ~(KAFFINITY)AFFINITY_MASK(Processor);
+        KiProcessorBlock[Processor]->IdleSchedule = TRUE;
+    }
+#endif
 }
 
 PKTHREAD
@@ -331,6 +616,10 @@ KiSelectNextThread(IN PKPRCB Prcb)
 
     /* Select a ready thread */
     Thread = KiSelectReadyThread(0, Prcb);
+#ifdef CONFIG_SMP
+    /* If we have nothing, try to take some work from another processor */
+    if (!Thread) Thread = KiStealReadyThread(Prcb, NULL);
+#endif
     if (!Thread)
     {
         /* Didn't find any, get the current idle thread */
@@ -339,9 +628,6 @@ KiSelectNextThread(IN PKPRCB Prcb)
         /* Enable idle scheduling */
         InterlockedOrSetMember(&KiIdleSummary, Prcb->SetMember);
         Prcb->IdleSchedule = TRUE;
-
-        /* FIXME: SMT support */
-        ASSERTMSG("SMP: Not yet implemented\n", FALSE);
     }
 
     /* Sanity checks and return the thread */
@@ -377,6 +663,10 @@ KiSwapThread(IN PKTHREAD CurrentThread,
     {
         /* Try to find a ready thread */
         NextThread = KiSelectReadyThread(0, Prcb);
+#ifdef CONFIG_SMP
+        /* If we have nothing, try to take some work from another processor */
+        if (!NextThread) NextThread = KiStealReadyThread(Prcb, NULL);
+#endif
         if (NextThread)
         {
             /* Switch to it */
@@ -387,6 +677,7 @@ KiSwapThread(IN PKTHREAD CurrentThread,
         {
             /* Set the idle summary */
             InterlockedOrSetMember(&KiIdleSummary, Prcb->SetMember);
+            Prcb->IdleSchedule = TRUE;
 
             /* Schedule the idle thread */
             NextThread = Prcb->IdleThread;
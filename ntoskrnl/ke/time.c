@@ -46,7 +46,8 @@ KiCheckForTimerExpiration(
 
     /* Check for timer expiration */
     Hand = KeTickCount.LowPart & (TIMER_TABLE_SIZE - 1);
-    if (KiTimerTableListHead[Hand].Time.QuadPart <= InterruptTime.QuadPart)
+    if ((KiTimerTableListHead[Hand].Time.QuadPart <= InterruptTime.QuadPart) ||
+        (KiReadTimerCascadeTime() <= InterruptTime.QuadPart))
     {
         /* Check if we are already doing expiration */
         if (!Prcb->TimerRequest)
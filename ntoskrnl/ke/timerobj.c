@@ -19,8 +19,221 @@ LARGE_INTEGER KiTimeIncrementReciprocal;
 UCHAR KiTimeIncrementShiftCount;
 BOOLEAN KiEnableTimerWatchdog = FALSE;
 
+/*
+ * Second level of the timer wheel. The timer table only holds timers that are
+ * due within the current or the next revolution of its hand; anything further
+ * away waits here, unsorted, in the slot of the revolution it is due in. Once
+ * per revolution, the slot of the next one is cascaded into the timer table.
+ */
+LIST_ENTRY KiTimerOverflowListHead[TIMER_TABLE_SIZE];
+KSPIN_LOCK KiTimerOverflowLock;
+ULONGLONG KiTimerCascadeRevolution;
+ULONGLONG KiTimerCascadeTime;
+
+/* Boundaries that coalescable timers are rounded up to, in 100ns units */
+static const ULONG KiCoalescingGranularity[] =
+{
+    0,
+    50 * 10000,
+    100 * 10000,
+    250 * 10000,
+    1000 * 10000
+};
+
 /* PRIVATE FUNCTIONS *********************************************************/
 
+FORCEINLINE
+ULONGLONG
+KiComputeTimerRevolution(IN ULONGLONG DueTime)
+{
+    /* Get how many times the timer table hand went around at this time */
+    return DueTime / ((ULONGLONG)KeMaximumIncrement * TIMER_TABLE_SIZE);
+}
+
+static
+BOOLEAN
+KiInsertOverflowTimer(IN PKTIMER Timer)
+{
+    ULONGLONG Revolution;
+    BOOLEAN Inserted = FALSE;
+
+    /* The cascade revolution only grows, so near timers don't need the lock */
+    Revolution = KiComputeTimerRevolution(Timer->DueTime.QuadPart);
+    if (Revolution <= KiTimerCascadeRevolution) return FALSE;
+
+    /* Check again under the lock, and insert the timer in its slot */
+    KeAcquireSpinLockAtDpcLevel(&KiTimerOverflowLock);
+    if (Revolution > KiTimerCascadeRevolution)
+    {
+        InsertTailList(&KiTimerOverflowListHead[Revolution & (TIMER_TABLE_SIZE - 1)],
+                       &Timer->TimerListEntry);
+        Inserted = TRUE;
+    }
+    KeReleaseSpinLockFromDpcLevel(&KiTimerOverflowLock);
+    return Inserted;
+}
+
+BOOLEAN
+FASTCALL
+KiRemoveOverflowTimer(IN PKTIMER Timer)
+{
+    ULONGLONG Revolution;
+    BOOLEAN Removed = FALSE;
+
+    /* Timers due in the current or next revolution are in the timer table */
+    Revolution = KiComputeTimerRevolution(Timer->DueTime.QuadPart);
+    if (Revolution <= KiTimerCascadeRevolution) return FALSE;
+
+    /*
+     * Otherwise it's still on the overflow wheel: cascading happens with the
+     * dispatcher lock held, just like every caller of this routine.
+     */
+    KeAcquireSpinLockAtDpcLevel(&KiTimerOverflowLock);
+    if (Revolution > KiTimerCascadeRevolution)
+    {
+        RemoveEntryList(&Timer->TimerListEntry);
+        Removed = TRUE;
+    }
+    KeReleaseSpinLockFromDpcLevel(&KiTimerOverflowLock);
+    return Removed;
+}
+
+VOID
+FASTCALL
+KiCascadeOverflowTimers(IN ULONGLONG InterruptTime)
+{
+    LIST_ENTRY CascadeList;
+    PLIST_ENTRY ListHead, NextEntry;
+    ULONGLONG Revolution, CurrentRevolution, NextCascadeTime;
+    PKSPIN_LOCK_QUEUE LockQueue;
+    BOOLEAN RequestInterrupt = FALSE;
+    PKTIMER Timer;
+    ULONG Hand;
+
+    /* The dispatcher lock keeps timers from being removed while we work */
+    InitializeListHead(&CascadeList);
+    CurrentRevolution = KiComputeTimerRevolution(InterruptTime);
+
+    /* Acquire the overflow lock */
+    KeAcquireSpinLockAtDpcLevel(&KiTimerOverflowLock);
+
+    /* Make sure the timer table covers the current and the next revolution */
+    while (KiTimerCascadeRevolution <= CurrentRevolution)
+    {
+        /* Loop the timers of the next revolution's slot */
+        Revolution = ++KiTimerCascadeRevolution;
+        ListHead = &KiTimerOverflowListHead[Revolution & (TIMER_TABLE_SIZE - 1)];
+        NextEntry = ListHead->Flink;
+        while (NextEntry != ListHead)
+        {
+            /* Get the timer and move to the next one */
+            Timer = CONTAINING_RECORD(NextEntry, KTIMER, TimerListEntry);
+            NextEntry = NextEntry->Flink;
+
+            /* Leave it alone if it's due on a later lap of the overflow wheel */
+            if (KiComputeTimerRevolution(Timer->DueTime.QuadPart) > Revolution)
+            {
+                continue;
+            }
+
+            /* Take it out, it goes in the timer table now */
+            RemoveEntryList(&Timer->TimerListEntry);
+            InsertTailList(&CascadeList, &Timer->TimerListEntry);
+        }
+    }
+
+    /* Update the time of the next cascade for the clock interrupt. We are
+       the only writer, so the exchange always succeeds, but other CPUs must
+       never see half of the new value */
+    NextCascadeTime = KiTimerCascadeRevolution * KeMaximumIncrement * TIMER_TABLE_SIZE;
+    InterlockedCompareExchange64((PLONGLONG)&KiTimerCascadeTime,
+                                 NextCascadeTime,
+                                 KiTimerCascadeTime);
+
+    /* Release the overflow lock */
+    KeReleaseSpinLockFromDpcLevel(&KiTimerOverflowLock);
+
+    /* Now insert the timers we took in the timer table */
+    while (!IsListEmpty(&CascadeList))
+    {
+        /* Get the timer and its hand */
+        NextEntry = RemoveHeadList(&CascadeList);
+        Timer = CONTAINING_RECORD(NextEntry, KTIMER, TimerListEntry);
+        Hand = KiComputeTimerTableIndex(Timer->DueTime.QuadPart);
+
+        /* Lock the hand and insert the timer */
+        LockQueue = KiAcquireTimerLock(Hand);
+        if (KiInsertTimerTable(Timer, Hand))
+        {
+            /* It's already due, which can happen if we ran late. Signal it */
+            KiRemoveEntryTimer(Timer);
+            KiReleaseTimerLock(LockQueue);
+            RequestInterrupt |= KiSignalTimer(Timer);
+        }
+        else
+        {
+            /* Release the lock */
+            KiReleaseTimerLock(LockQueue);
+        }
+    }
+
+    /* Request a DPC if needed */
+    if (RequestInterrupt) HalRequestSoftwareInterrupt(DISPATCH_LEVEL);
+}
+
+VOID
+FASTCALL
+KiRemoveAbsoluteOverflowTimers(IN PLIST_ENTRY ListHead)
+{
+    PLIST_ENTRY SlotHead, NextEntry;
+    PKTIMER Timer;
+    ULONG i;
+
+    /* Acquire the overflow lock and loop every slot */
+    KeAcquireSpinLockAtDpcLevel(&KiTimerOverflowLock);
+    for (i = 0; i < TIMER_TABLE_SIZE; i++)
+    {
+        SlotHead = &KiTimerOverflowListHead[i];
+        NextEntry = SlotHead->Flink;
+        while (NextEntry != SlotHead)
+        {
+            /* Get the timer and move to the next one */
+            Timer = CONTAINING_RECORD(NextEntry, KTIMER, TimerListEntry);
+            NextEntry = NextEntry->Flink;
+
+            /* Move absolute timers to the caller's list */
+            if (Timer->Header.Absolute)
+            {
+                RemoveEntryList(&Timer->TimerListEntry);
+                InsertTailList(ListHead, &Timer->TimerListEntry);
+            }
+        }
+    }
+
+    /* Release the lock */
+    KeReleaseSpinLockFromDpcLevel(&KiTimerOverflowLock);
+}
+
+VOID
+FASTCALL
+KiCoalesceDueTime(IN PKTIMER Timer)
+{
+    ULONGLONG Granularity;
+
+    /* Get the granularity this timer was set with */
+    ASSERT(Timer->Header.EncodedTolerableDelay <
+           RTL_NUMBER_OF(KiCoalescingGranularity));
+    Granularity = KiCoalescingGranularity[Timer->Header.EncodedTolerableDelay];
+    if (!Granularity) return;
+
+    /*
+     * Round the due time up to the next boundary, so that every timer with a
+     * similar tolerance expires on the same clock tick instead of its own.
+     */
+    Timer->DueTime.QuadPart += Granularity - 1;
+    Timer->DueTime.QuadPart -= Timer->DueTime.QuadPart % Granularity;
+}
+
 BOOLEAN
 FASTCALL
 KiInsertTreeTimer(IN PKTIMER Timer,
@@ -76,6 +289,9 @@ KiInsertTimerTable(IN PKTIMER Timer,
     /* Sanity check */
     ASSERT(Hand == KiComputeTimerTableIndex(DueTime));
 
+    /* Timers due after the next revolution go on the overflow wheel */
+    if (KiInsertOverflowTimer(Timer)) return FALSE;
+
     /* Loop the timer list backwards */
     ListHead = &KiTimerTableListHead[Hand].Entry;
     NextEntry = ListHead->Blink;
@@ -291,19 +507,34 @@ KeSetTimer(IN OUT PKTIMER Timer,
  */
 BOOLEAN
 NTAPI
-KeSetTimerEx(IN OUT PKTIMER Timer,
-             IN LARGE_INTEGER DueTime,
-             IN LONG Period,
-             IN PKDPC Dpc OPTIONAL)
+KeSetCoalescableTimer(IN OUT PKTIMER Timer,
+                      IN LARGE_INTEGER DueTime,
+                      IN ULONG Period,
+                      IN ULONG TolerableDelay,
+                      IN PKDPC Dpc OPTIONAL)
 {
     KIRQL OldIrql;
     BOOLEAN Inserted;
     ULONG Hand = 0;
+    UCHAR Granularity;
     BOOLEAN RequestInterrupt = FALSE;
     ASSERT_TIMER(Timer);
     ASSERT(KeGetCurrentIrql() <= DISPATCH_LEVEL);
-    DPRINT("KeSetTimerEx(): Timer %p, DueTime %I64d, Period %d, Dpc %p\n",
-           Timer, DueTime.QuadPart, Period, Dpc);
+    DPRINT("KeSetCoalescableTimer(): Timer %p, DueTime %I64d, Period %lu, "
+           "TolerableDelay %lu, Dpc %p\n",
+           Timer, DueTime.QuadPart, Period, TolerableDelay, Dpc);
+
+    /* A periodic timer can't be delayed by more than its period */
+    if ((Period) && (TolerableDelay > Period)) TolerableDelay = Period;
+
+    /* Find the largest granularity that fits in the tolerable delay */
+    for (Granularity = RTL_NUMBER_OF(KiCoalescingGranularity) - 1;
+         Granularity > 0;
+         Granularity--)
+    {
+        if (KiCoalescingGranularity[Granularity] <=
+            (ULONGLONG)TolerableDelay * 10000) break;
+    }
 
     /* Lock the Database and Raise IRQL */
     OldIrql = KiAcquireDispatcherLock();
@@ -315,6 +546,8 @@ KeSetTimerEx(IN OUT PKTIMER Timer,
     /* Set Default Timer Data */
     Timer->Dpc = Dpc;
     Timer->Period = Period;
+    Timer->Header.Coalescable = (Granularity != 0);
+    Timer->Header.EncodedTolerableDelay = Granularity;
     if (!KiComputeDueTime(Timer, DueTime, &Hand))
     {
         /* Signal the timer */
@@ -340,3 +573,16 @@ KeSetTimerEx(IN OUT PKTIMER Timer,
     return Inserted;
 }
 
+/*
+ * @implemented
+ */
+BOOLEAN
+NTAPI
+KeSetTimerEx(IN OUT PKTIMER Timer,
+             IN LARGE_INTEGER DueTime,
+             IN LONG Period,
+             IN PKDPC Dpc OPTIONAL)
+{
+    /* Call the coalescable version, with no tolerable delay */
+    return KeSetCoalescableTimer(Timer, DueTime, Period, 0, Dpc);
+}
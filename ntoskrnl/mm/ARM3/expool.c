@@ -1611,6 +1611,34 @@ ExpFindAndRemoveTagBigPages(IN PVOID Va,
     return PoolTag;
 }
 
+static
+VOID
+ExpQueryPoolLookasideHits(IN PKPRCB Prcb,
+                          IN BOOLEAN IncludeShared,
+                          IN OUT PULONG NonPagedHits,
+                          IN OUT PULONG PagedHits)
+{
+    ULONG i;
+
+    for (i = 0; i < NUMBER_POOL_LOOKASIDE_LISTS; i++)
+    {
+        //
+        // Processors without their own lists point both entries to the shared ones
+        //
+        if (Prcb->PPNPagedLookasideList[i].P != Prcb->PPNPagedLookasideList[i].L)
+        {
+            *NonPagedHits += Prcb->PPNPagedLookasideList[i].P->AllocateHits;
+            *PagedHits += Prcb->PPPagedLookasideList[i].P->AllocateHits;
+        }
+
+        if (IncludeShared)
+        {
+            *NonPagedHits += Prcb->PPNPagedLookasideList[i].L->AllocateHits;
+            *PagedHits += Prcb->PPPagedLookasideList[i].L->AllocateHits;
+        }
+    }
+}
+
 VOID
 NTAPI
 ExQueryPoolUsage(OUT PULONG PagedPoolPages,
@@ -1669,10 +1697,21 @@ ExQueryPoolUsage(OUT PULONG PagedPoolPages,
 #endif
 
     //
-    // FIXME: Not yet supported
+    // Tally up the lookaside hits of every processor, the shared lists are
+    // counted once through the boot processor
     //
-    *NonPagedPoolLookasideHits += 0;
-    *PagedPoolLookasideHits += 0;
+    *NonPagedPoolLookasideHits = 0;
+    *PagedPoolLookasideHits = 0;
+    for (i = 0; i < (ULONG)KeNumberProcessors; i++)
+    {
+        if (KiProcessorBlock[i])
+        {
+            ExpQueryPoolLookasideHits(KiProcessorBlock[i],
+                                      i == 0,
+                                      NonPagedPoolLookasideHits,
+                                      PagedPoolLookasideHits);
+        }
+    }
 }
 
 VOID
@@ -3040,6 +3079,63 @@ ExpKdbgExtPoolUsedGetTag(PCHAR Arg, PULONG Tag, PULONG Mask)
     *Tag = *((PULONG)Tmp);
 }
 
+static
+VOID
+ExpKdbgDumpPoolLookaside(PGENERAL_LOOKASIDE Lookaside)
+{
+    ULONG HitRate = 0;
+
+    if (Lookaside->TotalAllocates)
+    {
+        HitRate = (ULONG)(((ULONGLONG)Lookaside->AllocateHits * 100) / Lookaside->TotalAllocates);
+    }
+
+    KdbpPrint("\t%lu\t%lu\t%lu%%\t%u/%u",
+              Lookaside->TotalAllocates, Lookaside->AllocateHits, HitRate,
+              Lookaside->Depth, ExQueryDepthSList(&Lookaside->ListHead));
+}
+
+static
+VOID
+ExpKdbgDumpPoolLookasides(VOID)
+{
+    ULONG i, j;
+    PKPRCB Prcb;
+
+    for (i = 0; i < (ULONG)KeNumberProcessors; i++)
+    {
+        Prcb = KiProcessorBlock[i];
+        if (!Prcb) continue;
+
+        /* Processors without their own lists would just repeat the shared ones */
+        if (i != 0 && Prcb->PPNPagedLookasideList[0].P == Prcb->PPNPagedLookasideList[0].L)
+        {
+            KdbpPrint("\nCPU %lu uses the shared lookasides\n", i);
+            continue;
+        }
+
+        KdbpPrint("\nCPU %lu lookasides\t\tNonPaged\t\t\t\tPaged\n", i);
+        KdbpPrint("Size\tAllocs\tHits\tRate\tDepth\tAllocs\tHits\tRate\tDepth\n");
+        for (j = 0; j < NUMBER_POOL_LOOKASIDE_LISTS; j++)
+        {
+            KdbpPrint("%lu", Prcb->PPNPagedLookasideList[j].P->Size);
+            ExpKdbgDumpPoolLookaside(Prcb->PPNPagedLookasideList[j].P);
+            ExpKdbgDumpPoolLookaside(Prcb->PPPagedLookasideList[j].P);
+            KdbpPrint("\n");
+        }
+    }
+
+    KdbpPrint("\nShared lookasides\t\tNonPaged\t\t\t\tPaged\n");
+    KdbpPrint("Size\tAllocs\tHits\tRate\tDepth\tAllocs\tHits\tRate\tDepth\n");
+    for (j = 0; j < NUMBER_POOL_LOOKASIDE_LISTS; j++)
+    {
+        KdbpPrint("%lu", KiProcessorBlock[0]->PPNPagedLookasideList[j].L->Size);
+        ExpKdbgDumpPoolLookaside(KiProcessorBlock[0]->PPNPagedLookasideList[j].L);
+        ExpKdbgDumpPoolLookaside(KiProcessorBlock[0]->PPPagedLookasideList[j].L);
+        KdbpPrint("\n");
+    }
+}
+
 BOOLEAN
 ExpKdbgExtPoolUsed(
     ULONG Argc,
@@ -3083,6 +3179,12 @@ ExpKdbgExtPoolUsed(
     /* Call the dumper */
     MiDumpPoolConsumers(TRUE, Tag, Mask, Flags);
 
+    /* Flag 2 also dumps the small block lookasides */
+    if (Flags & 2)
+    {
+        ExpKdbgDumpPoolLookasides();
+    }
+
     return TRUE;
 }
 
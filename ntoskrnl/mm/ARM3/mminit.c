@@ -2181,8 +2181,9 @@ MmArmInitSystem(IN ULONG Phase,
         /* Initialize the Loader Lock */
         KeInitializeMutant(&MmSystemLoadLock, FALSE);
 
-        /* Set the zero page event */
+        /* Set the zero page event and the idle timer, which wake one thread each time */
         KeInitializeEvent(&MmZeroingPageEvent, SynchronizationEvent, FALSE);
+        KeInitializeTimerEx(&MmZeroingPageIdleTimer, SynchronizationTimer);
         MmZeroingPageThreadActive = FALSE;
 
         /* Initialize the dead stack S-LIST */
@@ -584,7 +584,19 @@ MiRemoveZeroPage(IN ULONG Color)
     ASSERT(Pfn1 == MI_PFN_ELEMENT(PageIndex));
 
     /* Zero it, if needed */
-    if (Zero) MiZeroPhysicalPage(PageIndex);
+    if (Zero)
+    {
+        MiZeroPhysicalPage(PageIndex);
+        MmSynchronousZeroPages++;
+
+        /* The zero page threads fell behind, make sure they're on it */
+        if ((MmZeroingPageThreads) &&
+            (MmFreePageListHead.Total) &&
+            !(MmZeroingPageThreadActive))
+        {
+            KeSetEvent(&MmZeroingPageEvent, IO_NO_INCREMENT, FALSE);
+        }
+    }
 
     /* Sanity checks */
     ASSERT(Pfn1->u3.e2.ReferenceCount == 0);
@@ -17,8 +17,24 @@
 
 /* GLOBALS ********************************************************************/
 
+/* Pages each thread takes off the free list at once */
+#define MI_ZERO_PAGE_BATCH              8
+
+/* Free pages per busy thread before another one is woken up */
+#define MI_ZERO_PAGE_HELPER_THRESHOLD   256
+
+/* How often the threads look for leftover free pages, in ms */
+#define MI_ZERO_PAGE_IDLE_PERIOD        1000
+
 BOOLEAN MmZeroingPageThreadActive;
 KEVENT MmZeroingPageEvent;
+KTIMER MmZeroingPageIdleTimer;
+
+/* Statistics, all protected by the PFN lock */
+ULONG MmZeroingPageThreads;
+ULONG MmActiveZeroingPageThreads;
+ULONG MmPagesZeroedByThreads;
+ULONG MmSynchronousZeroPages;
 
 /* PRIVATE FUNCTIONS **********************************************************/
 
@@ -32,34 +48,84 @@ NTAPI
 MiFreeInitializationCode(IN PVOID StartVa,
 IN PVOID EndVa);
 
+static
 VOID
-NTAPI
-MmZeroPageThread(VOID)
+MiZeroPagesNonTemporal(IN PVOID Address,
+                       IN ULONG Size)
+{
+#if defined(_M_IX86) || defined(_M_AMD64)
+    PULONG Page = Address;
+    PULONG End = (PULONG)((ULONG_PTR)Address + Size);
+
+    /* Nobody reads these pages soon, so don't pull them through the caches */
+    if (KeFeatureBits & KF_XMMI64)
+    {
+        while (Page < End)
+        {
+            _mm_stream_si32((int *)&Page[0], 0);
+            _mm_stream_si32((int *)&Page[1], 0);
+            _mm_stream_si32((int *)&Page[2], 0);
+            _mm_stream_si32((int *)&Page[3], 0);
+            Page += 4;
+        }
+
+        /* Non-temporal stores are weakly ordered, flush them before the pages get used */
+        _mm_sfence();
+        return;
+    }
+#endif
+
+    RtlZeroMemory(Address, Size);
+}
+
+static
+DECLSPEC_NORETURN
+VOID
+MiZeroingPageLoop(IN ULONG Processor)
 {
     PKTHREAD Thread = KeGetCurrentThread();
-    PVOID StartAddress, EndAddress;
     PVOID WaitObjects[2];
     KIRQL OldIrql;
     PVOID ZeroAddress;
+    PMMPTE ZeroPte;
+    MMPTE TempPte;
+    PFN_NUMBER Pages[MI_ZERO_PAGE_BATCH];
     PFN_NUMBER PageIndex, FreePage;
     PMMPFN Pfn1;
-
-    /* Get the discardable sections to free them */
-    MiFindInitializationCode(&StartAddress, &EndAddress);
-    if (StartAddress) MiFreeInitializationCode(StartAddress, EndAddress);
-    DPRINT("Free non-cache pages: %lx\n", MmAvailablePages + MiMemoryConsumers[MC_CACHE].PagesUsed);
+    ULONG Count, i;
 
     /* Set our priority to 0 */
     Thread->BasePriority = 0;
     KeSetPriorityThread(Thread, 0);
 
+    /*
+     * Each thread has its own mapping window, and stays on its processor so
+     * that flushing the local TB entries is enough when it gets reused.
+     */
+    KeSetSystemAffinityThread(AFFINITY_MASK(Processor));
+    ZeroPte = MiReserveSystemPtes(MI_ZERO_PAGE_BATCH, SystemPteSpace);
+    if (ZeroPte)
+    {
+        RtlZeroMemory(ZeroPte, MI_ZERO_PAGE_BATCH * sizeof(MMPTE));
+        ZeroAddress = MiPteToAddress(ZeroPte);
+    }
+    else
+    {
+        /* Keep going one page at a time through the zeroing space */
+        DPRINT1("No PTEs for the zero page thread of processor %lu\n", Processor);
+    }
+
+    OldIrql = MiAcquirePfnLock();
+    MmZeroingPageThreads++;
+    MiReleasePfnLock(OldIrql);
+
     /* Setup the wait objects */
     WaitObjects[0] = &MmZeroingPageEvent;
-//    WaitObjects[1] = &PoSystemIdleTimer; FIXME: Implement idle timer
+    WaitObjects[1] = &MmZeroingPageIdleTimer;
 
     while (TRUE)
     {
-        KeWaitForMultipleObjects(1, // 2
+        KeWaitForMultipleObjects(2,
                                  WaitObjects,
                                  WaitAny,
                                  WrFreePage,
@@ -68,47 +134,140 @@ MmZeroPageThread(VOID)
                                  NULL,
                                  NULL);
         OldIrql = MiAcquirePfnLock();
+        MmActiveZeroingPageThreads++;
         MmZeroingPageThreadActive = TRUE;
 
         while (TRUE)
         {
-            if (!MmFreePageListHead.Total)
+            /* Get another thread going if there's a lot left to do */
+            if ((MmActiveZeroingPageThreads < MmZeroingPageThreads) &&
+                (MmFreePageListHead.Total >= MmActiveZeroingPageThreads * MI_ZERO_PAGE_HELPER_THRESHOLD))
             {
-                MmZeroingPageThreadActive = FALSE;
-                MiReleasePfnLock(OldIrql);
-                break;
+                KeSetEvent(&MmZeroingPageEvent, IO_NO_INCREMENT, FALSE);
             }
 
-            PageIndex = MmFreePageListHead.Flink;
-            ASSERT(PageIndex != LIST_HEAD);
-            Pfn1 = MiGetPfnEntry(PageIndex);
-            MI_SET_USAGE(MI_USAGE_ZERO_LOOP);
-            MI_SET_PROCESS2("Kernel 0 Loop");
-            FreePage = MiRemoveAnyPage(MI_GET_PAGE_COLOR(PageIndex));
+            /* Take a batch of pages off the free list */
+            for (Count = 0; (Count < MI_ZERO_PAGE_BATCH) && (MmFreePageListHead.Total); Count++)
+            {
+                PageIndex = MmFreePageListHead.Flink;
+                ASSERT(PageIndex != LIST_HEAD);
+                Pfn1 = MiGetPfnEntry(PageIndex);
+                MI_SET_USAGE(MI_USAGE_ZERO_LOOP);
+                MI_SET_PROCESS2("Kernel 0 Loop");
+                FreePage = MiRemoveAnyPage(MI_GET_PAGE_COLOR(PageIndex));
+
+                /* The first global free page should also be the first on its own list */
+                if (FreePage != PageIndex)
+                {
+                    KeBugCheckEx(PFN_LIST_CORRUPT,
+                                 0x8F,
+                                 FreePage,
+                                 PageIndex,
+                                 0);
+                }
+
+                Pfn1->u1.Flink = LIST_HEAD;
+                Pages[Count] = PageIndex;
+            }
 
-            /* The first global free page should also be the first on its own list */
-            if (FreePage != PageIndex)
+            if (!Count)
             {
-                KeBugCheckEx(PFN_LIST_CORRUPT,
-                             0x8F,
-                             FreePage,
-                             PageIndex,
-                             0);
+                if (!--MmActiveZeroingPageThreads) MmZeroingPageThreadActive = FALSE;
+                MiReleasePfnLock(OldIrql);
+                break;
             }
 
-            Pfn1->u1.Flink = LIST_HEAD;
             MiReleasePfnLock(OldIrql);
 
-            ZeroAddress = MiMapPagesInZeroSpace(Pfn1, 1);
-            ASSERT(ZeroAddress);
-            RtlZeroMemory(ZeroAddress, PAGE_SIZE);
-            MiUnmapPagesInZeroSpace(ZeroAddress, 1);
+            if (ZeroPte)
+            {
+                /* Map the batch */
+                TempPte = ValidKernelPte;
+                for (i = 0; i < Count; i++)
+                {
+                    TempPte.u.Hard.PageFrameNumber = Pages[i];
+                    MI_WRITE_VALID_PTE(&ZeroPte[i], TempPte);
+                }
+
+                MiZeroPagesNonTemporal(ZeroAddress, Count * PAGE_SIZE);
+
+                /* And unmap it again */
+                for (i = 0; i < Count; i++)
+                {
+                    MI_ERASE_PTE(&ZeroPte[i]);
+                    KeInvalidateTlbEntry((PVOID)((ULONG_PTR)ZeroAddress + i * PAGE_SIZE));
+                }
+            }
+            else
+            {
+                for (i = 0; i < Count; i++)
+                {
+                    ZeroAddress = MiMapPagesInZeroSpace(MiGetPfnEntry(Pages[i]), 1);
+                    ASSERT(ZeroAddress);
+                    MiZeroPagesNonTemporal(ZeroAddress, PAGE_SIZE);
+                    MiUnmapPagesInZeroSpace(ZeroAddress, 1);
+                }
+            }
 
             OldIrql = MiAcquirePfnLock();
 
-            MiInsertPageInList(&MmZeroedPageListHead, PageIndex);
+            for (i = 0; i < Count; i++)
+            {
+                MiInsertPageInList(&MmZeroedPageListHead, Pages[i]);
+            }
+            MmPagesZeroedByThreads += Count;
         }
     }
 }
 
+static
+VOID
+NTAPI
+MiZeroingPageThreadStartup(IN PVOID Context)
+{
+    MiZeroingPageLoop((ULONG)(ULONG_PTR)Context);
+}
+
+VOID
+NTAPI
+MmZeroPageThread(VOID)
+{
+    PVOID StartAddress, EndAddress;
+    LARGE_INTEGER DueTime;
+    HANDLE ThreadHandle;
+    NTSTATUS Status;
+    ULONG i;
+
+    /* Get the discardable sections to free them */
+    MiFindInitializationCode(&StartAddress, &EndAddress);
+    if (StartAddress) MiFreeInitializationCode(StartAddress, EndAddress);
+    DPRINT("Free non-cache pages: %lx\n", MmAvailablePages + MiMemoryConsumers[MC_CACHE].PagesUsed);
+
+    /* Pick up free pages that never reached the wake up threshold once in a while */
+    DueTime.QuadPart = Int32x32To64(MI_ZERO_PAGE_IDLE_PERIOD, -10000);
+    KeSetTimerEx(&MmZeroingPageIdleTimer, DueTime, MI_ZERO_PAGE_IDLE_PERIOD, NULL);
+
+    /* Every other processor gets a zeroing thread of its own */
+    for (i = 1; i < (ULONG)KeNumberProcessors; i++)
+    {
+        Status = PsCreateSystemThread(&ThreadHandle,
+                                      THREAD_ALL_ACCESS,
+                                      NULL,
+                                      NULL,
+                                      NULL,
+                                      MiZeroingPageThreadStartup,
+                                      (PVOID)(ULONG_PTR)i);
+        if (!NT_SUCCESS(Status))
+        {
+            DPRINT1("Failed to create the zero page thread of processor %lu: %lx\n", i, Status);
+            continue;
+        }
+
+        ZwClose(ThreadHandle);
+    }
+
+    /* We take care of the boot processor and never come back */
+    MiZeroingPageLoop(0);
+}
+
 /* EOF */
@@ -45,6 +45,9 @@ static HANDLE MiBalancerThreadHandle = NULL;
 static KEVENT MiBalancerEvent;
 static KTIMER MiBalancerTimer;
 
+/* Pages written to the page file ahead of trimming, see MiWriteModifiedPages */
+ULONG MmModifiedPagesWritten;
+
 /* FUNCTIONS ****************************************************************/
 
 VOID
@@ -174,6 +177,90 @@ MiTrimMemoryConsumer(ULONG Consumer, ULONG InitialTarget)
     }
 }
 
+/*
+ * Modified page writer. Gather dirty pages bound for the page file and write
+ * them out in clusters to consecutive page file slots, so that trimming them
+ * right after only needs to drop the clean copies instead of writing every
+ * page on its own.
+ */
+static
+VOID
+MiWriteModifiedPages(ULONG Target)
+{
+    MM_SWAP_WRITE_ENTRY Batch[MM_SWAP_WRITE_CLUSTER];
+    SWAPENTRY SwapEntries[MM_SWAP_WRITE_CLUSTER];
+    PFN_NUMBER Pages[MM_SWAP_WRITE_CLUSTER];
+    PFN_NUMBER CurrentPage;
+    PFN_NUMBER NextPage;
+    ULONG Count, Allocated, i;
+    NTSTATUS Status;
+
+    if (MmNumberOfPagingFiles == 0)
+    {
+        return;
+    }
+
+    CurrentPage = MmGetLRUFirstUserPage();
+    while (CurrentPage != 0 && Target > 0)
+    {
+        /* Gather a cluster */
+        Count = 0;
+        while (CurrentPage != 0 && Count < min(Target, MM_SWAP_WRITE_CLUSTER))
+        {
+            Batch[Count].Page = CurrentPage;
+            if (NT_SUCCESS(MmPrepareSwapWritePhysicalAddress(&Batch[Count])))
+            {
+                Pages[Count] = CurrentPage;
+                Count++;
+            }
+
+            NextPage = MmGetLRUNextUserPage(CurrentPage);
+            CurrentPage = (NextPage > CurrentPage) ? NextPage : 0;
+        }
+
+        if (Count == 0)
+        {
+            break;
+        }
+
+        Allocated = MmAllocSwapPages(Count, SwapEntries);
+        Status = STATUS_PAGEFILE_QUOTA;
+        if (Allocated != 0)
+        {
+            Status = MmWriteToSwapPages(SwapEntries, Pages, Allocated);
+            if (!NT_SUCCESS(Status))
+            {
+                DPRINT1("MM: Failed to write modified pages (Status was 0x%.8X)\n", Status);
+            }
+        }
+
+        for (i = 0; i < Count; i++)
+        {
+            if (i < Allocated && NT_SUCCESS(Status))
+            {
+                MmCompleteSwapWritePhysicalAddress(&Batch[i], SwapEntries[i]);
+            }
+            else
+            {
+                if (i < Allocated)
+                {
+                    MmFreeSwapPage(SwapEntries[i]);
+                }
+                MmCompleteSwapWritePhysicalAddress(&Batch[i], 0);
+            }
+        }
+
+        if (!NT_SUCCESS(Status) || Allocated < Count)
+        {
+            /* Out of page file space, or the writes fail: leave it to the page out path */
+            break;
+        }
+
+        InterlockedExchangeAdd((PLONG)&MmModifiedPagesWritten, Allocated);
+        Target -= Count;
+    }
+}
+
 NTSTATUS
 MmTrimUserMemory(ULONG Target, ULONG Priority, PULONG NrFreedPages)
 {
@@ -183,6 +270,9 @@ MmTrimUserMemory(ULONG Target, ULONG Priority, PULONG NrFreedPages)
 
     (*NrFreedPages) = 0;
 
+    /* Write the dirty pages in clusters first, the page out below then just frees them */
+    MiWriteModifiedPages(Target);
+
     CurrentPage = MmGetLRUFirstUserPage();
     while (CurrentPage != 0 && Target > 0)
     {
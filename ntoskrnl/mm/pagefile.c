@@ -50,9 +50,9 @@ typedef struct _PAGINGFILE
     LARGE_INTEGER CurrentSize;
     PFN_NUMBER FreePages;
     PFN_NUMBER UsedPages;
-    PULONG AllocMap;
+    RTL_BITMAP AllocMap;
     KSPIN_LOCK AllocMapLock;
-    ULONG AllocMapSize;
+    ULONG AllocHint;
     PRETRIEVAL_POINTERS_BUFFER RetrievalPointers;
 }
 PAGINGFILE, *PPAGINGFILE;
@@ -64,6 +64,17 @@ typedef struct _RETRIEVEL_DESCRIPTOR_LIST
 }
 RETRIEVEL_DESCRIPTOR_LIST, *PRETRIEVEL_DESCRIPTOR_LIST;
 
+/* Per request state of a clustered page file write */
+typedef struct _MI_SWAP_WRITE_CLUSTER
+{
+    IO_STATUS_BLOCK Iosb[MM_SWAP_WRITE_CLUSTER];
+    NTSTATUS RunStatus[MM_SWAP_WRITE_CLUSTER];
+    KEVENT Event[MM_SWAP_WRITE_CLUSTER];
+    PMDL Mdl[MM_SWAP_WRITE_CLUSTER];
+    ULONG_PTR MdlBase[MM_SWAP_WRITE_CLUSTER * (sizeof(MDL) + sizeof(PFN_NUMBER)) / sizeof(ULONG_PTR)];
+}
+MI_SWAP_WRITE_CLUSTER, *PMI_SWAP_WRITE_CLUSTER;
+
 /* GLOBALS *******************************************************************/
 
 #define PAIRS_PER_RUN (1024)
@@ -76,6 +87,13 @@ static PPAGINGFILE PagingFileList[MAX_PAGING_FILES];
 /* Lock for examining the list of paging files */
 static KSPIN_LOCK PagingFileListLock;
 
+/*
+ * Clustered writes are too big for the stack of every caller, so they share
+ * one set of state. Only the modified page writer issues them anyway.
+ */
+static MI_SWAP_WRITE_CLUSTER MiSwapWriteCluster;
+static KGUARDED_MUTEX MiSwapWriteClusterLock;
+
 /* Number of paging files */
 ULONG MmNumberOfPagingFiles;
 
@@ -119,6 +137,12 @@ C_ASSERT(FILE_FROM_ENTRY(0xffffffff) < MAX_PAGING_FILES);
 
 static BOOLEAN MmSwapSpaceMessage = FALSE;
 
+/* Page file write statistics, see SystemPageFileWriteInformation */
+ULONG MmSwapWriteIoCount;
+ULONG MmSwapPagesWritten;
+LARGE_INTEGER MmSwapWriteTime;
+ULONG MmMaximumSwapWriteTime;
+
 /* FUNCTIONS *****************************************************************/
 
 VOID
@@ -217,6 +241,140 @@ MmGetOffsetPageFile(PRETRIEVAL_POINTERS_BUFFER RetrievalPointers, LARGE_INTEGER
 #endif
 }
 
+static
+VOID
+MiUpdateSwapWriteStatistics(ULONGLONG StartTime, ULONG Runs, ULONG Count, NTSTATUS Status)
+{
+    ULONG WriteTime;
+
+    WriteTime = (ULONG)(KeQueryInterruptTime() - StartTime);
+    InterlockedExchangeAdd((PLONG)&MmSwapWriteIoCount, Runs);
+    if (NT_SUCCESS(Status))
+    {
+        InterlockedExchangeAdd((PLONG)&MmSwapPagesWritten, Count);
+    }
+    ExInterlockedAddLargeStatistic(&MmSwapWriteTime, WriteTime);
+    if (WriteTime > MmMaximumSwapWriteTime)
+    {
+        MmMaximumSwapWriteTime = WriteTime;
+    }
+}
+
+/*
+ * Write a batch of pages to their swap entries. Entries that follow each
+ * other in the same paging file and on disk go out as a single request,
+ * and all the requests are issued before waiting for any of them.
+ */
+NTSTATUS
+NTAPI
+MmWriteToSwapPages(PSWAPENTRY SwapEntries, PPFN_NUMBER Pages, ULONG Count)
+{
+    PMI_SWAP_WRITE_CLUSTER Cluster = &MiSwapWriteCluster;
+    ULONG i, j, Run, Runs;
+    ULONG_PTR offset;
+    LARGE_INTEGER file_offset, next_offset;
+    PULONG_PTR MdlNext;
+    PPAGINGFILE PagingFile;
+    ULONGLONG StartTime;
+    NTSTATUS Status;
+
+    DPRINT("MmWriteToSwapPages(%lu)\n", Count);
+
+    ASSERT(Count != 0 && Count <= MM_SWAP_WRITE_CLUSTER);
+
+    /* Single pages don't need the cluster state */
+    if (Count == 1)
+    {
+        return MmWriteToSwapPage(SwapEntries[0], Pages[0]);
+    }
+
+    StartTime = KeQueryInterruptTime();
+
+    KeAcquireGuardedMutex(&MiSwapWriteClusterLock);
+    MdlNext = Cluster->MdlBase;
+
+    for (i = 0, Runs = 0; i < Count; i += Run, Runs++)
+    {
+        if (SwapEntries[i] == 0)
+        {
+            KeBugCheck(MEMORY_MANAGEMENT);
+            return(STATUS_UNSUCCESSFUL);
+        }
+
+        PagingFile = PagingFileList[FILE_FROM_ENTRY(SwapEntries[i])];
+        offset = OFFSET_FROM_ENTRY(SwapEntries[i]) - 1;
+
+        if (PagingFile->FileObject == NULL ||
+                PagingFile->FileObject->DeviceObject == NULL)
+        {
+            DPRINT1("Bad paging file 0x%.8X\n", SwapEntries[i]);
+            KeBugCheck(MEMORY_MANAGEMENT);
+        }
+
+        file_offset.QuadPart = offset * PAGE_SIZE;
+        file_offset = MmGetOffsetPageFile(PagingFile->RetrievalPointers, file_offset);
+
+        /* Extend the run for as long as the file stays contiguous on disk */
+        for (j = i + 1; j < Count; j++)
+        {
+            if (FILE_FROM_ENTRY(SwapEntries[j]) != FILE_FROM_ENTRY(SwapEntries[i]) ||
+                    OFFSET_FROM_ENTRY(SwapEntries[j]) - 1 != offset + (j - i))
+            {
+                break;
+            }
+
+            next_offset.QuadPart = (offset + (j - i)) * PAGE_SIZE;
+            next_offset = MmGetOffsetPageFile(PagingFile->RetrievalPointers, next_offset);
+            if (next_offset.QuadPart != file_offset.QuadPart + (j - i) * PAGE_SIZE)
+            {
+                break;
+            }
+        }
+        Run = j - i;
+
+        /* The MDLs and their page arrays are carved out of MdlBase */
+        Cluster->Mdl[Runs] = (PMDL)MdlNext;
+        MdlNext += (sizeof(MDL) + Run * sizeof(PFN_NUMBER)) / sizeof(ULONG_PTR);
+
+        MmInitializeMdl(Cluster->Mdl[Runs], NULL, Run * PAGE_SIZE);
+        MmBuildMdlFromPages(Cluster->Mdl[Runs], &Pages[i]);
+        Cluster->Mdl[Runs]->MdlFlags |= MDL_PAGES_LOCKED;
+
+        KeInitializeEvent(&Cluster->Event[Runs], NotificationEvent, FALSE);
+        Cluster->RunStatus[Runs] = IoSynchronousPageWrite(PagingFile->FileObject,
+                                                          Cluster->Mdl[Runs],
+                                                          &file_offset,
+                                                          &Cluster->Event[Runs],
+                                                          &Cluster->Iosb[Runs]);
+    }
+
+    /* Now wait for all of them */
+    Status = STATUS_SUCCESS;
+    for (i = 0; i < Runs; i++)
+    {
+        if (Cluster->RunStatus[i] == STATUS_PENDING)
+        {
+            KeWaitForSingleObject(&Cluster->Event[i], Executive, KernelMode, FALSE, NULL);
+            Cluster->RunStatus[i] = Cluster->Iosb[i].Status;
+        }
+
+        if (Cluster->Mdl[i]->MdlFlags & MDL_MAPPED_TO_SYSTEM_VA)
+        {
+            MmUnmapLockedPages (Cluster->Mdl[i]->MappedSystemVa, Cluster->Mdl[i]);
+        }
+
+        if (!NT_SUCCESS(Cluster->RunStatus[i]) && NT_SUCCESS(Status))
+        {
+            Status = Cluster->RunStatus[i];
+        }
+    }
+
+    KeReleaseGuardedMutex(&MiSwapWriteClusterLock);
+
+    MiUpdateSwapWriteStatistics(StartTime, Runs, Count, Status);
+    return(Status);
+}
+
 NTSTATUS
 NTAPI
 MmWriteToSwapPage(SWAPENTRY SwapEntry, PFN_NUMBER Page)
@@ -227,8 +385,9 @@ MmWriteToSwapPage(SWAPENTRY SwapEntry, PFN_NUMBER Page)
     IO_STATUS_BLOCK Iosb;
     NTSTATUS Status;
     KEVENT Event;
-    UCHAR MdlBase[sizeof(MDL) + sizeof(ULONG)];
+    UCHAR MdlBase[sizeof(MDL) + sizeof(PFN_NUMBER)];
     PMDL Mdl = (PMDL)MdlBase;
+    ULONGLONG StartTime;
 
     DPRINT("MmWriteToSwapPage\n");
 
@@ -238,6 +397,8 @@ MmWriteToSwapPage(SWAPENTRY SwapEntry, PFN_NUMBER Page)
         return(STATUS_UNSUCCESSFUL);
     }
 
+    StartTime = KeQueryInterruptTime();
+
     i = FILE_FROM_ENTRY(SwapEntry);
     offset = OFFSET_FROM_ENTRY(SwapEntry) - 1;
 
@@ -271,6 +432,8 @@ MmWriteToSwapPage(SWAPENTRY SwapEntry, PFN_NUMBER Page)
     {
         MmUnmapLockedPages (Mdl->MappedSystemVa, Mdl);
     }
+
+    MiUpdateSwapWriteStatistics(StartTime, 1, 1, Status);
     return(Status);
 }
 
@@ -348,6 +511,7 @@ MmInitPagingFile(VOID)
     ULONG i;
 
     KeInitializeSpinLock(&PagingFileListLock);
+    KeInitializeGuardedMutex(&MiSwapWriteClusterLock);
 
     MiFreeSwapPages = 0;
     MiUsedSwapPages = 0;
@@ -360,31 +524,36 @@ MmInitPagingFile(VOID)
     MmNumberOfPagingFiles = 0;
 }
 
+/*
+ * Allocate up to Count consecutive slots, settling for a shorter run when
+ * the file is fragmented. Allocation carries on after the previous run so
+ * that pages trimmed together end up next to each other in the file.
+ */
 static ULONG
-MiAllocPageFromPagingFile(PPAGINGFILE PagingFile)
+MiAllocPagesFromPagingFile(PPAGINGFILE PagingFile, ULONG Count, PULONG Allocated)
 {
     KIRQL oldIrql;
-    ULONG i, j;
+    ULONG off = 0xFFFFFFFF;
 
     KeAcquireSpinLock(&PagingFile->AllocMapLock, &oldIrql);
 
-    for (i = 0; i < PagingFile->AllocMapSize; i++)
+    Count = (ULONG)min(Count, PagingFile->FreePages);
+    while (Count != 0)
     {
-        for (j = 0; j < 32; j++)
+        off = RtlFindClearBitsAndSet(&PagingFile->AllocMap, Count, PagingFile->AllocHint);
+        if (off != 0xFFFFFFFF)
         {
-            if (!(PagingFile->AllocMap[i] & (1 << j)))
-            {
-                PagingFile->AllocMap[i] |= (1 << j);
-                PagingFile->UsedPages++;
-                PagingFile->FreePages--;
-                KeReleaseSpinLock(&PagingFile->AllocMapLock, oldIrql);
-                return((i * 32) + j);
-            }
+            PagingFile->AllocHint = off + Count;
+            PagingFile->UsedPages += Count;
+            PagingFile->FreePages -= Count;
+            *Allocated = Count;
+            break;
         }
+        Count /= 2;
     }
 
     KeReleaseSpinLock(&PagingFile->AllocMapLock, oldIrql);
-    return(0xFFFFFFFF);
+    return(off);
 }
 
 VOID
@@ -405,7 +574,7 @@ MmFreeSwapPage(SWAPENTRY Entry)
     }
     KeAcquireSpinLockAtDpcLevel(&PagingFileList[i]->AllocMapLock);
 
-    PagingFileList[i]->AllocMap[off >> 5] &= (~(1 << (off % 32)));
+    RtlClearBit(&PagingFileList[i]->AllocMap, (ULONG)off);
 
     PagingFileList[i]->FreePages++;
     PagingFileList[i]->UsedPages--;
@@ -417,47 +586,61 @@ MmFreeSwapPage(SWAPENTRY Entry)
     KeReleaseSpinLock(&PagingFileListLock, oldIrql);
 }
 
-SWAPENTRY
+/*
+ * Allocate up to Count swap entries, preferring runs that are contiguous in
+ * a paging file. Returns the number of entries actually allocated.
+ */
+ULONG
 NTAPI
-MmAllocSwapPage(VOID)
+MmAllocSwapPages(ULONG Count, PSWAPENTRY SwapEntries)
 {
     KIRQL oldIrql;
-    ULONG i;
+    ULONG i, j;
     ULONG off;
-    SWAPENTRY entry;
+    ULONG Run;
+    ULONG Allocated = 0;
 
     KeAcquireSpinLock(&PagingFileListLock, &oldIrql);
 
-    if (MiFreeSwapPages == 0)
+    for (i = 0; i < MAX_PAGING_FILES && Allocated < Count && MiFreeSwapPages != 0; i++)
     {
-        KeReleaseSpinLock(&PagingFileListLock, oldIrql);
-        return(0);
-    }
-
-    for (i = 0; i < MAX_PAGING_FILES; i++)
-    {
-        if (PagingFileList[i] != NULL &&
-                PagingFileList[i]->FreePages >= 1)
+        while (PagingFileList[i] != NULL &&
+                PagingFileList[i]->FreePages >= 1 &&
+                Allocated < Count)
         {
-            off = MiAllocPageFromPagingFile(PagingFileList[i]);
+            off = MiAllocPagesFromPagingFile(PagingFileList[i], Count - Allocated, &Run);
             if (off == 0xFFFFFFFF)
             {
                 KeBugCheck(MEMORY_MANAGEMENT);
                 KeReleaseSpinLock(&PagingFileListLock, oldIrql);
-                return(STATUS_UNSUCCESSFUL);
+                return(Allocated);
             }
-            MiUsedSwapPages++;
-            MiFreeSwapPages--;
-            KeReleaseSpinLock(&PagingFileListLock, oldIrql);
+            MiUsedSwapPages += Run;
+            MiFreeSwapPages -= Run;
 
-            entry = ENTRY_FROM_FILE_OFFSET(i, off + 1);
-            return(entry);
+            for (j = 0; j < Run; j++)
+            {
+                SwapEntries[Allocated++] = ENTRY_FROM_FILE_OFFSET(i, off + j + 1);
+            }
         }
     }
 
     KeReleaseSpinLock(&PagingFileListLock, oldIrql);
-    KeBugCheck(MEMORY_MANAGEMENT);
-    return(0);
+    return(Allocated);
+}
+
+SWAPENTRY
+NTAPI
+MmAllocSwapPage(VOID)
+{
+    SWAPENTRY entry;
+
+    if (MmAllocSwapPages(1, &entry) == 0)
+    {
+        return(0);
+    }
+
+    return(entry);
 }
 
 static PRETRIEVEL_DESCRIPTOR_LIST FASTCALL
@@ -490,6 +673,7 @@ NtCreatePagingFile(IN PUNICODE_STRING FileName,
     PPAGINGFILE PagingFile;
     KIRQL oldIrql;
     ULONG AllocMapSize;
+    PULONG AllocMapBuffer;
     FILE_FS_SIZE_INFORMATION FsSizeInformation;
     PRETRIEVEL_DESCRIPTOR_LIST RetDescList;
     PRETRIEVEL_DESCRIPTOR_LIST CurrentRetDescList;
@@ -725,11 +909,10 @@ NtCreatePagingFile(IN PUNICODE_STRING FileName,
     KeInitializeSpinLock(&PagingFile->AllocMapLock);
 
     AllocMapSize = (PagingFile->FreePages / 32) + 1;
-    PagingFile->AllocMap = ExAllocatePool(NonPagedPool,
-                                          AllocMapSize * sizeof(ULONG));
-    PagingFile->AllocMapSize = AllocMapSize;
+    AllocMapBuffer = ExAllocatePool(NonPagedPool,
+                                    AllocMapSize * sizeof(ULONG));
 
-    if (PagingFile->AllocMap == NULL)
+    if (AllocMapBuffer == NULL)
     {
         while (RetDescList)
         {
@@ -753,14 +936,15 @@ NtCreatePagingFile(IN PUNICODE_STRING FileName,
             RetDescList = RetDescList->Next;
             ExFreePool(CurrentRetDescList);
         }
-        ExFreePool(PagingFile->AllocMap);
+        ExFreePool(AllocMapBuffer);
         ExFreePool(PagingFile);
         ObDereferenceObject(FileObject);
         ZwClose(FileHandle);
         return(STATUS_NO_MEMORY);
     }
 
-    RtlZeroMemory(PagingFile->AllocMap, AllocMapSize * sizeof(ULONG));
+    RtlInitializeBitMap(&PagingFile->AllocMap, AllocMapBuffer, (ULONG)PagingFile->FreePages);
+    RtlClearAllBits(&PagingFile->AllocMap);
     RtlZeroMemory(PagingFile->RetrievalPointers, Size);
 
     Count = 0;
@@ -782,7 +966,7 @@ NtCreatePagingFile(IN PUNICODE_STRING FileName,
             PagingFile->RetrievalPointers->Extents[ExtentCount - 1].NextVcn.QuadPart != MaxVcn.QuadPart)
     {
         ExFreePool(PagingFile->RetrievalPointers);
-        ExFreePool(PagingFile->AllocMap);
+        ExFreePool(AllocMapBuffer);
         ExFreePool(PagingFile);
         ObDereferenceObject(FileObject);
         ZwClose(FileHandle);
@@ -190,6 +190,92 @@ MmPageOutPhysicalAddress(PFN_NUMBER Page)
     return(Status);
 }
 
+/*
+ * Get a dirty user page ready for the modified page writer. On success the
+ * owning process stays referenced and the page is kept off limits until
+ * MmCompleteSwapWritePhysicalAddress is called.
+ */
+NTSTATUS
+NTAPI
+MmPrepareSwapWritePhysicalAddress(PMM_SWAP_WRITE_ENTRY SwapWrite)
+{
+    PMM_RMAP_ENTRY entry;
+    PMEMORY_AREA MemoryArea;
+    PMMSUPPORT AddressSpace;
+    PVOID Address;
+    PEPROCESS Process;
+    NTSTATUS Status;
+
+    ExAcquireFastMutex(&RmapListLock);
+    entry = MmGetRmapListHeadPage(SwapWrite->Page);
+
+    while (entry && RMAP_IS_SEGMENT(entry->Address))
+        entry = entry->Next;
+
+    /* Only user pages, the kernel ones are left to the page out path */
+    if (entry == NULL || entry->Address >= MmSystemRangeStart)
+    {
+        ExReleaseFastMutex(&RmapListLock);
+        return(STATUS_UNSUCCESSFUL);
+    }
+
+    Process = entry->Process;
+    Address = entry->Address;
+
+    if (!ExAcquireRundownProtection(&Process->RundownProtect))
+    {
+        ExReleaseFastMutex(&RmapListLock);
+        return STATUS_PROCESS_IS_TERMINATING;
+    }
+
+    Status = ObReferenceObjectByPointer(Process, PROCESS_ALL_ACCESS, NULL, KernelMode);
+    ExReleaseFastMutex(&RmapListLock);
+    if (!NT_SUCCESS(Status))
+    {
+        ExReleaseRundownProtection(&Process->RundownProtect);
+        return Status;
+    }
+    AddressSpace = &Process->Vm;
+
+    MmLockAddressSpace(AddressSpace);
+    MemoryArea = MmLocateMemoryAreaByAddress(AddressSpace, Address);
+    if (MemoryArea == NULL ||
+        MemoryArea->DeleteInProgress ||
+        MemoryArea->Type != MEMORY_AREA_SECTION_VIEW)
+    {
+        Status = STATUS_UNSUCCESSFUL;
+    }
+    else
+    {
+        Status = MmPrepareSwapWriteSectionView(AddressSpace, MemoryArea, Address, SwapWrite);
+    }
+    MmUnlockAddressSpace(AddressSpace);
+
+    if (!NT_SUCCESS(Status))
+    {
+        ExReleaseRundownProtection(&Process->RundownProtect);
+        ObDereferenceObject(Process);
+        return Status;
+    }
+
+    SwapWrite->Process = Process;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Finish off a page prepared by MmPrepareSwapWritePhysicalAddress. SwapEntry
+ * is the entry the page was written to, or 0 if the write failed.
+ */
+VOID
+NTAPI
+MmCompleteSwapWritePhysicalAddress(PMM_SWAP_WRITE_ENTRY SwapWrite, SWAPENTRY SwapEntry)
+{
+    MmCompleteSwapWriteSectionView(SwapWrite, SwapEntry);
+
+    ExReleaseRundownProtection(&SwapWrite->Process->RundownProtect);
+    ObDereferenceObject(SwapWrite->Process);
+}
+
 VOID
 NTAPI
 MmSetCleanAllRmaps(PFN_NUMBER Page)
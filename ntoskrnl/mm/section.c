@@ -137,6 +137,14 @@ POBJECT_TYPE MmSectionObjectType = NULL;
 
 ULONG_PTR MmSubsectionBase;
 
+/*
+ * Number of pages read in around a not present fault on a file backed
+ * section, overridable with the SectionFaultClusterSize registry value.
+ * Zero or one disables clustering.
+ */
+#define MI_DEFAULT_SECTION_FAULT_CLUSTER    8
+ULONG MmSectionFaultClusterSize = MI_DEFAULT_SECTION_FAULT_CLUSTER;
+
 static ULONG SectionCharacteristicsToProtect[16] =
 {
     PAGE_NOACCESS,          /* 0 = NONE */
@@ -1242,6 +1250,123 @@ MiReadPage(PMEMORY_AREA MemoryArea,
     }
     return(STATUS_SUCCESS);
 }
+
+NTSTATUS
+NTAPI
+MiReadPageCluster(PMEMORY_AREA MemoryArea,
+                  LONGLONG SegOffset,
+                  PPFN_NUMBER Pages,
+                  ULONG Count)
+/*
+ * FUNCTION: Read consecutive pages for a section backed memory area.
+ * PARAMETERS:
+ *       MemoryArea - Memory area to read the pages for.
+ *       SegOffset - Offset of the first page to read.
+ *       Pages - Array that receives the pages containing the read data.
+ *       Count - Number of pages to read, they must all be fully backed by
+ *               the same VACB.
+ */
+{
+    LONGLONG BaseOffset;
+    LONGLONG FileOffset;
+    PVOID BaseAddress;
+    BOOLEAN UptoDate;
+    BOOLEAN Direct;
+    PROS_VACB Vacb;
+    PROS_SHARED_CACHE_MAP SharedCacheMap;
+    PMM_SECTION_SEGMENT Segment;
+    PEPROCESS Process;
+    KIRQL Irql;
+    PCHAR Source;
+    PVOID PageAddr;
+    NTSTATUS Status;
+    ULONG i;
+
+    if (Count == 1)
+    {
+        return MiReadPage(MemoryArea, SegOffset, Pages);
+    }
+
+    Segment = MemoryArea->Data.SectionData.Segment;
+    SharedCacheMap = MemoryArea->Data.SectionData.Section->FileObject->SectionObjectPointer->SharedCacheMap;
+    FileOffset = SegOffset + Segment->Image.FileOffset;
+
+    ASSERT(SharedCacheMap);
+    ASSERT(FileOffset / VACB_MAPPING_GRANULARITY ==
+           (FileOffset + Count * PAGE_SIZE - 1) / VACB_MAPPING_GRANULARITY);
+
+    /* Same choice as MiReadPage: share the cache pages when we can */
+    Direct = ((FileOffset % PAGE_SIZE) == 0) &&
+             !(Segment->Image.Characteristics & IMAGE_SCN_MEM_SHARED);
+
+    if (!Direct)
+    {
+        for (i = 0; i < Count; i++)
+        {
+            MI_SET_USAGE(MI_USAGE_SECTION);
+            MI_SET_PROCESS2(PsGetCurrentProcess()->ImageFileName);
+            Status = MmRequestPageMemoryConsumer(MC_USER, TRUE, &Pages[i]);
+            if (!NT_SUCCESS(Status))
+            {
+                while (i--) MmReleasePageMemoryConsumer(MC_USER, Pages[i]);
+                return Status;
+            }
+        }
+    }
+
+    /*
+     * The whole cluster lives in one VACB, so bringing it up to date is a
+     * single paging read.
+     */
+    Status = CcRosGetVacb(SharedCacheMap,
+                          FileOffset,
+                          &BaseOffset,
+                          &BaseAddress,
+                          &UptoDate,
+                          &Vacb);
+    if (NT_SUCCESS(Status) && !UptoDate)
+    {
+        Status = CcReadVirtualAddress(Vacb);
+        if (!NT_SUCCESS(Status))
+        {
+            CcRosReleaseVacb(SharedCacheMap, Vacb, FALSE, FALSE, FALSE);
+        }
+    }
+    if (!NT_SUCCESS(Status))
+    {
+        if (!Direct)
+        {
+            for (i = 0; i < Count; i++) MmReleasePageMemoryConsumer(MC_USER, Pages[i]);
+        }
+        return Status;
+    }
+
+    Process = PsGetCurrentProcess();
+    Source = (PCHAR)BaseAddress + FileOffset - BaseOffset;
+    for (i = 0; i < Count; i++, Source += PAGE_SIZE)
+    {
+        if (Direct)
+        {
+            /* Probe the page, since it's PDE might not be synced */
+            (void)*((volatile char*)Source);
+
+            Pages[i] = MmGetPhysicalAddress(Source).LowPart >> PAGE_SHIFT;
+
+            /* Each page gets unmapped on its own, so each one counts as a mapping */
+            CcRosVacbIncRefCount(Vacb);
+            CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, FALSE, TRUE);
+        }
+        else
+        {
+            PageAddr = MiMapPageInHyperSpace(Process, Pages[i], &Irql);
+            RtlCopyMemory(PageAddr, Source, PAGE_SIZE);
+            MiUnmapPageInHyperSpace(Process, PageAddr, Irql);
+        }
+    }
+
+    CcRosReleaseVacb(SharedCacheMap, Vacb, TRUE, FALSE, FALSE);
+    return(STATUS_SUCCESS);
+}
 #else
 NTSTATUS
 NTAPI
@@ -1273,8 +1398,172 @@ MiReadPage(PMEMORY_AREA MemoryArea,
     *Page = Resources.Page[0];
     return Status;
 }
+
+NTSTATUS
+NTAPI
+MiReadPageCluster(PMEMORY_AREA MemoryArea,
+                  LONGLONG SegOffset,
+                  PPFN_NUMBER Pages,
+                  ULONG Count)
+/*
+ * FUNCTION: Read consecutive pages for a section backed memory area.
+ * PARAMETERS:
+ *       MemoryArea - Memory area to read the pages for.
+ *       SegOffset - Offset of the first page to read.
+ *       Pages - Array that receives the pages containing the read data.
+ *       Count - Number of pages to read.
+ */
+{
+    NTSTATUS Status;
+    ULONG i;
+
+    for (i = 0; i < Count; i++)
+    {
+        Status = MiReadPage(MemoryArea, SegOffset + i * PAGE_SIZE, &Pages[i]);
+        if (!NT_SUCCESS(Status))
+        {
+            while (i--) MmReleasePageMemoryConsumer(MC_USER, Pages[i]);
+            return Status;
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+#endif
+
+/*
+ * Check that the page at SegOffset can be read along with the faulting page
+ * at FaultOffset, as far as the segment and the cache are concerned.
+ */
+static
+BOOLEAN
+MiIsSectionClusterOffset(PMEMORY_AREA MemoryArea,
+                         LONGLONG SegOffset,
+                         LONGLONG FaultOffset)
+{
+    PMM_SECTION_SEGMENT Segment = MemoryArea->Data.SectionData.Segment;
+    BOOLEAN IsImageSection;
+#ifndef NEWCC
+    LONGLONG FileOffset;
 #endif
 
+    IsImageSection = MemoryArea->Data.SectionData.Section->AllocationAttributes & SEC_IMAGE ? TRUE : FALSE;
+
+    /* Stay within the section, and leave partial image pages to MiReadPage */
+    if ((SegOffset >= Segment->Length.QuadPart) ||
+        ((SegOffset + PAGE_SIZE > Segment->RawLength.QuadPart) && IsImageSection))
+    {
+        return FALSE;
+    }
+
+#ifndef NEWCC
+    /* Everything must come from the VACB holding the faulting page */
+    FileOffset = SegOffset + Segment->Image.FileOffset;
+    if ((FileOffset / VACB_MAPPING_GRANULARITY != (FaultOffset + Segment->Image.FileOffset) / VACB_MAPPING_GRANULARITY) ||
+        (FileOffset / VACB_MAPPING_GRANULARITY != (FileOffset + PAGE_SIZE - 1) / VACB_MAPPING_GRANULARITY))
+    {
+        return FALSE;
+    }
+#endif
+
+    return TRUE;
+}
+
+/*
+ * Check that a page next to a fault has never been touched, neither in the
+ * segment nor in the faulting address space. Segment and address space must
+ * be locked.
+ */
+static
+BOOLEAN
+MiIsSectionClusterPage(PEPROCESS Process,
+                       PMEMORY_AREA MemoryArea,
+                       PVOID Address,
+                       LONGLONG SegOffset,
+                       LONGLONG FaultOffset)
+{
+    LARGE_INTEGER Offset;
+
+    if (!MiIsSectionClusterOffset(MemoryArea, SegOffset, FaultOffset))
+    {
+        return FALSE;
+    }
+
+    Offset.QuadPart = SegOffset;
+    if (MmGetPageEntrySectionSegment(MemoryArea->Data.SectionData.Segment, &Offset) != 0)
+    {
+        return FALSE;
+    }
+
+    return !MmIsPagePresent(Process, Address) &&
+           !MmIsPageSwapEntry(Process, Address) &&
+           !MmIsDisabledPage(Process, Address);
+}
+
+/*
+ * Work out how many pages around a not present fault to read in with it.
+ * The cluster covers the aligned block of MmSectionFaultClusterSize pages
+ * holding the fault, trimmed to the view, to the protection region and to
+ * the pages nobody has touched yet. Returns the number of pages and the
+ * index of the faulting page among them.
+ */
+static
+ULONG
+MiGetSectionFaultCluster(PEPROCESS Process,
+                         PMEMORY_AREA MemoryArea,
+                         PVOID RegionBase,
+                         PMM_REGION Region,
+                         PVOID PAddress,
+                         LONGLONG SegOffset,
+                         PULONG FaultIndex)
+{
+    ULONG ClusterSize;
+    ULONG Position;
+    ULONG Before;
+    ULONG After;
+    ULONG_PTR Low;
+    ULONG_PTR High;
+
+    *FaultIndex = 0;
+
+    ClusterSize = min(MmSectionFaultClusterSize, MM_MAX_SECTION_FAULT_CLUSTER);
+    if ((ClusterSize <= 1) || !MiIsSectionClusterOffset(MemoryArea, SegOffset, SegOffset))
+    {
+        return 1;
+    }
+
+    Low = max(MA_GetStartingAddress(MemoryArea), (ULONG_PTR)RegionBase);
+    High = min(MA_GetEndingAddress(MemoryArea), (ULONG_PTR)RegionBase + Region->Length);
+    Position = (ULONG)((SegOffset >> PAGE_SHIFT) % ClusterSize);
+
+    Before = 0;
+    while ((Before < Position) &&
+           ((ULONG_PTR)PAddress - Low >= (Before + 1) * PAGE_SIZE) &&
+           MiIsSectionClusterPage(Process,
+                                  MemoryArea,
+                                  (PCHAR)PAddress - (Before + 1) * PAGE_SIZE,
+                                  SegOffset - (Before + 1) * PAGE_SIZE,
+                                  SegOffset))
+    {
+        Before++;
+    }
+
+    After = 0;
+    while ((Position + After + 1 < ClusterSize) &&
+           (High - (ULONG_PTR)PAddress >= (After + 2) * PAGE_SIZE) &&
+           MiIsSectionClusterPage(Process,
+                                  MemoryArea,
+                                  (PCHAR)PAddress + (After + 1) * PAGE_SIZE,
+                                  SegOffset + (After + 1) * PAGE_SIZE,
+                                  SegOffset))
+    {
+        After++;
+    }
+
+    *FaultIndex = Before;
+    return Before + 1 + After;
+}
+
 NTSTATUS
 NTAPI
 MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
@@ -1291,6 +1580,7 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
     ULONG_PTR Entry1;
     ULONG Attributes;
     PMM_REGION Region;
+    PVOID RegionBase;
     BOOLEAN HasSwapEntry;
     PVOID PAddress;
     PEPROCESS Process = MmGetAddressSpaceOwner(AddressSpace);
@@ -1327,7 +1617,7 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
     Section = MemoryArea->Data.SectionData.Section;
     Region = MmFindRegion((PVOID)MA_GetStartingAddress(MemoryArea),
                           &MemoryArea->Data.SectionData.RegionListHead,
-                          Address, NULL);
+                          Address, &RegionBase);
     ASSERT(Region != NULL);
     /*
      * Lock the segment
@@ -1495,28 +1785,61 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
     if (Entry == 0)
     {
         SWAPENTRY FakeSwapEntry;
+        PFN_NUMBER ClusterPages[MM_MAX_SECTION_FAULT_CLUSTER];
+        ULONG ClusterCount = 1;
+        ULONG FaultIndex = 0;
+        LARGE_INTEGER FirstOffset;
+        LARGE_INTEGER ClusterOffset;
+        PCHAR FirstAddress;
+        BOOLEAN ReadFromFile;
+        ULONG i;
 
         /*
          * If the entry is zero (and it can't change because we have
          * locked the segment) then we need to load the page.
          */
+        ReadFromFile = !(Segment->Flags & MM_PAGEFILE_SEGMENT) &&
+                       !((Offset.QuadPart >= (LONGLONG)PAGE_ROUND_UP(Segment->RawLength.QuadPart) &&
+                          (Section->AllocationAttributes & SEC_IMAGE)));
+
+        /*
+         * Pull in the untouched neighbours of the page while we are at it,
+         * the read costs the same and saves faulting on each of them.
+         */
+        if (ReadFromFile)
+        {
+            ClusterCount = MiGetSectionFaultCluster(Process,
+                                                    MemoryArea,
+                                                    RegionBase,
+                                                    Region,
+                                                    PAddress,
+                                                    Offset.QuadPart,
+                                                    &FaultIndex);
+        }
+        FirstOffset.QuadPart = Offset.QuadPart - FaultIndex * PAGE_SIZE;
+        FirstAddress = (PCHAR)PAddress - FaultIndex * PAGE_SIZE;
 
         /*
-         * Release all our locks and read in the page from disk
+         * Release all our locks and read in the pages from disk
          */
-        MmSetPageEntrySectionSegment(Segment, &Offset, MAKE_SWAP_SSE(MM_WAIT_ENTRY));
+        for (i = 0; i < ClusterCount; i++)
+        {
+            ClusterOffset.QuadPart = FirstOffset.QuadPart + i * PAGE_SIZE;
+            MmSetPageEntrySectionSegment(Segment, &ClusterOffset, MAKE_SWAP_SSE(MM_WAIT_ENTRY));
+        }
         MmUnlockSectionSegment(Segment);
-        MmCreatePageFileMapping(Process, PAddress, MM_WAIT_ENTRY);
+        for (i = 0; i < ClusterCount; i++)
+        {
+            MmCreatePageFileMapping(Process, FirstAddress + i * PAGE_SIZE, MM_WAIT_ENTRY);
+        }
         MmUnlockAddressSpace(AddressSpace);
 
-        if ((Segment->Flags & MM_PAGEFILE_SEGMENT) ||
-                ((Offset.QuadPart >= (LONGLONG)PAGE_ROUND_UP(Segment->RawLength.QuadPart) &&
-                  (Section->AllocationAttributes & SEC_IMAGE))))
+        if (!ReadFromFile)
         {
             MI_SET_USAGE(MI_USAGE_SECTION);
             if (Process) MI_SET_PROCESS2(Process->ImageFileName);
             if (!Process) MI_SET_PROCESS2("Kernel Section");
-            Status = MmRequestPageMemoryConsumer(MC_USER, TRUE, &Page);
+            Status = MmRequestPageMemoryConsumer(MC_USER, TRUE, &ClusterPages[0]);
             if (!NT_SUCCESS(Status))
             {
                 DPRINT1("MmRequestPageMemoryConsumer failed (Status %x)\n", Status);
@@ -1525,10 +1848,10 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
         }
         else
         {
-            Status = MiReadPage(MemoryArea, Offset.QuadPart, &Page);
+            Status = MiReadPageCluster(MemoryArea, FirstOffset.QuadPart, ClusterPages, ClusterCount);
             if (!NT_SUCCESS(Status))
             {
-                DPRINT1("MiReadPage failed (Status %x)\n", Status);
+                DPRINT1("MiReadPageCluster failed (Status %x)\n", Status);
             }
         }
         if (!NT_SUCCESS(Status))
@@ -1540,6 +1863,21 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
              * Cleanup and release locks
              */
             MmLockAddressSpace(AddressSpace);
+
+            /* Nobody asked for the neighbours, give them back */
+            if (ClusterCount > 1)
+            {
+                MmLockSectionSegment(Segment);
+                for (i = 0; i < ClusterCount; i++)
+                {
+                    if (i == FaultIndex) continue;
+                    ClusterOffset.QuadPart = FirstOffset.QuadPart + i * PAGE_SIZE;
+                    MmSetPageEntrySectionSegment(Segment, &ClusterOffset, 0);
+                    MmDeletePageFileMapping(Process, FirstAddress + i * PAGE_SIZE, &FakeSwapEntry);
+                }
+                MmUnlockSectionSegment(Segment);
+            }
+
             MiSetPageEvent(Process, Address);
             DPRINT("Address 0x%p\n", Address);
             return(Status);
@@ -1549,27 +1887,46 @@ MmNotPresentFaultSectionView(PMMSUPPORT AddressSpace,
         MmLockAddressSpace(AddressSpace);
         MmLockSectionSegment(Segment);
 
-        MmDeletePageFileMapping(Process, PAddress, &FakeSwapEntry);
-        DPRINT("CreateVirtualMapping Page %x Process %p PAddress %p Attributes %x\n",
-               Page, Process, PAddress, Attributes);
-        Status = MmCreateVirtualMapping(Process,
-                                        PAddress,
-                                        Attributes,
-                                        &Page,
-                                        1);
-        if (!NT_SUCCESS(Status))
+        for (i = 0; i < ClusterCount; i++)
         {
-            DPRINT1("Unable to create virtual mapping\n");
-            KeBugCheck(MEMORY_MANAGEMENT);
-        }
-        ASSERT(MmIsPagePresent(Process, PAddress));
-        MmInsertRmap(Page, Process, Address);
+            PVOID ClusterAddress = FirstAddress + i * PAGE_SIZE;
 
-        /* Set this section offset has being backed by our new page. */
-        Entry = MAKE_SSE(Page << PAGE_SHIFT, 1);
-        MmSetPageEntrySectionSegment(Segment, &Offset, Entry);
+            MmDeletePageFileMapping(Process, ClusterAddress, &FakeSwapEntry);
+            DPRINT("CreateVirtualMapping Page %x Process %p PAddress %p Attributes %x\n",
+                   ClusterPages[i], Process, ClusterAddress, Attributes);
+            Status = MmCreateVirtualMapping(Process,
+                                            ClusterAddress,
+                                            Attributes,
+                                            &ClusterPages[i],
+                                            1);
+            if (!NT_SUCCESS(Status))
+            {
+                DPRINT1("Unable to create virtual mapping\n");
+                KeBugCheck(MEMORY_MANAGEMENT);
+            }
+            ASSERT(MmIsPagePresent(Process, ClusterAddress));
+            MmInsertRmap(ClusterPages[i], Process, ClusterAddress);
+
+            /* Set this section offset has being backed by our new page. */
+            ClusterOffset.QuadPart = FirstOffset.QuadPart + i * PAGE_SIZE;
+            Entry = MAKE_SSE(ClusterPages[i] << PAGE_SHIFT, 1);
+            MmSetPageEntrySectionSegment(Segment, &ClusterOffset, Entry);
+        }
         MmUnlockSectionSegment(Segment);
 
+        if (Process && ReadFromFile)
+        {
+            if (ClusterCount > 1)
+            {
+                MmGetSectionFaultCounters(Process)->ClusteredFaults++;
+                MmGetSectionFaultCounters(Process)->ClusteredPages += ClusterCount - 1;
+            }
+            else
+            {
+                MmGetSectionFaultCounters(Process)->SinglePageFaults++;
+            }
+        }
+
         MiSetPageEvent(Process, Address);
         DPRINT("Address 0x%p\n", Address);
         return(STATUS_SUCCESS);
@@ -2262,6 +2619,107 @@ MmPageOutSectionView(PMMSUPPORT AddressSpace,
     return(STATUS_SUCCESS);
 }
 
+/*
+ * Called with the address space locked. Checks that the page at Address is
+ * a dirty page that will go to the page file when trimmed, marks it clean,
+ * and puts a wait entry in the segment so that it can't be paged out or
+ * freed while the modified page writer has it.
+ */
+NTSTATUS
+NTAPI
+MmPrepareSwapWriteSectionView(PMMSUPPORT AddressSpace,
+                              PMEMORY_AREA MemoryArea,
+                              PVOID Address,
+                              PMM_SWAP_WRITE_ENTRY SwapWrite)
+{
+    PMM_SECTION_SEGMENT Segment = MemoryArea->Data.SectionData.Segment;
+    PEPROCESS Process = MmGetAddressSpaceOwner(AddressSpace);
+    PFN_NUMBER Page = SwapWrite->Page;
+    LARGE_INTEGER Offset;
+    ULONG_PTR Entry;
+    BOOLEAN Private;
+    KIRQL OldIrql;
+
+    if (MemoryArea->Data.SectionData.Section->AllocationAttributes & SEC_PHYSICALMEMORY)
+    {
+        return STATUS_UNSUCCESSFUL;
+    }
+
+    Offset.QuadPart = (ULONG_PTR)Address - MA_GetStartingAddress(MemoryArea)
+                      + MemoryArea->Data.SectionData.ViewOffset.QuadPart;
+
+    MmLockSectionSegment(Segment);
+
+    Entry = MmGetPageEntrySectionSegment(Segment, &Offset);
+    if ((Entry && MM_IS_WAIT_PTE(Entry)) ||
+        !MmIsPagePresent(Process, Address) ||
+        MmGetPfnForProcess(Process, Address) != Page ||
+        MmGetReferenceCountPage(Page) != 1 ||
+        MmGetSavedSwapEntryPage(Page) != 0 ||
+        !MmIsDirtyPageRmap(Page))
+    {
+        MmUnlockSectionSegment(Segment);
+        return STATUS_UNSUCCESSFUL;
+    }
+
+    /*
+     * Same test as in MmPageOutSectionView. Only take the pages which the
+     * page out path would write to the page file and then free without
+     * writing once they are clean and have a swap entry: private pages of
+     * file sections and the pages of page file sections.
+     */
+    Private = (Segment->Image.Characteristics & IMAGE_SCN_CNT_UNINITIALIZED_DATA) ||
+              IS_SWAP_FROM_SSE(Entry) ||
+              PFN_FROM_SSE(Entry) != Page;
+    if (Private == !!(Segment->Flags & MM_PAGEFILE_SEGMENT))
+    {
+        MmUnlockSectionSegment(Segment);
+        return STATUS_UNSUCCESSFUL;
+    }
+
+    SwapWrite->Segment = Segment;
+    SwapWrite->Offset = Offset;
+    SwapWrite->SectionEntry = Entry;
+
+    MmSetPageEntrySectionSegment(Segment, &Offset, MAKE_SWAP_SSE(MM_WAIT_ENTRY));
+    MmUnlockSectionSegment(Segment);
+
+    /* Anything written from now on dirties the page again */
+    MmSetCleanAllRmaps(Page);
+
+    OldIrql = MiAcquirePfnLock();
+    MmReferencePage(Page);
+    MiReleasePfnLock(OldIrql);
+
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Undo MmPrepareSwapWriteSectionView once the write is done. A clean page
+ * with a saved swap entry gets freed without another write when trimmed.
+ */
+VOID
+NTAPI
+MmCompleteSwapWriteSectionView(PMM_SWAP_WRITE_ENTRY SwapWrite,
+                               SWAPENTRY SwapEntry)
+{
+    if (SwapEntry != 0)
+    {
+        MmSetSavedSwapEntryPage(SwapWrite->Page, SwapEntry);
+    }
+    else
+    {
+        MmSetDirtyAllRmaps(SwapWrite->Page);
+    }
+
+    MmLockSectionSegment(SwapWrite->Segment);
+    MmSetPageEntrySectionSegment(SwapWrite->Segment, &SwapWrite->Offset, SwapWrite->SectionEntry);
+    MmUnlockSectionSegment(SwapWrite->Segment);
+
+    MmDereferencePage(SwapWrite->Page);
+    MiSetPageEvent(NULL, NULL);
+}
+
 NTSTATUS
 NTAPI
 MmWritePageSectionView(PMMSUPPORT AddressSpace,
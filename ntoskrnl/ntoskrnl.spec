@@ -674,6 +674,7 @@
 @ stdcall KeRemoveEntryDeviceQueue(ptr ptr)
 @ stdcall KeRemoveQueue(ptr long ptr)
 @ stdcall KeRemoveQueueDpc(ptr)
+@ stdcall KeRemoveQueueEx(ptr long long ptr ptr long)
 @ stdcall KeRemoveSystemServiceTable(long)
 @ stdcall KeResetEvent(ptr)
 @ stdcall -arch=i386 KeRestoreFloatingPointState(ptr)
@@ -686,6 +687,7 @@
 @ extern KeServiceDescriptorTable
 @ stdcall KeSetAffinityThread(ptr long)
 @ stdcall KeSetBasePriorityThread(ptr long)
+@ stdcall KeSetCoalescableTimer(ptr long long long long ptr)
 @ stdcall KeSetDmaIoCoherency(long)
 @ stdcall KeSetEvent(ptr long long)
 @ stdcall KeSetEventBoostPriority(ptr ptr)
@@ -732,6 +734,8 @@
 @ stdcall -arch=i386 KiDispatchInterrupt()
 @ extern -arch=i386,arm KiEnableTimerWatchdog
 @ stdcall -arch=i386,arm KiIpiServiceRoutine(ptr ptr)
+@ stdcall KiLockStatSpinLockAcquired(ptr ptr int64) #ReactOS-Specific
+@ stdcall KiLockStatSpinLockReleased(ptr) #ReactOS-Specific
 @ fastcall -arch=i386,arm KiReleaseSpinLock(ptr)
 @ cdecl -arch=i386,arm KiUnexpectedInterrupt()
 @ stdcall -arch=i386 Kii386SpinOnSpinLock(ptr long)
@@ -244,6 +244,13 @@ RtlInitializeHeapManager(VOID)
 {
 }
 
+ULONG
+NTAPI
+RtlpGetHeapAffinity(VOID)
+{
+    return KeGetCurrentProcessorNumber();
+}
+
 #if DBG
 VOID FASTCALL
 CHECK_PAGED_CODE_RTL(char *file, int line)
@@ -54,6 +54,9 @@ else()
     set(_WINKD_ FALSE CACHE BOOL "Whether to compile with the KD protocol.")
 endif()
 
+set(LOCK_STATISTICS FALSE CACHE BOOL
+"Whether to compile in kernel spinlock and guarded mutex contention statistics.")
+
 set(_ELF_ FALSE CACHE BOOL
 "Whether to compile support for ELF files.
 Do not enable unless you know what you're doing.")
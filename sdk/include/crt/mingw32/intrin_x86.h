@@ -125,6 +125,13 @@ __INTRIN_INLINE void _mm_sfence(void)
 }
 #endif
 
+#if !HAS_BUILTIN(_mm_stream_si32)
+__INTRIN_INLINE void _mm_stream_si32(int * Destination, int Value)
+{
+	__asm__ __volatile__("movnti %1, %0" : "=m" (*Destination) : "r" (Value));
+}
+#endif
+
 #ifdef __x86_64__
 __INTRIN_INLINE void __faststorefence(void)
 {
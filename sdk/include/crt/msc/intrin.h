@@ -18,6 +18,7 @@ extern "C" {
 #pragma intrinsic(_mm_mfence)
 #pragma intrinsic(_mm_lfence)
 #pragma intrinsic(_mm_sfence)
+#pragma intrinsic(_mm_stream_si32)
 #endif
 #if defined(_M_AMD64)
 #pragma intrinsic(__faststorefence)
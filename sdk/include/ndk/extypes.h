@@ -313,6 +313,16 @@ typedef enum _SYSTEM_INFORMATION_CLASS
     SystemPrefetchPathInformation,
     SystemVerifierFaultsInformation,
     MaxSystemInfoClass,
+
+    //
+    // ReactOS specific classes, kept well away from the NT ones
+    //
+    SystemReactOSInformationBase = 0x1000,
+    SystemWorkQueueInformation = SystemReactOSInformationBase,
+    SystemLockStatisticsInformation,
+    SystemZeroPageInformation,
+    SystemSectionFaultInformation,
+    SystemPageFileWriteInformation,
 } SYSTEM_INFORMATION_CLASS;
 
 //
@@ -799,7 +809,7 @@ typedef struct _SYSTEM_PERFORMANCE_INFORMATION
     ULONG TotalSystemCodePages;
     ULONG NonPagedPoolLookasideHits;
     ULONG PagedPoolLookasideHits;
-    ULONG Spare3Count;
+    ULONG Spare3Count; // ReactOS: pages zeroed on demand because the zeroed list was empty
     ULONG ResidentSystemCachePage;
     ULONG ResidentPagedPoolPage;
     ULONG ResidentSystemDriverPage;
@@ -1528,6 +1538,97 @@ typedef struct _SYSTEM_MEMORY_LIST_INFORMATION
 
 #endif // !NTOS_MODE_USER
 
+//
+// ReactOS Class 0x1000
+//
+typedef struct _SYSTEM_WORK_QUEUE_ENTRY
+{
+    ULONG QueueType;
+    ULONG Processor;
+    ULONG WorkerCount;
+    ULONG DynamicThreadCount;
+    ULONG QueueDepth;
+    ULONG WorkItemsQueued;
+    ULONG WorkItemsProcessed;
+    ULONG WorkItemsStolen;
+    ULONG MaximumWaitTime;
+    LARGE_INTEGER TotalWaitTime;
+} SYSTEM_WORK_QUEUE_ENTRY, *PSYSTEM_WORK_QUEUE_ENTRY;
+
+typedef struct _SYSTEM_WORK_QUEUE_INFORMATION
+{
+    ULONG NumberOfQueues;
+    SYSTEM_WORK_QUEUE_ENTRY Queues[1];
+} SYSTEM_WORK_QUEUE_INFORMATION, *PSYSTEM_WORK_QUEUE_INFORMATION;
+
+//
+// ReactOS Class 0x1001
+//
+#define LOCK_STATISTICS_SPIN_LOCK       0
+#define LOCK_STATISTICS_GUARDED_MUTEX   1
+
+typedef struct _SYSTEM_LOCK_STATISTICS_ENTRY
+{
+    PVOID Lock;
+    PVOID CallSite;
+    ULONG Type;
+    ULONG Acquires;
+    ULONG Contentions;
+    ULONGLONG SpinCycles;
+    ULONGLONG MaximumHoldCycles;
+} SYSTEM_LOCK_STATISTICS_ENTRY, *PSYSTEM_LOCK_STATISTICS_ENTRY;
+
+typedef struct _SYSTEM_LOCK_STATISTICS_INFORMATION
+{
+    ULONG NumberOfLocks;
+    ULONG TotalLocks;
+    ULONG DroppedLocks;
+    SYSTEM_LOCK_STATISTICS_ENTRY Locks[1];
+} SYSTEM_LOCK_STATISTICS_INFORMATION, *PSYSTEM_LOCK_STATISTICS_INFORMATION;
+
+//
+// ReactOS Class 0x1002
+//
+typedef struct _SYSTEM_ZERO_PAGE_INFORMATION
+{
+    ULONG ZeroedPageCount;
+    ULONG FreePageCount;
+    ULONG ZeroingThreads;
+    ULONG ActiveZeroingThreads;
+    ULONG PagesZeroedByThreads;
+    ULONG SynchronousZeroPages;
+} SYSTEM_ZERO_PAGE_INFORMATION, *PSYSTEM_ZERO_PAGE_INFORMATION;
+
+//
+// ReactOS Class 0x1003
+//
+typedef struct _SYSTEM_SECTION_FAULT_ENTRY
+{
+    HANDLE UniqueProcessId;
+    ULONG SinglePageFaults;
+    ULONG ClusteredFaults;
+    ULONG ClusteredPages;
+} SYSTEM_SECTION_FAULT_ENTRY, *PSYSTEM_SECTION_FAULT_ENTRY;
+
+typedef struct _SYSTEM_SECTION_FAULT_INFORMATION
+{
+    ULONG ClusterSize;
+    ULONG NumberOfProcesses;
+    SYSTEM_SECTION_FAULT_ENTRY Processes[1];
+} SYSTEM_SECTION_FAULT_INFORMATION, *PSYSTEM_SECTION_FAULT_INFORMATION;
+
+//
+// ReactOS Class 0x1004
+//
+typedef struct _SYSTEM_PAGE_FILE_WRITE_INFORMATION
+{
+    ULONG WriteIoCount;
+    ULONG PagesWritten;
+    ULONG ModifiedPagesWritten;
+    ULONG MaximumWriteTime;
+    LARGE_INTEGER TotalWriteTime;
+} SYSTEM_PAGE_FILE_WRITE_INFORMATION, *PSYSTEM_PAGE_FILE_WRITE_INFORMATION;
+
 #ifdef __cplusplus
 }; // extern "C"
 #endif
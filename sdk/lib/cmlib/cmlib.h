@@ -202,6 +202,7 @@
 
 #define TAG_CM     '  MC'
 #define TAG_KCB    'bkMC'
+#define TAG_KCB_SUBKEY_CACHE 'ckMC'
 #define TAG_CMHIVE 'vHMC'
 #define TAG_CMSD   'DSMC'
 
@@ -1902,6 +1902,129 @@ RtlpAllocateNonDedicated(PHEAP Heap,
     return NULL;
 }
 
+/* Low fragmentation front end. Busy blocks of the dedicated sizes are
+   parked in per-affinity lookaside lists instead of being returned to
+   the free lists, so that hot sizes are recycled without taking the heap
+   lock, coalescing or splitting. */
+
+FORCEINLINE
+PHEAP_LFH_AFFINITY_SLOT
+RtlpLowFragHeapGetSlot(PHEAP Heap)
+{
+    PHEAP_LFH LowFragHeap = (PHEAP_LFH)Heap->FrontEndHeap;
+
+    return &LowFragHeap->Slots[RtlpGetHeapAffinity() % HEAP_LFH_AFFINITY_SLOTS];
+}
+
+FORCEINLINE
+PHEAP_ENTRY
+RtlpLowFragHeapAllocate(PHEAP Heap,
+                        SIZE_T Index)
+{
+    PHEAP_LFH_AFFINITY_SLOT Slot;
+    PSLIST_ENTRY ListEntry;
+
+    Slot = RtlpLowFragHeapGetSlot(Heap);
+    ListEntry = RtlInterlockedPopEntrySList(&Slot->Buckets[Index]);
+    if (!ListEntry)
+    {
+        Slot->Misses++;
+        return NULL;
+    }
+
+    Slot->Hits++;
+
+    /* The list entry lives in the user part of the block */
+    return (PHEAP_ENTRY)ListEntry - 1;
+}
+
+FORCEINLINE
+BOOLEAN
+RtlpLowFragHeapFree(PHEAP Heap,
+                    PHEAP_ENTRY HeapEntry)
+{
+    PHEAP_LFH_AFFINITY_SLOT Slot;
+    PSLIST_HEADER Bucket;
+
+    /* Only plain busy blocks of the dedicated sizes are cached; anything
+       carrying extra information goes through the regular path */
+    if ((HeapEntry->Flags & ~HEAP_ENTRY_LAST_ENTRY) != HEAP_ENTRY_BUSY ||
+        HeapEntry->Size >= HEAP_LFH_BUCKETS ||
+        HeapEntry->SegmentOffset >= HEAP_SEGMENTS ||
+        HeapEntry->SmallTagIndex == HEAP_LFH_CACHED_TAG)
+    {
+        return FALSE;
+    }
+
+    Slot = RtlpLowFragHeapGetSlot(Heap);
+    Bucket = &Slot->Buckets[HeapEntry->Size];
+
+    /* Don't let a single size hoard the heap */
+    if (RtlQueryDepthSList(Bucket) >= HEAP_LFH_MAX_DEPTH)
+        return FALSE;
+
+    /* Mark the block so a double free is caught instead of corrupting the list */
+    HeapEntry->SmallTagIndex = HEAP_LFH_CACHED_TAG;
+    RtlInterlockedPushEntrySList(Bucket, (PSLIST_ENTRY)(HeapEntry + 1));
+
+    return TRUE;
+}
+
+NTSTATUS
+NTAPI
+RtlpEnableLowFragHeap(PHEAP Heap)
+{
+    PHEAP_LFH LowFragHeap;
+    ULONG i, j;
+
+    /* Nothing to do if it's already there */
+    if (Heap->FrontEndHeapType == HEAP_FRONT_END_LFH)
+        return STATUS_SUCCESS;
+
+    /* The front end relies on the heap being serialized, and it would
+       defeat tail/free checking and tagging */
+    if ((Heap->Flags & (HEAP_NO_SERIALIZE |
+                        HEAP_TAIL_CHECKING_ENABLED |
+                        HEAP_FREE_CHECKING_ENABLED)) ||
+        RtlpHeapIsSpecial(Heap->Flags | Heap->ForceFlags) ||
+        Heap->PseudoTagEntries)
+    {
+        DPRINT1("HEAP: Can't enable LFH on heap %p with flags 0x%08X\n", Heap, Heap->Flags);
+        return STATUS_UNSUCCESSFUL;
+    }
+
+    /* Allocate the front end from the heap itself, it goes away together with it */
+    LowFragHeap = RtlAllocateHeap(Heap, 0, sizeof(HEAP_LFH));
+    if (!LowFragHeap) return STATUS_NO_MEMORY;
+
+    for (i = 0; i < HEAP_LFH_AFFINITY_SLOTS; i++)
+    {
+        for (j = 0; j < HEAP_LFH_BUCKETS; j++)
+            RtlInitializeSListHead(&LowFragHeap->Slots[i].Buckets[j]);
+
+        LowFragHeap->Slots[i].Hits = 0;
+        LowFragHeap->Slots[i].Misses = 0;
+    }
+
+    RtlEnterHeapLock(Heap->LockVariable, TRUE);
+
+    if (Heap->FrontEndHeap)
+    {
+        /* Somebody beat us to it */
+        RtlLeaveHeapLock(Heap->LockVariable);
+        RtlFreeHeap(Heap, 0, LowFragHeap);
+        return STATUS_SUCCESS;
+    }
+
+    /* Publish the front end before the type, the fast paths check the type first */
+    Heap->FrontEndHeap = LowFragHeap;
+    Heap->FrontEndHeapType = HEAP_FRONT_END_LFH;
+
+    RtlLeaveHeapLock(Heap->LockVariable);
+
+    return STATUS_SUCCESS;
+}
+
 /***********************************************************************
  *           HeapAlloc   (KERNEL32.334)
  * RETURNS
@@ -1977,6 +2100,25 @@ RtlAllocateHeap(IN PVOID HeapPtr,
 
     Index = AllocationSize >> HEAP_ENTRY_SHIFT;
 
+    /* Try the low fragmentation front end first */
+    if (Heap->FrontEndHeapType == HEAP_FRONT_END_LFH &&
+        Index < HEAP_LFH_BUCKETS &&
+        EntryFlags == HEAP_ENTRY_BUSY)
+    {
+        InUseEntry = RtlpLowFragHeapAllocate(Heap, Index);
+        if (InUseEntry)
+        {
+            InUseEntry->UnusedBytes = (UCHAR)(AllocationSize - Size);
+            InUseEntry->SmallTagIndex = 0;
+
+            /* Zero memory if that was requested */
+            if (Flags & HEAP_ZERO_MEMORY)
+                RtlZeroMemory(InUseEntry + 1, Size);
+
+            return InUseEntry + 1;
+        }
+    }
+
     /* Acquire the lock if necessary */
     if (!(Flags & HEAP_NO_SERIALIZE))
     {
@@ -2180,6 +2322,17 @@ BOOLEAN NTAPI RtlFreeHeap(
     if (RtlpHeapIsSpecial(Flags))
         return RtlDebugFreeHeap(Heap, Flags, Ptr);
 
+    /* Get pointer to the heap entry */
+    HeapEntry = (PHEAP_ENTRY)Ptr - 1;
+
+    /* Park small blocks in the low fragmentation front end if possible */
+    if (Heap->FrontEndHeapType == HEAP_FRONT_END_LFH &&
+        ((ULONG_PTR)Ptr & 0x7) == 0 &&
+        RtlpLowFragHeapFree(Heap, HeapEntry))
+    {
+        return TRUE;
+    }
+
     /* Lock if necessary */
     if (!(Flags & HEAP_NO_SERIALIZE))
     {
@@ -2187,13 +2340,12 @@ BOOLEAN NTAPI RtlFreeHeap(
         Locked = TRUE;
     }
 
-    /* Get pointer to the heap entry */
-    HeapEntry = (PHEAP_ENTRY)Ptr - 1;
-
     /* Check this entry, fail if it's invalid */
     if (!(HeapEntry->Flags & HEAP_ENTRY_BUSY) ||
         (((ULONG_PTR)Ptr & 0x7) != 0) ||
-        (HeapEntry->SegmentOffset >= HEAP_SEGMENTS))
+        (HeapEntry->SegmentOffset >= HEAP_SEGMENTS) ||
+        (Heap->FrontEndHeapType == HEAP_FRONT_END_LFH &&
+         HeapEntry->SmallTagIndex == HEAP_LFH_CACHED_TAG))
     {
         /* This is an invalid block */
         DPRINT1("HEAP: Trying to free an invalid address %p!\n", Ptr);
@@ -3923,8 +4075,9 @@ RtlSetHeapInformation(IN HANDLE HeapHandle OPTIONAL,
             return STATUS_UNSUCCESSFUL;
         }
 
-        DPRINT1("RtlSetHeapInformation() needs to enable LFH\n");
-        return STATUS_SUCCESS;
+        if (!HeapHandle) return STATUS_INVALID_PARAMETER;
+
+        return RtlpEnableLowFragHeap((PHEAP)HeapHandle);
     }
 
     return STATUS_SUCCESS;
@@ -3963,7 +4116,7 @@ RtlQueryHeapInformation(HANDLE HeapHandle,
     return STATUS_UNSUCCESSFUL;
 }
 
-NTSTATUS
+ULONG
 NTAPI
 RtlMultipleAllocateHeap(IN PVOID HeapHandle,
                         IN ULONG Flags,
@@ -3971,19 +4124,60 @@ RtlMultipleAllocateHeap(IN PVOID HeapHandle,
                         IN ULONG Count,
                         OUT PVOID *Array)
 {
-    UNIMPLEMENTED;
-    return 0;
+    PHEAP Heap = (PHEAP)HeapHandle;
+    BOOLEAN HeapLocked = FALSE;
+    ULONG i;
+
+    /* Take the lock once for the whole batch */
+    if (!((Flags | Heap->ForceFlags) & HEAP_NO_SERIALIZE) &&
+        !RtlpHeapIsSpecial(Flags | Heap->ForceFlags))
+    {
+        RtlEnterHeapLock(Heap->LockVariable, TRUE);
+        HeapLocked = TRUE;
+        Flags |= HEAP_NO_SERIALIZE;
+    }
+
+    for (i = 0; i < Count; i++)
+    {
+        Array[i] = RtlAllocateHeap(Heap, Flags & ~HEAP_GENERATE_EXCEPTIONS, Size);
+        if (!Array[i]) break;
+    }
+
+    if (HeapLocked) RtlLeaveHeapLock(Heap->LockVariable);
+
+    /* Return how many blocks were actually allocated */
+    return i;
 }
 
-NTSTATUS
+ULONG
 NTAPI
 RtlMultipleFreeHeap(IN PVOID HeapHandle,
                     IN ULONG Flags,
                     IN ULONG Count,
                     OUT PVOID *Array)
 {
-    UNIMPLEMENTED;
-    return 0;
+    PHEAP Heap = (PHEAP)HeapHandle;
+    BOOLEAN HeapLocked = FALSE;
+    ULONG i;
+
+    /* Take the lock once for the whole batch */
+    if (!((Flags | Heap->ForceFlags) & HEAP_NO_SERIALIZE) &&
+        !RtlpHeapIsSpecial(Flags | Heap->ForceFlags))
+    {
+        RtlEnterHeapLock(Heap->LockVariable, TRUE);
+        HeapLocked = TRUE;
+        Flags |= HEAP_NO_SERIALIZE;
+    }
+
+    for (i = 0; i < Count; i++)
+    {
+        if (!RtlFreeHeap(Heap, Flags, Array[i])) break;
+    }
+
+    if (HeapLocked) RtlLeaveHeapLock(Heap->LockVariable);
+
+    /* Return how many blocks were actually freed */
+    return i;
 }
 
 /* EOF */
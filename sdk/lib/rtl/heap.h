@@ -55,6 +55,16 @@
 /* Segment flags */
 #define HEAP_USER_ALLOCATED    0x1
 
+/* Front end heap types */
+#define HEAP_FRONT_END_NONE        0
+#define HEAP_FRONT_END_LFH         2
+
+/* Low fragmentation front end parameters */
+#define HEAP_LFH_BUCKETS           HEAP_FREELISTS
+#define HEAP_LFH_AFFINITY_SLOTS    4
+#define HEAP_LFH_MAX_DEPTH         64
+#define HEAP_LFH_CACHED_TAG        0xFF
+
 /* A handy inline to distinguis normal heap, special "debug heap" and special "page heap" */
 FORCEINLINE BOOLEAN
 RtlpHeapIsSpecial(ULONG Flags)
@@ -269,6 +279,21 @@ typedef struct _HEAP
     HEAP_TUNING_PARAMETERS TuningParameters;
 } HEAP, *PHEAP;
 
+/* Per-affinity bucket set of the low fragmentation front end. Each bucket
+   caches busy blocks of exactly one size (in heap granularity units), so a
+   hit never has to touch the free lists nor take the heap lock */
+typedef struct _HEAP_LFH_AFFINITY_SLOT
+{
+    SLIST_HEADER Buckets[HEAP_LFH_BUCKETS];
+    ULONG Hits;
+    ULONG Misses;
+} HEAP_LFH_AFFINITY_SLOT, *PHEAP_LFH_AFFINITY_SLOT;
+
+typedef struct _HEAP_LFH
+{
+    HEAP_LFH_AFFINITY_SLOT Slots[HEAP_LFH_AFFINITY_SLOTS];
+} HEAP_LFH, *PHEAP_LFH;
+
 typedef struct _HEAP_SEGMENT
 {
     HEAP_ENTRY Entry;
@@ -485,4 +510,8 @@ VOID
 NTAPI
 RtlInitializeHeapManager(VOID);
 
+ULONG
+NTAPI
+RtlpGetHeapAffinity(VOID);
+
 #endif
@@ -50,6 +50,15 @@ RtlpAddHeapToProcessList(PHEAP Heap)
     // } _SEH2_END
 }
 
+/* Usermode only! */
+ULONG
+NTAPI
+RtlpGetHeapAffinity(VOID)
+{
+    /* Spread threads over the front end slots by their (4-aligned) thread id */
+    return (ULONG)((ULONG_PTR)NtCurrentTeb()->ClientId.UniqueThread >> 2);
+}
+
 /* Usermode only! */
 VOID
 NTAPI
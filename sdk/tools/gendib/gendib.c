@@ -132,6 +132,7 @@ ROPINFO, *PROPINFO;
 #define FLAG_BOTTOMUP            0x04
 #define FLAG_FORCENOUSESSOURCE   0x08
 #define FLAG_FORCERAWSOURCEAVAIL 0x10
+#define FLAG_UNALIGNEDSOURCE     0x20
 
 static PROPINFO
 FindRopInfo(unsigned RopCode)
@@ -245,7 +246,7 @@ CreateShiftTables(FILE *Out)
 
 static void
 CreateOperation(FILE *Out, unsigned Bpp, PROPINFO RopInfo, unsigned SourceBpp,
-                unsigned Bits)
+                unsigned Bits, int Word)
 {
     const char *Cast;
     const char *Dest;
@@ -257,6 +258,11 @@ CreateOperation(FILE *Out, unsigned Bpp, PROPINFO RopInfo, unsigned SourceBpp,
         Cast = "";
         Dest = "*DestPtr";
     }
+    else if (24 == Bpp)
+    {
+        Cast = "";
+        Dest = "Dest";
+    }
     else if (16 == Bpp)
     {
         Cast = "(USHORT) ";
@@ -284,7 +290,14 @@ CreateOperation(FILE *Out, unsigned Bpp, PROPINFO RopInfo, unsigned SourceBpp,
                 Output(Out, "%sSource", Cast);
                 break;
             case 'P':
-                Output(Out, "%sPattern", Cast);
+                if (Word < 0)
+                {
+                    Output(Out, "%sPattern", Cast);
+                }
+                else
+                {
+                    Output(Out, "PatternWords[%d]", Word);
+                }
                 break;
             case 'D':
                 Output(Out, "%s", Dest);
@@ -334,7 +347,7 @@ CreateBase(FILE *Out, int Source, int Flags, unsigned Bpp)
     if (Source)
     {
         Output(Out, "             %sBltInfo->SourcePoint.x",
-               16 < Bpp ? "" : "((");
+               16 < Bpp || 0 != (Flags & FLAG_UNALIGNEDSOURCE) ? "" : "((");
     }
     else
     {
@@ -348,12 +361,12 @@ CreateBase(FILE *Out, int Source, int Flags, unsigned Bpp)
     {
         Output(Out, " * %u", Bpp / 8);
     }
-    if (Source && Bpp <= 16)
+    if (Source && Bpp <= 16 && 0 == (Flags & FLAG_UNALIGNEDSOURCE))
     {
         Output(Out, ") & ~ 0x3)");
     }
     Output(Out, ";\n", Bpp / 8);
-    if (Source && Bpp <= 16)
+    if (Source && Bpp <= 16 && 0 == (Flags & FLAG_UNALIGNEDSOURCE))
     {
         Output(Out, "BaseSourcePixels = %u - (BltInfo->SourcePoint.x & 0x%x);\n",
                32 / Bpp, 32 / Bpp - 1);
@@ -445,7 +458,7 @@ static void
 CreateCounts(FILE *Out, unsigned Bpp)
 {
     MARK(Out);
-    if (32 != Bpp)
+    if (Bpp < 24)
     {
         if (8 < Bpp)
         {
@@ -495,13 +508,85 @@ CreateSetSinglePixel(FILE *Out, unsigned Bpp, PROPINFO RopInfo, int Flags,
     {
         Output(Out, "\n");
     }
-    CreateOperation(Out, Bpp, RopInfo, SourceBpp, 16);
+    if (24 == Bpp && RopInfo->UsesDest)
+    {
+        Output(Out, "Dest = *(PUSHORT) DestPtr + (*((PUCHAR) DestPtr + 2) << 16);\n");
+    }
+    CreateOperation(Out, Bpp, RopInfo, SourceBpp, 16, -1);
     Output(Out, ";\n");
+    if (24 == Bpp)
+    {
+        Output(Out, "*(PUSHORT) DestPtr = (USHORT) Dest;\n");
+        Output(Out, "*((PUCHAR) DestPtr + 2) = (UCHAR) (Dest >> 16);\n");
+    }
     MARK(Out);
     Output(Out, "\n");
     Output(Out, "DestPtr = (PULONG)((char *) DestPtr + %u);\n", Bpp / 8);
 }
 
+/*
+ * Named rops are plain bitwise operations, so when the source has the same
+ * layout as the destination and the pattern is a solid color, 4 pixels at
+ * 24bpp can be handled as 3 ULONGs without splitting them into pixels.
+ * The generic routine keeps doing one pixel at a time, which makes it a
+ * reference for the self test.
+ */
+static int
+UsesPackedWords(unsigned Bpp, PROPINFO RopInfo, int Flags, unsigned SourceBpp)
+{
+    if (24 != Bpp || ROPCODE_GENERIC == RopInfo->RopCode)
+    {
+        return 0;
+    }
+    if (RopInfo->UsesPattern && 0 != (Flags & FLAG_PATTERNSURFACE))
+    {
+        return 0;
+    }
+    if (RopInfo->UsesSource && 0 == (Flags & FLAG_FORCENOUSESSOURCE) &&
+            (24 != SourceBpp || 0 == (Flags & FLAG_TRIVIALXLATE)))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+static void
+CreateLine24(FILE *Out, PROPINFO RopInfo, int Flags, unsigned SourceBpp)
+{
+    unsigned Word;
+
+    MARK(Out);
+    if (UsesPackedWords(24, RopInfo, Flags, SourceBpp))
+    {
+        Output(Out, "for (i = 4; i <= CenterCount; i += 4)\n");
+        Output(Out, "{\n");
+        for (Word = 0; Word < 3; Word++)
+        {
+            if (RopInfo->UsesSource)
+            {
+                Output(Out, "Source = *SourcePtr++;\n");
+            }
+            CreateOperation(Out, 24, RopInfo, SourceBpp, 32,
+                            RopInfo->UsesPattern ? (int) Word : -1);
+            Output(Out, ";\n");
+            Output(Out, "DestPtr++;\n");
+        }
+        Output(Out, "}\n");
+        Output(Out, "\n");
+        Output(Out, "for (i -= 4; i < CenterCount; i++)\n");
+    }
+    else
+    {
+        Output(Out, "for (i = 0; i < CenterCount; i++)\n");
+    }
+    Output(Out, "{\n");
+    CreateSetSinglePixel(Out, 24, RopInfo, Flags, SourceBpp);
+    MARK(Out);
+    Output(Out, "}\n");
+    Output(Out, "\n");
+}
+
 static void
 CreateBitCase(FILE *Out, unsigned Bpp, PROPINFO RopInfo, int Flags,
               unsigned SourceBpp)
@@ -513,7 +598,16 @@ CreateBitCase(FILE *Out, unsigned Bpp, PROPINFO RopInfo, int Flags,
     {
         if (0 == (Flags & FLAG_FORCENOUSESSOURCE))
         {
-            CreateBase(Out, 1, Flags, SourceBpp);
+            /* A plain copy moves bytes, it doesn't read whole words */
+            if (ROPCODE_SRCCOPY == RopInfo->RopCode &&
+                    0 != (Flags & FLAG_TRIVIALXLATE) && Bpp == SourceBpp)
+            {
+                CreateBase(Out, 1, Flags | FLAG_UNALIGNEDSOURCE, SourceBpp);
+            }
+            else
+            {
+                CreateBase(Out, 1, Flags, SourceBpp);
+            }
         }
         CreateBase(Out, 0, Flags, Bpp);
         CreateCounts(Out, Bpp);
@@ -544,6 +638,12 @@ CreateBitCase(FILE *Out, unsigned Bpp, PROPINFO RopInfo, int Flags,
         Output(Out, "BasePatternX = (BltInfo->DestRect.left - BltInfo->BrushOrigin.x) %%\n");
         Output(Out, "           BltInfo->PatternSurface->sizlBitmap.cx;\n");
     }
+    if (RopInfo->UsesPattern && UsesPackedWords(Bpp, RopInfo, Flags, SourceBpp))
+    {
+        Output(Out, "PatternWords[0] = (Pattern & 0xffffff) | (Pattern << 24);\n");
+        Output(Out, "PatternWords[1] = ((Pattern >> 8) & 0xffff) | (Pattern << 16);\n");
+        Output(Out, "PatternWords[2] = ((Pattern >> 16) & 0xff) | (Pattern << 8);\n");
+    }
 
     Output(Out, "for (LineIndex = 0; LineIndex < LineCount; LineIndex++)\n");
     Output(Out, "{\n");
@@ -573,6 +673,12 @@ CreateBitCase(FILE *Out, unsigned Bpp, PROPINFO RopInfo, int Flags,
         Output(Out, "RtlMoveMemory(DestBase, SourceBase, CenterCount);\n");
         Output(Out, "\n");
     }
+    else if (24 == Bpp)
+    {
+        Output(Out, "\n");
+        CreateLine24(Out, RopInfo, Flags, SourceBpp);
+        MARK(Out);
+    }
     else
     {
         Output(Out, "\n");
@@ -625,7 +731,7 @@ CreateBitCase(FILE *Out, unsigned Bpp, PROPINFO RopInfo, int Flags,
             }
             Output(Out, "\n");
         }
-        CreateOperation(Out, Bpp, RopInfo, SourceBpp, 32);
+        CreateOperation(Out, Bpp, RopInfo, SourceBpp, 32, -1);
         Output(Out, ";\n");
         MARK(Out);
         Output(Out, "\n");
@@ -648,22 +754,22 @@ CreateBitCase(FILE *Out, unsigned Bpp, PROPINFO RopInfo, int Flags,
             Output(Out, "}\n");
             Output(Out, "\n");
         }
-        if (RopInfo->UsesPattern && 0 != (Flags & FLAG_PATTERNSURFACE))
+    }
+    if (RopInfo->UsesPattern && 0 != (Flags & FLAG_PATTERNSURFACE))
+    {
+        if (0 == (Flags & FLAG_BOTTOMUP))
         {
-            if (0 == (Flags & FLAG_BOTTOMUP))
-            {
-                Output(Out, "if (BltInfo->PatternSurface->sizlBitmap.cy <= ++PatternY)\n");
-                Output(Out, "{\n");
-                Output(Out, "PatternY -= BltInfo->PatternSurface->sizlBitmap.cy;\n");
-                Output(Out, "}\n");
-            }
-            else
-            {
-                Output(Out, "if (0 == PatternY--)\n");
-                Output(Out, "{\n");
-                Output(Out, "PatternY = BltInfo->PatternSurface->sizlBitmap.cy - 1;\n");
-                Output(Out, "}\n");
-            }
+            Output(Out, "if (BltInfo->PatternSurface->sizlBitmap.cy <= ++PatternY)\n");
+            Output(Out, "{\n");
+            Output(Out, "PatternY -= BltInfo->PatternSurface->sizlBitmap.cy;\n");
+            Output(Out, "}\n");
+        }
+        else
+        {
+            Output(Out, "if (0 == PatternY--)\n");
+            Output(Out, "{\n");
+            Output(Out, "PatternY = BltInfo->PatternSurface->sizlBitmap.cy - 1;\n");
+            Output(Out, "}\n");
         }
     }
     if (RopInfo->UsesSource && 0 == (Flags & FLAG_FORCENOUSESSOURCE))
@@ -820,7 +926,15 @@ CreatePrimitive(FILE *Out, unsigned Bpp, PROPINFO RopInfo)
             Output(Out, "ULONG RawSource;\n");
             Output(Out, "unsigned SourcePixels, BaseSourcePixels;\n");
         }
-        if (32 == Bpp)
+        if (24 == Bpp)
+        {
+            Output(Out, "ULONG Dest = 0;\n");
+            if (RopInfo->UsesPattern)
+            {
+                Output(Out, "ULONG PatternWords[3];\n");
+            }
+        }
+        if (24 <= Bpp)
         {
             Output(Out, "ULONG CenterCount;\n");
         }
@@ -967,6 +1081,99 @@ CreateBitBlt(FILE *Out, unsigned Bpp)
     Output(Out, "}\n");
 }
 
+/*
+ * Runs every named rop on a small surface and compares the result with the
+ * one of the generic routine, which works one pixel at a time through
+ * DIB_DoRop. Only built for checked builds.
+ */
+static void
+CreateSelfTest(FILE *Out, unsigned Bpp)
+{
+    unsigned RopCode;
+    PROPINFO RopInfo;
+
+    MARK(Out);
+    Output(Out, "\n");
+    Output(Out, "#if DBG\n");
+    Output(Out, "static const UCHAR SelfTestRops[] =\n");
+    Output(Out, "{\n");
+    for (RopCode = 0; RopCode < 256; RopCode++)
+    {
+        RopInfo = FindRopInfo(RopCode);
+        if (NULL != RopInfo)
+        {
+            Output(Out, "0x%02x, /* %s */\n", RopCode, RopInfo->Name);
+        }
+    }
+    Output(Out, "};\n");
+    Output(Out, "\n");
+    Output(Out, "BOOLEAN\n");
+    Output(Out, "DIB_%uBPP_BitBltSelfTest(VOID)\n", Bpp);
+    Output(Out, "{\n");
+    Output(Out, "ULONG SourceBits[64], DestBits[64], ExpectedBits[64];\n");
+    Output(Out, "SURFOBJ SourceSurface, DestSurface, ExpectedSurface;\n");
+    Output(Out, "BRUSHOBJ Brush;\n");
+    Output(Out, "BLTINFO BltInfo;\n");
+    Output(Out, "ULONG Index, Pass, i;\n");
+    Output(Out, "BOOLEAN Result = TRUE;\n");
+    Output(Out, "\n");
+    Output(Out, "RtlZeroMemory(&SourceSurface, sizeof(SURFOBJ));\n");
+    Output(Out, "SourceSurface.sizlBitmap.cx = 16;\n");
+    Output(Out, "SourceSurface.sizlBitmap.cy = 4;\n");
+    Output(Out, "SourceSurface.lDelta = %u;\n", 2 * Bpp);
+    Output(Out, "SourceSurface.iBitmapFormat = BMF_%uBPP;\n", Bpp);
+    Output(Out, "DestSurface = SourceSurface;\n");
+    Output(Out, "ExpectedSurface = SourceSurface;\n");
+    Output(Out, "SourceSurface.pvScan0 = SourceBits;\n");
+    Output(Out, "DestSurface.pvScan0 = DestBits;\n");
+    Output(Out, "ExpectedSurface.pvScan0 = ExpectedBits;\n");
+    Output(Out, "\n");
+    Output(Out, "RtlZeroMemory(&Brush, sizeof(BRUSHOBJ));\n");
+    Output(Out, "Brush.iSolidColor = 0x%x;\n",
+           32 == Bpp ? 0xc3a55a : 0xc3a55a & ((1 << Bpp) - 1));
+    Output(Out, "\n");
+    Output(Out, "for (i = 0; i < 64; i++)\n");
+    Output(Out, "{\n");
+    Output(Out, "SourceBits[i] = i * 0x9e3779b9;\n");
+    Output(Out, "DestBits[i] = ExpectedBits[i] = ~i * 0x7f4a7c15;\n");
+    Output(Out, "}\n");
+    Output(Out, "\n");
+    Output(Out, "/* Odd sizes, and the source both above and below the destination */\n");
+    Output(Out, "for (Index = 0; Index < sizeof(SelfTestRops) / sizeof(SelfTestRops[0]); Index++)\n");
+    Output(Out, "{\n");
+    Output(Out, "for (Pass = 0; Pass < 2; Pass++)\n");
+    Output(Out, "{\n");
+    Output(Out, "RtlZeroMemory(&BltInfo, sizeof(BLTINFO));\n");
+    Output(Out, "BltInfo.SourceSurface = &SourceSurface;\n");
+    Output(Out, "BltInfo.Brush = &Brush;\n");
+    Output(Out, "BltInfo.DestRect.left = 1;\n");
+    Output(Out, "BltInfo.DestRect.top = 1;\n");
+    Output(Out, "BltInfo.DestRect.right = 14;\n");
+    Output(Out, "BltInfo.DestRect.bottom = 3;\n");
+    Output(Out, "BltInfo.SourcePoint.x = 2;\n");
+    Output(Out, "BltInfo.SourcePoint.y = 2 * Pass;\n");
+    Output(Out, "BltInfo.Rop4 = SelfTestRops[Index] * 0x101;\n");
+    Output(Out, "\n");
+    Output(Out, "BltInfo.DestSurface = &ExpectedSurface;\n");
+    Output(Out, "DIB_%uBPP_BitBlt_Generic(&BltInfo);\n", Bpp);
+    Output(Out, "BltInfo.DestSurface = &DestSurface;\n");
+    Output(Out, "PrimitivesTable[SelfTestRops[Index]](&BltInfo);\n");
+    Output(Out, "\n");
+    Output(Out, "if (sizeof(DestBits) != RtlCompareMemory(DestBits, ExpectedBits, sizeof(DestBits)))\n");
+    Output(Out, "{\n");
+    Output(Out, "DbgPrint(\"DIB_%uBPP_BitBlt: rop 0x%%02x differs from the generic routine\\n\",\n", Bpp);
+    Output(Out, "         SelfTestRops[Index]);\n");
+    Output(Out, "RtlCopyMemory(DestBits, ExpectedBits, sizeof(DestBits));\n");
+    Output(Out, "Result = FALSE;\n");
+    Output(Out, "}\n");
+    Output(Out, "}\n");
+    Output(Out, "}\n");
+    Output(Out, "\n");
+    Output(Out, "return Result;\n");
+    Output(Out, "}\n");
+    Output(Out, "#endif\n");
+}
+
 static void
 Generate(char *OutputDir, unsigned Bpp)
 {
@@ -1014,6 +1221,7 @@ Generate(char *OutputDir, unsigned Bpp)
     }
     CreateTable(Out, Bpp);
     CreateBitBlt(Out, Bpp);
+    CreateSelfTest(Out, Bpp);
 
     fclose(Out);
 }
@@ -1023,7 +1231,7 @@ main(int argc, char *argv[])
 {
     unsigned Index;
     static unsigned DestBpp[] =
-    { 8, 16, 32 };
+    { 8, 16, 24, 32 };
 
     if (argc < 2)
         return 0;
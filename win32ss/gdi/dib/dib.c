@@ -248,4 +248,19 @@ Dummy_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
   return FALSE;
 }
 
+#if DBG
+BOOLEAN
+DIB_BitBltSelfTest(VOID)
+{
+  BOOLEAN Result = TRUE;
+
+  if (!DIB_8BPP_BitBltSelfTest()) Result = FALSE;
+  if (!DIB_16BPP_BitBltSelfTest()) Result = FALSE;
+  if (!DIB_24BPP_BitBltSelfTest()) Result = FALSE;
+  if (!DIB_32BPP_BitBltSelfTest()) Result = FALSE;
+
+  return Result;
+}
+#endif
+
 /* EOF */
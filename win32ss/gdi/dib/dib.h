@@ -127,6 +127,49 @@ BOOLEAN DIB_XXBPP_StretchBlt(SURFOBJ*,SURFOBJ*,SURFOBJ*,SURFOBJ*,RECTL*,RECTL*,P
 BOOLEAN DIB_XXBPP_FloodFillSolid(SURFOBJ*, BRUSHOBJ*, RECTL*, POINTL*, ULONG, UINT);
 BOOLEAN DIB_XXBPP_AlphaBlend(SURFOBJ*, SURFOBJ*, RECTL*, RECTL*, CLIPOBJ*, XLATEOBJ*, BLENDOBJ*);
 
+#if DBG
+/* Generated by gendib, check the named rop routines against the generic one */
+BOOLEAN DIB_8BPP_BitBltSelfTest(VOID);
+BOOLEAN DIB_16BPP_BitBltSelfTest(VOID);
+BOOLEAN DIB_24BPP_BitBltSelfTest(VOID);
+BOOLEAN DIB_32BPP_BitBltSelfTest(VOID);
+BOOLEAN DIB_BitBltSelfTest(VOID);
+#endif
+
+/* Steps a source coordinate along a destination span, giving the same
+   results as "Start + (i * SrcExt) / DstExt" without a division per pixel.
+   Both extents must be positive. */
+typedef struct _DIB_STEP
+{
+  LONG Pos;
+  LONG Whole;
+  LONG Frac;
+  LONG Acc;
+  LONG DstExt;
+} DIB_STEP, *PDIB_STEP;
+
+static __inline VOID
+DIB_StepInit(PDIB_STEP Step, LONG Start, LONG SrcExt, LONG DstExt)
+{
+  Step->Pos = Start;
+  Step->Whole = SrcExt / DstExt;
+  Step->Frac = SrcExt % DstExt;
+  Step->Acc = 0;
+  Step->DstExt = DstExt;
+}
+
+static __inline VOID
+DIB_StepNext(PDIB_STEP Step)
+{
+  Step->Pos += Step->Whole;
+  Step->Acc += Step->Frac;
+  if (Step->Acc >= Step->DstExt)
+  {
+    Step->Acc -= Step->DstExt;
+    Step->Pos++;
+  }
+}
+
 extern unsigned char notmask[2];
 extern unsigned char altnotmask[2];
 #define MASK1BPP(x) (1<<(7-((x)&7)))
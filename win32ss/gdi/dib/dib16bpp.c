@@ -572,6 +572,66 @@ Clamp5(ULONG val)
    return (val > 31) ? 31 : (UCHAR)val;
 }
 
+/*
+ * Blends 32bpp BGR source rows straight into 5-5-5 or 5-6-5 rows, without
+ * translating every source pixel to RGB first. The math is the same as in
+ * the generic loops of DIB_16BPP_AlphaBlend.
+ */
+static VOID
+DIB_16BPP_AlphaBlendRows(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
+                         RECTL* SourceRect, BLENDFUNCTION BlendFunc, BOOLEAN Is555)
+{
+  LONG Rows, Cols;
+  LONG DstWidth = DestRect->right - DestRect->left;
+  LONG DstHeight = DestRect->bottom - DestRect->top;
+  ULONG ConstAlpha = BlendFunc.SourceConstantAlpha;
+  BOOLEAN SrcAlpha = (BlendFunc.AlphaFormat & AC_SRC_ALPHA) != 0;
+  DIB_STEP StepX, StepY;
+  PUSHORT Dst;
+  PULONG SrcLine;
+  ULONG SrcPixel, DstPixel, Red, Green, Blue, Alpha, Alpha5, Alpha6;
+
+  DIB_StepInit(&StepY, SourceRect->top, SourceRect->bottom - SourceRect->top, DstHeight);
+  for (Rows = 0; Rows < DstHeight; Rows++)
+  {
+    Dst = (PUSHORT)((ULONG_PTR)Dest->pvScan0 + ((DestRect->top + Rows) * Dest->lDelta)) +
+          DestRect->left;
+    SrcLine = (PULONG)((ULONG_PTR)Source->pvScan0 + StepY.Pos * Source->lDelta);
+
+    DIB_StepInit(&StepX, SourceRect->left, SourceRect->right - SourceRect->left, DstWidth);
+    for (Cols = 0; Cols < DstWidth; Cols++, Dst++)
+    {
+      SrcPixel = SrcLine[StepX.Pos];
+      Red = (((SrcPixel >> 16) & 0xFF) * ConstAlpha) / 255;
+      Green = (((SrcPixel >> 8) & 0xFF) * ConstAlpha) / 255;
+      Blue = ((SrcPixel & 0xFF) * ConstAlpha) / 255;
+      Alpha = SrcAlpha ? ((SrcPixel >> 24) * ConstAlpha) / 255 : ConstAlpha;
+
+      DstPixel = *Dst;
+      Alpha5 = Alpha >> 3;
+      if (Is555)
+      {
+        *Dst = (USHORT)((DstPixel & 0x8000) |
+          (Clamp5((((DstPixel >> 10) & 0x1F) * (31 - Alpha5)) / 31 + (Red >> 3)) << 10) |
+          (Clamp5((((DstPixel >> 5) & 0x1F) * (31 - Alpha5)) / 31 + (Green >> 3)) << 5) |
+          Clamp5(((DstPixel & 0x1F) * (31 - Alpha5)) / 31 + (Blue >> 3)));
+      }
+      else
+      {
+        Alpha6 = Alpha >> 2;
+        *Dst = (USHORT)(
+          (Clamp5((((DstPixel >> 11) & 0x1F) * (31 - Alpha5)) / 31 + (Red >> 3)) << 11) |
+          (Clamp6((((DstPixel >> 5) & 0x3F) * (63 - Alpha6)) / 63 + (Green >> 2)) << 5) |
+          Clamp5(((DstPixel & 0x1F) * (31 - Alpha5)) / 31 + (Blue >> 3)));
+      }
+
+      DIB_StepNext(&StepX);
+    }
+
+    DIB_StepNext(&StepY);
+  }
+}
+
 BOOLEAN
 DIB_16BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
                      RECTL* SourceRect, CLIPOBJ* ClipRegion,
@@ -618,6 +678,19 @@ DIB_16BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
   }
 
   pexlo = CONTAINING_RECORD(ColorTranslation, EXLATEOBJ, xlo);
+
+  /* Take the row path for the usual 32bpp source */
+  if ((Source->iBitmapFormat == BMF_32BPP) &&
+      (pexlo->ppalSrc->flFlags & PAL_BGR) &&
+      (pexlo->ppalDst->flFlags & (PAL_RGB16_555 | PAL_RGB16_565)) &&
+      (SourceRect->right > SourceRect->left) && (SourceRect->bottom > SourceRect->top) &&
+      (DestRect->right > DestRect->left) && (DestRect->bottom > DestRect->top))
+  {
+    DIB_16BPP_AlphaBlendRows(Dest, Source, DestRect, SourceRect, BlendFunc,
+                             (pexlo->ppalDst->flFlags & PAL_RGB16_555) != 0);
+    return TRUE;
+  }
+
   EXLATEOBJ_vInitialize(&exloSrcRGB, pexlo->ppalSrc, &gpalRGB, 0, 0, 0);
 
   if (pexlo->ppalDst->flFlags & PAL_RGB16_555)
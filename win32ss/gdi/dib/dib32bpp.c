@@ -50,7 +50,7 @@ BOOLEAN
 DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 {
   LONG     i, j, sx, sy, xColor, f1;
-  PBYTE    SourceBits, DestBits, SourceLine, DestLine;
+  PBYTE    SourceBits, DestBits, SourceLine;
   PBYTE    SourceBits_4BPP, SourceLine_4BPP;
   PDWORD   Source32, Dest32;
 
@@ -112,72 +112,22 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
     break;
 
   case BMF_8BPP:
-    SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + BltInfo->SourcePoint.x;
-    DestLine = DestBits;
-
-    for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
-    {
-      SourceBits = SourceLine;
-      DestBits = DestLine;
-
-      for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
-      {
-        xColor = *SourceBits;
-        *((PDWORD) DestBits) = (DWORD)XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, xColor);
-        SourceBits += 1;
-        DestBits += 4;
-      }
-
-      SourceLine += BltInfo->SourceSurface->lDelta;
-      DestLine += BltInfo->DestSurface->lDelta;
-    }
-    break;
-
   case BMF_16BPP:
-    SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + 2 * BltInfo->SourcePoint.x;
-    DestLine = DestBits;
-
-    for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
-    {
-      SourceBits = SourceLine;
-      DestBits = DestLine;
-
-      for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
-      {
-        xColor = *((PWORD) SourceBits);
-        *((PDWORD) DestBits) = (DWORD)XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, xColor);
-        SourceBits += 2;
-        DestBits += 4;
-      }
-
-      SourceLine += BltInfo->SourceSurface->lDelta;
-      DestLine += BltInfo->DestSurface->lDelta;
-    }
-    break;
-
   case BMF_24BPP:
     SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0
       + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta)
-      + 3 * BltInfo->SourcePoint.x;
-    DestLine = DestBits;
+      + BltInfo->SourcePoint.x * (BitsPerFormat(BltInfo->SourceSurface->iBitmapFormat) >> 3);
 
     for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
     {
-      SourceBits = SourceLine;
-      DestBits = DestLine;
-
-      for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
-      {
-        xColor = (*(SourceBits + 2) << 0x10) +
-          (*(SourceBits + 1) << 0x08) +
-          (*(SourceBits));
-        *((PDWORD)DestBits) = (DWORD)XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, xColor);
-        SourceBits += 3;
-        DestBits += 4;
-      }
+      XLATEOBJ_vXlateRow(BltInfo->XlateSourceToDest,
+                         BltInfo->SourceSurface->iBitmapFormat,
+                         SourceLine,
+                         (PULONG)DestBits,
+                         BltInfo->DestRect.right - BltInfo->DestRect.left);
 
       SourceLine += BltInfo->SourceSurface->lDelta;
-      DestLine += BltInfo->DestSurface->lDelta;
+      DestBits += BltInfo->DestSurface->lDelta;
     }
     break;
 
@@ -220,12 +170,12 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
         {
           if (BltInfo->DestRect.left < BltInfo->SourcePoint.x)
           {
-            Dest32 = (DWORD *) DestBits;
-            Source32 = (DWORD *) SourceBits;
-            for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
-            {
-              *Dest32++ = XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, *Source32++);
-            }
+            /* Going forward, each pixel is read before it can be overwritten */
+            XLATEOBJ_vXlateRow(BltInfo->XlateSourceToDest,
+                               BMF_32BPP,
+                               SourceBits,
+                               (PULONG)DestBits,
+                               BltInfo->DestRect.right - BltInfo->DestRect.left);
           }
           else
           {
@@ -248,12 +198,12 @@ DIB_32BPP_BitBltSrcCopy(PBLTINFO BltInfo)
         {
           if (BltInfo->DestRect.left < BltInfo->SourcePoint.x)
           {
-            Dest32 = (DWORD *) DestBits;
-            Source32 = (DWORD *) SourceBits;
-            for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
-            {
-              *Dest32++ = XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, *Source32++);
-            }
+            /* Going forward, each pixel is read before it can be overwritten */
+            XLATEOBJ_vXlateRow(BltInfo->XlateSourceToDest,
+                               BMF_32BPP,
+                               SourceBits,
+                               (PULONG)DestBits,
+                               BltInfo->DestRect.right - BltInfo->DestRect.left);
           }
           else
           {
@@ -341,6 +291,98 @@ Clamp8(ULONG val)
   return (val > 255) ? 255 : (UCHAR)val;
 }
 
+/* The helpers below work on two channels at once, kept in the 0x00FF00FF
+   lanes of a ULONG. They give exactly the same results as the per channel
+   "(x * y) / 255" and Clamp8 of the generic loop. */
+
+static __inline ULONG
+Div255x2(ULONG lanes)
+{
+  return ((lanes + 0x00010001 + ((lanes >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+}
+
+static __inline ULONG
+Clamp8x2(ULONG lanes)
+{
+  return (lanes | (((lanes >> 8) & 0x00010001) * 0xFF)) & 0x00FF00FF;
+}
+
+static __inline ULONG
+Scale8x4(ULONG color, ULONG alpha)
+{
+  return Div255x2((color & 0x00FF00FF) * alpha) |
+         (Div255x2(((color >> 8) & 0x00FF00FF) * alpha) << 8);
+}
+
+static __inline ULONG
+Blend8x4(ULONG dst, ULONG src, ULONG alpha)
+{
+  ULONG invalpha = 255 - alpha;
+
+  return Clamp8x2(Div255x2((dst & 0x00FF00FF) * invalpha) + (src & 0x00FF00FF)) |
+         (Clamp8x2(Div255x2(((dst >> 8) & 0x00FF00FF) * invalpha) + ((src >> 8) & 0x00FF00FF)) << 8);
+}
+
+/*
+ * Blends 32bpp or 24bpp source rows that need no color translation straight
+ * into the destination rows, instead of going through DIB_GetSource.
+ */
+static VOID
+DIB_32BPP_AlphaBlendRows(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
+                         RECTL* SourceRect, BLENDFUNCTION BlendFunc)
+{
+  LONG Rows, Cols;
+  LONG DstWidth = DestRect->right - DestRect->left;
+  LONG DstHeight = DestRect->bottom - DestRect->top;
+  ULONG ConstAlpha = BlendFunc.SourceConstantAlpha;
+  BOOLEAN SrcAlpha = (BlendFunc.AlphaFormat & AC_SRC_ALPHA) != 0;
+  BOOLEAN Src32 = (Source->iBitmapFormat == BMF_32BPP);
+  DIB_STEP StepX, StepY;
+  PULONG Dst;
+  PBYTE SrcLine, Src;
+  ULONG SrcPixel, Alpha;
+
+  DIB_StepInit(&StepY, SourceRect->top, SourceRect->bottom - SourceRect->top, DstHeight);
+  for (Rows = 0; Rows < DstHeight; Rows++)
+  {
+    Dst = (PULONG)((ULONG_PTR)Dest->pvScan0 + ((DestRect->top + Rows) * Dest->lDelta) +
+                   (DestRect->left << 2));
+    SrcLine = (PBYTE)Source->pvScan0 + StepY.Pos * Source->lDelta;
+
+    DIB_StepInit(&StepX, SourceRect->left, SourceRect->right - SourceRect->left, DstWidth);
+    for (Cols = 0; Cols < DstWidth; Cols++, Dst++)
+    {
+      if (Src32)
+      {
+        SrcPixel = ((PULONG)SrcLine)[StepX.Pos];
+        if (ConstAlpha != 255)
+          SrcPixel = Scale8x4(SrcPixel, ConstAlpha);
+      }
+      else
+      {
+        /* 24bpp has no alpha, the constant alpha takes its place */
+        Src = SrcLine + StepX.Pos * 3;
+        SrcPixel = Src[0] | (Src[1] << 8) | (Src[2] << 16);
+        if (ConstAlpha != 255)
+          SrcPixel = Scale8x4(SrcPixel, ConstAlpha);
+        SrcPixel |= ConstAlpha << 24;
+      }
+
+      Alpha = SrcAlpha ? (SrcPixel >> 24) : ConstAlpha;
+
+      /* Opaque pixels replace the destination, empty ones leave it alone */
+      if (Alpha == 255)
+        *Dst = SrcPixel;
+      else if (Alpha != 0 || SrcPixel != 0)
+        *Dst = Blend8x4(*Dst, SrcPixel, Alpha);
+
+      DIB_StepNext(&StepX);
+    }
+
+    DIB_StepNext(&StepY);
+  }
+}
+
 BOOLEAN
 DIB_32BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
                      RECTL* SourceRect, CLIPOBJ* ClipRegion,
@@ -379,6 +421,16 @@ DIB_32BPP_AlphaBlend(SURFOBJ* Dest, SURFOBJ* Source, RECTL* DestRect,
     return FALSE;
   }
 
+  /* Take the row path when the source bits can be used as they are */
+  if ((Source->iBitmapFormat == BMF_32BPP || Source->iBitmapFormat == BMF_24BPP) &&
+      (!ColorTranslation || (ColorTranslation->flXlate & XO_TRIVIAL)) &&
+      (SourceRect->right > SourceRect->left) && (SourceRect->bottom > SourceRect->top) &&
+      (DestRect->right > DestRect->left) && (DestRect->bottom > DestRect->top))
+  {
+    DIB_32BPP_AlphaBlendRows(Dest, Source, DestRect, SourceRect, BlendFunc);
+    return TRUE;
+  }
+
   Dst = (PULONG)((ULONG_PTR)Dest->pvScan0 + (DestRect->top * Dest->lDelta) +
     (DestRect->left << 2));
   SrcBpp = BitsPerFormat(Source->iBitmapFormat);
@@ -54,9 +54,11 @@ DIB_8BPP_VLine(SURFOBJ *SurfObj, LONG x, LONG y1, LONG y2, ULONG c)
 BOOLEAN
 DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
 {
-  LONG     i, j, sx, sy, xColor, f1;
+  LONG     i, j, k, cx, sx, sy, xColor, f1;
+  ULONG    cjSrcPixel;
   PBYTE    SourceBits, DestBits, SourceLine, DestLine;
   PBYTE    SourceBits_4BPP, SourceLine_4BPP;
+  ULONG    aulChunk[64];
 
   DestBits = (PBYTE)BltInfo->DestSurface->pvScan0 + (BltInfo->DestRect.top * BltInfo->DestSurface->lDelta) + BltInfo->DestRect.left;
 
@@ -170,53 +172,10 @@ DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
       break;
 
     case BMF_16BPP:
-      SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + 2 * BltInfo->SourcePoint.x;
-      DestLine = DestBits;
-
-      for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
-      {
-        SourceBits = SourceLine;
-        DestBits = DestLine;
-
-        for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
-        {
-          xColor = *((PWORD) SourceBits);
-          *DestBits = (BYTE)XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, xColor);
-          SourceBits += 2;
-          DestBits += 1;
-        }
-
-        SourceLine += BltInfo->SourceSurface->lDelta;
-        DestLine += BltInfo->DestSurface->lDelta;
-      }
-      break;
-
     case BMF_24BPP:
-      SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + 3 * BltInfo->SourcePoint.x;
-      DestLine = DestBits;
-
-      for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
-      {
-        SourceBits = SourceLine;
-        DestBits = DestLine;
-
-        for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
-        {
-          xColor = (*(SourceBits + 2) << 0x10) +
-             (*(SourceBits + 1) << 0x08) +
-             (*(SourceBits));
-          *DestBits = (BYTE)XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, xColor);
-          SourceBits += 3;
-          DestBits += 1;
-        }
-
-        SourceLine += BltInfo->SourceSurface->lDelta;
-        DestLine += BltInfo->DestSurface->lDelta;
-      }
-      break;
-
     case BMF_32BPP:
-      SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + 4 * BltInfo->SourcePoint.x;
+      cjSrcPixel = BitsPerFormat(BltInfo->SourceSurface->iBitmapFormat) >> 3;
+      SourceLine = (PBYTE)BltInfo->SourceSurface->pvScan0 + (BltInfo->SourcePoint.y * BltInfo->SourceSurface->lDelta) + cjSrcPixel * BltInfo->SourcePoint.x;
       DestLine = DestBits;
 
       for (j = BltInfo->DestRect.top; j < BltInfo->DestRect.bottom; j++)
@@ -224,12 +183,21 @@ DIB_8BPP_BitBltSrcCopy(PBLTINFO BltInfo)
         SourceBits = SourceLine;
         DestBits = DestLine;
 
-        for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i++)
+        /* Translate the line in chunks, the indices are stored as bytes */
+        for (i = BltInfo->DestRect.left; i < BltInfo->DestRect.right; i += cx)
         {
-          xColor = *((PDWORD) SourceBits);
-          *DestBits = (BYTE)XLATEOBJ_iXlate(BltInfo->XlateSourceToDest, xColor);
-          SourceBits += 4;
-          DestBits += 1;
+          cx = min(BltInfo->DestRect.right - i, (LONG)_countof(aulChunk));
+          XLATEOBJ_vXlateRow(BltInfo->XlateSourceToDest,
+                             BltInfo->SourceSurface->iBitmapFormat,
+                             SourceBits,
+                             aulChunk,
+                             cx);
+          for (k = 0; k < cx; k++)
+          {
+            DestBits[k] = (BYTE)aulChunk[k];
+          }
+          SourceBits += cx * cjSrcPixel;
+          DestBits += cx;
         }
 
         SourceLine += BltInfo->SourceSurface->lDelta;
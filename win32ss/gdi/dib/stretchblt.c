@@ -13,6 +13,116 @@
 #define NDEBUG
 #include <debug.h>
 
+/*
+ * Nearest neighbour SRCCOPY between 16, 24 and 32bpp surfaces, one row kernel
+ * per pair of depths so that the inner loop reads and writes the bits
+ * directly instead of calling GetPixel/PutPixel for every pixel.
+ */
+typedef VOID (*PFN_DIB_StretchRow)(PBYTE, PBYTE, PDIB_STEP, LONG, XLATEOBJ*);
+
+#define READ_PIXEL_16(p) (*(PUSHORT)(p))
+#define READ_PIXEL_24(p) ((ULONG)*(PUSHORT)(p) | ((ULONG)(p)[2] << 16))
+#define READ_PIXEL_32(p) (*(PULONG)(p))
+
+#define WRITE_PIXEL_16(p, c) (*(PUSHORT)(p) = (USHORT)(c))
+#define WRITE_PIXEL_24(p, c) ((p)[0] = (BYTE)(c), (p)[1] = (BYTE)((c) >> 8), (p)[2] = (BYTE)((c) >> 16))
+#define WRITE_PIXEL_32(p, c) (*(PULONG)(p) = (c))
+
+#define DEFINE_STRETCH_ROW(SrcBpp, DstBpp)                                    \
+static VOID                                                                   \
+DIB_StretchRow_##SrcBpp##_##DstBpp(PBYTE pjDst, PBYTE pjSrc, PDIB_STEP StepX, \
+                                   LONG cx, XLATEOBJ *ColorTranslation)       \
+{                                                                             \
+  ULONG Color;                                                                \
+                                                                              \
+  for (; cx > 0; cx--, pjDst += (DstBpp) / 8)                                 \
+  {                                                                           \
+    Color = READ_PIXEL_##SrcBpp(pjSrc + StepX->Pos * ((SrcBpp) / 8));         \
+    if (ColorTranslation)                                                     \
+      Color = XLATEOBJ_iXlate(ColorTranslation, Color);                       \
+    WRITE_PIXEL_##DstBpp(pjDst, Color);                                       \
+    DIB_StepNext(StepX);                                                      \
+  }                                                                           \
+}
+
+DEFINE_STRETCH_ROW(16, 16)
+DEFINE_STRETCH_ROW(16, 24)
+DEFINE_STRETCH_ROW(16, 32)
+DEFINE_STRETCH_ROW(24, 16)
+DEFINE_STRETCH_ROW(24, 24)
+DEFINE_STRETCH_ROW(24, 32)
+DEFINE_STRETCH_ROW(32, 16)
+DEFINE_STRETCH_ROW(32, 24)
+DEFINE_STRETCH_ROW(32, 32)
+
+static const PFN_DIB_StretchRow StretchRowFunctions[3][3] =
+{
+  { DIB_StretchRow_16_16, DIB_StretchRow_16_24, DIB_StretchRow_16_32 },
+  { DIB_StretchRow_24_16, DIB_StretchRow_24_24, DIB_StretchRow_24_32 },
+  { DIB_StretchRow_32_16, DIB_StretchRow_32_24, DIB_StretchRow_32_32 }
+};
+
+static __inline INT
+StretchRowIndex(ULONG iBitmapFormat)
+{
+  switch (iBitmapFormat)
+  {
+  case BMF_16BPP: return 0;
+  case BMF_24BPP: return 1;
+  case BMF_32BPP: return 2;
+  default: return -1;
+  }
+}
+
+static BOOLEAN
+DIB_StretchSrcCopyRows(SURFOBJ *DestSurf, SURFOBJ *SourceSurf,
+                       RECTL *DestRect, RECTL *SourceRect,
+                       XLATEOBJ *ColorTranslation)
+{
+  PFN_DIB_StretchRow pfnRow;
+  INT SrcIndex, DstIndex;
+  LONG DstWidth = DestRect->right - DestRect->left;
+  LONG DstHeight = DestRect->bottom - DestRect->top;
+  LONG SrcWidth = SourceRect->right - SourceRect->left;
+  LONG SrcHeight = SourceRect->bottom - SourceRect->top;
+  LONG DesY;
+  DIB_STEP StepX, StepY;
+  PBYTE pjDst, pjSrc;
+
+  SrcIndex = StretchRowIndex(SourceSurf->iBitmapFormat);
+  DstIndex = StretchRowIndex(DestSurf->iBitmapFormat);
+  if (SrcIndex < 0 || DstIndex < 0)
+    return FALSE;
+
+  /* Mirroring and clipped source pixels are left to the generic code */
+  if (DstWidth <= 0 || DstHeight <= 0 || SrcWidth <= 0 || SrcHeight <= 0)
+    return FALSE;
+  if (SourceRect->left < 0 || SourceRect->top < 0 ||
+      SourceRect->right > SourceSurf->sizlBitmap.cx ||
+      SourceRect->bottom > abs(SourceSurf->sizlBitmap.cy))
+    return FALSE;
+
+  if (ColorTranslation && (ColorTranslation->flXlate & XO_TRIVIAL))
+    ColorTranslation = NULL;
+
+  pfnRow = StretchRowFunctions[SrcIndex][DstIndex];
+
+  DIB_StepInit(&StepY, SourceRect->top, SrcHeight, DstHeight);
+  for (DesY = DestRect->top; DesY < DestRect->bottom; DesY++)
+  {
+    pjDst = (PBYTE)DestSurf->pvScan0 + DesY * DestSurf->lDelta +
+            DestRect->left * BitsPerFormat(DestSurf->iBitmapFormat) / 8;
+    pjSrc = (PBYTE)SourceSurf->pvScan0 + StepY.Pos * SourceSurf->lDelta;
+
+    DIB_StepInit(&StepX, SourceRect->left, SrcWidth, DstWidth);
+    pfnRow(pjDst, pjSrc, &StepX, DstWidth, ColorTranslation);
+
+    DIB_StepNext(&StepY);
+  }
+
+  return TRUE;
+}
+
 BOOLEAN DIB_XXBPP_StretchBlt(SURFOBJ *DestSurf, SURFOBJ *SourceSurf, SURFOBJ *MaskSurf,
                             SURFOBJ *PatternSurface,
                             RECTL *DestRect, RECTL *SourceRect,
@@ -50,6 +160,13 @@ BOOLEAN DIB_XXBPP_StretchBlt(SURFOBJ *DestSurf, SURFOBJ *SourceSurf, SURFOBJ *Ma
 
   ASSERT(IS_VALID_ROP4(ROP));
 
+  /* Plain copies between the common depths have their own row kernels */
+  if (ROP == ROP4_SRCCOPY && !MaskSurf &&
+      DIB_StretchSrcCopyRows(DestSurf, SourceSurf, DestRect, SourceRect, ColorTranslation))
+  {
+    return TRUE;
+  }
+
   fnDest_GetPixel = DibFunctionsForBitmapFormat[DestSurf->iBitmapFormat].DIB_GetPixel;
   fnDest_PutPixel = DibFunctionsForBitmapFormat[DestSurf->iBitmapFormat].DIB_PutPixel;
 
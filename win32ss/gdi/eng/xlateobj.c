@@ -179,7 +179,7 @@ ULONG
 FASTCALL
 EXLATEOBJ_iXlateRGBtoPal(PEXLATEOBJ pexlo, ULONG iColor)
 {
-    return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    return PALETTE_ulGetNearestCachedIndex(pexlo->ppalDst, iColor);
 }
 
 _Function_class_(FN_XLATE)
@@ -252,7 +252,7 @@ EXLATEOBJ_iXlate555toPal(PEXLATEOBJ pexlo, ULONG iColor)
 {
     iColor = EXLATEOBJ_iXlate555toRGB(pexlo, iColor);
 
-    return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    return PALETTE_ulGetNearestCachedIndex(pexlo->ppalDst, iColor);
 }
 
 _Function_class_(FN_XLATE)
@@ -321,7 +321,7 @@ EXLATEOBJ_iXlate565toPal(EXLATEOBJ *pexlo, ULONG iColor)
 {
     iColor = EXLATEOBJ_iXlate565toRGB(pexlo, iColor);
 
-    return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    return PALETTE_ulGetNearestCachedIndex(pexlo->ppalDst, iColor);
 }
 
 _Function_class_(FN_XLATE)
@@ -347,7 +347,7 @@ EXLATEOBJ_iXlateBitfieldsToPal(PEXLATEOBJ pexlo, ULONG iColor)
     iColor = EXLATEOBJ_iXlateShiftAndMask(pexlo, iColor);
 
     /* Return nearest index */
-    return PALETTE_ulGetNearestPaletteIndex(pexlo->ppalDst, iColor);
+    return PALETTE_ulGetNearestCachedIndex(pexlo->ppalDst, iColor);
 }
 
 
@@ -375,6 +375,7 @@ EXLATEOBJ_vInitialize(
     pexlo->xlo.pulXlate = pexlo->aulXlate;
     pexlo->pfnXlate = EXLATEOBJ_iXlateTrivial;
     pexlo->hColorTransform = NULL;
+    pexlo->pulLut16 = NULL;
     pexlo->ppalSrc = ppalSrc;
     pexlo->ppalDst = ppalDst;
     pexlo->xlo.iSrcType = (USHORT)ppalSrc->flFlags;
@@ -654,6 +655,173 @@ EXLATEOBJ_vCleanup(
         EngFreeMem(pexlo->xlo.pulXlate);
     }
     pexlo->xlo.pulXlate = pexlo->aulXlate;
+
+    if (pexlo->pulLut16)
+    {
+        EngFreeMem(pexlo->pulLut16);
+        pexlo->pulLut16 = NULL;
+    }
+}
+
+/*
+ * All of these map every bit field of a 16 bpp color on its own, so the
+ * result for a color is the combination of the results for its fields.
+ */
+static
+BOOLEAN
+EXLATEOBJ_bIsChannelSeparable(
+    _In_ PEXLATEOBJ pexlo)
+{
+    return (pexlo->pfnXlate == EXLATEOBJ_iXlateShiftAndMask ||
+            pexlo->pfnXlate == EXLATEOBJ_iXlate555toRGB ||
+            pexlo->pfnXlate == EXLATEOBJ_iXlate555toBGR ||
+            pexlo->pfnXlate == EXLATEOBJ_iXlate555to565 ||
+            pexlo->pfnXlate == EXLATEOBJ_iXlate565to555 ||
+            pexlo->pfnXlate == EXLATEOBJ_iXlate565toRGB ||
+            pexlo->pfnXlate == EXLATEOBJ_iXlate565toBGR);
+}
+
+static
+VOID
+EXLATEOBJ_vXlateRow16(
+    _In_ PEXLATEOBJ pexlo,
+    _In_ PUSHORT pusSrc,
+    _Out_writes_(cx) PULONG pulDst,
+    _In_ ULONG cx)
+{
+    PULONG pulLut = pexlo->pulLut16;
+    ULONG i, iColor, cGreenBits, iRedShift;
+
+    /* The 5-5-5 functions ignore the top bit, the others are 5-6-5 or plain bit operations */
+    cGreenBits = (pexlo->pfnXlate == EXLATEOBJ_iXlate555toRGB ||
+                  pexlo->pfnXlate == EXLATEOBJ_iXlate555toBGR) ? 5 : 6;
+    iRedShift = 5 + cGreenBits;
+
+    if (!pulLut && cx >= 32 && EXLATEOBJ_bIsChannelSeparable(pexlo))
+    {
+        /* Build one table of 64 entries for each of the 3 fields */
+        pulLut = EngAllocMem(0, 3 * 64 * sizeof(ULONG), GDITAG_PXLATE);
+        if (pulLut)
+        {
+            for (i = 0; i < 32; i++)
+            {
+                pulLut[i] = pexlo->pfnXlate(pexlo, i);
+            }
+            for (i = 0; i < (1UL << cGreenBits); i++)
+            {
+                pulLut[64 + i] = pexlo->pfnXlate(pexlo, i << 5);
+            }
+            for (i = 0; i < (1UL << (16 - iRedShift)); i++)
+            {
+                pulLut[128 + i] = pexlo->pfnXlate(pexlo, i << iRedShift);
+            }
+            pexlo->pulLut16 = pulLut;
+        }
+    }
+
+    if (pulLut)
+    {
+        for (i = 0; i < cx; i++)
+        {
+            iColor = pusSrc[i];
+            pulDst[i] = pulLut[iColor & 0x1F] |
+                        pulLut[64 + ((iColor >> 5) & ((1 << cGreenBits) - 1))] |
+                        pulLut[128 + (iColor >> iRedShift)];
+        }
+    }
+    else
+    {
+        for (i = 0; i < cx; i++)
+        {
+            pulDst[i] = pexlo->pfnXlate(pexlo, pusSrc[i]);
+        }
+    }
+}
+
+/*
+ * Translates a row of cx source pixels into pulDst, one ULONG per pixel.
+ * pvSrc and pulDst may point to the same memory for 32 bpp sources.
+ */
+VOID
+NTAPI
+XLATEOBJ_vXlateRow(
+    _In_opt_ XLATEOBJ *pxlo,
+    _In_ ULONG iSrcFormat,
+    _In_ PVOID pvSrc,
+    _Out_writes_(cx) PULONG pulDst,
+    _In_ ULONG cx)
+{
+    PEXLATEOBJ pexlo = (PEXLATEOBJ)pxlo;
+    PBYTE pjSrc = pvSrc;
+    PULONG pulSrc = pvSrc;
+    ULONG i, iColor;
+    BOOLEAN bTrivial;
+
+    bTrivial = (!pxlo || (pxlo->flXlate & XO_TRIVIAL));
+
+    switch (iSrcFormat)
+    {
+        case BMF_8BPP:
+            if (bTrivial)
+            {
+                for (i = 0; i < cx; i++) pulDst[i] = pjSrc[i];
+            }
+            else if (pxlo->flXlate & XO_TABLE)
+            {
+                for (i = 0; i < cx; i++)
+                {
+                    iColor = pjSrc[i];
+                    pulDst[i] = (iColor < pxlo->cEntries) ? pxlo->pulXlate[iColor] : 0;
+                }
+            }
+            else
+            {
+                for (i = 0; i < cx; i++) pulDst[i] = pexlo->pfnXlate(pexlo, pjSrc[i]);
+            }
+            break;
+
+        case BMF_16BPP:
+            if (bTrivial)
+            {
+                for (i = 0; i < cx; i++) pulDst[i] = ((PUSHORT)pvSrc)[i];
+            }
+            else
+            {
+                EXLATEOBJ_vXlateRow16(pexlo, pvSrc, pulDst, cx);
+            }
+            break;
+
+        case BMF_24BPP:
+            for (i = 0; i < cx; i++, pjSrc += 3)
+            {
+                iColor = pjSrc[0] | (pjSrc[1] << 8) | (pjSrc[2] << 16);
+                pulDst[i] = bTrivial ? iColor : pexlo->pfnXlate(pexlo, iColor);
+            }
+            break;
+
+        case BMF_32BPP:
+            if (bTrivial)
+            {
+                if (pulDst != pulSrc) RtlCopyMemory(pulDst, pulSrc, cx * sizeof(ULONG));
+            }
+            else if (pexlo->pfnXlate == EXLATEOBJ_iXlateRGBtoBGR)
+            {
+                for (i = 0; i < cx; i++)
+                {
+                    iColor = pulSrc[i];
+                    pulDst[i] = (iColor & 0xFF00FF00) | ((iColor >> 16) & 0xFF) | ((iColor & 0xFF) << 16);
+                }
+            }
+            else
+            {
+                for (i = 0; i < cx; i++) pulDst[i] = pexlo->pfnXlate(pexlo, pulSrc[i]);
+            }
+            break;
+
+        default:
+            ASSERT(FALSE);
+            break;
+    }
 }
 
 /** Public DDI Functions ******************************************************/
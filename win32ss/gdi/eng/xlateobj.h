@@ -41,6 +41,9 @@ typedef struct _EXLATEOBJ
             ULONG ulBlueShift;
         };
     };
+
+    /* Per channel lookup table for 16 bpp sources, built on demand */
+    PULONG pulLut16;
 } EXLATEOBJ, *PEXLATEOBJ;
 
 extern EXLATEOBJ gexloTrivial;
@@ -54,6 +57,15 @@ XLATEOBJ_pfnXlate(
     return ((PEXLATEOBJ)pxlo)->pfnXlate;
 }
 
+VOID
+NTAPI
+XLATEOBJ_vXlateRow(
+    _In_opt_ XLATEOBJ *pxlo,
+    _In_ ULONG iSrcFormat,
+    _In_ PVOID pvSrc,
+    _Out_writes_(cx) PULONG pulDst,
+    _In_ ULONG cx);
+
 VOID
 NTAPI
 EXLATEOBJ_vInitialize(
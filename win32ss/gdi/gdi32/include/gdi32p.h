@@ -313,11 +313,16 @@ int FASTCALL DocumentEventEx(PVOID,HANDLE,HDC,int,ULONG,PVOID,ULONG,PVOID);
 BOOL FASTCALL EndPagePrinterEx(PVOID,HANDLE);
 BOOL FASTCALL LoadTheSpoolerDrv(VOID);
 
+/*
+ * Allocate an entry in the TEB batch. cjExtra is the size of the variable
+ * part of commands like GdiBCTextOut that follows the fixed structure.
+ */
 FORCEINLINE
 PVOID
-GdiAllocBatchCommand(
+GdiAllocBatchCommandEx(
     HDC hdc,
-    USHORT Cmd)
+    USHORT Cmd,
+    USHORT cjExtra)
 {
     PTEB pTeb;
     USHORT cjSize;
@@ -329,23 +334,16 @@ GdiAllocBatchCommand(
     /* Check if we have a valid environment */
     if (!pTeb || !pTeb->Win32ThreadInfo) return NULL;
 
-    /* Do we use a DC? */
-    if (hdc)
-    {
-        /* If the batch DC is NULL, we set this one as the new one */
-        if (!pTeb->GdiTebBatch.HDC) pTeb->GdiTebBatch.HDC = hdc;
-
-        /* If not, check if the batch DC equal to our DC */
-        else if (pTeb->GdiTebBatch.HDC != hdc) return NULL;
-    }
+    /* Do we use a DC? If so, it must be the batch DC, if there is one */
+    if (hdc && pTeb->GdiTebBatch.HDC && (pTeb->GdiTebBatch.HDC != hdc)) return NULL;
 
     /* Get the size of the entry */
-    if      (Cmd == GdiBCPatBlt) cjSize = 0;
-    else if (Cmd == GdiBCPolyPatBlt) cjSize = 0;
-    else if (Cmd == GdiBCTextOut) cjSize = 0;
-    else if (Cmd == GdiBCExtTextOut) cjSize = 0;
+    if      (Cmd == GdiBCPatBlt) cjSize = sizeof(GDIBSPATBLT);
+    else if (Cmd == GdiBCPolyPatBlt) cjSize = FIELD_OFFSET(GDIBSPPATBLT, pRect);
+    else if (Cmd == GdiBCTextOut) cjSize = FIELD_OFFSET(GDIBSTEXTOUT, String);
+    else if (Cmd == GdiBCExtTextOut) cjSize = sizeof(GDIBSEXTTEXTOUT);
     else if (Cmd == GdiBCSetBrushOrg) cjSize = sizeof(GDIBSSETBRHORG);
-    else if (Cmd == GdiBCExtSelClipRgn) cjSize = 0;
+    else if (Cmd == GdiBCExtSelClipRgn) cjSize = sizeof(GDIBSEXTSELCLPRGN);
     else if (Cmd == GdiBCSelObj) cjSize = sizeof(GDIBSOBJECT);
     else if (Cmd == GdiBCDelRgn) cjSize = sizeof(GDIBSOBJECT);
     else if (Cmd == GdiBCDelObj) cjSize = sizeof(GDIBSOBJECT);
@@ -354,6 +352,11 @@ GdiAllocBatchCommand(
     /* Unsupported operation */
     if (cjSize == 0) return NULL;
 
+    /* Add the variable part, keeping the next entry aligned */
+    if (cjExtra > GDIBATCHBUFSIZE - cjSize) return NULL;
+    cjSize = (cjSize + cjExtra + sizeof(ULONG_PTR) - 1) & ~(sizeof(ULONG_PTR) - 1);
+    if (cjSize > GDIBATCHBUFSIZE) return NULL;
+
     /* Check if the buffer is full */
     if ((pTeb->GdiBatchCount >= GDI_BatchLimit) ||
         ((pTeb->GdiTebBatch.Offset + cjSize) > GDIBATCHBUFSIZE))
@@ -363,6 +366,9 @@ GdiAllocBatchCommand(
         NtGdiFlush();
     }
 
+    /* Set the batch DC only now, flushing the batch resets it */
+    if (hdc) pTeb->GdiTebBatch.HDC = hdc;
+
     /* Get the head of the entry */
     pHdr = (PVOID)((PUCHAR)pTeb->GdiTebBatch.Buffer + pTeb->GdiTebBatch.Offset);
 
@@ -377,6 +383,15 @@ GdiAllocBatchCommand(
     return pHdr;
 }
 
+FORCEINLINE
+PVOID
+GdiAllocBatchCommand(
+    HDC hdc,
+    USHORT Cmd)
+{
+    return GdiAllocBatchCommandEx(hdc, Cmd, 0);
+}
+
 FORCEINLINE
 PDC_ATTR
 GdiGetDcAttr(HDC hdc)
@@ -842,10 +842,15 @@ GdiSetBatchLimit(DWORD	Limit)
 {
     DWORD OldLimit = GDI_BatchLimit;
 
-    if ( (!Limit) ||
-            (Limit >= GDI_BATCH_LIMIT))
+    /* Zero restores the default limit */
+    if (!Limit)
     {
-        return Limit;
+        Limit = (DWORD) NtCurrentTeb()->ProcessEnvironmentBlock->GdiDCAttributeList;
+    }
+
+    if (Limit > GDI_BATCH_LIMIT)
+    {
+        return 0;
     }
 
     GdiFlush();
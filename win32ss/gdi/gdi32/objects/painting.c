@@ -456,9 +456,40 @@ PatBlt(
     _In_ INT nHeight,
     _In_ DWORD dwRop)
 {
+    PDC_ATTR pdcattr;
+    PGDIBSPATBLT pgO;
+
     HANDLE_METADC(BOOL, PatBlt, FALSE, hdc, nXLeft, nYLeft, nWidth, nHeight, dwRop);
 
-    /* FIXME some part need be done in user mode */
+    /* Get the DC attribute */
+    pdcattr = GdiGetDcAttr(hdc);
+
+    /* Batch it, unless the caller may access the bits behind our back */
+    if (pdcattr &&
+        !(pdcattr->ulDirty_ & DC_DIBSECTION) &&
+        !ROP_USES_SOURCE(dwRop))
+    {
+        pgO = GdiAllocBatchCommand(hdc, GdiBCPatBlt);
+        if (pgO)
+        {
+            /* Capture the brush and colors, the DC may change before the flush */
+            pgO->nXLeft = nXLeft;
+            pgO->nYLeft = nYLeft;
+            pgO->nWidth = nWidth;
+            pgO->nHeight = nHeight;
+            pgO->hbrush = pdcattr->hbrush;
+            pgO->dwRop = dwRop;
+            pgO->crForegroundClr = pdcattr->crForegroundClr;
+            pgO->crBackgroundClr = pdcattr->crBackgroundClr;
+            pgO->crBrushClr = pdcattr->crBrushClr;
+            pgO->ptlViewportOrg = pdcattr->ptlViewportOrg;
+            pgO->ulForegroundClr = pdcattr->ulForegroundClr;
+            pgO->ulBackgroundClr = pdcattr->ulBackgroundClr;
+            pgO->ulBrushClr = pdcattr->ulBrushClr;
+            return TRUE;
+        }
+    }
+
     return NtGdiPatBlt( hdc,  nXLeft,  nYLeft,  nWidth,  nHeight,  dwRop);
 }
 
@@ -474,6 +505,8 @@ PolyPatBlt(
     UINT i;
     BOOL bResult;
     HBRUSH hbrOld;
+    PDC_ATTR pdcattr;
+    PGDIBSPPATBLT pgO;
 
     /* Handle meta DCs */
     if ((GDI_HANDLE_GET_TYPE(hdc) == GDILoObjType_LO_METADC16_TYPE) ||
@@ -511,7 +544,36 @@ PolyPatBlt(
         return bResult;
     }
 
-    /* FIXME some part need be done in user mode */
+    /* Get the DC attribute */
+    pdcattr = GdiGetDcAttr(hdc);
+
+    /* Batch it if the rectangles fit in a single entry */
+    if (pdcattr &&
+        !(pdcattr->ulDirty_ & DC_DIBSECTION) &&
+        !ROP_USES_SOURCE(dwRop) &&
+        (nCount > 0) &&
+        (nCount <= (GDIBATCHBUFSIZE - FIELD_OFFSET(GDIBSPPATBLT, pRect)) / sizeof(PATRECT)))
+    {
+        pgO = GdiAllocBatchCommandEx(hdc, GdiBCPolyPatBlt, (USHORT)(nCount * sizeof(PATRECT)));
+        if (pgO)
+        {
+            pgO->rop4 = dwRop;
+            pgO->Mode = dwMode;
+            pgO->Count = nCount;
+            pgO->crForegroundClr = pdcattr->crForegroundClr;
+            pgO->crBackgroundClr = pdcattr->crBackgroundClr;
+            pgO->crBrushClr = pdcattr->crBrushClr;
+            pgO->ulForegroundClr = pdcattr->ulForegroundClr;
+            pgO->ulBackgroundClr = pdcattr->ulBackgroundClr;
+            pgO->ulBrushClr = pdcattr->ulBrushClr;
+            pgO->ptlViewportOrg = pdcattr->ptlViewportOrg;
+
+            /* POLYPATBLT and PATRECT share the same layout */
+            RtlCopyMemory(pgO->pRect, pPoly, nCount * sizeof(PATRECT));
+            return TRUE;
+        }
+    }
+
     return NtGdiPolyPatBlt(hdc, dwRop, pPoly, nCount, dwMode);
 }
 
@@ -751,67 +751,45 @@ ExtSelectClipRgn(
     /* Batch handles RGN_COPY only! */
     if (iMode == RGN_COPY)
     {
-#if 0
-        PDC_ATTR pDc_Attr;
-        PRGN_ATTR pRgn_Attr = NULL;
+        PDC_ATTR pdcattr;
+        PRGN_ATTR prgnattr = NULL;
+        PGDIBSEXTSELCLPRGN pgO;
 
-        /* hrgn can be NULL unless the RGN_COPY mode is specified. */
-        if (hrgn)
-            GdiGetHandleUserData((HGDIOBJ) hrgn, GDI_OBJECT_TYPE_REGION, (PVOID) &pRgn_Attr);
+        /* Get the DC attribute and the region attribute, if there is a region */
+        pdcattr = GdiGetDcAttr(hdc);
+        if (hrgn) prgnattr = GdiGetRgnAttr(hrgn);
 
-        if ( GdiGetHandleUserData((HGDIOBJ) hdc, GDI_OBJECT_TYPE_DC, (PVOID) &pDc_Attr) &&
-                pDc_Attr )
+        /* Complex regions need the whole region data, leave them to win32k */
+        if (pdcattr &&
+            (!hrgn || (prgnattr && (prgnattr->iComplexity <= SIMPLEREGION))))
         {
-            PGDI_TABLE_ENTRY pEntry = GdiHandleTable + GDI_HANDLE_GET_INDEX(hdc);
-            PTEB pTeb = NtCurrentTeb();
-
-            if ( pTeb->Win32ThreadInfo != NULL &&
-                    pTeb->GdiTebBatch.HDC == hdc &&
-                    !(pDc_Attr->ulDirty_ & DC_DIBSECTION) &&
-                    !(pEntry->Flags & GDI_ENTRY_VALIDATE_VIS) )
+            pgO = GdiAllocBatchCommand(hdc, GdiBCExtSelClipRgn);
+            if (pgO)
             {
-                if (!hrgn ||
-                        (hrgn && pRgn_Attr && pRgn_Attr->iComplexity <= SIMPLEREGION) )
+                pgO->fnMode = iMode;
+
+                if (!hrgn)
                 {
-                    if ((pTeb->GdiTebBatch.Offset + sizeof(GDIBSEXTSELCLPRGN)) <= GDIBATCHBUFSIZE)
-                    {
-                        // FIXME: This is broken, use GdiAllocBatchCommand!
-                        PGDIBSEXTSELCLPRGN pgO = (PGDIBSEXTSELCLPRGN)(&pTeb->GdiTebBatch.Buffer[0] +
-                                                 pTeb->GdiTebBatch.Offset);
-                        pgO->gbHdr.Cmd = GdiBCExtSelClipRgn;
-                        pgO->gbHdr.Size = sizeof(GDIBSEXTSELCLPRGN);
-                        pgO->fnMode = iMode;
-
-                        if ( hrgn && pRgn_Attr )
-                        {
-                            Ret = pRgn_Attr->iComplexity;
-
-                            if ( pDc_Attr->VisRectRegion.Rect.left   >= pRgn_Attr->Rect.right  ||
-                                    pDc_Attr->VisRectRegion.Rect.top    >= pRgn_Attr->Rect.bottom ||
-                                    pDc_Attr->VisRectRegion.Rect.right  <= pRgn_Attr->Rect.left   ||
-                                    pDc_Attr->VisRectRegion.Rect.bottom <= pRgn_Attr->Rect.top )
-                                Ret = NULLREGION;
-
-                            pgO->left   = pRgn_Attr->Rect.left;
-                            pgO->top    = pRgn_Attr->Rect.top;
-                            pgO->right  = pRgn_Attr->Rect.right;
-                            pgO->bottom = pRgn_Attr->Rect.bottom;
-                        }
-                        else
-                        {
-                            Ret = pDc_Attr->VisRectRegion.Flags;
-                            pgO->fnMode |= 0x80000000; // Set no hrgn mode.
-                        }
-                        pTeb->GdiTebBatch.Offset += sizeof(GDIBSEXTSELCLPRGN);
-                        pTeb->GdiBatchCount++;
-                        if (pTeb->GdiBatchCount >= GDI_BatchLimit) NtGdiFlush();
-                        if ( NewRgn ) DeleteObject(NewRgn);
-                        return Ret;
-                    }
+                    /* Removing the clip region always succeeds */
+                    pgO->fnMode |= GDIBS_NO_CLIP_REGION;
+                    SetRectEmpty((PRECT)&pgO->rcl);
+                    Ret = SIMPLEREGION;
+                }
+                else if (prgnattr->iComplexity == NULLREGION)
+                {
+                    SetRectEmpty((PRECT)&pgO->rcl);
+                    Ret = NULLREGION;
+                }
+                else
+                {
+                    pgO->rcl = prgnattr->Rect;
+                    Ret = SIMPLEREGION;
                 }
+
+                if ( NewRgn ) DeleteObject(NewRgn);
+                return Ret;
             }
         }
-#endif
     }
     Ret = NtGdiExtSelectClipRgn(hdc, hrgn, iMode);
 
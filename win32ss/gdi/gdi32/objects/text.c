@@ -488,6 +488,8 @@ ExtTextOutW(
     _In_ UINT cwc,
     _In_reads_opt_(cwc) const INT *lpDx)
 {
+    PDC_ATTR pdcattr;
+
     HANDLE_METADC(BOOL,
                   ExtTextOut,
                   FALSE,
@@ -500,6 +502,75 @@ ExtTextOutW(
                   cwc,
                   lpDx);
 
+    /* Get the DC attribute */
+    pdcattr = GdiGetDcAttr(hdc);
+
+    /* Batch simple text, anything that needs the current position or
+       per character spacing goes straight to win32k */
+    if (pdcattr &&
+        !(pdcattr->ulDirty_ & DC_DIBSECTION) &&
+        !(pdcattr->dwLayout & LAYOUT_RTL) &&
+        !(pdcattr->lTextAlign & TA_UPDATECP) &&
+        !lpDx &&
+        !(fuOptions & ETO_PDY))
+    {
+        if ((cwc == 0) && lprc && (fuOptions & ETO_OPAQUE))
+        {
+            PGDIBSEXTTEXTOUT pgO;
+
+            /* Only an opaque rectangle */
+            pgO = GdiAllocBatchCommand(hdc, GdiBCExtTextOut);
+            if (pgO)
+            {
+                pgO->Count = 0;
+                pgO->Options = fuOptions;
+                pgO->Rect = *lprc;
+                pgO->ptlViewportOrg = pdcattr->ptlViewportOrg;
+                pgO->ulBackgroundClr = pdcattr->ulBackgroundClr;
+                return TRUE;
+            }
+        }
+        else if ((cwc > 0) && lpString &&
+                 (cwc <= (GDIBATCHBUFSIZE - FIELD_OFFSET(GDIBSTEXTOUT, String)) / sizeof(WCHAR)))
+        {
+            PGDIBSTEXTOUT pgO;
+
+            pgO = GdiAllocBatchCommandEx(hdc, GdiBCTextOut, (USHORT)(cwc * sizeof(WCHAR)));
+            if (pgO)
+            {
+                /* Capture the text attributes, the DC may change before the flush */
+                pgO->crForegroundClr = pdcattr->crForegroundClr;
+                pgO->crBackgroundClr = pdcattr->crBackgroundClr;
+                pgO->lmBkMode = pdcattr->lBkMode;
+                pgO->ulForegroundClr = pdcattr->ulForegroundClr;
+                pgO->ulBackgroundClr = pdcattr->ulBackgroundClr;
+                pgO->x = x;
+                pgO->y = y;
+                pgO->Options = fuOptions;
+                pgO->iCS_CP = 0;
+                pgO->cbCount = cwc;
+                pgO->Size = cwc * sizeof(WCHAR);
+                pgO->hlfntNew = pdcattr->hlfntNew;
+                pgO->flTextAlign = pdcattr->lTextAlign;
+                pgO->ptlViewportOrg = pdcattr->ptlViewportOrg;
+
+                if (lprc)
+                {
+                    pgO->Rect = *lprc;
+                }
+                else
+                {
+                    /* The rectangle options are meaningless without one */
+                    pgO->Options &= ~(ETO_OPAQUE | ETO_CLIPPED);
+                    RtlZeroMemory(&pgO->Rect, sizeof(pgO->Rect));
+                }
+
+                RtlCopyMemory(pgO->String, lpString, cwc * sizeof(WCHAR));
+                return TRUE;
+            }
+        }
+    }
+
     return NtGdiExtTextOutW(hdc,
                             x,
                             y,
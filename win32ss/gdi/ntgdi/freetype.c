@@ -86,10 +86,20 @@ static BOOL RenderingEnabled = TRUE;
 #define ASSERT_FREETYPE_LOCK_NOT_HELD() \
   ASSERT(FreeTypeLock->Owner != KeGetCurrentThread())
 
-#define MAX_FONT_CACHE 256
+/* The glyph cache is bounded both by entry count and by the bytes of
+   rendered bitmaps it holds. Lookups go through a hash of the glyph key,
+   eviction takes the tail of the LRU list. */
+#define MAX_FONT_CACHE 1024
+#define MAX_FONT_CACHE_BYTES (1024 * 1024)
+#define FONT_CACHE_HASH_SIZE 256    /* must be a power of two */
 
 static LIST_ENTRY FontCacheListHead;
+static LIST_ENTRY FontCacheHashTable[FONT_CACHE_HASH_SIZE];
 static UINT FontCacheNumEntries;
+static ULONG FontCacheBytes;
+static ULONG FontCacheHits;
+static ULONG FontCacheMisses;
+static ULONG FontCacheEvictions;
 
 static PWCHAR ElfScripts[32] =   /* These are in the order of the fsCsb[0] bits */
 {
@@ -229,6 +239,9 @@ RemoveCachedEntry(PFONT_CACHE_ENTRY Entry)
 
     FT_Done_Glyph((FT_Glyph)Entry->BitmapGlyph);
     RemoveEntryList(&Entry->ListEntry);
+    RemoveEntryList(&Entry->HashEntry);
+    ASSERT(FontCacheBytes >= Entry->CacheSize);
+    FontCacheBytes -= Entry->CacheSize;
     ExFreePoolWithTag(Entry, TAG_FONT);
     FontCacheNumEntries--;
     ASSERT(FontCacheNumEntries <= MAX_FONT_CACHE);
@@ -255,6 +268,22 @@ RemoveCacheEntries(FT_Face Face)
     }
 }
 
+static ULONG
+GlyphCacheHash(FT_Face Face, INT GlyphIndex, INT Height, FT_Render_Mode RenderMode)
+{
+    ULONG_PTR Hash;
+
+    /* The transform is not hashed; entries differing only by their
+       transform share a bucket and are told apart by SameScaleMatrix */
+    Hash = (ULONG_PTR)Face >> 4;
+    Hash = Hash * 31 + (ULONG)GlyphIndex;
+    Hash = Hash * 31 + (ULONG)Height;
+    Hash = Hash * 31 + (ULONG)RenderMode;
+    Hash ^= Hash >> 16;
+
+    return (ULONG)Hash;
+}
+
 static void SharedMem_Release(PSHARED_MEM Ptr)
 {
     ASSERT_FREETYPE_LOCK_HELD();
@@ -454,10 +483,16 @@ BOOL FASTCALL
 InitFontSupport(VOID)
 {
     ULONG ulError;
+    ULONG i;
 
     InitializeListHead(&FontListHead);
     InitializeListHead(&FontCacheListHead);
+    for (i = 0; i < FONT_CACHE_HASH_SIZE; ++i)
+    {
+        InitializeListHead(&FontCacheHashTable[i]);
+    }
     FontCacheNumEntries = 0;
+    FontCacheBytes = 0;
     /* Fast Mutexes must be allocated from non paged pool */
     FontListLock = ExAllocatePoolWithTag(NonPagedPool, sizeof(FAST_MUTEX), TAG_INTERNAL_SYNC);
     if (FontListLock == NULL)
@@ -2622,16 +2657,21 @@ ftGdiGlyphCacheGet(
     FT_Render_Mode RenderMode,
     PMATRIX pmx)
 {
-    PLIST_ENTRY CurrentEntry;
+    PLIST_ENTRY CurrentEntry, BucketHead;
     PFONT_CACHE_ENTRY FontEntry;
+    ULONG Hash;
 
     ASSERT_FREETYPE_LOCK_HELD();
 
-    CurrentEntry = FontCacheListHead.Flink;
-    while (CurrentEntry != &FontCacheListHead)
+    Hash = GlyphCacheHash(Face, GlyphIndex, Height, RenderMode);
+    BucketHead = &FontCacheHashTable[Hash & (FONT_CACHE_HASH_SIZE - 1)];
+
+    CurrentEntry = BucketHead->Flink;
+    while (CurrentEntry != BucketHead)
     {
-        FontEntry = CONTAINING_RECORD(CurrentEntry, FONT_CACHE_ENTRY, ListEntry);
-        if ((FontEntry->Face == Face) &&
+        FontEntry = CONTAINING_RECORD(CurrentEntry, FONT_CACHE_ENTRY, HashEntry);
+        if ((FontEntry->Hash == Hash) &&
+            (FontEntry->Face == Face) &&
             (FontEntry->GlyphIndex == GlyphIndex) &&
             (FontEntry->Height == Height) &&
             (FontEntry->RenderMode == RenderMode) &&
@@ -2640,16 +2680,39 @@ ftGdiGlyphCacheGet(
         CurrentEntry = CurrentEntry->Flink;
     }
 
-    if (CurrentEntry == &FontCacheListHead)
+    if (CurrentEntry == BucketHead)
     {
+        FontCacheMisses++;
         return NULL;
     }
 
-    RemoveEntryList(CurrentEntry);
-    InsertHeadList(&FontCacheListHead, CurrentEntry);
+    FontCacheHits++;
+
+    /* Move it to the front of the LRU list and its bucket */
+    RemoveEntryList(&FontEntry->ListEntry);
+    InsertHeadList(&FontCacheListHead, &FontEntry->ListEntry);
+    if (BucketHead->Flink != CurrentEntry)
+    {
+        RemoveEntryList(CurrentEntry);
+        InsertHeadList(BucketHead, CurrentEntry);
+    }
     return FontEntry->BitmapGlyph;
 }
 
+VOID FASTCALL
+ftGdiGlyphCacheQueryInfo(PFONT_CACHE_INFO Info)
+{
+    IntLockFreeType;
+    Info->NumEntries = FontCacheNumEntries;
+    Info->MaxEntries = MAX_FONT_CACHE;
+    Info->CacheBytes = FontCacheBytes;
+    Info->MaxCacheBytes = MAX_FONT_CACHE_BYTES;
+    Info->Hits = FontCacheHits;
+    Info->Misses = FontCacheMisses;
+    Info->Evictions = FontCacheEvictions;
+    IntUnLockFreeType;
+}
+
 /* no cache */
 FT_BitmapGlyph APIENTRY
 ftGdiGlyphSet(
@@ -2752,12 +2815,24 @@ ftGdiGlyphCacheSet(
     NewEntry->Height = Height;
     NewEntry->RenderMode = RenderMode;
     NewEntry->mxWorldToDevice = *pmx;
+    NewEntry->Hash = GlyphCacheHash(Face, GlyphIndex, Height, RenderMode);
+    NewEntry->CacheSize = sizeof(FONT_CACHE_ENTRY) +
+                          abs(BitmapGlyph->bitmap.pitch) * BitmapGlyph->bitmap.rows;
 
     InsertHeadList(&FontCacheListHead, &NewEntry->ListEntry);
-    if (++FontCacheNumEntries > MAX_FONT_CACHE)
+    InsertHeadList(&FontCacheHashTable[NewEntry->Hash & (FONT_CACHE_HASH_SIZE - 1)],
+                   &NewEntry->HashEntry);
+    FontCacheBytes += NewEntry->CacheSize;
+    ++FontCacheNumEntries;
+
+    /* Evict least recently used glyphs, but never the one just added */
+    while ((FontCacheNumEntries > MAX_FONT_CACHE ||
+            FontCacheBytes > MAX_FONT_CACHE_BYTES) &&
+           FontCacheListHead.Blink != &NewEntry->ListEntry)
     {
-        NewEntry = CONTAINING_RECORD(FontCacheListHead.Blink, FONT_CACHE_ENTRY, ListEntry);
-        RemoveCachedEntry(NewEntry);
+        RemoveCachedEntry(CONTAINING_RECORD(FontCacheListHead.Blink,
+                                            FONT_CACHE_ENTRY, ListEntry));
+        FontCacheEvictions++;
     }
 
     return BitmapGlyph;
@@ -5064,10 +5139,14 @@ ScaleLong(LONG lValue, PFLOATOBJ pef)
     return lValue;
 }
 
+/*
+ * Does the work of GreExtTextOutW on a DC that is already locked, also used
+ * when replaying the GDI batch.
+ */
 BOOL
-APIENTRY
-GreExtTextOutW(
-    IN HDC hDC,
+FASTCALL
+IntExtTextOutW(
+    IN PDC dc,
     IN INT XStart,
     IN INT YStart,
     IN UINT fuOptions,
@@ -5083,7 +5162,6 @@ GreExtTextOutW(
      * appropriate)
      */
 
-    DC *dc;
     PDC_ATTR pdcattr;
     SURFOBJ *SurfObj;
     SURFACE *psurf = NULL;
@@ -5124,31 +5202,18 @@ GreExtTextOutW(
         return FALSE;
     }
 
-    /* NOTE: This function locks the screen DC, so it must never be called
-       with a DC already locked */
     Render = IntIsFontRenderingEnabled();
 
-    // TODO: Write test-cases to exactly match real Windows in different
-    // bad parameters (e.g. does Windows check the DC or the RECT first?).
-    dc = DC_LockDc(hDC);
-    if (!dc)
-    {
-        EngSetLastError(ERROR_INVALID_HANDLE);
-        return FALSE;
-    }
-
     if (PATH_IsPathOpen(dc->dclevel))
     {
-        bResult = PATH_ExtTextOut(dc,
-                              XStart,
-                              YStart,
-                              fuOptions,
-                              (const RECTL *)lprc,
-                              String,
-                              Count,
-                              (const INT *)Dx);
-        DC_UnlockDc(dc);
-        return bResult;
+        return PATH_ExtTextOut(dc,
+                               XStart,
+                               YStart,
+                               fuOptions,
+                               (const RECTL *)lprc,
+                               String,
+                               Count,
+                               (const INT *)Dx);
     }
 
     DC_vPrepareDCsForBlit(dc, NULL, NULL, NULL);
@@ -5813,8 +5878,48 @@ Cleanup:
     if (TextObj != NULL)
         TEXTOBJ_UnlockText(TextObj);
 
-    DC_UnlockDc(dc);
+    return bResult;
+}
+
+BOOL
+APIENTRY
+GreExtTextOutW(
+    IN HDC hDC,
+    IN INT XStart,
+    IN INT YStart,
+    IN UINT fuOptions,
+    IN OPTIONAL PRECTL lprc,
+    IN LPCWSTR String,
+    IN INT Count,
+    IN OPTIONAL LPINT Dx,
+    IN DWORD dwCodePage)
+{
+    DC *dc;
+    BOOL bResult;
 
+    /* NOTE: This function locks hDC itself, so it must never be called with
+       that DC already locked. Callers holding the lock use IntExtTextOutW */
+
+    // TODO: Write test-cases to exactly match real Windows in different
+    // bad parameters (e.g. does Windows check the DC or the RECT first?).
+    dc = DC_LockDc(hDC);
+    if (!dc)
+    {
+        EngSetLastError(ERROR_INVALID_HANDLE);
+        return FALSE;
+    }
+
+    bResult = IntExtTextOutW(dc,
+                             XStart,
+                             YStart,
+                             fuOptions,
+                             lprc,
+                             String,
+                             Count,
+                             Dx,
+                             dwCodePage);
+
+    DC_UnlockDc(dc);
     return bResult;
 }
 
@@ -59,6 +59,136 @@ SynchonizeDriver(FLONG Flags)
   return;
 }
 
+//
+// Swap the viewport origin a command was queued with into the DC. Calling
+// it again with the same point puts the current origin back.
+//
+static
+VOID
+FASTCALL
+IntBatchSwapViewportOrg(PDC dc, PPOINTL pptlViewportOrg)
+{
+  PDC_ATTR pdcattr = dc->pdcattr;
+  POINTL ptlSave;
+
+  if ((pdcattr->ptlViewportOrg.x == pptlViewportOrg->x) &&
+      (pdcattr->ptlViewportOrg.y == pptlViewportOrg->y))
+  {
+     return;
+  }
+
+  ptlSave = pdcattr->ptlViewportOrg;
+  pdcattr->ptlViewportOrg = *pptlViewportOrg;
+  *pptlViewportOrg = ptlSave;
+  pdcattr->flXform |= PAGE_XLATE_CHANGED | DEVICE_TO_WORLD_INVALID;
+}
+
+//
+// Replay a batched pattern blit with the brush colors it was queued with.
+//
+static
+VOID
+FASTCALL
+IntBatchPatBlt(
+    PDC dc,
+    HBRUSH hbrush,
+    INT XLeft,
+    INT YLeft,
+    INT Width,
+    INT Height,
+    DWORD dwRop,
+    COLORREF crForegroundClr,
+    COLORREF crBackgroundClr,
+    COLORREF crBrushClr)
+{
+  PBRUSH pbrush;
+  EBRUSHOBJ eboFill;
+
+  pbrush = BRUSH_ShareLockBrush(hbrush);
+  if (!pbrush) return;
+
+  EBRUSHOBJ_vInit(&eboFill,
+                  pbrush,
+                  dc->dclevel.pSurface,
+                  crBackgroundClr,
+                  crForegroundClr,
+                  dc->dclevel.ppal);
+
+  // The DC brush takes its color from the attribute at the time of the call.
+  if (hbrush == StockObjects[DC_BRUSH])
+  {
+     EBRUSHOBJ_vSetSolidRGBColor(&eboFill, crBrushClr);
+  }
+
+  IntPatBlt(dc, XLeft, YLeft, Width, Height, dwRop, &eboFill);
+
+  EBRUSHOBJ_vCleanup(&eboFill);
+  BRUSH_ShareUnlockBrush(pbrush);
+}
+
+//
+// Replay a batched text call. The text attributes it was queued with are
+// swapped into the DC for the call and the current ones put back after.
+//
+static
+VOID
+FASTCALL
+IntBatchTextOut(
+    PDC dc,
+    INT XStart,
+    INT YStart,
+    UINT fuOptions,
+    PRECTL prcl,
+    LPCWSTR String,
+    INT Count,
+    COLORREF crForegroundClr,
+    COLORREF crBackgroundClr,
+    LONG lBkMode,
+    FLONG flTextAlign,
+    HANDLE hlfnt)
+{
+  PDC_ATTR pdcattr = dc->pdcattr;
+  COLORREF crForegroundSave, crBackgroundSave;
+  ULONG ulForegroundSave, ulBackgroundSave;
+  BYTE jBkModeSave;
+  LONG lBkModeSave, lTextAlignSave;
+  FLONG flTextAlignSave;
+  HANDLE hlfntSave;
+
+  crForegroundSave = pdcattr->crForegroundClr;
+  crBackgroundSave = pdcattr->crBackgroundClr;
+  ulForegroundSave = pdcattr->ulForegroundClr;
+  ulBackgroundSave = pdcattr->ulBackgroundClr;
+  jBkModeSave = pdcattr->jBkMode;
+  lBkModeSave = pdcattr->lBkMode;
+  lTextAlignSave = pdcattr->lTextAlign;
+  flTextAlignSave = pdcattr->flTextAlign;
+  hlfntSave = pdcattr->hlfntNew;
+
+  pdcattr->crForegroundClr = pdcattr->ulForegroundClr = crForegroundClr;
+  pdcattr->crBackgroundClr = pdcattr->ulBackgroundClr = crBackgroundClr;
+  pdcattr->jBkMode = (BYTE)lBkMode;
+  pdcattr->lBkMode = lBkMode;
+  pdcattr->lTextAlign = pdcattr->flTextAlign = flTextAlign;
+  pdcattr->hlfntNew = hlfnt;
+  pdcattr->ulDirty_ |= DIRTY_TEXT | DIRTY_BACKGROUND;
+
+  IntExtTextOutW(dc, XStart, YStart, fuOptions, prcl, String, Count, NULL, 0);
+
+  pdcattr->crForegroundClr = crForegroundSave;
+  pdcattr->crBackgroundClr = crBackgroundSave;
+  pdcattr->ulForegroundClr = ulForegroundSave;
+  pdcattr->ulBackgroundClr = ulBackgroundSave;
+  pdcattr->jBkMode = jBkModeSave;
+  pdcattr->lBkMode = lBkModeSave;
+  pdcattr->lTextAlign = lTextAlignSave;
+  pdcattr->flTextAlign = flTextAlignSave;
+  pdcattr->hlfntNew = hlfntSave;
+
+  // Make the next call realize the brushes from the restored colors.
+  pdcattr->ulDirty_ |= DIRTY_TEXT | DIRTY_BACKGROUND;
+}
+
 //
 // Process the batch.
 //
@@ -68,6 +198,13 @@ GdiFlushUserBatch(PDC dc, PGDIBATCHHDR pHdr)
 {
   ULONG Cmd = 0, Size = 0;
   PDC_ATTR pdcattr = NULL;
+  PGDIBATCHHDR pEntry = NULL, pPoolEntry = NULL;
+  union
+  {
+     GDIBSPATBLT PatBlt;
+     GDIBSEXTTEXTOUT ExtTextOut;
+     GDIBSEXTSELCLPRGN ExtSelClipRgn;
+  } Entry;
 
   if (dc)
   {
@@ -78,27 +215,168 @@ GdiFlushUserBatch(PDC dc, PGDIBATCHHDR pHdr)
   {
      Cmd = pHdr->Cmd;
      Size = pHdr->Size; // Return the full size of the structure.
+
+     if ((Size < sizeof(GDIBATCHHDR)) || (Size > GDIBATCHBUFSIZE))
+     {
+        DPRINT1("WARNING! GdiBatch entry size %lu!\n", Size);
+        _SEH2_YIELD(return 0;)
+     }
+
+     // The drawing and clipping commands work from a copy, user mode can't
+     // change it under us. Only text and rectangle lists need more room than
+     // the stack copy.
+     if ((Cmd == GdiBCPatBlt) || (Cmd == GdiBCPolyPatBlt) ||
+         (Cmd == GdiBCTextOut) || (Cmd == GdiBCExtTextOut) ||
+         (Cmd == GdiBCExtSelClipRgn))
+     {
+        if (Size <= sizeof(Entry))
+        {
+           pEntry = (PGDIBATCHHDR)&Entry;
+        }
+        else
+        {
+           pPoolEntry = ExAllocatePoolWithTag(PagedPool, Size, GDITAG_TEMP);
+           pEntry = pPoolEntry;
+        }
+
+        if (pEntry) RtlCopyMemory(pEntry, pHdr, Size);
+     }
   }
   _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
   {
      DPRINT1("WARNING! GdiBatch Fault!\n");
+     if (pPoolEntry) ExFreePoolWithTag(pPoolEntry, GDITAG_TEMP);
      _SEH2_YIELD(return 0;)
   }
   _SEH2_END;
 
+  // Out of pool, drop the command but carry on with the batch.
+  if (!pEntry &&
+      ((Cmd == GdiBCPatBlt) || (Cmd == GdiBCPolyPatBlt) ||
+       (Cmd == GdiBCTextOut) || (Cmd == GdiBCExtTextOut) ||
+       (Cmd == GdiBCExtSelClipRgn)))
+  {
+     return Size;
+  }
+
   switch(Cmd)
   {
      case GdiBCPatBlt:
+     {
+        PGDIBSPATBLT pgDPB;
+        DWORD dwRop;
+
+        if (!dc || !dc->dclevel.pSurface) break;
+        if (Size < sizeof(GDIBSPATBLT)) break;
+        pgDPB = (PGDIBSPATBLT) pEntry;
+
+        // Convert the ROP3 to a ROP4 like NtGdiPatBlt does.
+        dwRop = MAKEROP4(pgDPB->dwRop & 0xFF0000, pgDPB->dwRop);
+        if (WIN32_ROP4_USES_SOURCE(dwRop)) break;
+
+        IntBatchSwapViewportOrg(dc, &pgDPB->ptlViewportOrg);
+        IntBatchPatBlt(dc,
+                       (HBRUSH)pgDPB->hbrush,
+                       pgDPB->nXLeft,
+                       pgDPB->nYLeft,
+                       pgDPB->nWidth,
+                       pgDPB->nHeight,
+                       dwRop,
+                       pgDPB->crForegroundClr,
+                       pgDPB->crBackgroundClr,
+                       pgDPB->crBrushClr);
+        IntBatchSwapViewportOrg(dc, &pgDPB->ptlViewportOrg);
         break;
+     }
 
      case GdiBCPolyPatBlt:
+     {
+        PGDIBSPPATBLT pgDPB;
+        ULONG i;
+
+        if (!dc || !dc->dclevel.pSurface) break;
+        if (Size < FIELD_OFFSET(GDIBSPPATBLT, pRect)) break;
+        pgDPB = (PGDIBSPPATBLT) pEntry;
+
+        if (pgDPB->Count > (Size - FIELD_OFFSET(GDIBSPPATBLT, pRect)) / sizeof(PATRECT)) break;
+        if (WIN32_ROP4_USES_SOURCE(pgDPB->rop4)) break;
+
+        IntBatchSwapViewportOrg(dc, &pgDPB->ptlViewportOrg);
+        for (i = 0; i < pgDPB->Count; i++)
+        {
+           IntBatchPatBlt(dc,
+                          pgDPB->pRect[i].hBrush,
+                          pgDPB->pRect[i].r.left,
+                          pgDPB->pRect[i].r.top,
+                          pgDPB->pRect[i].r.right,
+                          pgDPB->pRect[i].r.bottom,
+                          pgDPB->rop4,
+                          pgDPB->crForegroundClr,
+                          pgDPB->crBackgroundClr,
+                          pgDPB->crBrushClr);
+        }
+        IntBatchSwapViewportOrg(dc, &pgDPB->ptlViewportOrg);
         break;
+     }
 
      case GdiBCTextOut:
+     {
+        PGDIBSTEXTOUT pgO;
+        RECTL rcl;
+
+        if (!dc || !dc->dclevel.pSurface) break;
+        if (Size < FIELD_OFFSET(GDIBSTEXTOUT, String)) break;
+        pgO = (PGDIBSTEXTOUT) pEntry;
+
+        if (pgO->cbCount > (Size - FIELD_OFFSET(GDIBSTEXTOUT, String)) / sizeof(WCHAR)) break;
+
+        rcl = *(PRECTL)&pgO->Rect;
+        IntBatchSwapViewportOrg(dc, &pgO->ptlViewportOrg);
+        IntBatchTextOut(dc,
+                        pgO->x,
+                        pgO->y,
+                        pgO->Options,
+                        (pgO->Options & (ETO_OPAQUE | ETO_CLIPPED)) ? &rcl : NULL,
+                        pgO->String,
+                        pgO->cbCount,
+                        pgO->crForegroundClr,
+                        pgO->crBackgroundClr,
+                        pgO->lmBkMode,
+                        pgO->flTextAlign,
+                        pgO->hlfntNew);
+        IntBatchSwapViewportOrg(dc, &pgO->ptlViewportOrg);
         break;
+     }
 
      case GdiBCExtTextOut:
+     {
+        PGDIBSEXTTEXTOUT pgO;
+        RECTL rcl;
+
+        if (!dc || !dc->dclevel.pSurface) break;
+        if (Size < sizeof(GDIBSEXTTEXTOUT)) break;
+        pgO = (PGDIBSEXTTEXTOUT) pEntry;
+
+        // Only the opaque rectangle is batched, no text.
+        if (!(pgO->Options & ETO_OPAQUE)) break;
+
+        rcl = *(PRECTL)&pgO->Rect;
+        IntBatchSwapViewportOrg(dc, &pgO->ptlViewportOrg);
+        IntBatchTextOut(dc,
+                        0,
+                        0,
+                        pgO->Options,
+                        &rcl,
+                        NULL,
+                        0,
+                        pdcattr->crForegroundClr,
+                        pgO->ulBackgroundClr,
+                        pdcattr->lBkMode,
+                        TA_TOP | TA_LEFT,
+                        pdcattr->hlfntNew);
+        IntBatchSwapViewportOrg(dc, &pgO->ptlViewportOrg);
         break;
+     }
 
      case GdiBCSetBrushOrg:
      {
@@ -111,7 +389,27 @@ GdiFlushUserBatch(PDC dc, PGDIBATCHHDR pHdr)
      }
 
      case GdiBCExtSelClipRgn:
+     {
+        PGDIBSEXTSELCLPRGN pgO;
+        PREGION prgn;
+
+        if (!dc) break;
+        if (Size < sizeof(GDIBSEXTSELCLPRGN)) break;
+        pgO = (PGDIBSEXTSELCLPRGN) pEntry;
+
+        // gdi32 only queues RGN_COPY of a NULL, empty or rectangular region.
+        if (pgO->fnMode & GDIBS_NO_CLIP_REGION)
+        {
+           IntGdiExtSelectClipRgn(dc, NULL, RGN_COPY);
+           break;
+        }
+
+        prgn = IntSysCreateRectpRgnIndirect(&pgO->rcl);
+        if (!prgn) break;
+        IntGdiExtSelectClipRgn(dc, prgn, RGN_COPY);
+        REGION_Delete(prgn);
         break;
+     }
 
      case GdiBCSelObj:
      {
@@ -138,6 +436,8 @@ GdiFlushUserBatch(PDC dc, PGDIBATCHHDR pHdr)
         break;
   }
 
+  if (pPoolEntry) ExFreePoolWithTag(pPoolEntry, GDITAG_TEMP);
+
   return Size;
 }
 
@@ -191,6 +491,8 @@ NtGdiFlushUserBatch(VOID)
        for (; GdiBatchCount > 0; GdiBatchCount--)
        {
            ULONG Size;
+           // Don't run past the end of the TEB buffer.
+           if (pHdr + sizeof(GDIBATCHHDR) > (PCHAR)&pTeb->GdiTebBatch.Buffer[0] + GDIBATCHBUFSIZE) break;
            // Process Gdi Batch!
            Size = GdiFlushUserBatch(pDC, (PGDIBATCHHDR) pHdr);
            if (!Size) break;
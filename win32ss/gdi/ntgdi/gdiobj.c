@@ -1430,6 +1430,47 @@ NtGdiDeleteClientObj(
     return GreDeleteObject(hobj);
 }
 
+W32KAPI
+NTSTATUS
+APIENTRY
+NtGdiGetStats(
+    IN HANDLE hProcess,
+    IN INT iIndex,
+    IN INT iPidType,
+    OUT PVOID pResults,
+    IN UINT cjResultSize)
+{
+    NTSTATUS Status = STATUS_SUCCESS;
+    FONT_CACHE_INFO FontCacheInfo;
+
+    /* Only the glyph cache statistics are supported so far */
+    if (iIndex != GS_GLYPH_CACHE_INFO)
+    {
+        DPRINT1("NtGdiGetStats: Index %d not implemented\n", iIndex);
+        return STATUS_NOT_IMPLEMENTED;
+    }
+
+    if (cjResultSize < sizeof(FontCacheInfo))
+    {
+        return STATUS_BUFFER_TOO_SMALL;
+    }
+
+    ftGdiGlyphCacheQueryInfo(&FontCacheInfo);
+
+    _SEH2_TRY
+    {
+        ProbeForWrite(pResults, sizeof(FontCacheInfo), sizeof(ULONG));
+        RtlCopyMemory(pResults, &FontCacheInfo, sizeof(FontCacheInfo));
+    }
+    _SEH2_EXCEPT(EXCEPTION_EXECUTE_HANDLER)
+    {
+        Status = _SEH2_GetExceptionCode();
+    }
+    _SEH2_END;
+
+    return Status;
+}
+
 
 
 PGDI_HANDLE_TABLE GdiHandleTable = NULL;
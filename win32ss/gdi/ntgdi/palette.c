@@ -237,6 +237,10 @@ PALETTE_vCleanup(PVOID ObjectBody)
     {
         ExFreePoolWithTag(pPal->IndexedColors, TAG_PALETTE);
     }
+    if (pPal->pulNearestCache)
+    {
+        EngFreeMem(pPal->pulNearestCache);
+    }
 }
 
 INT
@@ -286,6 +290,100 @@ PALETTE_ulGetNearestPaletteIndex(PALETTE* ppal, ULONG iColor)
     return ulBestIndex;
 }
 
+/*
+ * The nearest index cache has one entry per RGB555 color. An entry holds the
+ * full 24 bit color it was computed for in the upper bits and the index in
+ * the lowest byte, so a lookup only hits when the exact color was seen
+ * before and the result is the same as the one of a full search.
+ */
+#define NEAREST_CACHE_SIZE 0x8000
+
+static
+VOID
+PALETTE_vResetCache(PULONG pulCache)
+{
+    /* Every entry holds a color that doesn't belong to its slot. 0xFFFFFFFF
+       would be a valid entry for white in the last slot, so that one gets 0
+       and is written first: lookups can run while the cache gets reset */
+    pulCache[0x7FFF] = 0;
+    RtlFillMemoryUlong(pulCache, (NEAREST_CACHE_SIZE - 1) * sizeof(ULONG), 0xFFFFFFFF);
+}
+
+ULONG
+NTAPI
+PALETTE_ulGetNearestCachedIndex(PALETTE* ppal, ULONG iColor)
+{
+    PULONG pulCache, pulNew;
+    ULONG ulKey, ulEntry, ulUnique, ulIndex;
+
+    iColor &= 0xFFFFFF;
+
+    pulCache = ppal->pulNearestCache;
+    if (!pulCache)
+    {
+        /* Small palettes are quick to search, the index must fit in a byte */
+        if (ppal->NumColors <= 16 || ppal->NumColors > 256)
+        {
+            return PALETTE_ulGetNearestPaletteIndex(ppal, iColor);
+        }
+
+        pulNew = EngAllocMem(0, NEAREST_CACHE_SIZE * sizeof(ULONG), GDITAG_PALETTE);
+        if (!pulNew)
+        {
+            return PALETTE_ulGetNearestPaletteIndex(ppal, iColor);
+        }
+        PALETTE_vResetCache(pulNew);
+
+        /* Another thread might have been faster */
+        pulCache = InterlockedCompareExchangePointer((PVOID*)&ppal->pulNearestCache,
+                                                     pulNew,
+                                                     NULL);
+        if (pulCache)
+        {
+            EngFreeMem(pulNew);
+        }
+        else
+        {
+            pulCache = pulNew;
+        }
+    }
+
+    ulKey = ((iColor >> 3) & 0x1F) | ((iColor >> 6) & 0x3E0) | ((iColor >> 9) & 0x7C00);
+    ulEntry = pulCache[ulKey];
+    if ((ulEntry >> 8) == iColor)
+    {
+        return ulEntry & 0xFF;
+    }
+
+    ulUnique = *(volatile ULONG *)&ppal->ulCacheUnique;
+    ulIndex = PALETTE_ulGetNearestPaletteIndex(ppal, iColor);
+    ulEntry = (iColor << 8) | ulIndex;
+
+    /* Store first, then make sure no invalidation happened meanwhile. If one
+       did, our result might be stale and the table reset might have run
+       before the store, so take the entry back out again */
+    InterlockedExchange((LONG *)&pulCache[ulKey], ulEntry);
+    if (ulUnique != *(volatile ULONG *)&ppal->ulCacheUnique)
+    {
+        InterlockedCompareExchange((LONG *)&pulCache[ulKey],
+                                   (ulKey == 0x7FFF) ? 0 : 0xFFFFFFFF,
+                                   ulEntry);
+    }
+
+    return ulIndex;
+}
+
+VOID
+NTAPI
+PALETTE_vInvalidateCache(PALETTE* ppal)
+{
+    InterlockedIncrement((LONG*)&ppal->ulCacheUnique);
+    if (ppal->pulNearestCache)
+    {
+        PALETTE_vResetCache(ppal->pulNearestCache);
+    }
+}
+
 ULONG
 NTAPI
 PALETTE_ulGetNearestBitFieldsIndex(PALETTE* ppal, ULONG ulColor)
@@ -773,6 +871,7 @@ IntGdiRealizePalette(HDC hDC)
     {
         InterlockedExchange((LONG*)&ppalSurf->IndexedColors[i], *(LONG*)&ppalDC->IndexedColors[i]);
     }
+    PALETTE_vInvalidateCache(ppalSurf);
 
 cleanup:
     DC_UnlockDc(pdc);
@@ -816,6 +915,8 @@ IntAnimatePalette(HPALETTE hPal,
             }
         }
 
+        if (ret) PALETTE_vInvalidateCache(palPtr);
+
         PALETTE_ShareUnlockPalette(palPtr);
 
 #if 0
@@ -982,6 +1083,7 @@ IntSetPaletteEntries(
         Entries = numEntries - Start;
     }
     memcpy(palGDI->IndexedColors + Start, pe, Entries * sizeof(PALETTEENTRY));
+    PALETTE_vInvalidateCache(palGDI);
     PALETTE_ShareUnlockPalette(palGDI);
 
     return Entries;
@@ -1041,6 +1143,7 @@ GreGetSetColorTable(
                 ppal->IndexedColors[i].peGreen = prgbColors->rgbGreen;
                 ppal->IndexedColors[i].peBlue = prgbColors->rgbBlue;
             }
+            PALETTE_vInvalidateCache(ppal);
 
             /* Mark the dc brushes invalid */
             pdc->pdcattr->ulDirty_ |= DIRTY_FILL|DIRTY_LINE|
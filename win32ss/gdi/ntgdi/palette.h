@@ -47,6 +47,8 @@ typedef struct _PALETTE
     ULONG ulGreenShift;
     ULONG ulBlueShift;
     HDEV  hPDev;
+    PULONG pulNearestCache; // RGB555 keyed cache for nearest index lookups
+    ULONG ulCacheUnique;
     PALETTEENTRY apalColors[0];
 } PALETTE, *PPALETTE;
 
@@ -103,6 +105,17 @@ PALETTE_ulGetNearestPaletteIndex(
     PPALETTE ppal,
     ULONG iColor);
 
+ULONG
+NTAPI
+PALETTE_ulGetNearestCachedIndex(
+    PPALETTE ppal,
+    ULONG iColor);
+
+VOID
+NTAPI
+PALETTE_vInvalidateCache(
+    PPALETTE ppal);
+
 ULONG
 NTAPI
 PALETTE_ulGetNearestIndex(
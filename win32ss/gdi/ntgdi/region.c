@@ -509,8 +509,8 @@ REGION_bAddRect(
     return TRUE;
 }
 
-typedef VOID (FASTCALL *overlapProcp)(PREGION, PRECT, PRECT, PRECT, PRECT, INT, INT);
-typedef VOID (FASTCALL *nonOverlapProcp)(PREGION, PRECT, PRECT, INT, INT);
+typedef BOOL (FASTCALL *overlapProcp)(PREGION, PRECT, PRECT, PRECT, PRECT, INT, INT);
+typedef BOOL (FASTCALL *nonOverlapProcp)(PREGION, PRECT, PRECT, INT, INT);
 
 // Number of points to buffer before sending them off to scanlines() :  Must be an even number
 #define NUMPTSTOBUFFER 200
@@ -924,12 +924,66 @@ REGION_Coalesce(
     return (curStart);
 }
 
+/*!
+ *      Find the first band of a region that ends below the given scanline.
+ *      Bands are sorted and all rectangles of a band share the same bottom,
+ *      so the bottoms never decrease and a binary search is enough.
+ */
+static
+PRECTL
+FASTCALL
+REGION_pFindBandBelow(
+    PRECTL r,
+    PRECTL rEnd,
+    LONG y)
+{
+    PRECTL pMid;
+
+    while (r != rEnd)
+    {
+        pMid = r + (rEnd - r) / 2;
+        if (pMid->bottom <= y)
+        {
+            r = pMid + 1;
+        }
+        else
+        {
+            rEnd = pMid;
+        }
+    }
+
+    return r;
+}
+
+/*!
+ *      Copy whole bands that don't overlap the other region into the new
+ *      region. This is what the non-overlapping functions would do one band
+ *      at a time.
+ */
+static
+BOOL
+FASTCALL
+REGION_bCopyBands(
+    PREGION pReg,
+    PRECTL r,
+    PRECTL rEnd)
+{
+    if (!REGION_bEnsureBufferSize(pReg, pReg->rdh.nCount + (rEnd - r)))
+    {
+        return FALSE;
+    }
+
+    COPY_RECTS(pReg->Buffer + pReg->rdh.nCount, r, rEnd - r);
+    pReg->rdh.nCount += rEnd - r;
+    return TRUE;
+}
+
 /*!
  *      Apply an operation to two regions. Called by REGION_Union,
  *      REGION_Inverse, REGION_Subtract, REGION_Intersect...
  *
  * Results:
- *      None.
+ *      FALSE when out of memory, the new region is empty then.
  *
  * Side Effects:
  *      The new region is overwritten.
@@ -947,7 +1001,7 @@ REGION_Coalesce(
  *
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_RegionOp(
     PREGION newReg, /* Place to store result */
@@ -964,6 +1018,7 @@ REGION_RegionOp(
     INT ybot;                          /* Bottom of intersection */
     INT ytop;                          /* Top of intersection */
     RECTL *oldRects;                   /* Old rects for newReg */
+    ULONG oldSize;                     /* Old buffer size of newReg */
     ULONG prevBand;                    /* Index of start of
                                         * Previous band in newReg */
     ULONG curBand;                     /* Index of start of current band in newReg */
@@ -986,6 +1041,7 @@ REGION_RegionOp(
      * note of its rects pointer (so that we can free them later), preserve its
      * extents and simply set numRects to zero. */
     oldRects = newReg->Buffer;
+    oldSize = newReg->rdh.nRgnSize;
     newReg->rdh.nCount = 0;
 
     /* Allocate a reasonable number of rectangles for the new region. The idea
@@ -1000,8 +1056,7 @@ REGION_RegionOp(
                                            TAG_REGION);
     if (newReg->Buffer == NULL)
     {
-        newReg->rdh.nRgnSize = 0;
-        return;
+        goto Fail;
     }
 
     /* Initialize ybot and ytop.
@@ -1028,7 +1083,44 @@ REGION_RegionOp(
      * the possible expansion, and resultant moving, of the new region's
      * array of rectangles. */
     prevBand = 0;
-    do
+
+    /* Bands of one region lying completely above the other region can't
+     * intersect anything, so skip them in one go. Only the last one can
+     * still be coalesced with the following band. */
+    if (r1->bottom <= r2->top)
+    {
+        r1BandEnd = REGION_pFindBandBelow(r1, r1End, r2->top);
+        if (nonOverlap1Func != NULL)
+        {
+            if (!REGION_bCopyBands(newReg, r1, r1BandEnd))
+                goto Fail;
+        }
+        ybot = (r1BandEnd - 1)->bottom;
+        r1 = r1BandEnd;
+    }
+    else if (r2->bottom <= r1->top)
+    {
+        r2BandEnd = REGION_pFindBandBelow(r2, r2End, r1->top);
+        if (nonOverlap2Func != NULL)
+        {
+            if (!REGION_bCopyBands(newReg, r2, r2BandEnd))
+                goto Fail;
+        }
+        ybot = (r2BandEnd - 1)->bottom;
+        r2 = r2BandEnd;
+    }
+
+    if (newReg->rdh.nCount != 0)
+    {
+        prevBand = newReg->rdh.nCount - 1;
+        while ((prevBand != 0) &&
+               (newReg->Buffer[prevBand - 1].top == newReg->Buffer[prevBand].top))
+        {
+            prevBand--;
+        }
+    }
+
+    while ((r1 != r1End) && (r2 != r2End))
     {
         curBand = newReg->rdh.nCount;
 
@@ -1062,7 +1154,8 @@ REGION_RegionOp(
 
             if ((top != bot) && (nonOverlap1Func != NULL))
             {
-                (*nonOverlap1Func)(newReg, r1, r1BandEnd, top, bot);
+                if (!(*nonOverlap1Func)(newReg, r1, r1BandEnd, top, bot))
+                    goto Fail;
             }
 
             ytop = r2->top;
@@ -1074,7 +1167,8 @@ REGION_RegionOp(
 
             if ((top != bot) && (nonOverlap2Func != NULL))
             {
-                (*nonOverlap2Func)(newReg, r2, r2BandEnd, top, bot);
+                if (!(*nonOverlap2Func)(newReg, r2, r2BandEnd, top, bot))
+                    goto Fail;
             }
 
             ytop = r1->top;
@@ -1099,7 +1193,8 @@ REGION_RegionOp(
         curBand = newReg->rdh.nCount;
         if (ybot > ytop)
         {
-            (*overlapFunc)(newReg, r1, r1BandEnd, r2, r2BandEnd, ytop, ybot);
+            if (!(*overlapFunc)(newReg, r1, r1BandEnd, r2, r2BandEnd, ytop, ybot))
+                goto Fail;
         }
 
         if (newReg->rdh.nCount != curBand)
@@ -1118,7 +1213,6 @@ REGION_RegionOp(
             r2 = r2BandEnd;
         }
     }
-    while ((r1 != r1End) && (r2 != r2End));
 
     /* Deal with whichever region still has rectangles left. */
     curBand = newReg->rdh.nCount;
@@ -1126,42 +1220,41 @@ REGION_RegionOp(
     {
         if (nonOverlap1Func != NULL)
         {
-            do
+            /* Only the first band can have been partially handled already */
+            r1BandEnd = r1;
+            while ((r1BandEnd < r1End) && (r1BandEnd->top == r1->top))
             {
-                r1BandEnd = r1;
-                while ((r1BandEnd < r1End) && (r1BandEnd->top == r1->top))
-                {
-                    r1BandEnd++;
-                }
+                r1BandEnd++;
+            }
 
-                (*nonOverlap1Func)(newReg,
-                                   r1,
-                                   r1BandEnd,
-                                   max(r1->top,ybot),
-                                   r1->bottom);
-                r1 = r1BandEnd;
+            if (!(*nonOverlap1Func)(newReg,
+                                    r1,
+                                    r1BandEnd,
+                                    max(r1->top,ybot),
+                                    r1->bottom) ||
+                !REGION_bCopyBands(newReg, r1BandEnd, r1End))
+            {
+                goto Fail;
             }
-            while (r1 != r1End);
         }
     }
     else if ((r2 != r2End) && (nonOverlap2Func != NULL))
     {
-        do
+        r2BandEnd = r2;
+        while ((r2BandEnd < r2End) && (r2BandEnd->top == r2->top))
         {
-            r2BandEnd = r2;
-            while ((r2BandEnd < r2End) && (r2BandEnd->top == r2->top))
-            {
-                r2BandEnd++;
-            }
+            r2BandEnd++;
+        }
 
-            (*nonOverlap2Func)(newReg,
-                               r2,
-                               r2BandEnd,
-                               max(r2->top,ybot),
-                               r2->bottom);
-            r2 = r2BandEnd;
+        if (!(*nonOverlap2Func)(newReg,
+                                r2,
+                                r2BandEnd,
+                                max(r2->top,ybot),
+                                r2->bottom) ||
+            !REGION_bCopyBands(newReg, r2BandEnd, r2End))
+        {
+            goto Fail;
         }
-        while (r2 != r2End);
     }
 
     if (newReg->rdh.nCount != curBand)
@@ -1174,8 +1267,10 @@ REGION_RegionOp(
      * rectangles in the region. This never goes to 0, however...
      *
      * Only do this stuff if the number of rectangles allocated is more than
-     * twice the number of rectangles in the region (a simple optimization...). */
-    if ((newReg->rdh.nRgnSize > (2 * newReg->rdh.nCount * sizeof(RECT))) &&
+     * four times the number of rectangles in the region. The buffer was
+     * allocated twice as large as the larger source region, so this avoids
+     * copying the rectangles again in the common cases. */
+    if ((newReg->rdh.nRgnSize > (4 * newReg->rdh.nCount * sizeof(RECT))) &&
         (newReg->rdh.nCount > 2))
     {
         if (REGION_NOT_EMPTY(newReg))
@@ -1216,7 +1311,16 @@ REGION_RegionOp(
 
     if (oldRects != &newReg->rdh.rcBound)
         ExFreePoolWithTag(oldRects, TAG_REGION);
-    return;
+    return TRUE;
+
+Fail:
+    /* Out of memory, leave an empty region rather than a partial one */
+    if ((newReg->Buffer != NULL) && (newReg->Buffer != &newReg->rdh.rcBound))
+        ExFreePoolWithTag(newReg->Buffer, TAG_REGION);
+    newReg->Buffer = oldRects;
+    newReg->rdh.nRgnSize = oldSize;
+    EMPTY_REGION(newReg);
+    return FALSE;
 }
 
 /***********************************************************************
@@ -1228,14 +1332,14 @@ REGION_RegionOp(
  * Handle an overlapping band for REGION_Intersect.
  *
  * Results:
- *      None.
+ *      FALSE when out of memory.
  *
  * \note Side Effects:
  *      Rectangles may be added to the region.
  *
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_IntersectO(
     PREGION pReg,
@@ -1262,7 +1366,7 @@ REGION_IntersectO(
         {
             if (!REGION_bAddRect(pReg, left, top, right, bottom))
             {
-                return;
+                return FALSE;
             }
         }
 
@@ -1284,14 +1388,14 @@ REGION_IntersectO(
         }
     }
 
-    return;
+    return TRUE;
 }
 
 /***********************************************************************
  * REGION_IntersectRegion
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_IntersectRegion(
     PREGION newReg,
@@ -1307,12 +1411,15 @@ REGION_IntersectRegion(
     }
     else
     {
-        REGION_RegionOp(newReg,
-                        reg1,
-                        reg2,
-                        REGION_IntersectO,
-                        NULL,
-                        NULL);
+        if (!REGION_RegionOp(newReg,
+                             reg1,
+                             reg2,
+                             REGION_IntersectO,
+                             NULL,
+                             NULL))
+        {
+            return FALSE;
+        }
     }
 
     /* Can't alter newReg's extents before we call miRegionOp because
@@ -1321,6 +1428,7 @@ REGION_IntersectRegion(
      * way there's no checking against rectangles that will be nuked
      * due to coalescing, so we have to examine fewer rectangles. */
     REGION_SetExtents(newReg);
+    return TRUE;
 }
 
 /***********************************************************************
@@ -1333,7 +1441,7 @@ REGION_IntersectRegion(
  *      subsumption or anything.
  *
  * Results:
- *      None.
+ *      FALSE when out of memory.
  *
  * \note Side Effects:
  *      pReg->numRects is incremented and the final rectangles overwritten
@@ -1341,7 +1449,7 @@ REGION_IntersectRegion(
  *
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_UnionNonO(
     PREGION pReg,
@@ -1354,7 +1462,7 @@ REGION_UnionNonO(
     {
         if (!REGION_bEnsureBufferSize(pReg, pReg->rdh.nCount + (rEnd - r)))
         {
-            return;
+            return FALSE;
         }
 
         do
@@ -1365,7 +1473,7 @@ REGION_UnionNonO(
         while (r != rEnd);
     }
 
-    return;
+    return TRUE;
 }
 
 static __inline
@@ -1403,7 +1511,7 @@ REGION_bMergeRect(
  *      left-most rectangle each time and merges it into the region.
  *
  * Results:
- *      None.
+ *      FALSE when out of memory.
  *
  * \note Side Effects:
  *      Rectangles are overwritten in pReg->rects and pReg->numRects will
@@ -1411,7 +1519,7 @@ REGION_bMergeRect(
  *
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_UnionO (
     PREGION pReg,
@@ -1426,12 +1534,18 @@ REGION_UnionO (
     {
         if (r1->left < r2->left)
         {
-            REGION_bMergeRect(pReg, r1->left, top, r1->right, bottom);
+            if (!REGION_bMergeRect(pReg, r1->left, top, r1->right, bottom))
+            {
+                return FALSE;
+            }
             r1++;
         }
         else
         {
-            REGION_bMergeRect(pReg, r2->left, top, r2->right, bottom);
+            if (!REGION_bMergeRect(pReg, r2->left, top, r2->right, bottom))
+            {
+                return FALSE;
+            }
             r2++;
         }
     }
@@ -1440,7 +1554,10 @@ REGION_UnionO (
     {
         do
         {
-            REGION_bMergeRect(pReg, r1->left, top, r1->right, bottom);
+            if (!REGION_bMergeRect(pReg, r1->left, top, r1->right, bottom))
+            {
+                return FALSE;
+            }
             r1++;
         }
         while (r1 != r1End);
@@ -1449,19 +1566,22 @@ REGION_UnionO (
     {
         while (r2 != r2End)
         {
-            REGION_bMergeRect(pReg, r2->left, top, r2->right, bottom);
+            if (!REGION_bMergeRect(pReg, r2->left, top, r2->right, bottom))
+            {
+                return FALSE;
+            }
             r2++;
         }
     }
 
-    return;
+    return TRUE;
 }
 
 /***********************************************************************
  * REGION_UnionRegion
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_UnionRegion(
     PREGION newReg,
@@ -1476,10 +1596,10 @@ REGION_UnionRegion(
     {
         if (newReg != reg2)
         {
-            REGION_CopyRegion(newReg, reg2);
+            return REGION_CopyRegion(newReg, reg2);
         }
 
-        return;
+        return TRUE;
     }
 
     /* If nothing to union (region 2 empty) */
@@ -1489,10 +1609,10 @@ REGION_UnionRegion(
     {
         if (newReg != reg1)
         {
-            REGION_CopyRegion(newReg, reg1);
+            return REGION_CopyRegion(newReg, reg1);
         }
 
-        return;
+        return TRUE;
     }
 
     /* Region 1 completely subsumes region 2 */
@@ -1504,10 +1624,10 @@ REGION_UnionRegion(
     {
         if (newReg != reg1)
         {
-            REGION_CopyRegion(newReg, reg1);
+            return REGION_CopyRegion(newReg, reg1);
         }
 
-        return;
+        return TRUE;
     }
 
     /* Region 2 completely subsumes region 1 */
@@ -1519,23 +1639,27 @@ REGION_UnionRegion(
     {
         if (newReg != reg2)
         {
-            REGION_CopyRegion(newReg, reg2);
+            return REGION_CopyRegion(newReg, reg2);
         }
 
-        return;
+        return TRUE;
     }
 
-    REGION_RegionOp(newReg,
-                    reg1,
-                    reg2,
-                    REGION_UnionO,
-                    REGION_UnionNonO,
-                    REGION_UnionNonO);
+    if (!REGION_RegionOp(newReg,
+                         reg1,
+                         reg2,
+                         REGION_UnionO,
+                         REGION_UnionNonO,
+                         REGION_UnionNonO))
+    {
+        return FALSE;
+    }
 
     newReg->rdh.rcBound.left = min(reg1->rdh.rcBound.left, reg2->rdh.rcBound.left);
     newReg->rdh.rcBound.top = min(reg1->rdh.rcBound.top, reg2->rdh.rcBound.top);
     newReg->rdh.rcBound.right = max(reg1->rdh.rcBound.right, reg2->rdh.rcBound.right);
     newReg->rdh.rcBound.bottom = max(reg1->rdh.rcBound.bottom, reg2->rdh.rcBound.bottom);
+    return TRUE;
 }
 
 /***********************************************************************
@@ -1547,14 +1671,14 @@ REGION_UnionRegion(
  *      region 2 we discard. Anything from region 1 we add to the region.
  *
  * Results:
- *      None.
+ *      FALSE when out of memory.
  *
  * \note Side Effects:
  *      pReg may be affected.
  *
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_SubtractNonO1(
     PREGION pReg,
@@ -1567,7 +1691,7 @@ REGION_SubtractNonO1(
     {
         if (!REGION_bEnsureBufferSize(pReg, pReg->rdh.nCount + (rEnd - r)))
         {
-            return;
+            return FALSE;
         }
 
         do
@@ -1578,7 +1702,7 @@ REGION_SubtractNonO1(
         while (r != rEnd);
     }
 
-    return;
+    return TRUE;
 }
 
 
@@ -1587,14 +1711,14 @@ REGION_SubtractNonO1(
  *      checked.
  *
  * Results:
- *      None.
+ *      FALSE when out of memory.
  *
  * \note Side Effects:
  *      pReg may have rectangles added to it.
  *
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_SubtractO(
     PREGION pReg,
@@ -1641,7 +1765,7 @@ REGION_SubtractO(
              * part of minuend to region and skip to next subtrahend. */
             if (!REGION_bAddRect(pReg, left, top, r2->left, bottom))
             {
-                return;
+                return FALSE;
             }
 
             left = r2->right;
@@ -1665,7 +1789,7 @@ REGION_SubtractO(
             {
                 if (!REGION_bAddRect(pReg, left, top, r1->right, bottom))
                 {
-                    return;
+                    return FALSE;
                 }
             }
 
@@ -1680,7 +1804,7 @@ REGION_SubtractO(
     {
         if (!REGION_bEnsureBufferSize(pReg, pReg->rdh.nCount + (r1End - r1)))
         {
-            return;
+            return FALSE;
         }
 
         /* Add remaining minuend rectangles to region. */
@@ -1696,7 +1820,7 @@ REGION_SubtractO(
         while (r1 != r1End);
     }
 
-    return;
+    return TRUE;
 }
 
 /*!
@@ -1704,14 +1828,14 @@ REGION_SubtractO(
  *      S stands for subtrahend, M for minuend and D for difference.
  *
  * Results:
- *      TRUE.
+ *      FALSE when out of memory, regD is empty then.
  *
  * \note Side Effects:
  *      regD is overwritten.
  *
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_SubtractRegion(
     PREGION regD,
@@ -1723,16 +1847,29 @@ REGION_SubtractRegion(
         (regS->rdh.nCount == 0) ||
         (EXTENTCHECK(&regM->rdh.rcBound, &regS->rdh.rcBound) == 0))
     {
-        REGION_CopyRegion(regD, regM);
-        return;
+        return REGION_CopyRegion(regD, regM);
     }
 
-    REGION_RegionOp(regD,
-                    regM,
-                    regS,
-                    REGION_SubtractO,
-                    REGION_SubtractNonO1,
-                    NULL);
+    /* Subtrahend is a single rectangle covering all of the minuend */
+    if ((regS->rdh.nCount == 1) &&
+        (regS->rdh.rcBound.left <= regM->rdh.rcBound.left) &&
+        (regS->rdh.rcBound.top <= regM->rdh.rcBound.top) &&
+        (regM->rdh.rcBound.right <= regS->rdh.rcBound.right) &&
+        (regM->rdh.rcBound.bottom <= regS->rdh.rcBound.bottom))
+    {
+        EMPTY_REGION(regD);
+        return TRUE;
+    }
+
+    if (!REGION_RegionOp(regD,
+                         regM,
+                         regS,
+                         REGION_SubtractO,
+                         REGION_SubtractNonO1,
+                         NULL))
+    {
+        return FALSE;
+    }
 
     /* Can't alter newReg's extents before we call miRegionOp because
      * it might be one of the source regions and miRegionOp depends
@@ -1740,13 +1877,14 @@ REGION_SubtractRegion(
      * way there's no checking against rectangles that will be nuked
      * due to coalescing, so we have to examine fewer rectangles. */
     REGION_SetExtents(regD);
+    return TRUE;
 }
 
 /***********************************************************************
  * REGION_XorRegion
  */
 static
-VOID
+BOOL
 FASTCALL
 REGION_XorRegion(
     PREGION dr,
@@ -1755,12 +1893,13 @@ REGION_XorRegion(
 {
     HRGN htra, htrb;
     PREGION tra, trb;
+    BOOL bResult;
 
     // FIXME: Don't use a handle
     tra = REGION_AllocRgnWithHandle(sra->rdh.nCount + 1);
     if (tra == NULL)
     {
-        return;
+        return FALSE;
     }
     htra = tra->BaseObject.hHmgr;
 
@@ -1770,26 +1909,32 @@ REGION_XorRegion(
     {
         REGION_UnlockRgn(tra);
         GreDeleteObject(htra);
-        return;
+        return FALSE;
     }
     htrb = trb->BaseObject.hHmgr;
 
-    REGION_SubtractRegion(tra, sra, srb);
-    REGION_SubtractRegion(trb, srb, sra);
-    REGION_UnionRegion(dr, tra, trb);
+    bResult = REGION_SubtractRegion(tra, sra, srb) &&
+              REGION_SubtractRegion(trb, srb, sra) &&
+              REGION_UnionRegion(dr, tra, trb);
     REGION_UnlockRgn(tra);
     REGION_UnlockRgn(trb);
 
     GreDeleteObject(htra);
     GreDeleteObject(htrb);
-    return;
+
+    if (!bResult)
+    {
+        EMPTY_REGION(dr);
+    }
+
+    return bResult;
 }
 
 
 /*!
  * Adds a rectangle to a REGION
  */
-VOID
+BOOL
 FASTCALL
 REGION_UnionRectWithRgn(
     PREGION rgn,
@@ -1801,7 +1946,7 @@ REGION_UnionRectWithRgn(
     region.rdh.nCount = 1;
     region.rdh.nRgnSize = sizeof(RECT);
     region.rdh.rcBound = *rect;
-    REGION_UnionRegion(rgn, rgn, &region);
+    return REGION_UnionRegion(rgn, rgn, &region);
 }
 
 INT
@@ -1817,7 +1962,9 @@ REGION_SubtractRectFromRgn(
     rgnLocal.rdh.nCount = 1;
     rgnLocal.rdh.nRgnSize = sizeof(RECT);
     rgnLocal.rdh.rcBound = *prcl;
-    REGION_SubtractRegion(prgnDest, prgnSrc, &rgnLocal);
+    if (!REGION_SubtractRegion(prgnDest, prgnSrc, &rgnLocal))
+        return ERROR;
+
     return REGION_Complexity(prgnDest);
 }
 
@@ -1920,6 +2067,8 @@ REGION_bMakeFrameRegion(
     _In_ INT cx,
     _In_ INT cy)
 {
+    BOOL bResult;
+
     /* Handle negative cx / cy */
     cx = abs(cx);
     cy = abs(cy);
@@ -1968,33 +2117,31 @@ REGION_bMakeFrameRegion(
     NT_VERIFY(REGION_bOffsetRgn(prgnSrc, cx, cy));
 
     /* Intersect with the source region (this crops the top-left frame) */
-    REGION_IntersectRegion(prgnDest, prgnDest, prgnSrc);
+    bResult = REGION_IntersectRegion(prgnDest, prgnDest, prgnSrc);
 
     /* Move the source region to the bottom-left */
     NT_VERIFY(REGION_bOffsetRgn(prgnSrc, -2 * cx, 0));
 
     /* Intersect with the source region (this crops the top-right frame) */
-    REGION_IntersectRegion(prgnDest, prgnDest, prgnSrc);
+    bResult = REGION_IntersectRegion(prgnDest, prgnDest, prgnSrc) && bResult;
 
     /* Move the source region to the top-left */
     NT_VERIFY(REGION_bOffsetRgn(prgnSrc, 0, -2 * cy));
 
     /* Intersect with the source region (this crops the bottom-right frame) */
-    REGION_IntersectRegion(prgnDest, prgnDest, prgnSrc);
+    bResult = REGION_IntersectRegion(prgnDest, prgnDest, prgnSrc) && bResult;
 
     /* Move the source region to the top-right  */
     NT_VERIFY(REGION_bOffsetRgn(prgnSrc, 2 * cx, 0));
 
     /* Intersect with the source region (this crops the bottom-left frame) */
-    REGION_IntersectRegion(prgnDest, prgnDest, prgnSrc);
+    bResult = REGION_IntersectRegion(prgnDest, prgnDest, prgnSrc) && bResult;
 
     /* Move the source region back to the original position */
     NT_VERIFY(REGION_bOffsetRgn(prgnSrc, -cx, cy));
 
     /* Finally subtract the cropped region from the source */
-    REGION_SubtractRegion(prgnDest, prgnSrc, prgnDest);
-
-    return TRUE;
+    return bResult && REGION_SubtractRegion(prgnDest, prgnSrc, prgnDest);
 }
 
 HRGN
@@ -2500,16 +2647,20 @@ IntGdiCombineRgn(
     switch (iCombineMode)
     {
         case RGN_AND:
-            REGION_IntersectRegion(prgnDest, prgnSrc1, prgnSrc2);
+            if (!REGION_IntersectRegion(prgnDest, prgnSrc1, prgnSrc2))
+                return ERROR;
             break;
         case RGN_OR:
-            REGION_UnionRegion(prgnDest, prgnSrc1, prgnSrc2);
+            if (!REGION_UnionRegion(prgnDest, prgnSrc1, prgnSrc2))
+                return ERROR;
             break;
         case RGN_XOR:
-            REGION_XorRegion(prgnDest, prgnSrc1, prgnSrc2);
+            if (!REGION_XorRegion(prgnDest, prgnSrc1, prgnSrc2))
+                return ERROR;
             break;
         case RGN_DIFF:
-            REGION_SubtractRegion(prgnDest, prgnSrc1, prgnSrc2);
+            if (!REGION_SubtractRegion(prgnDest, prgnSrc1, prgnSrc2))
+                return ERROR;
             break;
     }
 
@@ -3659,10 +3810,12 @@ NtGdiCreateRoundRectRgn(
             /* Move toward center */
             rect.top = top++;
             rect.bottom = rect.top + 1;
-            REGION_UnionRectWithRgn(obj, &rect);
+            if (!REGION_UnionRectWithRgn(obj, &rect))
+                goto Failure;
             rect.top = --bottom;
             rect.bottom = rect.top + 1;
-            REGION_UnionRectWithRgn(obj, &rect);
+            if (!REGION_UnionRectWithRgn(obj, &rect))
+                goto Failure;
             yd -= 2*asq;
             d  -= yd;
         }
@@ -3681,10 +3834,12 @@ NtGdiCreateRoundRectRgn(
         /* next vertical point */
         rect.top = top++;
         rect.bottom = rect.top + 1;
-        REGION_UnionRectWithRgn(obj, &rect);
+        if (!REGION_UnionRectWithRgn(obj, &rect))
+            goto Failure;
         rect.top = --bottom;
         rect.bottom = rect.top + 1;
-        REGION_UnionRectWithRgn(obj, &rect);
+        if (!REGION_UnionRectWithRgn(obj, &rect))
+            goto Failure;
 
         /* If nearest pixel is outside ellipse */
         if (d < 0)
@@ -3705,11 +3860,18 @@ NtGdiCreateRoundRectRgn(
     {
         rect.top = top;
         rect.bottom = bottom;
-        REGION_UnionRectWithRgn(obj, &rect);
+        if (!REGION_UnionRectWithRgn(obj, &rect))
+            goto Failure;
     }
 
     REGION_UnlockRgn(obj);
     return hrgn;
+
+Failure:
+    /* The region is empty now, don't hand out a partial shape */
+    EngSetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    REGION_Delete(obj);
+    return NULL;
 }
 
 BOOL
@@ -3858,10 +4020,14 @@ NtGdiExtCreateRegion(
         /* Insert the rectangles one by one */
         for(i=0; i<nCount; i++)
         {
-            REGION_UnionRectWithRgn(Region, &rects[i]);
+            if (!REGION_UnionRectWithRgn(Region, &rects[i]))
+            {
+                Status = STATUS_NO_MEMORY;
+                break;
+            }
         }
 
-        if (Xform != NULL)
+        if (NT_SUCCESS(Status) && (Xform != NULL))
         {
             ULONG ret;
 
@@ -3892,7 +4058,8 @@ NtGdiExtCreateRegion(
     _SEH2_END;
     if (!NT_SUCCESS(Status))
     {
-        EngSetLastError(ERROR_INVALID_PARAMETER);
+        EngSetLastError((Status == STATUS_NO_MEMORY) ?
+                        ERROR_NOT_ENOUGH_MEMORY : ERROR_INVALID_PARAMETER);
         REGION_UnlockRgn(Region);
         GreDeleteObject(hRgn);
         return NULL;
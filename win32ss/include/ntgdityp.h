@@ -349,6 +349,21 @@ typedef struct _GDIHANDLECACHE
     HANDLE          Handle[CACHE_BRUSH_ENTRIES+CACHE_PEN_ENTRIES+CACHE_REGION_ENTRIES+CACHE_LFONT_ENTRIES];
 } GDIHANDLECACHE, *PGDIHANDLECACHE;
 
+/* ReactOS specific NtGdiGetStats index, returns FONT_CACHE_INFO */
+#define GS_GLYPH_CACHE_INFO   0x1000
+
+/* Glyph cache statistics, see ftGdiGlyphCacheQueryInfo */
+typedef struct _FONT_CACHE_INFO
+{
+    ULONG NumEntries;
+    ULONG MaxEntries;
+    ULONG CacheBytes;
+    ULONG MaxCacheBytes;
+    ULONG Hits;
+    ULONG Misses;
+    ULONG Evictions;
+} FONT_CACHE_INFO, *PFONT_CACHE_INFO;
+
 /* Font Structures */
 typedef struct _TMDIFF
 {
@@ -532,6 +547,9 @@ typedef struct _GDIBSSETBRHORG
   POINTL ptlBrushOrigin;
 } GDIBSSETBRHORG, *PGDIBSSETBRHORG;
 
+/* Set in fnMode to remove the clip region instead of using rcl */
+#define GDIBS_NO_CLIP_REGION 0x80000000
+
 typedef struct _GDIBSEXTSELCLPRGN
 {
   GDIBATCHHDR gbHdr;
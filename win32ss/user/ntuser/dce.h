@@ -29,6 +29,11 @@ typedef struct tagDCE
     PTHREADINFO  ptiOwner;
     PPROCESSINFO ppiOwner;
     struct _MONITOR* pMonitor;
+    /* Last visible region computed through this DCE, valid while ulVisRgnUnique is current */
+    struct _REGION *prgnVisCache;
+    HWND         hwndVisCache;
+    DWORD        fVisCacheFlags;
+    ULONG        ulVisRgnUnique;
 } DCE, *PDCE;
 
 /* internal DCX flags, see psdk/winuser.h for the rest */
@@ -980,6 +980,13 @@ DriverEntry(
     NT_ROF(InitGdiHandleTable());
     NT_ROF(InitPaletteImpl());
 
+#if DBG
+    if (!DIB_BitBltSelfTest())
+    {
+        DPRINT1("The generated DIB blit routines failed their self test!\n");
+    }
+#endif
+
     /* Create stock objects, ie. precreated objects commonly
        used by win32 applications */
     CreateStockObjects();
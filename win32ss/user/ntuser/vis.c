@@ -9,6 +9,8 @@
 #include <win32k.h>
 DBG_DEFAULT_CHANNEL(UserWinpos);
 
+ULONG gulVisRgnUnique = 0;
+
 PREGION FASTCALL
 VIS_ComputeVisibleRegion(
    PWND Wnd,
@@ -9,7 +9,18 @@
 
 #pragma once
 
+/* Changes whenever the position, z-order, style or shape of any window changes */
+extern ULONG gulVisRgnUnique;
+
 PREGION FASTCALL VIS_ComputeVisibleRegion(PWND Window, BOOLEAN ClientArea, BOOLEAN ClipChildren, BOOLEAN ClipSiblings);
 VOID FASTCALL co_VIS_WindowLayoutChanged(PWND Window, PREGION UncoveredRgn);
 
+/* Drops the visible regions cached in the DCEs */
+FORCEINLINE
+VOID
+VIS_InvalidateCache(VOID)
+{
+    gulVisRgnUnique++;
+}
+
 /* EOF */
@@ -66,18 +66,54 @@ DceGetDceFromDC(HDC hdc)
     return NULL;
 }
 
+/*
+ * Each DCE remembers the last visible region it computed, so GetDC doesn't
+ * walk all the siblings again when nothing moved. VIS_InvalidateCache drops
+ * it on any change to the window tree that could make a difference.
+ */
 static
 PREGION FASTCALL
-DceGetVisRgn(PWND Window, ULONG Flags, HWND hWndChild, ULONG CFlags)
+DceGetVisRgn(PDCE Dce, PWND Window, ULONG Flags, HWND hWndChild, ULONG CFlags)
 {
     PREGION Rgn;
+    DWORD VisFlags = Flags & (DCX_WINDOW | DCX_CLIPCHILDREN | DCX_CLIPSIBLINGS);
+
+    if (Dce->prgnVisCache &&
+        Dce->ulVisRgnUnique == gulVisRgnUnique &&
+        Dce->hwndVisCache == Window->head.h &&
+        Dce->fVisCacheFlags == VisFlags)
+    {
+        Rgn = IntSysCreateRectpRgn(0, 0, 0, 0);
+        if (Rgn && IntGdiCombineRgn(Rgn, Dce->prgnVisCache, NULL, RGN_COPY) != ERROR)
+            return Rgn;
+        if (Rgn)
+            REGION_Delete(Rgn);
+    }
+
     Rgn = VIS_ComputeVisibleRegion( Window,
                                     0 == (Flags & DCX_WINDOW),
                                     0 != (Flags & DCX_CLIPCHILDREN),
                                     0 != (Flags & DCX_CLIPSIBLINGS));
     /* Caller expects a non-null region */
     if (!Rgn)
-        Rgn = IntSysCreateRectpRgn(0, 0, 0, 0);
+        return IntSysCreateRectpRgn(0, 0, 0, 0);
+
+    if (!Dce->prgnVisCache)
+        Dce->prgnVisCache = IntSysCreateRectpRgn(0, 0, 0, 0);
+
+    if (Dce->prgnVisCache &&
+        IntGdiCombineRgn(Dce->prgnVisCache, Rgn, NULL, RGN_COPY) != ERROR)
+    {
+        Dce->hwndVisCache = Window->head.h;
+        Dce->fVisCacheFlags = VisFlags;
+        Dce->ulVisRgnUnique = gulVisRgnUnique;
+    }
+    else
+    {
+        /* Make sure a stale region is never used */
+        Dce->hwndVisCache = NULL;
+    }
+
     return Rgn;
 }
 
@@ -105,6 +141,8 @@ DceAllocDCE(PWND Window OPTIONAL, DCE_TYPE Type)
   pDce->hrgnClipPublic = NULL;
   pDce->hrgnSavedVis = NULL;
   pDce->ppiOwner = NULL;
+  pDce->prgnVisCache = NULL;
+  pDce->hwndVisCache = NULL;
 
   InsertTailList(&LEDce, &pDce->List);
 
@@ -214,7 +252,7 @@ DceUpdateVisRgn(DCE *Dce, PWND Window, ULONG Flags)
       {
          DcxFlags = Flags & ~(DCX_CLIPSIBLINGS | DCX_CLIPCHILDREN | DCX_WINDOW);
       }
-      RgnVisible = DceGetVisRgn(Parent, DcxFlags, Window->head.h, Flags);
+      RgnVisible = DceGetVisRgn(Dce, Parent, DcxFlags, Window->head.h, Flags);
    }
    else if (Window == NULL)
    {
@@ -230,7 +268,7 @@ DceUpdateVisRgn(DCE *Dce, PWND Window, ULONG Flags)
    }
    else
    {
-      RgnVisible = DceGetVisRgn(Window, Flags, 0, 0);
+      RgnVisible = DceGetVisRgn(Dce, Window, Flags, 0, 0);
    }
 
 noparent:
@@ -668,6 +706,12 @@ DceFreeDCE(PDCE pdce, BOOLEAN Force)
       pdce->hrgnClip = NULL;
   }
 
+  if (pdce->prgnVisCache)
+  {
+      REGION_Delete(pdce->prgnVisCache);
+      pdce->prgnVisCache = NULL;
+  }
+
   RemoveEntryList(&pdce->List);
 
   ExFreePoolWithTag(pdce, USERTAG_DCE);
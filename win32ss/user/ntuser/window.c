@@ -128,6 +128,7 @@ IntSetStyle( PWND pwnd, ULONG set_bits, ULONG clear_bits )
     styleNew = (pwnd->style | set_bits) & ~clear_bits;
     if (styleNew == styleOld) return styleNew;
     pwnd->style = styleNew;
+    VIS_InvalidateCache();
     if ((styleOld ^ styleNew) & WS_VISIBLE) // State Change.
     {
        if (styleOld & WS_VISIBLE) pwnd->head.pti->cVisWindows--;
@@ -523,6 +524,7 @@ LRESULT co_UserFreeWindow(PWND Window,
    }
    Window->state2 |= WNDS2_INDESTROY;
    Window->style &= ~WS_VISIBLE;
+   VIS_InvalidateCache();
    Window->head.pti->cVisWindows--;
 
 
@@ -864,6 +866,8 @@ IntLinkWindow(
    PWND WndInsertAfter /* set to NULL if top sibling */
 )
 {
+  VIS_InvalidateCache();
+
   if ((Wnd->spwndPrev = WndInsertAfter))
    {
       /* link after WndInsertAfter */
@@ -1144,6 +1148,7 @@ co_IntSetParent(PWND Wnd, PWND WndNewParent)
        !(Wnd->style & WS_CLIPSIBLINGS) )
    {
       Wnd->style |= WS_CLIPSIBLINGS;
+      VIS_InvalidateCache();
       DceResetActiveDCEs(Wnd);
    }
 
@@ -1251,6 +1256,8 @@ co_UserSetParent(HWND hWndChild, HWND hWndNewParent)
 VOID FASTCALL
 IntUnlinkWindow(PWND Wnd)
 {
+   VIS_InvalidateCache();
+
    if (Wnd->spwndNext)
        Wnd->spwndNext->spwndPrev = Wnd->spwndPrev;
 
@@ -3655,6 +3662,7 @@ co_IntSetWindowLongPtr(HWND hWnd, DWORD Index, LONG_PTR NewValue, BOOL Ansi, ULO
             }
 
             Window->ExStyle = (DWORD)Style.styleNew;
+            VIS_InvalidateCache();
 
             co_IntSendMessage(hWnd, WM_STYLECHANGED, GWL_EXSTYLE, (LPARAM) &Style);
             break;
@@ -3708,6 +3716,7 @@ co_IntSetWindowLongPtr(HWND hWnd, DWORD Index, LONG_PTR NewValue, BOOL Ansi, ULO
                DceResetActiveDCEs( Window );
             }
             Window->style = (DWORD)Style.styleNew;
+            VIS_InvalidateCache();
 
             if (!bAlter)
                 co_IntSendMessage(hWnd, WM_STYLECHANGED, GWL_STYLE, (LPARAM) &Style);
@@ -278,6 +278,8 @@ SelectWindowRgn(PWND Window, HRGN hRgnClip)
 
         Window->hrgnClip = hRgnClip;
     }
+
+    VIS_InvalidateCache();
 }
 
 //
@@ -1490,6 +1492,7 @@ WinPosInternalMoveWindow(PWND Window, INT MoveX, INT MoveY)
 
    ASSERT(Window != Window->spwndChild);
    TRACE("InternalMoveWin  X %d Y %d\n", MoveX, MoveY);
+   VIS_InvalidateCache();
 
    Window->rcWindow.left += MoveX;
    Window->rcWindow.right += MoveX;
@@ -1818,6 +1821,7 @@ co_WinPosSetWindowPos(
 
    Window->rcWindow = NewWindowRect;
    Window->rcClient = NewClientRect;
+   VIS_InvalidateCache();
 
    /* erase parent when hiding or resizing child */
    if (WinPos.flags & SWP_HIDEWINDOW)
@@ -1833,6 +1837,7 @@ co_WinPosSetWindowPos(
 
       Window->style &= ~WS_VISIBLE; //IntSetStyle( Window, 0, WS_VISIBLE );
       Window->head.pti->cVisWindows--;
+      VIS_InvalidateCache();
       IntNotifyWinEvent(EVENT_OBJECT_HIDE, Window, OBJID_WINDOW, CHILDID_SELF, WEF_SETBYWNDPTI);
    }
    else if (WinPos.flags & SWP_SHOWWINDOW)
@@ -1845,6 +1850,7 @@ co_WinPosSetWindowPos(
 
       Window->style |= WS_VISIBLE; //IntSetStyle( Window, WS_VISIBLE, 0 );
       Window->head.pti->cVisWindows++;
+      VIS_InvalidateCache();
       IntNotifyWinEvent(EVENT_OBJECT_SHOW, Window, OBJID_WINDOW, CHILDID_SELF, WEF_SETBYWNDPTI);
    }
 